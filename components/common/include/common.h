@@ -11,8 +11,46 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
 #define CONFIG_ONBOARD_LED_GPIO   8     // ESP32 C3 Super mini https://www.espboards.dev/esp32/esp32-c3-super-mini/
 
+/* Temperatures are centi-degrees C (7.83 C is 783) from the parser to the
+ * strip, so nothing on the way needs floats */
+#define TEMP_CENTI_PER_C    100
+
+/* A centi-degree value as degrees: printf("now=" TEMP_C_FMT, TEMP_C_ARGS(t)) */
+#define TEMP_C_FMT          "%s%d.%02d"
+#define TEMP_C_ARGS(centi)  ((centi) < 0 ? "-" : ""), abs(centi) / TEMP_CENTI_PER_C, abs(centi) % TEMP_CENTI_PER_C
+
 typedef void (*light_animate_and_set_cb_t)(int temp_min, int temp_now, int temp_max);
 
+/* As light_animate_and_set_cb_t, on one of several strips (0 is the first) */
+typedef void (*light_strip_set_cb_t)(int strip, int temp_min, int temp_now, int temp_max);
+
+/* A new reading, dt is the forecast time of temp_now (unix seconds) */
+typedef void (*forecast_record_cb_t)(int64_t dt, int temp_min, int temp_now, int temp_max);
+
+/* One fetch cycle, for telemetry. Durations are microseconds, 0 for a step
+ * that wasn't needed (cached address, kept-alive connection). */
+typedef struct {
+    int status;                 // HTTP status, -1 on a network error
+    bool reused;
+    int64_t dt;                 // of the reading being shown, 0 if none yet
+    int temp_min;
+    int temp_now;
+    int temp_max;
+    uint32_t dns_us;
+    uint32_t connect_us;
+    uint32_t first_byte_us;
+    uint32_t parse_us;
+} fetch_report_t;
+
+typedef void (*fetch_report_cb_t)(const fetch_report_t *report);
+
+/* Every strip is done animating, render_us is the CPU time spent composing & sending the frames */
+typedef void (*render_report_cb_t)(uint32_t render_us);
+
 #define OPENWEATHERMAP_LOCATION "Dublin,IE"
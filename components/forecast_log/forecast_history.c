@@ -0,0 +1,115 @@
+/**
+ * @file forecast_history.c
+ * @author The Authors
+ * @brief The device's forecast history: forecast_log on its flash partition
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "sdkconfig.h"
+#include "forecast_history.h"
+
+static const char *TAG = "forecast_history";
+
+static forecast_log_t s_log;
+static SemaphoreHandle_t s_log_lock;    // appends (http_get_task) vs queries (MQTT task)
+
+static esp_err_t partition_read(void *ctx, size_t offset, void *buf, size_t len) {
+    return esp_partition_read((const esp_partition_t *)ctx, offset, buf, len);
+}
+
+static esp_err_t partition_write(void *ctx, size_t offset, const void *buf, size_t len) {
+    return esp_partition_write((const esp_partition_t *)ctx, offset, buf, len);
+}
+
+static esp_err_t partition_erase_sector(void *ctx, size_t offset) {
+    const esp_partition_t *part = ctx;
+    return esp_partition_erase_range(part, offset, part->erase_size);
+}
+
+esp_err_t forecast_history_init(void) {
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                           CONFIG_FORECAST_LOG_PARTITION_LABEL);
+    if (!part) {
+        ESP_LOGW(TAG, "No \"%s\" partition, history disabled", CONFIG_FORECAST_LOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const forecast_log_flash_t flash = {
+        .read = partition_read,
+        .write = partition_write,
+        .erase_sector = partition_erase_sector,
+        .sector_size = part->erase_size,
+        .size = part->size - part->size % part->erase_size,
+        .ctx = (void *)part,
+    };
+    esp_err_t err = forecast_log_open(&s_log, &flash);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Can't open the log: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    s_log_lock = xSemaphoreCreateMutex();
+    if (!s_log_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "sectors=%" PRIu32 " head=%" PRIu32 " seq=%" PRIu32 " used=%u torn=%" PRIu32 " last dt=%lld",
+             s_log.sectors, s_log.head, s_log.head_seq, (unsigned)s_log.head_offset, s_log.stats.torn,
+             s_log.has_last ? (long long)s_log.last.dt : 0LL);
+    return ESP_OK;
+}
+
+void forecast_history_record(int64_t dt, int temp_min, int temp_now, int temp_max) {
+    if (!s_log_lock) {
+        return;
+    }
+    const forecast_record_t rec = {
+        .dt = dt,
+        .temp_min = temp_min,
+        .temp_now = temp_now,
+        .temp_max = temp_max,
+    };
+    xSemaphoreTake(s_log_lock, portMAX_DELAY);
+    esp_err_t err = forecast_log_append(&s_log, &rec);
+    xSemaphoreGive(s_log_lock);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Append failed: %s", esp_err_to_name(err));
+    }
+}
+
+bool forecast_history_last(forecast_record_t *rec) {
+    if (!s_log_lock) {
+        return false;
+    }
+    xSemaphoreTake(s_log_lock, portMAX_DELAY);
+    bool found = forecast_log_last(&s_log, rec);
+    xSemaphoreGive(s_log_lock);
+    return found;
+}
+
+size_t forecast_history_query(int64_t since_dt, forecast_history_visit_t visit, void *ctx) {
+    forecast_log_iter_t it;
+    forecast_record_t rec;
+    size_t count = 0;
+
+    if (!s_log_lock) {
+        return 0;
+    }
+    xSemaphoreTake(s_log_lock, portMAX_DELAY);
+    forecast_log_iter_init(&s_log, &it, since_dt);
+    while (forecast_log_iter_next(&it, &rec)) {
+        count++;
+        if (!visit(ctx, &rec)) {
+            break;
+        }
+    }
+    xSemaphoreGive(s_log_lock);
+    return count;
+}
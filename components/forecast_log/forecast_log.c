@@ -0,0 +1,311 @@
+/**
+ * @file forecast_log.c
+ * @author The Authors
+ * @brief Append-only, delta-encoded forecast history on raw (NOR) flash
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * See forecast_log.h for the layout. A typical record (next 3 hour slot,
+ * temperatures within a few degrees) takes about 11 bytes against 20 raw.
+ */
+#include <string.h>
+#include "forecast_log.h"
+
+#define LOG_MAGIC       0x32474c46u     // "FLG2", "FLOG" had whole degrees and starts over
+#define ERASED          0xff
+
+typedef struct {
+    uint32_t seq;
+    uint32_t seq_inv;       // written in the same operation, catches a torn header
+    uint32_t reserved;
+    uint32_t magic;         // last, so it's only there once the rest is
+} sector_header_t;
+
+_Static_assert(sizeof(sector_header_t) == FORECAST_LOG_HEADER_SIZE, "header size");
+
+typedef enum {
+    RECORD_OK,
+    RECORD_TORN,
+    RECORD_END,
+} record_status_t;
+
+static uint8_t crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static size_t put_varint(uint8_t *out, int64_t value) {
+    uint64_t zz = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    size_t n = 0;
+    while (zz >= 0x80) {
+        out[n++] = (uint8_t)(zz | 0x80);
+        zz >>= 7;
+    }
+    out[n++] = (uint8_t)zz;
+    return n;
+}
+
+static bool get_varint(const uint8_t **in, const uint8_t *end, int64_t *value) {
+    uint64_t zz = 0;
+    for (int shift = 0; shift < 64 && *in < end; shift += 7) {
+        uint8_t byte = *(*in)++;
+        zz |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = (int64_t)(zz >> 1) ^ -(int64_t)(zz & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief len | payload | crc8, deltas to prev or absolute if prev is NULL
+ */
+static size_t encode(const forecast_record_t *rec, const forecast_record_t *prev, uint8_t *out) {
+    static const forecast_record_t zero;
+    if (!prev) {
+        prev = &zero;
+    }
+    size_t n = 1;
+    n += put_varint(out + n, rec->dt - prev->dt);
+    n += put_varint(out + n, (int64_t)rec->temp_min - prev->temp_min);
+    n += put_varint(out + n, (int64_t)rec->temp_now - prev->temp_now);
+    n += put_varint(out + n, (int64_t)rec->temp_max - prev->temp_max);
+    out[0] = (uint8_t)(n - 1);
+    out[n] = crc8(out, n);
+    return n + 1;
+}
+
+static bool decode(const uint8_t *payload, size_t len, const forecast_record_t *prev, forecast_record_t *rec) {
+    static const forecast_record_t zero;
+    const uint8_t *end = payload + len;
+    int64_t d_dt, d_min, d_now, d_max;
+    if (!prev) {
+        prev = &zero;
+    }
+    if (!get_varint(&payload, end, &d_dt) || !get_varint(&payload, end, &d_min)
+            || !get_varint(&payload, end, &d_now) || !get_varint(&payload, end, &d_max) || payload != end) {
+        return false;
+    }
+    rec->dt = prev->dt + d_dt;
+    rec->temp_min = (int32_t)(prev->temp_min + d_min);
+    rec->temp_now = (int32_t)(prev->temp_now + d_now);
+    rec->temp_max = (int32_t)(prev->temp_max + d_max);
+    return true;
+}
+
+static inline size_t sector_base(const forecast_log_t *log, uint32_t sector) {
+    return (size_t)sector * log->flash.sector_size;
+}
+
+static bool read_header(const forecast_log_t *log, uint32_t sector, uint32_t *seq) {
+    sector_header_t hdr;
+    if (log->flash.read(log->flash.ctx, sector_base(log, sector), &hdr, sizeof(hdr)) != ESP_OK) {
+        return false;
+    }
+    if (hdr.magic != LOG_MAGIC || hdr.seq != ~hdr.seq_inv) {
+        return false;
+    }
+    *seq = hdr.seq;
+    return true;
+}
+
+/**
+ * @brief Read the record at offset. *next is where the following one starts,
+ *        for RECORD_END that's the end of the used part of the sector.
+ */
+static record_status_t read_record(const forecast_log_t *log, uint32_t sector, size_t offset,
+                                   const forecast_record_t *prev, forecast_record_t *rec, size_t *next) {
+    uint8_t buf[FORECAST_LOG_RECORD_MAX];
+    size_t sector_size = log->flash.sector_size;
+    size_t base = sector_base(log, sector);
+
+    *next = offset;
+    if (offset + 2 > sector_size || log->flash.read(log->flash.ctx, base + offset, buf, 1) != ESP_OK || buf[0] == ERASED) {
+        return RECORD_END;
+    }
+    size_t len = buf[0];
+    if (len == 0 || len + 2 > sizeof(buf) || offset + len + 2 > sector_size) {
+        *next = sector_size;    // garbage length, nothing after it can be trusted
+        return RECORD_TORN;
+    }
+    *next = offset + len + 2;
+    if (log->flash.read(log->flash.ctx, base + offset + 1, buf + 1, len + 1) != ESP_OK) {
+        return RECORD_END;
+    }
+    if (crc8(buf, len + 1) != buf[len + 1] || !decode(buf + 1, len, prev, rec)) {
+        return RECORD_TORN;
+    }
+    return RECORD_OK;
+}
+
+/**
+ * @brief Walk a whole sector: last good record & where the free space starts
+ */
+static bool scan_sector(forecast_log_t *log, uint32_t sector, forecast_record_t *last, size_t *end) {
+    forecast_record_t rec;
+    bool found = false;
+    size_t offset = FORECAST_LOG_HEADER_SIZE;
+    size_t next;
+    record_status_t status;
+
+    while ((status = read_record(log, sector, offset, found ? last : NULL, &rec, &next)) != RECORD_END) {
+        if (status == RECORD_OK) {
+            *last = rec;
+            found = true;
+        } else {
+            log->stats.torn++;
+        }
+        offset = next;
+    }
+    *end = next;
+    return found;
+}
+
+static esp_err_t start_sector(forecast_log_t *log, uint32_t sector, uint32_t seq) {
+    sector_header_t hdr = {
+        .seq = seq,
+        .seq_inv = ~seq,
+        .reserved = 0xffffffffu,
+        .magic = LOG_MAGIC,
+    };
+    esp_err_t err = log->flash.erase_sector(log->flash.ctx, sector_base(log, sector));
+    if (err != ESP_OK) {
+        return err;
+    }
+    log->stats.erases++;
+    err = log->flash.write(log->flash.ctx, sector_base(log, sector), &hdr, sizeof(hdr));
+    if (err != ESP_OK) {
+        return err;
+    }
+    log->head = sector;
+    log->head_seq = seq;
+    log->head_offset = FORECAST_LOG_HEADER_SIZE;
+    log->head_has_record = false;
+    return ESP_OK;
+}
+
+esp_err_t forecast_log_open(forecast_log_t *log, const forecast_log_flash_t *flash) {
+    memset(log, 0, sizeof(*log));
+    log->flash = *flash;
+    if (flash->sector_size <= FORECAST_LOG_HEADER_SIZE + FORECAST_LOG_RECORD_MAX || flash->size / flash->sector_size < 2) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    log->sectors = flash->size / flash->sector_size;
+
+    bool found = false;
+    for (uint32_t sector = 0; sector < log->sectors; sector++) {
+        uint32_t seq;
+        if (read_header(log, sector, &seq) && (!found || seq > log->head_seq)) {
+            log->head = sector;
+            log->head_seq = seq;
+            found = true;
+        }
+    }
+    if (!found) {
+        return start_sector(log, 0, 1);
+    }
+
+    log->head_has_record = scan_sector(log, log->head, &log->last, &log->head_offset);
+    log->has_last = log->head_has_record;
+
+    /* Head only just started: the last record is in an older sector */
+    for (uint32_t back = 1; !log->has_last && back < log->sectors; back++) {
+        uint32_t sector = (log->head + log->sectors - back) % log->sectors;
+        uint32_t seq;
+        size_t end;
+        if (!read_header(log, sector, &seq) || seq != log->head_seq - back) {
+            break;
+        }
+        log->has_last = scan_sector(log, sector, &log->last, &end);
+    }
+    return ESP_OK;
+}
+
+esp_err_t forecast_log_append(forecast_log_t *log, const forecast_record_t *rec) {
+    uint8_t buf[FORECAST_LOG_RECORD_MAX];
+
+    if (log->has_last && rec->dt == log->last.dt && rec->temp_min == log->last.temp_min
+            && rec->temp_now == log->last.temp_now && rec->temp_max == log->last.temp_max) {
+        log->stats.duplicates++;
+        return ESP_OK;
+    }
+
+    size_t len = encode(rec, log->head_has_record ? &log->last : NULL, buf);
+    if (log->head_offset + len > log->flash.sector_size) {
+        /* Wrap onto the oldest sector */
+        esp_err_t err = start_sector(log, (log->head + 1) % log->sectors, log->head_seq + 1);
+        if (err != ESP_OK) {
+            return err;
+        }
+        len = encode(rec, NULL, buf);
+    }
+
+    esp_err_t err = log->flash.write(log->flash.ctx, sector_base(log, log->head) + log->head_offset, buf, len);
+    log->head_offset += len;    // even on failure, part of it may be programmed
+    if (err != ESP_OK) {
+        return err;
+    }
+    log->last = *rec;
+    log->has_last = true;
+    log->head_has_record = true;
+    log->stats.appends++;
+    return ESP_OK;
+}
+
+bool forecast_log_last(const forecast_log_t *log, forecast_record_t *rec) {
+    if (log->has_last) {
+        *rec = log->last;
+    }
+    return log->has_last;
+}
+
+void forecast_log_iter_init(const forecast_log_t *log, forecast_log_iter_t *it, int64_t since_dt) {
+    memset(it, 0, sizeof(*it));
+    it->log = log;
+    it->since_dt = since_dt;
+}
+
+bool forecast_log_iter_next(forecast_log_iter_t *it, forecast_record_t *rec) {
+    const forecast_log_t *log = it->log;
+
+    while (it->visited < log->sectors) {
+        if (it->offset == 0) {
+            /* Oldest first: the sector after head, round to head itself */
+            uint32_t seq;
+            uint32_t age = log->sectors - 1 - it->visited;
+            it->sector = (log->head + 1 + it->visited) % log->sectors;
+            if (!read_header(log, it->sector, &seq) || seq != log->head_seq - age) {
+                it->visited++;
+                continue;
+            }
+            it->offset = FORECAST_LOG_HEADER_SIZE;
+            it->has_prev = false;
+        }
+
+        size_t next;
+        record_status_t status = read_record(log, it->sector, it->offset, it->has_prev ? &it->prev : NULL, rec, &next);
+        if (status == RECORD_END) {
+            it->visited++;
+            it->offset = 0;
+            continue;
+        }
+        it->offset = next;
+        if (status == RECORD_OK) {
+            it->prev = *rec;
+            it->has_prev = true;
+            if (rec->dt >= it->since_dt) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file file_flash.c
+ * @author The Authors
+ * @brief NOR flash emulated in a file, with erase counters & power cuts
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "file_flash.h"
+
+esp_err_t file_flash_open(file_flash_t *ff, const char *path, size_t size, size_t sector_size) {
+    memset(ff, 0, sizeof(*ff));
+    ff->file = fopen(path, "w+b");
+    ff->erase_counts = calloc(size / sector_size, sizeof(ff->erase_counts[0]));
+    if (!ff->file || !ff->erase_counts) {
+        file_flash_close(ff);
+        return ESP_FAIL;
+    }
+    ff->size = size;
+    ff->sector_size = sector_size;
+    ff->write_budget = -1;
+
+    uint8_t blank[256];
+    memset(blank, 0xff, sizeof(blank));
+    for (size_t off = 0; off < size; off += sizeof(blank)) {
+        fwrite(blank, 1, size - off < sizeof(blank) ? size - off : sizeof(blank), ff->file);
+    }
+    fflush(ff->file);
+    return ESP_OK;
+}
+
+void file_flash_close(file_flash_t *ff) {
+    if (ff->file) {
+        fclose(ff->file);
+    }
+    free(ff->erase_counts);
+    memset(ff, 0, sizeof(*ff));
+}
+
+void file_flash_cut_power_after(file_flash_t *ff, long bytes) {
+    ff->write_budget = bytes;
+}
+
+void file_flash_power_on(file_flash_t *ff) {
+    ff->power_lost = false;
+    ff->write_budget = -1;
+}
+
+static esp_err_t ff_read(void *ctx, size_t offset, void *buf, size_t len) {
+    file_flash_t *ff = ctx;
+    if (ff->power_lost || offset + len > ff->size) {
+        return ESP_FAIL;
+    }
+    fseek(ff->file, (long)offset, SEEK_SET);
+    return fread(buf, 1, len, ff->file) == len ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t ff_write(void *ctx, size_t offset, const void *buf, size_t len) {
+    file_flash_t *ff = ctx;
+    uint8_t cell[64];
+    const uint8_t *src = buf;
+
+    if (ff->power_lost || offset + len > ff->size) {
+        return ESP_FAIL;
+    }
+    while (len > 0) {
+        size_t n = len < sizeof(cell) ? len : sizeof(cell);
+        if (ff->write_budget >= 0 && (long)n > ff->write_budget) {
+            n = ff->write_budget;
+        }
+        /* Programming only clears bits */
+        fseek(ff->file, (long)offset, SEEK_SET);
+        if (fread(cell, 1, n, ff->file) != n) {
+            return ESP_FAIL;
+        }
+        for (size_t i = 0; i < n; i++) {
+            cell[i] &= src[i];
+        }
+        fseek(ff->file, (long)offset, SEEK_SET);
+        fwrite(cell, 1, n, ff->file);
+        fflush(ff->file);
+
+        offset += n;
+        src += n;
+        len -= n;
+        if (ff->write_budget >= 0) {
+            ff->write_budget -= n;
+            if (ff->write_budget == 0 && len > 0) {
+                ff->power_lost = true;
+                return ESP_FAIL;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t ff_erase_sector(void *ctx, size_t offset) {
+    file_flash_t *ff = ctx;
+    uint8_t blank[256];
+
+    if (ff->power_lost || offset % ff->sector_size || offset >= ff->size) {
+        return ESP_FAIL;
+    }
+    memset(blank, 0xff, sizeof(blank));
+    fseek(ff->file, (long)offset, SEEK_SET);
+    for (size_t done = 0; done < ff->sector_size; done += sizeof(blank)) {
+        size_t n = ff->sector_size - done < sizeof(blank) ? ff->sector_size - done : sizeof(blank);
+        fwrite(blank, 1, n, ff->file);
+    }
+    fflush(ff->file);
+    ff->erase_counts[offset / ff->sector_size]++;
+    return ESP_OK;
+}
+
+forecast_log_flash_t file_flash_ops(file_flash_t *ff) {
+    return (forecast_log_flash_t) {
+        .read = ff_read,
+        .write = ff_write,
+        .erase_sector = ff_erase_sector,
+        .sector_size = ff->sector_size,
+        .size = ff->size,
+        .ctx = ff,
+    };
+}
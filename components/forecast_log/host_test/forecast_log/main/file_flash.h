@@ -0,0 +1,49 @@
+/**
+ * @file file_flash.h
+ * @author The Authors
+ * @brief NOR flash emulated in a file, with erase counters & power cuts
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "forecast_log.h"
+
+typedef struct {
+    FILE *file;
+    size_t size;
+    size_t sector_size;
+    uint32_t *erase_counts;     // per sector
+    long write_budget;          // bytes still programmed before the power goes, < 0: no limit
+    bool power_lost;
+} file_flash_t;
+
+/**
+ * @brief Create a blank (all 0xff) flash image at path
+ */
+esp_err_t file_flash_open(file_flash_t *ff, const char *path, size_t size, size_t sector_size);
+
+void file_flash_close(file_flash_t *ff);
+
+/**
+ * @brief Lose power part way through a write: the first `bytes` more bytes are
+ *        programmed, then every operation fails until file_flash_power_on()
+ */
+void file_flash_cut_power_after(file_flash_t *ff, long bytes);
+
+/**
+ * @brief Power back on, the image keeps whatever was programmed
+ */
+void file_flash_power_on(file_flash_t *ff);
+
+/**
+ * @brief forecast_log flash primitives backed by ff
+ */
+forecast_log_flash_t file_flash_ops(file_flash_t *ff);
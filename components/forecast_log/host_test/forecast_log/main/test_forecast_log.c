@@ -0,0 +1,243 @@
+/**
+ * @file test_forecast_log.c
+ * @author The Authors
+ * @brief Host tests for the forecast history log on file-emulated flash
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * "Reboots" reopen the log from whatever the flash image holds.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "unity.h"
+#include "forecast_log.h"
+#include "file_flash.h"
+
+#define FIRST_DT        1734609600LL
+#define SLOT_SECONDS    (3 * 3600)
+
+static char s_path[64];
+
+/* Something like a real run of readings: 3 hour steps, drifting
+ * temperatures in centi-degrees */
+static forecast_record_t reading(int i) {
+    static const int16_t wobble[8] = { 0, -83, -291, -417, -502, -388, -176, -54 };
+    forecast_record_t rec = {
+        .dt = FIRST_DT + (int64_t)i * SLOT_SECONDS,
+        .temp_now = 812 + wobble[i % 8] - (i / 40) % 12 * 100,
+    };
+    rec.temp_min = rec.temp_now - 317 - i % 2 * 45;
+    rec.temp_max = rec.temp_now + 208;
+    return rec;
+}
+
+static void assert_record(const forecast_record_t *expected, const forecast_record_t *actual) {
+    TEST_ASSERT_EQUAL_INT64(expected->dt, actual->dt);
+    TEST_ASSERT_EQUAL(expected->temp_min, actual->temp_min);
+    TEST_ASSERT_EQUAL(expected->temp_now, actual->temp_now);
+    TEST_ASSERT_EQUAL(expected->temp_max, actual->temp_max);
+}
+
+static void open_log(forecast_log_t *log, file_flash_t *ff) {
+    forecast_log_flash_t flash = file_flash_ops(ff);
+    TEST_ASSERT_EQUAL(ESP_OK, forecast_log_open(log, &flash));
+}
+
+/* Every record from the first index, in order, and nothing else */
+static void assert_history(const forecast_log_t *log, int first, int last) {
+    forecast_log_iter_t it;
+    forecast_record_t rec;
+    int i = first;
+
+    forecast_log_iter_init(log, &it, 0);
+    while (forecast_log_iter_next(&it, &rec)) {
+        forecast_record_t expected = reading(i++);
+        assert_record(&expected, &rec);
+    }
+    TEST_ASSERT_EQUAL(last + 1, i);
+}
+
+static void test_append_reopen(void) {
+    file_flash_t ff;
+    forecast_log_t log;
+    forecast_record_t rec;
+
+    TEST_ASSERT_EQUAL(ESP_OK, file_flash_open(&ff, s_path, 16 * 4096, 4096));
+    open_log(&log, &ff);
+    TEST_ASSERT_FALSE(forecast_log_last(&log, &rec));
+
+    for (int i = 0; i < 100; i++) {
+        rec = reading(i);
+        TEST_ASSERT_EQUAL(ESP_OK, forecast_log_append(&log, &rec));
+    }
+    /* A 304 or an unchanged forecast doesn't cost flash */
+    TEST_ASSERT_EQUAL(ESP_OK, forecast_log_append(&log, &rec));
+    TEST_ASSERT_EQUAL(1, log.stats.duplicates);
+
+    size_t used = log.head_offset - FORECAST_LOG_HEADER_SIZE;
+    printf("LOG 100 records in %u bytes (%u.%02u bytes/record, raw %u)\n", (unsigned)used,
+           (unsigned)(used / 100), (unsigned)(used % 100), (unsigned)(sizeof(int64_t) + 3 * sizeof(int32_t)));
+    TEST_ASSERT_LESS_THAN(12 * 100, used);     // centi-degree deltas take 2 bytes each
+
+    /* Power cycle */
+    open_log(&log, &ff);
+    TEST_ASSERT_TRUE(forecast_log_last(&log, &rec));
+    forecast_record_t expected = reading(99);
+    assert_record(&expected, &rec);
+    assert_history(&log, 0, 99);
+
+    /* Only the tail */
+    forecast_log_iter_t it;
+    forecast_log_iter_init(&log, &it, reading(95).dt);
+    int count = 0;
+    while (forecast_log_iter_next(&it, &rec)) {
+        count++;
+    }
+    TEST_ASSERT_EQUAL(5, count);
+
+    file_flash_close(&ff);
+}
+
+static void test_wrap_wears_evenly(void) {
+    file_flash_t ff;
+    forecast_log_t log;
+    const size_t sectors = 4;
+    const int total = 2000;
+
+    TEST_ASSERT_EQUAL(ESP_OK, file_flash_open(&ff, s_path, sectors * 256, 256));
+    open_log(&log, &ff);
+    for (int i = 0; i < total; i++) {
+        forecast_record_t rec = reading(i);
+        TEST_ASSERT_EQUAL(ESP_OK, forecast_log_append(&log, &rec));
+    }
+
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (size_t s = 0; s < sectors; s++) {
+        lo = ff.erase_counts[s] < lo ? ff.erase_counts[s] : lo;
+        hi = ff.erase_counts[s] > hi ? ff.erase_counts[s] : hi;
+    }
+    printf("LOG %d records through %u sectors: erases %u..%u\n", total, (unsigned)sectors, (unsigned)lo, (unsigned)hi);
+    TEST_ASSERT_GREATER_THAN(1, lo);
+    TEST_ASSERT_LESS_OR_EQUAL(lo + 1, hi);
+
+    /* Newest records survive, contiguous up to the last one */
+    open_log(&log, &ff);
+    forecast_log_iter_t it;
+    forecast_record_t rec;
+    forecast_log_iter_init(&log, &it, 0);
+    TEST_ASSERT_TRUE(forecast_log_iter_next(&it, &rec));
+    int first = (int)((rec.dt - FIRST_DT) / SLOT_SECONDS);
+    TEST_ASSERT_GREATER_THAN(total - 200, first);
+    assert_history(&log, first, total - 1);
+
+    file_flash_close(&ff);
+}
+
+static void test_torn_record(void) {
+    forecast_record_t rec;
+    uint8_t probe[FORECAST_LOG_RECORD_MAX];
+
+    /* Every cut point through one record, including none at all */
+    for (long cut = 0; cut < (long)sizeof(probe); cut++) {
+        file_flash_t ff;
+        forecast_log_t log;
+
+        TEST_ASSERT_EQUAL(ESP_OK, file_flash_open(&ff, s_path, 4 * 4096, 4096));
+        open_log(&log, &ff);
+        for (int i = 0; i < 10; i++) {
+            rec = reading(i);
+            TEST_ASSERT_EQUAL(ESP_OK, forecast_log_append(&log, &rec));
+        }
+        size_t before = log.head_offset;
+        file_flash_cut_power_after(&ff, cut);
+        rec = reading(10);
+        bool complete = forecast_log_append(&log, &rec) == ESP_OK;
+        size_t record_len = log.head_offset - before;
+        file_flash_power_on(&ff);
+
+        open_log(&log, &ff);
+        TEST_ASSERT_TRUE(forecast_log_last(&log, &rec));
+        forecast_record_t expected = reading(complete ? 10 : 9);
+        assert_record(&expected, &rec);
+        if (!complete && cut > 0) {
+            TEST_ASSERT_EQUAL(1, log.stats.torn);
+            TEST_ASSERT_EQUAL(before + record_len, log.head_offset);     // stepped over
+        }
+
+        /* Appends carry on after the damage */
+        for (int i = complete ? 11 : 10; i < 20; i++) {
+            rec = reading(i);
+            TEST_ASSERT_EQUAL(ESP_OK, forecast_log_append(&log, &rec));
+        }
+        open_log(&log, &ff);
+        assert_history(&log, 0, 19);
+
+        file_flash_close(&ff);
+        if (complete) {
+            break;
+        }
+    }
+}
+
+static void test_torn_sector_start(void) {
+    forecast_record_t rec;
+
+    /* Power goes between erasing the next sector & finishing its header */
+    for (long cut = 0; cut < FORECAST_LOG_HEADER_SIZE; cut++) {
+        file_flash_t ff;
+        forecast_log_t log;
+        int i = 0;
+
+        TEST_ASSERT_EQUAL(ESP_OK, file_flash_open(&ff, s_path, 4 * 256, 256));
+        open_log(&log, &ff);
+        while (log.head == 0) {
+            rec = reading(i++);
+            TEST_ASSERT_EQUAL(ESP_OK, forecast_log_append(&log, &rec));
+        }
+        /* Rewind: redo the append that opened sector 1, with the power failing */
+        file_flash_close(&ff);
+        TEST_ASSERT_EQUAL(ESP_OK, file_flash_open(&ff, s_path, 4 * 256, 256));
+        open_log(&log, &ff);
+        for (int j = 0; j < i - 1; j++) {
+            rec = reading(j);
+            TEST_ASSERT_EQUAL(ESP_OK, forecast_log_append(&log, &rec));
+        }
+        TEST_ASSERT_EQUAL(0, log.head);
+        file_flash_cut_power_after(&ff, cut);
+        rec = reading(i - 1);
+        TEST_ASSERT_NOT_EQUAL(ESP_OK, forecast_log_append(&log, &rec));
+        file_flash_power_on(&ff);
+
+        open_log(&log, &ff);
+        TEST_ASSERT_EQUAL(0, log.head);
+        TEST_ASSERT_TRUE(forecast_log_last(&log, &rec));
+        forecast_record_t expected = reading(i - 2);
+        assert_record(&expected, &rec);
+
+        for (int j = i - 1; j < i + 10; j++) {
+            rec = reading(j);
+            TEST_ASSERT_EQUAL(ESP_OK, forecast_log_append(&log, &rec));
+        }
+        open_log(&log, &ff);
+        assert_history(&log, 0, i + 9);
+        file_flash_close(&ff);
+    }
+}
+
+void app_main(void)
+{
+    snprintf(s_path, sizeof(s_path), "/tmp/forecast_log_%d.bin", (int)getpid());
+
+    UNITY_BEGIN();
+    RUN_TEST(test_append_reopen);
+    RUN_TEST(test_wrap_wears_evenly);
+    RUN_TEST(test_torn_record);
+    RUN_TEST(test_torn_sector_start);
+    int failures = UNITY_END();
+    unlink(s_path);
+    exit(failures);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file forecast_history.h
+ * @author The Authors
+ * @brief The device's forecast history: forecast_log on its flash partition
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "forecast_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Return false to stop the walk */
+typedef bool (*forecast_history_visit_t)(void *ctx, const forecast_record_t *rec);
+
+/**
+ * @brief Open the log on CONFIG_FORECAST_LOG_PARTITION_LABEL. Only reads the
+ *        sector headers & the newest sector, so it's quick enough for boot.
+ *
+ * @return esp_err_t    ESP_ERR_NOT_FOUND without the partition
+ */
+esp_err_t forecast_history_init(void);
+
+/**
+ * @brief Append a reading, matches forecast_record_cb_t. A no-op if the log
+ *        isn't open.
+ *
+ * @param dt
+ * @param temp_min  centi-degrees C
+ * @param temp_now
+ * @param temp_max
+ */
+void forecast_history_record(int64_t dt, int temp_min, int temp_now, int temp_max);
+
+/**
+ * @brief The most recent reading
+ *
+ * @param[out] rec
+ * @return false if there isn't one
+ */
+bool forecast_history_last(forecast_record_t *rec);
+
+/**
+ * @brief Call visit for every reading with dt >= since_dt, oldest first.
+ *        Records are read from flash one at a time.
+ *
+ * @param since_dt
+ * @param visit
+ * @param ctx
+ * @return size_t   records visited
+ */
+size_t forecast_history_query(int64_t since_dt, forecast_history_visit_t visit, void *ctx);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file forecast_log.h
+ * @author The Authors
+ * @brief Append-only, delta-encoded forecast history on raw (NOR) flash
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The region is a ring of erase sectors, each starting with a header carrying
+ * a sequence number. Sectors are filled in turn and the oldest one is erased
+ * when the ring wraps, so every sector sees the same number of erases.
+ *
+ * Record layout, byte aligned:
+ *   len (1) | payload (len) | crc8 (1) over len & payload
+ * payload: zigzag varints of dt, temp_min, temp_now & temp_max. The first
+ * record of a sector holds absolute values, the rest deltas to the previous
+ * record, so any sector decodes on its own. A record cut short by a power
+ * loss fails its CRC and is skipped, appends continue after it.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FORECAST_LOG_HEADER_SIZE    16
+#define FORECAST_LOG_RECORD_MAX     (1 + 4 * 10 + 1)
+
+typedef struct {
+    int64_t dt;             // forecast time of temp_now, unix seconds
+    int32_t temp_min;       // centi-degrees C
+    int32_t temp_now;
+    int32_t temp_max;
+} forecast_record_t;
+
+/* Flash primitives, NOR semantics: erase sets 0xff, writes only clear bits */
+typedef struct {
+    esp_err_t (*read)(void *ctx, size_t offset, void *buf, size_t len);
+    esp_err_t (*write)(void *ctx, size_t offset, const void *buf, size_t len);
+    esp_err_t (*erase_sector)(void *ctx, size_t offset);
+    size_t sector_size;
+    size_t size;            // whole sectors only, at least 2
+    void *ctx;
+} forecast_log_flash_t;
+
+typedef struct {
+    uint32_t appends;
+    uint32_t duplicates;    // appends skipped, same as the last record
+    uint32_t erases;
+    uint32_t torn;          // damaged records stepped over when opening
+} forecast_log_stats_t;
+
+typedef struct {
+    forecast_log_flash_t flash;
+    uint32_t sectors;
+    uint32_t head;          // sector being appended to
+    uint32_t head_seq;
+    size_t head_offset;     // next free byte in head
+    bool has_last;
+    bool head_has_record;   // false: the next append is absolute
+    forecast_record_t last;
+    forecast_log_stats_t stats;
+} forecast_log_t;
+
+typedef struct {
+    const forecast_log_t *log;
+    int64_t since_dt;
+    uint32_t visited;       // sectors done
+    uint32_t sector;
+    size_t offset;          // 0: sector not opened yet
+    bool has_prev;
+    forecast_record_t prev;
+} forecast_log_iter_t;
+
+/**
+ * @brief Find the newest sector & the last record. A blank region is formatted.
+ *
+ * @param log
+ * @param flash     copied
+ * @return esp_err_t
+ */
+esp_err_t forecast_log_open(forecast_log_t *log, const forecast_log_flash_t *flash);
+
+/**
+ * @brief Append a record, unless it's the same as the last one
+ *
+ * @param log
+ * @param rec
+ * @return esp_err_t
+ */
+esp_err_t forecast_log_append(forecast_log_t *log, const forecast_record_t *rec);
+
+/**
+ * @brief The most recent record, without touching flash
+ *
+ * @param log
+ * @param[out] rec
+ * @return false if the log is empty
+ */
+bool forecast_log_last(const forecast_log_t *log, forecast_record_t *rec);
+
+/**
+ * @brief Walk the records oldest first, one flash read at a time. Appending
+ *        while iterating is not supported.
+ *
+ * @param log
+ * @param it
+ * @param since_dt  records with an older dt are skipped
+ */
+void forecast_log_iter_init(const forecast_log_t *log, forecast_log_iter_t *it, int64_t since_dt);
+
+/**
+ * @brief Next record
+ *
+ * @param it
+ * @param[out] rec
+ * @return false at the end
+ */
+bool forecast_log_iter_next(forecast_log_iter_t *it, forecast_record_t *rec);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
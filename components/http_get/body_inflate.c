@@ -0,0 +1,328 @@
+/**
+ * @file body_inflate.c
+ * @author The Authors
+ * @brief Streaming gzip / deflate decoder between the response framing and the parser
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "body_inflate.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <zlib.h>
+#else
+#include "miniz.h"
+#include "esp_rom_crc.h"
+#endif
+
+/* Parts of a gzip header (RFC 1952), in order */
+enum { GZ_FIXED, GZ_XLEN, GZ_EXTRA, GZ_NAME, GZ_COMMENT, GZ_HCRC, GZ_END };
+
+#define GZ_FHCRC        0x02
+#define GZ_FEXTRA       0x04
+#define GZ_FNAME        0x08
+#define GZ_FCOMMENT     0x10
+#define GZ_FRESERVED    0xe0
+
+#define GZIP_TRAILER    8       // CRC-32, ISIZE
+#define ZLIB_TRAILER    4       // Adler-32, big-endian
+
+/*
+ * The raw deflate decoder: inflate what it can of in into the window at
+ * window_pos. *in_len is how much there is and comes back as how much was
+ * used, *out_len how much came out. 1 at the end of the stream, 0 for more,
+ * -1 on bad data.
+ */
+#if CONFIG_IDF_TARGET_LINUX
+static bool decoder_new(body_inflate_t *z) {
+    z_stream *s = calloc(1, sizeof(*s));
+    if (!s || inflateInit2(s, -15) != Z_OK) {
+        free(s);
+        return false;
+    }
+    z->decoder = s;
+    return true;
+}
+
+static void decoder_free(body_inflate_t *z) {
+    if (z->decoder) {
+        inflateEnd(z->decoder);
+        free(z->decoder);
+    }
+}
+
+static int decoder_run(body_inflate_t *z, const uint8_t *in, size_t *in_len, size_t *out_len) {
+    z_stream *s = z->decoder;
+    size_t room = BODY_INFLATE_WINDOW - z->window_pos;
+
+    s->next_in = (Bytef *)in;
+    s->avail_in = *in_len;
+    s->next_out = z->window + z->window_pos;
+    s->avail_out = room;
+    int err = inflate(s, Z_NO_FLUSH);
+    *in_len -= s->avail_in;
+    *out_len = room - s->avail_out;
+    if (err == Z_STREAM_END) {
+        return 1;
+    }
+    return err == Z_OK || err == Z_BUF_ERROR ? 0 : -1;
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t *buf, size_t len) {
+    return crc32(crc, buf, len);
+}
+
+static uint32_t adler_update(uint32_t adler, const uint8_t *buf, size_t len) {
+    return adler32(adler, buf, len);
+}
+#else
+static bool decoder_new(body_inflate_t *z) {
+    tinfl_decompressor *d = malloc(sizeof(*d));
+    if (!d) {
+        return false;
+    }
+    tinfl_init(d);
+    z->decoder = d;
+    return true;
+}
+
+static void decoder_free(body_inflate_t *z) {
+    free(z->decoder);
+}
+
+static int decoder_run(body_inflate_t *z, const uint8_t *in, size_t *in_len, size_t *out_len) {
+    *out_len = BODY_INFLATE_WINDOW - z->window_pos;
+    tinfl_status status = tinfl_decompress(z->decoder, in, in_len, z->window, z->window + z->window_pos, out_len,
+                                           TINFL_FLAG_HAS_MORE_INPUT);
+    if (status == TINFL_STATUS_DONE) {
+        return 1;
+    }
+    return status < 0 ? -1 : 0;
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t *buf, size_t len) {
+    return esp_rom_crc32_le(crc, buf, len);
+}
+
+/* RFC 1950, the ROM has no Adler-32 */
+static uint32_t adler_update(uint32_t adler, const uint8_t *buf, size_t len) {
+    uint32_t a = adler & 0xffff;
+    uint32_t b = adler >> 16;
+
+    while (len) {
+        size_t n = len < 5552 ? len : 5552;     // the most before b can overflow 32 bits
+        len -= n;
+        while (n--) {
+            a += *buf++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return b << 16 | a;
+}
+#endif
+
+static void emit(body_inflate_t *z, const uint8_t *buf, size_t len) {
+    if (z->encoding == HTTP_ENCODING_GZIP) {
+        z->check = crc_update(z->check, buf, len);
+    } else if (z->trailer_want == ZLIB_TRAILER) {
+        z->check = adler_update(z->check, buf, len);
+    }
+    z->out_bytes += len;
+    z->out_cb(z->out_ctx, (const char *)buf, len);
+}
+
+/* Bytes of in used */
+static size_t inflate_data(body_inflate_t *z, const uint8_t *in, size_t len) {
+    size_t used = 0;
+
+    while (z->state == BODY_INFLATE_DATA) {
+        size_t in_n = len - used;
+        size_t out_n = 0;
+        int r = decoder_run(z, in + used, &in_n, &out_n);
+        used += in_n;
+        if (out_n) {
+            emit(z, z->window + z->window_pos, out_n);
+            z->window_pos = (z->window_pos + out_n) & (BODY_INFLATE_WINDOW - 1);
+        }
+        if (r < 0) {
+            z->state = BODY_INFLATE_ERROR;
+        } else if (r > 0) {
+            z->state = z->trailer_want ? BODY_INFLATE_TRAILER : BODY_INFLATE_DONE;
+        } else if (used == len && out_n == 0) {
+            break;                      // wants more input
+        }
+    }
+    return used;
+}
+
+/* On to the next part of the gzip header from stage on that this one has */
+static void gzip_part(body_inflate_t *z, uint8_t stage) {
+    static const uint8_t flag[GZ_END] = {
+        [GZ_XLEN] = GZ_FEXTRA, [GZ_NAME] = GZ_FNAME, [GZ_COMMENT] = GZ_FCOMMENT, [GZ_HCRC] = GZ_FHCRC,
+    };
+    for (; stage < GZ_END; stage++) {
+        if (flag[stage] & z->gzip_flags) {
+            z->hdr_stage = stage;
+            z->hdr_left = stage == GZ_XLEN || stage == GZ_HCRC ? 2 : 0;
+            z->hdr_value = 0;
+            return;
+        }
+    }
+    z->state = BODY_INFLATE_DATA;
+}
+
+static void gzip_header_byte(body_inflate_t *z, uint8_t c) {
+    switch (z->hdr_stage) {
+    case GZ_FIXED: {
+        /* ID1 ID2 CM FLG MTIME(4) XFL OS */
+        unsigned at = 10 - z->hdr_left;
+        if ((at == 0 && c != 0x1f) || (at == 1 && c != 0x8b) || (at == 2 && c != 8) || (at == 3 && (c & GZ_FRESERVED))) {
+            z->state = BODY_INFLATE_ERROR;
+            return;
+        }
+        if (at == 3) {
+            z->gzip_flags = c;
+        }
+        if (--z->hdr_left == 0) {
+            gzip_part(z, GZ_XLEN);
+        }
+        break;
+    }
+    case GZ_XLEN:
+        z->hdr_value |= c << (8 * (2 - z->hdr_left));
+        if (--z->hdr_left == 0) {
+            if (z->hdr_value) {
+                z->hdr_stage = GZ_EXTRA;
+                z->hdr_left = z->hdr_value;
+            } else {
+                gzip_part(z, GZ_NAME);
+            }
+        }
+        break;
+    case GZ_EXTRA:
+        if (--z->hdr_left == 0) {
+            gzip_part(z, GZ_NAME);
+        }
+        break;
+    case GZ_NAME:
+    case GZ_COMMENT:
+        if (c == 0) {
+            gzip_part(z, z->hdr_stage + 1);
+        }
+        break;
+    case GZ_HCRC:
+        if (--z->hdr_left == 0) {
+            gzip_part(z, GZ_END);
+        }
+        break;
+    }
+}
+
+/* "deflate" should be zlib wrapped (RFC 9110), but some servers send it raw */
+static void deflate_header_byte(body_inflate_t *z, uint8_t c) {
+    z->trailer[z->trailer_len++] = c;
+    if (z->trailer_len < 2) {
+        return;
+    }
+    uint8_t cmf = z->trailer[0];
+    uint8_t flg = z->trailer[1];
+    bool zlib = (cmf & 0x0f) == 8 && (cmf >> 4) <= 7 && ((cmf << 8) | flg) % 31 == 0 && !(flg & 0x20);
+
+    z->trailer_len = 0;
+    z->state = BODY_INFLATE_DATA;
+    if (zlib) {
+        z->trailer_want = ZLIB_TRAILER;
+        z->check = 1;
+    } else {
+        uint8_t start[2] = { cmf, flg };
+        inflate_data(z, start, sizeof(start));
+    }
+}
+
+static void trailer_byte(body_inflate_t *z, uint8_t c) {
+    z->trailer[z->trailer_len++] = c;
+    if (z->trailer_len < z->trailer_want) {
+        return;
+    }
+    z->state = BODY_INFLATE_DONE;
+    const uint8_t *t = z->trailer;
+    if (z->encoding == HTTP_ENCODING_GZIP) {
+        uint32_t crc = t[0] | t[1] << 8 | t[2] << 16 | (uint32_t)t[3] << 24;
+        uint32_t isize = t[4] | t[5] << 8 | t[6] << 16 | (uint32_t)t[7] << 24;
+        if (crc != z->check || isize != z->out_bytes) {
+            z->state = BODY_INFLATE_ERROR;
+        }
+    } else {
+        uint32_t adler = (uint32_t)t[0] << 24 | t[1] << 16 | t[2] << 8 | t[3];
+        if (adler != z->check) {
+            z->state = BODY_INFLATE_ERROR;
+        }
+    }
+}
+
+bool body_inflate_begin(body_inflate_t *z, http_encoding_t encoding, http_response_body_cb_t out_cb, void *out_ctx) {
+    memset(z, 0, sizeof(*z));
+    z->encoding = encoding;
+    z->out_cb = out_cb;
+    z->out_ctx = out_ctx;
+    z->state = BODY_INFLATE_ERROR;
+    if (encoding != HTTP_ENCODING_GZIP && encoding != HTTP_ENCODING_DEFLATE) {
+        return false;
+    }
+
+    z->window = malloc(BODY_INFLATE_WINDOW);
+    if (!z->window || !decoder_new(z)) {
+        body_inflate_end(z);
+        return false;
+    }
+    z->state = BODY_INFLATE_HEADER;
+    if (encoding == HTTP_ENCODING_GZIP) {
+        z->hdr_stage = GZ_FIXED;
+        z->hdr_left = 10;
+        z->trailer_want = GZIP_TRAILER;
+    }
+    return true;
+}
+
+void body_inflate_feed(void *ctx, const char *buf, size_t len) {
+    body_inflate_t *z = ctx;
+    const uint8_t *p = (const uint8_t *)buf;
+    const uint8_t *end = p + len;
+
+    z->in_bytes += len;
+    while (p < end) {
+        switch (z->state) {
+        case BODY_INFLATE_HEADER:
+            if (z->encoding == HTTP_ENCODING_GZIP) {
+                gzip_header_byte(z, *p++);
+            } else {
+                deflate_header_byte(z, *p++);
+            }
+            break;
+        case BODY_INFLATE_DATA:
+            p += inflate_data(z, p, end - p);
+            break;
+        case BODY_INFLATE_TRAILER:
+            trailer_byte(z, *p++);
+            break;
+        case BODY_INFLATE_DONE:
+        case BODY_INFLATE_ERROR:
+            return;                     // anything after the stream is ignored
+        }
+    }
+}
+
+bool body_inflate_end(body_inflate_t *z) {
+    decoder_free(z);
+    free(z->window);
+    z->decoder = NULL;
+    z->window = NULL;
+    return z->state == BODY_INFLATE_DONE;
+}
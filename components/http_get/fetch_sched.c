@@ -0,0 +1,118 @@
+/**
+ * @file fetch_sched.c
+ * @author The Authors
+ * @brief Decides when the next forecast fetch is due
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include "fetch_sched.h"
+
+#define DAY_MS              (24 * 3600 * 1000LL)
+#define BACKOFF_SHIFT_MAX   16
+
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/**
+ * @brief Seconds until the forecast should next change, -1 if there's
+ *        nothing to go on
+ */
+static int64_t until_rollover_s(const fetch_sched_t *sched, int64_t server_date, int64_t dt_first) {
+    if (server_date < 0 || dt_first <= 0) {
+        return -1;
+    }
+    /* On a 304 dt_first is from the last 200 and may have gone by already */
+    int64_t until = dt_first - server_date;
+    if (until < 0) {
+        until += FETCH_SCHED_SLOT_S * ((-until + FETCH_SCHED_SLOT_S - 1) / FETCH_SCHED_SLOT_S);
+    }
+    return until + sched->cfg.slot_settle_s;
+}
+
+void fetch_sched_init(fetch_sched_t *sched, const fetch_sched_config_t *cfg, int64_t now_ms, uint32_t seed) {
+    memset(sched, 0, sizeof(*sched));
+    sched->cfg = *cfg;
+    sched->next_ms = now_ms;
+    sched->last_fetch_ms = -1;
+    sched->window_start_ms = now_ms;
+    sched->rng = seed ? seed : 1;
+}
+
+int64_t fetch_sched_delay_ms(fetch_sched_t *sched, int64_t now_ms) {
+    int64_t due = sched->next_ms;
+
+    if (now_ms - sched->window_start_ms >= DAY_MS) {
+        sched->window_start_ms = now_ms;
+        sched->stats.quota_used = 0;
+    }
+    if (sched->cfg.daily_quota && sched->stats.quota_used >= sched->cfg.daily_quota
+            && due < sched->window_start_ms + DAY_MS) {
+        due = sched->window_start_ms + DAY_MS;
+    }
+    return due > now_ms ? due - now_ms : 0;
+}
+
+void fetch_sched_on_fetch(fetch_sched_t *sched, int64_t now_ms) {
+    if (sched->last_fetch_ms >= 0) {
+        int64_t polls = (now_ms - sched->last_fetch_ms) / (FETCH_SCHED_LEGACY_POLL_S * 1000);
+        if (polls > 1) {
+            sched->stats.avoided += (uint32_t)(polls - 1);
+        }
+    }
+    sched->last_fetch_ms = now_ms;
+    sched->stats.fetches++;
+    sched->stats.quota_used++;
+}
+
+void fetch_sched_on_success(fetch_sched_t *sched, int64_t now_ms, int64_t server_date, int64_t dt_first,
+                            int32_t max_age, bool not_modified) {
+    const fetch_sched_config_t *cfg = &sched->cfg;
+    int64_t interval = until_rollover_s(sched, server_date, dt_first);
+
+    if (max_age >= 0 && (interval < 0 || max_age < interval)) {
+        interval = max_age;
+    }
+    if (interval < 0) {
+        interval = cfg->default_interval_s;
+    }
+    if (interval < cfg->min_interval_s) {
+        interval = cfg->min_interval_s;
+    } else if (interval > cfg->max_interval_s) {
+        interval = cfg->max_interval_s;
+    }
+
+    sched->failures_in_row = 0;
+    if (not_modified) {
+        sched->stats.not_modified++;
+    }
+    sched->next_ms = now_ms + interval * 1000;
+}
+
+void fetch_sched_on_failure(fetch_sched_t *sched, int64_t now_ms) {
+    uint32_t shift = sched->failures_in_row < BACKOFF_SHIFT_MAX ? sched->failures_in_row : BACKOFF_SHIFT_MAX;
+    int64_t backoff = (int64_t)sched->cfg.backoff_base_s * 1000 << shift;
+
+    if (backoff > (int64_t)sched->cfg.backoff_max_s * 1000) {
+        backoff = (int64_t)sched->cfg.backoff_max_s * 1000;
+    }
+    /* "Equal jitter": at least half the backoff, so retries still spread out */
+    backoff = backoff / 2 + xorshift32(&sched->rng) % (backoff / 2 + 1);
+
+    sched->failures_in_row++;
+    sched->stats.failures++;
+    sched->next_ms = now_ms + backoff;
+}
+
+void fetch_sched_refresh_now(fetch_sched_t *sched, int64_t now_ms) {
+    sched->stats.refresh_now++;
+    sched->next_ms = now_ms;
+}
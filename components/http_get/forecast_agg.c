@@ -0,0 +1,180 @@
+/**
+ * @file forecast_agg.c
+ * @author The Authors
+ * @brief Min/max of the /forecast slots over time windows, as the body streams in
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include "forecast_agg.h"
+
+static inline int16_t clamp16(int temp) {
+    return temp < INT16_MIN ? INT16_MIN : temp > INT16_MAX ? INT16_MAX : (int16_t)temp;
+}
+
+/* First slot that hasn't ended at t */
+static uint8_t slot_at(const forecast_agg_t *agg, int64_t t) {
+    if (t <= agg->dt0) {
+        return 0;
+    }
+    int64_t i = (t - agg->dt0) / FORECAST_AGG_SLOT_S;
+    return i > FORECAST_AGG_SLOTS_MAX ? FORECAST_AGG_SLOTS_MAX : (uint8_t)i;
+}
+
+/* Past the last slot that starts before t */
+static uint8_t slot_before(const forecast_agg_t *agg, int64_t t) {
+    if (t <= agg->dt0) {
+        return 0;
+    }
+    int64_t i = (t - agg->dt0 + FORECAST_AGG_SLOT_S - 1) / FORECAST_AGG_SLOT_S;
+    return i > FORECAST_AGG_SLOTS_MAX ? FORECAST_AGG_SLOTS_MAX : (uint8_t)i;
+}
+
+static int64_t next_midnight(const forecast_agg_t *agg, int64_t t) {
+    int64_t local = t + agg->utc_offset_s;
+    int64_t into_day = ((local % FORECAST_AGG_DAY_S) + FORECAST_AGG_DAY_S) % FORECAST_AGG_DAY_S;
+    return local - into_day + FORECAST_AGG_DAY_S - agg->utc_offset_s;
+}
+
+static void bounds(const forecast_agg_t *agg, forecast_window_kind_t kind, uint8_t *start, uint8_t *end) {
+    int64_t midnight = next_midnight(agg, agg->now);
+
+    *start = agg->current;
+    switch (kind) {
+    case FORECAST_WINDOW_NEXT_24H:
+        *end = slot_before(agg, agg->now + FORECAST_AGG_DAY_S);
+        break;
+    case FORECAST_WINDOW_TODAY:
+        *end = slot_before(agg, midnight);
+        break;
+    case FORECAST_WINDOW_TOMORROW:
+        *start = slot_at(agg, midnight);
+        *end = slot_before(agg, midnight + FORECAST_AGG_DAY_S);
+        break;
+    case FORECAST_WINDOW_HORIZON:
+    default:
+        *end = FORECAST_AGG_SLOTS_MAX;
+        break;
+    }
+}
+
+static void push(forecast_agg_t *agg, forecast_window_t *w, uint8_t i) {
+    forecast_deque_t *lo = &w->lo;
+    forecast_deque_t *hi = &w->hi;
+
+    while (lo->tail > lo->head && agg->temp_min[lo->idx[lo->tail - 1]] >= agg->temp_min[i]) {
+        lo->tail--;
+    }
+    lo->idx[lo->tail++] = i;
+    while (hi->tail > hi->head && agg->temp_max[hi->idx[hi->tail - 1]] <= agg->temp_max[i]) {
+        hi->tail--;
+    }
+    hi->idx[hi->tail++] = i;
+}
+
+static void evict(forecast_deque_t *d, uint8_t start) {
+    while (d->head < d->tail && d->idx[d->head] < start) {
+        d->head++;
+    }
+}
+
+/* Bring every window up to agg->now: drop what has ended, push what has come in range */
+static void place_windows(forecast_agg_t *agg) {
+    for (int kind = 0; kind < FORECAST_WINDOWS; kind++) {
+        forecast_window_t *w = &agg->windows[kind];
+        bounds(agg, kind, &w->start, &w->end);
+        evict(&w->lo, w->start);
+        evict(&w->hi, w->start);
+        if (w->next < w->start) {
+            w->next = w->start;
+        }
+        while (w->next < w->end && w->next < agg->count) {
+            push(agg, w, w->next++);
+        }
+    }
+}
+
+static void slot_element_cb(void *ctx, const forecast_parser_t *parser) {
+    /* "city" and "coord" end at the same depth, they aren't slots */
+    if (!parser->has_temp_now || parser->dt_first == 0) {
+        return;
+    }
+    forecast_agg_slot(ctx, parser->dt_first, parser->temp_now,
+                      parser->has_temp_min ? parser->temp_min : parser->temp_now,
+                      parser->has_temp_max ? parser->temp_max : parser->temp_now);
+}
+
+void forecast_agg_begin(forecast_agg_t *agg, int32_t utc_offset_s) {
+    agg->utc_offset_s = utc_offset_s;
+    agg->dt0 = 0;
+    agg->now = 0;
+    agg->count = 0;
+    agg->current = 0;
+    agg->dropped = 0;
+    memset(agg->windows, 0, sizeof(agg->windows));
+    forecast_parser_init(&agg->parser);
+    forecast_parser_set_element_cb(&agg->parser, FORECAST_PARSER_LIST_ENTRY_DEPTH, slot_element_cb, agg);
+}
+
+void forecast_agg_body_cb(void *ctx, const char *buf, size_t len) {
+    forecast_parser_feed(&((forecast_agg_t *)ctx)->parser, buf, len);
+}
+
+size_t forecast_agg_finish(forecast_agg_t *agg) {
+    forecast_parser_finish(&agg->parser);
+    return agg->count;
+}
+
+bool forecast_agg_slot(forecast_agg_t *agg, int64_t dt, int temp, int temp_min, int temp_max) {
+    if (agg->count == 0) {
+        agg->dt0 = dt;
+        agg->now = dt;
+        agg->current = 0;
+        place_windows(agg);
+    } else if (agg->count >= FORECAST_AGG_SLOTS_MAX || dt != agg->dt0 + (int64_t)agg->count * FORECAST_AGG_SLOT_S) {
+        agg->dropped++;
+        return false;
+    }
+
+    uint8_t i = agg->count++;
+    agg->temp[i] = clamp16(temp);
+    agg->temp_min[i] = clamp16(temp_min);
+    agg->temp_max[i] = clamp16(temp_max);
+    for (int kind = 0; kind < FORECAST_WINDOWS; kind++) {
+        forecast_window_t *w = &agg->windows[kind];
+        if (w->next == i && i < w->end) {
+            push(agg, w, w->next++);
+        }
+    }
+    return true;
+}
+
+void forecast_agg_slide(forecast_agg_t *agg, int64_t now) {
+    if (agg->count == 0 || now <= agg->now) {
+        return;
+    }
+    agg->now = now;
+    agg->current = slot_at(agg, now);
+    place_windows(agg);
+}
+
+bool forecast_agg_range(const forecast_agg_t *agg, forecast_window_kind_t kind, int *temp_min, int *temp_now,
+                        int *temp_max, int64_t *dt) {
+    if (kind >= FORECAST_WINDOWS) {
+        return false;
+    }
+    const forecast_window_t *w = &agg->windows[kind];
+    if (w->lo.head == w->lo.tail) {
+        return false;
+    }
+    *temp_min = agg->temp_min[w->lo.idx[w->lo.head]];
+    *temp_max = agg->temp_max[w->hi.idx[w->hi.head]];
+    *temp_now = agg->temp[w->start];
+    if (dt) {
+        *dt = agg->dt0 + (int64_t)w->start * FORECAST_AGG_SLOT_S;
+    }
+    return true;
+}
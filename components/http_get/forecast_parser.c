@@ -0,0 +1,245 @@
+/**
+ * @file forecast_parser.c
+ * @author The Authors
+ * @brief Incremental tokenizer for the OpenWeatherMap /forecast response
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Single pass over the body: strings are tracked so that only keys (a string
+ * followed by ':') are matched, and numbers are accumulated digit by digit,
+ * temperatures to two decimals, without floats.
+ * All state lives in forecast_parser_t so nothing is lost between reads.
+ */
+#include <string.h>
+#include "common.h"
+#include "forecast_parser.h"
+
+/* Same sentinels http_get_task has always started from, in centi-degrees */
+#define TEMP_NOW_UNSET  (99 * TEMP_CENTI_PER_C)
+#define TEMP_MIN_UNSET  (99 * TEMP_CENTI_PER_C)
+#define TEMP_MAX_UNSET  (-40 * TEMP_CENTI_PER_C)
+#define TEMP_DIGITS     2       // fraction digits kept, TEMP_CENTI_PER_C
+
+static forecast_key_t match_key(const forecast_parser_t *parser) {
+    if (parser->key_overflow) {
+        return FORECAST_KEY_NONE;
+    }
+    switch (parser->key_len) {
+    case 2:
+        if (memcmp(parser->key_buf, "dt", 2) == 0) {
+            return FORECAST_KEY_DT;
+        }
+        return memcmp(parser->key_buf, "id", 2) == 0 ? FORECAST_KEY_ID : FORECAST_KEY_NONE;
+    case 4:
+        return memcmp(parser->key_buf, "temp", 4) == 0 ? FORECAST_KEY_TEMP : FORECAST_KEY_NONE;
+    case 8:
+        if (memcmp(parser->key_buf, "temp_mi", 7) == 0 && parser->key_buf[7] == 'n') {
+            return FORECAST_KEY_TEMP_MIN;
+        }
+        if (memcmp(parser->key_buf, "temp_ma", 7) == 0 && parser->key_buf[7] == 'x') {
+            return FORECAST_KEY_TEMP_MAX;
+        }
+        return FORECAST_KEY_NONE;
+    default:
+        return FORECAST_KEY_NONE;
+    }
+}
+
+/* Temperatures to centi-degrees, the number's digits past TEMP_DIGITS were dropped */
+static int centi(const forecast_parser_t *parser, int64_t value) {
+    for (uint8_t d = parser->frac_digits; d < TEMP_DIGITS; d++) {
+        value *= 10;
+    }
+    return (int)value;
+}
+
+static void commit_value(forecast_parser_t *parser) {
+    int64_t value = parser->negative ? -parser->value : parser->value;
+    int temp = centi(parser, value);
+
+    switch (parser->key) {
+    case FORECAST_KEY_TEMP:
+        if (!parser->has_temp_now) {
+            parser->temp_now = temp;
+            parser->has_temp_now = true;
+        }
+        break;
+    case FORECAST_KEY_TEMP_MIN:
+        if (temp < parser->temp_min) {
+            parser->temp_min = temp;
+        }
+        parser->has_temp_min = true;
+        break;
+    case FORECAST_KEY_TEMP_MAX:
+        if (temp > parser->temp_max) {
+            parser->temp_max = temp;
+        }
+        parser->has_temp_max = true;
+        break;
+    case FORECAST_KEY_DT:
+        if (parser->dt_first == 0) {
+            parser->dt_first = value;
+        }
+        parser->dt_last = value;
+        break;
+    case FORECAST_KEY_ID:
+        /* Not the ids nested in "weather" or "sys" */
+        if (parser->element_cb && parser->depth == parser->element_depth) {
+            parser->id = value;
+        }
+        break;
+    default:
+        break;
+    }
+    parser->key = FORECAST_KEY_NONE;
+}
+
+static void reset_results(forecast_parser_t *parser) {
+    parser->temp_now = TEMP_NOW_UNSET;
+    parser->temp_min = TEMP_MIN_UNSET;
+    parser->temp_max = TEMP_MAX_UNSET;
+    parser->dt_first = 0;
+    parser->dt_last = 0;
+    parser->has_temp_now = false;
+    parser->has_temp_min = false;
+    parser->has_temp_max = false;
+    parser->id = 0;
+}
+
+static void nest(forecast_parser_t *parser, char c) {
+    if (c == '{' || c == '[') {
+        parser->depth++;
+        return;
+    }
+    if (c == '}' && parser->element_cb && parser->depth == parser->element_depth) {
+        parser->element_cb(parser->element_ctx, parser);
+        reset_results(parser);
+    }
+    if (parser->depth > 0) {
+        parser->depth--;
+    }
+}
+
+void forecast_parser_init(forecast_parser_t *parser) {
+    memset(parser, 0, sizeof(*parser));
+    parser->state = FORECAST_PS_SCAN;
+    reset_results(parser);
+}
+
+void forecast_parser_set_element_cb(forecast_parser_t *parser, uint8_t depth, forecast_element_cb_t cb, void *ctx) {
+    parser->element_cb = cb;
+    parser->element_ctx = ctx;
+    parser->element_depth = depth;
+}
+
+void forecast_parser_feed(forecast_parser_t *parser, const char *buf, size_t len) {
+    forecast_parser_state_t state = parser->state;
+    const bool nesting = parser->element_cb != NULL;   // only elements need the depth
+
+    for (size_t i = 0; i < len; i++) {
+        char c = buf[i];
+        forecast_parser_state_t before = state;
+
+        switch (state) {
+        case FORECAST_PS_SCAN:
+            if (c == '"') {
+                parser->key_len = 0;
+                parser->key_overflow = false;
+                state = FORECAST_PS_STRING;
+            }
+            break;
+
+        case FORECAST_PS_STRING:
+            if (c == '"') {
+                state = FORECAST_PS_AFTER_STRING;
+            } else if (c == '\\') {
+                parser->key_overflow = true;    // escaped keys never match
+                state = FORECAST_PS_ESCAPE;
+            } else if (parser->key_len < FORECAST_PARSER_KEY_MAX) {
+                parser->key_buf[parser->key_len++] = c;
+            } else {
+                parser->key_overflow = true;
+            }
+            break;
+
+        case FORECAST_PS_ESCAPE:
+            state = FORECAST_PS_STRING;
+            break;
+
+        case FORECAST_PS_AFTER_STRING:
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                break;
+            }
+            if (c == ':') {
+                parser->key = match_key(parser);
+                state = parser->key == FORECAST_KEY_NONE ? FORECAST_PS_SCAN : FORECAST_PS_VALUE_START;
+            } else {
+                /* It was a value, not a key. ',', '}' and ']' never open a string */
+                state = FORECAST_PS_SCAN;
+            }
+            break;
+
+        case FORECAST_PS_VALUE_START:
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                break;
+            }
+            parser->value = 0;
+            parser->negative = false;
+            parser->frac_digits = 0;
+            if (c == '-') {
+                parser->negative = true;
+                state = FORECAST_PS_INT;
+            } else if (c >= '0' && c <= '9') {
+                parser->value = c - '0';
+                state = FORECAST_PS_INT;
+            } else {
+                parser->key = FORECAST_KEY_NONE;
+                state = c == '"' ? FORECAST_PS_STRING : FORECAST_PS_SCAN;
+                parser->key_len = 0;
+                parser->key_overflow = false;
+            }
+            break;
+
+        case FORECAST_PS_INT:
+            if (c >= '0' && c <= '9') {
+                parser->value = parser->value * 10 + (c - '0');
+            } else if (c == '.') {
+                state = FORECAST_PS_FRAC;
+            } else {
+                commit_value(parser);
+                state = FORECAST_PS_SCAN;   // c is one of ',', '}', ']' or whitespace
+            }
+            break;
+
+        case FORECAST_PS_FRAC:
+            /* Hundredths are kept, past them truncate toward zero */
+            if (c >= '0' && c <= '9') {
+                if (parser->frac_digits < TEMP_DIGITS) {
+                    parser->value = parser->value * 10 + (c - '0');
+                    parser->frac_digits++;
+                }
+            } else {
+                commit_value(parser);
+                state = FORECAST_PS_SCAN;
+            }
+            break;
+        }
+
+        /* After the switch, so a number ended by '}' is committed first */
+        if (nesting && (c == '{' || c == '[' || c == '}' || c == ']')
+                && before != FORECAST_PS_STRING && before != FORECAST_PS_ESCAPE) {
+            nest(parser, c);
+        }
+    }
+
+    parser->state = state;
+}
+
+void forecast_parser_finish(forecast_parser_t *parser) {
+    if (parser->state == FORECAST_PS_INT || parser->state == FORECAST_PS_FRAC) {
+        commit_value(parser);
+    }
+    parser->state = FORECAST_PS_SCAN;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file test_body_inflate.c
+ * @author The Authors
+ * @brief Host test for the streaming gzip / deflate decoder
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The decoder tests run standalone. The client tests need the stand-in
+ * server from pytest_body_inflate.py, which passes its port in STANDIN_PORT.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "body_inflate.h"
+#include "http_client.h"
+#include "forecast_parser.h"
+
+static const char PLAIN_BODY[] =
+    "{\"list\":[{\"dt\":1734609600,\"main\":{\"temp\":7.8,\"temp_min\":-2.1,\"temp_max\":9.0}},"
+    "{\"dt\":1734620400,\"main\":{\"temp\":6.1,\"temp_min\":-3.4,\"temp_max\":8.2}}]}";
+
+/* Every gzip header field: FEXTRA, FNAME "forecast.json", FCOMMENT, FHCRC */
+static const uint8_t GZIP_BODY[] = {
+    0x1f, 0x8b, 0x08, 0x1e, 0xc0, 0x0a, 0x64, 0x67, 0x02, 0x03, 0x04, 0x00,
+    0x41, 0x42, 0x00, 0x00, 0x66, 0x6f, 0x72, 0x65, 0x63, 0x61, 0x73, 0x74,
+    0x2e, 0x6a, 0x73, 0x6f, 0x6e, 0x00, 0x6f, 0x77, 0x6d, 0x00, 0x9b, 0x8a,
+    0xab, 0x56, 0xca, 0xc9, 0x2c, 0x2e, 0x51, 0xb2, 0x8a, 0xae, 0x56, 0x4a,
+    0x01, 0x52, 0x86, 0xe6, 0xc6, 0x26, 0x66, 0x06, 0x96, 0x66, 0x06, 0x06,
+    0x3a, 0x4a, 0xb9, 0x89, 0x99, 0x79, 0x4a, 0x56, 0xd5, 0x4a, 0x25, 0xa9,
+    0xb9, 0x05, 0x4a, 0x56, 0xe6, 0x7a, 0x16, 0x3a, 0x60, 0x66, 0x7c, 0x2e,
+    0x48, 0x58, 0xd7, 0x48, 0xcf, 0x10, 0xc6, 0x4f, 0xac, 0x50, 0xb2, 0xb2,
+    0xd4, 0x33, 0xa8, 0xad, 0xd5, 0x41, 0x32, 0xc4, 0xc8, 0xc0, 0x04, 0xd3,
+    0x10, 0x33, 0x84, 0x26, 0xb0, 0x21, 0xc6, 0x7a, 0x26, 0xc8, 0x86, 0x58,
+    0xe8, 0x19, 0xd5, 0xd6, 0xc6, 0xd6, 0x02, 0x00, 0x69, 0xf7, 0x5e, 0x3b,
+    0x94, 0x00, 0x00, 0x00,
+};
+
+static const uint8_t ZLIB_BODY[] = {
+    0x78, 0xda, 0xab, 0x56, 0xca, 0xc9, 0x2c, 0x2e, 0x51, 0xb2, 0x8a, 0xae,
+    0x56, 0x4a, 0x01, 0x52, 0x86, 0xe6, 0xc6, 0x26, 0x66, 0x06, 0x96, 0x66,
+    0x06, 0x06, 0x3a, 0x4a, 0xb9, 0x89, 0x99, 0x79, 0x4a, 0x56, 0xd5, 0x4a,
+    0x25, 0xa9, 0xb9, 0x05, 0x4a, 0x56, 0xe6, 0x7a, 0x16, 0x3a, 0x60, 0x66,
+    0x7c, 0x2e, 0x48, 0x58, 0xd7, 0x48, 0xcf, 0x10, 0xc6, 0x4f, 0xac, 0x50,
+    0xb2, 0xb2, 0xd4, 0x33, 0xa8, 0xad, 0xd5, 0x41, 0x32, 0xc4, 0xc8, 0xc0,
+    0x04, 0xd3, 0x10, 0x33, 0x84, 0x26, 0xb0, 0x21, 0xc6, 0x7a, 0x26, 0xc8,
+    0x86, 0x58, 0xe8, 0x19, 0xd5, 0xd6, 0xc6, 0xd6, 0x02, 0x00, 0x82, 0xc4,
+    0x2b, 0x99,
+};
+
+/* Raw deflate, as some servers send "deflate" */
+static const uint8_t RAW_BODY[] = {
+    0xab, 0x56, 0xca, 0xc9, 0x2c, 0x2e, 0x51, 0xb2, 0x8a, 0xae, 0x56, 0x4a,
+    0x01, 0x52, 0x86, 0xe6, 0xc6, 0x26, 0x66, 0x06, 0x96, 0x66, 0x06, 0x06,
+    0x3a, 0x4a, 0xb9, 0x89, 0x99, 0x79, 0x4a, 0x56, 0xd5, 0x4a, 0x25, 0xa9,
+    0xb9, 0x05, 0x4a, 0x56, 0xe6, 0x7a, 0x16, 0x3a, 0x60, 0x66, 0x7c, 0x2e,
+    0x48, 0x58, 0xd7, 0x48, 0xcf, 0x10, 0xc6, 0x4f, 0xac, 0x50, 0xb2, 0xb2,
+    0xd4, 0x33, 0xa8, 0xad, 0xd5, 0x41, 0x32, 0xc4, 0xc8, 0xc0, 0x04, 0xd3,
+    0x10, 0x33, 0x84, 0x26, 0xb0, 0x21, 0xc6, 0x7a, 0x26, 0xc8, 0x86, 0x58,
+    0xe8, 0x19, 0xd5, 0xd6, 0xc6, 0xd6, 0x02, 0x00,
+};
+
+typedef struct {
+    char body[256];
+    size_t len;
+    bool overflow;
+} body_sink_t;
+
+static void sink_cb(void *ctx, const char *buf, size_t len) {
+    body_sink_t *sink = ctx;
+    if (sink->len + len >= sizeof(sink->body)) {
+        sink->overflow = true;
+        return;
+    }
+    memcpy(sink->body + sink->len, buf, len);
+    sink->len += len;
+    sink->body[sink->len] = '\0';
+}
+
+/* Inflate in two slices split at split, or a byte at a time if split is SIZE_MAX */
+static bool inflate_split(http_encoding_t encoding, const uint8_t *in, size_t len, size_t split, body_sink_t *sink) {
+    body_inflate_t z;
+
+    memset(sink, 0, sizeof(*sink));
+    if (!body_inflate_begin(&z, encoding, sink_cb, sink)) {
+        return false;
+    }
+    if (split == SIZE_MAX) {
+        for (size_t i = 0; i < len; i++) {
+            body_inflate_feed(&z, (const char *)in + i, 1);
+        }
+    } else {
+        body_inflate_feed(&z, (const char *)in, split);
+        body_inflate_feed(&z, (const char *)in + split, len - split);
+    }
+    return body_inflate_end(&z) && !sink->overflow;
+}
+
+static void check_every_split(http_encoding_t encoding, const uint8_t *in, size_t len) {
+    body_sink_t sink;
+
+    for (size_t split = 0; split <= len; split++) {
+        TEST_ASSERT_TRUE(inflate_split(encoding, in, len, split, &sink));
+        TEST_ASSERT_EQUAL_STRING(PLAIN_BODY, sink.body);
+    }
+    TEST_ASSERT_TRUE(inflate_split(encoding, in, len, SIZE_MAX, &sink));
+    TEST_ASSERT_EQUAL_STRING(PLAIN_BODY, sink.body);
+}
+
+static void test_gzip_every_split(void) {
+    check_every_split(HTTP_ENCODING_GZIP, GZIP_BODY, sizeof(GZIP_BODY));
+}
+
+static void test_zlib_every_split(void) {
+    check_every_split(HTTP_ENCODING_DEFLATE, ZLIB_BODY, sizeof(ZLIB_BODY));
+}
+
+static void test_raw_deflate_every_split(void) {
+    check_every_split(HTTP_ENCODING_DEFLATE, RAW_BODY, sizeof(RAW_BODY));
+}
+
+static void test_counts(void) {
+    body_inflate_t z;
+    body_sink_t sink = { 0 };
+
+    TEST_ASSERT_TRUE(body_inflate_begin(&z, HTTP_ENCODING_GZIP, sink_cb, &sink));
+    body_inflate_feed(&z, (const char *)GZIP_BODY, sizeof(GZIP_BODY));
+    TEST_ASSERT_EQUAL(sizeof(GZIP_BODY), z.in_bytes);
+    TEST_ASSERT_EQUAL(strlen(PLAIN_BODY), z.out_bytes);
+    TEST_ASSERT_TRUE(body_inflate_end(&z));
+    TEST_ASSERT_NULL(z.window);
+}
+
+static void test_bad_streams(void) {
+    uint8_t bad[sizeof(GZIP_BODY)];
+    body_sink_t sink;
+
+    /* CRC-32, then ISIZE */
+    memcpy(bad, GZIP_BODY, sizeof(bad));
+    bad[sizeof(bad) - 8] ^= 1;
+    TEST_ASSERT_FALSE(inflate_split(HTTP_ENCODING_GZIP, bad, sizeof(bad), 0, &sink));
+    memcpy(bad, GZIP_BODY, sizeof(bad));
+    bad[sizeof(bad) - 4] ^= 1;
+    TEST_ASSERT_FALSE(inflate_split(HTTP_ENCODING_GZIP, bad, sizeof(bad), 0, &sink));
+
+    /* Adler-32 */
+    uint8_t bad_zlib[sizeof(ZLIB_BODY)];
+    memcpy(bad_zlib, ZLIB_BODY, sizeof(bad_zlib));
+    bad_zlib[sizeof(bad_zlib) - 1] ^= 1;
+    TEST_ASSERT_FALSE(inflate_split(HTTP_ENCODING_DEFLATE, bad_zlib, sizeof(bad_zlib), 0, &sink));
+
+    /* Not gzip at all */
+    memcpy(bad, GZIP_BODY, sizeof(bad));
+    bad[1] = 0;
+    TEST_ASSERT_FALSE(inflate_split(HTTP_ENCODING_GZIP, bad, sizeof(bad), 0, &sink));
+    TEST_ASSERT_EQUAL(0, sink.len);
+
+    /* Cut short, anywhere */
+    for (size_t len = 0; len < sizeof(GZIP_BODY); len++) {
+        TEST_ASSERT_FALSE(inflate_split(HTTP_ENCODING_GZIP, GZIP_BODY, len, 0, &sink));
+    }
+    for (size_t len = 0; len < sizeof(RAW_BODY); len++) {
+        TEST_ASSERT_FALSE(inflate_split(HTTP_ENCODING_DEFLATE, RAW_BODY, len, 0, &sink));
+    }
+
+    /* Only gzip & deflate are asked for */
+    TEST_ASSERT_FALSE(inflate_split(HTTP_ENCODING_OTHER, GZIP_BODY, sizeof(GZIP_BODY), 0, &sink));
+    TEST_ASSERT_FALSE(inflate_split(HTTP_ENCODING_IDENTITY, GZIP_BODY, sizeof(GZIP_BODY), 0, &sink));
+}
+
+static const char *s_port;
+static uint32_t s_forecast_len;
+
+static void parser_cb(void *ctx, const char *buf, size_t len) {
+    forecast_parser_feed(ctx, buf, len);
+}
+
+static int fetch(http_client_t *client, const char *path, forecast_parser_t *parser) {
+    char recv_buf[512];
+    forecast_parser_init(parser);
+    int status = http_client_get(client, path, recv_buf, sizeof(recv_buf), parser_cb, parser);
+    forecast_parser_finish(parser);
+    printf("BODY %s %u bytes over the air, %u parsed\n", path, (unsigned)client->body_wire_bytes,
+           (unsigned)client->body_bytes);
+    return status;
+}
+
+static void test_client_compressed(void) {
+    static const char *const paths[] = {
+        "/forecast", "/forecast-gzip", "/forecast-gzip-chunked", "/forecast-deflate", "/forecast-raw-deflate",
+    };
+    http_client_t client;
+    forecast_parser_t parser;
+
+    http_client_init(&client, "127.0.0.1", s_port, "localhost");
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        TEST_ASSERT_EQUAL(200, fetch(&client, paths[i], &parser));
+        TEST_ASSERT_EQUAL(780, parser.temp_now);
+        TEST_ASSERT_EQUAL(-400, parser.temp_min);
+        TEST_ASSERT_EQUAL(2100, parser.temp_max);
+        TEST_ASSERT_EQUAL(s_forecast_len, client.body_bytes);
+        if (i == 0) {
+            TEST_ASSERT_EQUAL(s_forecast_len, client.body_wire_bytes);
+        } else {
+            TEST_ASSERT_LESS_THAN(s_forecast_len / 4, client.body_wire_bytes);
+        }
+    }
+    TEST_ASSERT_EQUAL(1, client.stats.connects);
+
+    /* A body that doesn't check out, or can't be read, fails the fetch */
+    TEST_ASSERT_EQUAL(-1, fetch(&client, "/forecast-corrupt", &parser));
+    TEST_ASSERT_EQUAL(-1, fetch(&client, "/forecast-br", &parser));
+    TEST_ASSERT_EQUAL(2, client.stats.errors);
+
+    /* No heap to inflate with: the next request goes without Accept-Encoding, the one after with it again */
+    client.identity_next = true;
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-gzip", &parser));
+    TEST_ASSERT_EQUAL(s_forecast_len, client.body_wire_bytes);
+    TEST_ASSERT_FALSE(client.identity_next);
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-gzip", &parser));
+    TEST_ASSERT_LESS_THAN(s_forecast_len / 4, client.body_wire_bytes);
+
+    http_client_close(&client);
+    printf("CLIENT body over the air=%u parsed=%u\n", (unsigned)client.stats.body_wire_bytes,
+           (unsigned)client.stats.body_bytes);
+}
+
+void app_main(void)
+{
+    s_port = getenv("STANDIN_PORT");
+
+    UNITY_BEGIN();
+    RUN_TEST(test_gzip_every_split);
+    RUN_TEST(test_zlib_every_split);
+    RUN_TEST(test_raw_deflate_every_split);
+    RUN_TEST(test_counts);
+    RUN_TEST(test_bad_streams);
+    if (s_port) {
+        s_forecast_len = strtoul(getenv("STANDIN_FORECAST_LEN"), NULL, 10);
+        RUN_TEST(test_client_compressed);
+    }
+    exit(UNITY_END());
+}
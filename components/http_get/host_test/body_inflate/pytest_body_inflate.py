@@ -0,0 +1,96 @@
+#!/usr/bin/env python
+#
+# Runs the body_inflate host test against a local stand-in for the
+# OpenWeatherMap server that serves its forecast gzip or deflate compressed.
+#
+#   idf.py --preview set-target linux && idf.py build
+#   pytest pytest_body_inflate.py
+
+import gzip
+import json
+import os
+import subprocess
+import threading
+import zlib
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+# 400 three hour slots, over 32 KB: the decoder's window wraps
+FORECAST = json.dumps({
+    'cod': '200',
+    'cnt': 400,
+    'list': [{'dt': 1734609600 + 10800 * i,
+              'main': {'temp': 7.8 if i == 0 else 5.0 + i % 7, 'temp_min': -float(i % 5), 'temp_max': 10.0 + i % 12},
+              'weather': [{'id': 800, 'main': 'Clear', 'description': 'clear sky', 'icon': '01d'}]}
+             for i in range(400)],
+}, separators=(',', ':')).encode()
+
+
+def raw_deflate(data: bytes) -> bytes:
+    c = zlib.compressobj(9, zlib.DEFLATED, -15)
+    return c.compress(data) + c.flush()
+
+
+ENCODED = {
+    '/forecast-gzip': ('gzip', gzip.compress(FORECAST)),
+    '/forecast-gzip-chunked': ('gzip', gzip.compress(FORECAST)),
+    '/forecast-deflate': ('deflate', zlib.compress(FORECAST)),
+    '/forecast-raw-deflate': ('deflate', raw_deflate(FORECAST)),
+    '/forecast-corrupt': ('gzip', gzip.compress(FORECAST)[:-8] + b'\0\0\0\0\0\0\0\0'),
+    '/forecast-br': ('br', b'\x0b\x02\x80hello\x03'),
+}
+
+
+class StandInHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, *args) -> None:  # keep pytest output readable
+        pass
+
+    def do_GET(self) -> None:
+        accepting = 'gzip' in self.headers.get('Accept-Encoding', '')
+        with self.server.lock:
+            self.server.requests += 1
+            if accepting:
+                self.server.accepting += 1
+
+        encoding, body = ENCODED.get(self.path, (None, FORECAST)) if accepting else (None, FORECAST)
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        if encoding:
+            self.send_header('Content-Encoding', encoding)
+        if self.path.endswith('-chunked'):
+            self.send_header('Transfer-Encoding', 'chunked')
+            self.end_headers()
+            for i in range(0, len(body), 1000):
+                chunk = body[i:i + 1000]
+                self.wfile.write(b'%x\r\n%s\r\n' % (len(chunk), chunk))
+            self.wfile.write(b'0\r\n\r\n')
+            return
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+
+def start_standin() -> ThreadingHTTPServer:
+    server = ThreadingHTTPServer(('127.0.0.1', 0), StandInHandler)
+    server.lock = threading.Lock()
+    server.requests = 0
+    server.accepting = 0
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server
+
+
+def test_body_inflate() -> None:
+    server = start_standin()
+    elf = os.path.join(os.path.dirname(__file__), 'build', 'body_inflate_host_test.elf')
+    env = dict(os.environ, STANDIN_PORT=str(server.server_address[1]), STANDIN_FORECAST_LEN=str(len(FORECAST)))
+    try:
+        result = subprocess.run([elf], env=env, capture_output=True, text=True, timeout=60)
+    finally:
+        server.shutdown()
+    print(result.stdout)
+    assert result.returncode == 0
+    assert 'BODY /forecast-gzip ' in result.stdout
+    assert server.requests == 9
+    # All but the one asked for uncompressed
+    assert server.accepting == server.requests - 1
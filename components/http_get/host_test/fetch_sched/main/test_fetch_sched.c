@@ -0,0 +1,183 @@
+/**
+ * @file test_fetch_sched.c
+ * @author The Authors
+ * @brief Host test for the fetch scheduler, on a virtual clock
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The stand-in server changes its forecast at every 3 hour UTC boundary and
+ * answers 304 in between, like OpenWeatherMap with an ETag.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "fetch_sched.h"
+
+#define SERVER_EPOCH    1734601234LL    // server clock at virtual t=0, mid-slot
+#define DAY_S           (24 * 3600)
+
+static const fetch_sched_config_t s_cfg = {
+    .min_interval_s = 300,
+    .max_interval_s = 3600,
+    .default_interval_s = 1800,
+    .slot_settle_s = 120,
+    .backoff_base_s = 4,
+    .backoff_max_s = 900,
+    .daily_quota = 1000,
+};
+
+typedef struct {
+    int64_t version;        // slot the client last got a 200 for
+    int64_t dt_first;
+} server_t;
+
+static int64_t server_date(int64_t now_ms) {
+    return SERVER_EPOCH + now_ms / 1000;
+}
+
+/* 200 if the forecast moved on since the client last had it */
+static bool server_fetch(server_t *server, int64_t now_ms) {
+    int64_t date = server_date(now_ms);
+    int64_t version = date / FETCH_SCHED_SLOT_S;
+    bool modified = version != server->version;
+    server->version = version;
+    server->dt_first = (version + 1) * FETCH_SCHED_SLOT_S;
+    return modified;
+}
+
+static void test_day_follows_slots(void) {
+    fetch_sched_t sched;
+    server_t server = { 0 };
+    int64_t now = 0;
+    int updates = 0;
+    int64_t worst_staleness = 0;
+
+    fetch_sched_init(&sched, &s_cfg, now, 1);
+    while (now < DAY_S * 1000LL) {
+        now += fetch_sched_delay_ms(&sched, now);
+        fetch_sched_on_fetch(&sched, now);
+        bool modified = server_fetch(&server, now);
+        fetch_sched_on_success(&sched, now, server_date(now), server.dt_first, -1, !modified);
+
+        if (modified && updates++ > 0) {
+            /* How long the new forecast sat on the server before we got it */
+            int64_t staleness = server_date(now) - server.version * FETCH_SCHED_SLOT_S;
+            worst_staleness = staleness > worst_staleness ? staleness : worst_staleness;
+        }
+    }
+
+    printf("SCHED day: fetches=%u updates=%d not_modified=%u avoided=%u worst_staleness=%llds\n",
+           (unsigned)sched.stats.fetches, updates, (unsigned)sched.stats.not_modified,
+           (unsigned)sched.stats.avoided, (long long)worst_staleness);
+    TEST_ASSERT_EQUAL(DAY_S / FETCH_SCHED_SLOT_S + 1, updates);
+    TEST_ASSERT_LESS_OR_EQUAL(s_cfg.slot_settle_s, worst_staleness);
+    /* Every max_interval at worst, against a fetch a minute */
+    TEST_ASSERT_LESS_OR_EQUAL(DAY_S / s_cfg.max_interval_s + 2, sched.stats.fetches);
+    TEST_ASSERT_GREATER_OR_EQUAL(DAY_S / FETCH_SCHED_LEGACY_POLL_S - sched.stats.fetches - 1, sched.stats.avoided);
+    TEST_ASSERT_EQUAL(sched.stats.fetches - updates, sched.stats.not_modified);
+}
+
+static void test_cache_control_and_fallback(void) {
+    fetch_sched_t sched;
+
+    /* max-age sooner than the rollover wins */
+    fetch_sched_init(&sched, &s_cfg, 0, 1);
+    fetch_sched_on_fetch(&sched, 0);
+    fetch_sched_on_success(&sched, 0, 1734609600 - 3000, 1734609600, 600, false);
+    TEST_ASSERT_EQUAL_INT64(600 * 1000, fetch_sched_delay_ms(&sched, 0));
+
+    /* ...but never below min_interval */
+    fetch_sched_on_success(&sched, 0, 1734609600 - 3000, 1734609600, 0, false);
+    TEST_ASSERT_EQUAL_INT64(s_cfg.min_interval_s * 1000, fetch_sched_delay_ms(&sched, 0));
+
+    /* Rollover, plus settling time */
+    fetch_sched_on_success(&sched, 0, 1734609600 - 3000, 1734609600, -1, false);
+    TEST_ASSERT_EQUAL_INT64((3000 + s_cfg.slot_settle_s) * 1000, fetch_sched_delay_ms(&sched, 0));
+
+    /* A stale dt_first (304 after the rollover) steps on to the next slot */
+    fetch_sched_on_success(&sched, 0, 1734609600 + 10000, 1734609600, -1, true);
+    TEST_ASSERT_EQUAL_INT64((FETCH_SCHED_SLOT_S - 10000 + s_cfg.slot_settle_s) * 1000, fetch_sched_delay_ms(&sched, 0));
+
+    /* No Date header: nothing to align to */
+    fetch_sched_on_success(&sched, 0, -1, 1734609600, -1, false);
+    TEST_ASSERT_EQUAL_INT64(s_cfg.default_interval_s * 1000, fetch_sched_delay_ms(&sched, 0));
+}
+
+static void test_backoff_with_jitter(void) {
+    fetch_sched_t sched;
+    int64_t now = 0;
+
+    fetch_sched_init(&sched, &s_cfg, now, 12345);
+    for (int n = 0; n < 12; n++) {
+        fetch_sched_on_fetch(&sched, now);
+        fetch_sched_on_failure(&sched, now);
+
+        int64_t backoff = (int64_t)s_cfg.backoff_base_s * 1000 << n;
+        if (backoff > s_cfg.backoff_max_s * 1000) {
+            backoff = s_cfg.backoff_max_s * 1000;
+        }
+        int64_t delay = fetch_sched_delay_ms(&sched, now);
+        TEST_ASSERT_GREATER_OR_EQUAL(backoff / 2, delay);
+        TEST_ASSERT_LESS_OR_EQUAL(backoff, delay);
+        now += delay;
+    }
+    TEST_ASSERT_EQUAL(12, sched.stats.failures);
+
+    /* Success resets it */
+    fetch_sched_on_fetch(&sched, now);
+    fetch_sched_on_success(&sched, now, -1, 0, -1, false);
+    fetch_sched_on_failure(&sched, now);
+    TEST_ASSERT_LESS_OR_EQUAL(s_cfg.backoff_base_s * 1000, fetch_sched_delay_ms(&sched, now));
+
+    /* Different seeds don't retry in step */
+    fetch_sched_t other;
+    int same = 0;
+    fetch_sched_init(&sched, &s_cfg, 0, 1);
+    fetch_sched_init(&other, &s_cfg, 0, 2);
+    for (int n = 0; n < 8; n++) {
+        fetch_sched_on_failure(&sched, 0);
+        fetch_sched_on_failure(&other, 0);
+        same += fetch_sched_delay_ms(&sched, 0) == fetch_sched_delay_ms(&other, 0);
+    }
+    TEST_ASSERT_LESS_THAN(8, same);
+}
+
+static void test_refresh_now_and_quota(void) {
+    fetch_sched_config_t cfg = s_cfg;
+    fetch_sched_t sched;
+    int64_t now = 0;
+
+    cfg.daily_quota = 5;
+    fetch_sched_init(&sched, &cfg, now, 1);
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_INT64(0, fetch_sched_delay_ms(&sched, now));
+        fetch_sched_on_fetch(&sched, now);
+        fetch_sched_on_success(&sched, now, -1, 0, -1, false);
+        if (i < 4) {
+            TEST_ASSERT_EQUAL_INT64(cfg.default_interval_s * 1000, fetch_sched_delay_ms(&sched, now));
+        }
+        now += 1000;
+        fetch_sched_refresh_now(&sched, now);
+    }
+    TEST_ASSERT_EQUAL(5, sched.stats.quota_used);
+    TEST_ASSERT_EQUAL(5, sched.stats.refresh_now);
+
+    /* Quota spent: the refresh waits for the window to roll */
+    TEST_ASSERT_EQUAL_INT64(DAY_S * 1000LL - now, fetch_sched_delay_ms(&sched, now));
+    now = DAY_S * 1000LL;
+    TEST_ASSERT_EQUAL_INT64(0, fetch_sched_delay_ms(&sched, now));
+    TEST_ASSERT_EQUAL(0, sched.stats.quota_used);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_day_follows_slots);
+    RUN_TEST(test_cache_control_and_fallback);
+    RUN_TEST(test_backoff_with_jitter);
+    RUN_TEST(test_refresh_now_and_quota);
+    exit(UNITY_END());
+}
@@ -0,0 +1,287 @@
+/**
+ * @file test_forecast_agg.c
+ * @author The Authors
+ * @brief Host test & benchmark for the forecast window aggregation
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Every window is checked against a brute force pass over the slots, for
+ * bodies starting at every hour of the day, in several time zones, read in
+ * chunks of every size, and slid along hour by hour.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "forecast_agg.h"
+
+#define FIRST_DT            1734609600LL    // 2024-12-19 12:00 UTC
+#define HOUR_S              3600
+#define BENCH_ITERATIONS    2000
+#define RECV_BUF_SIZE       64              // same as http_get_task
+
+/* One slot as /forecast sends it, with the nesting the parser has to skip */
+#define SLOT_FMT \
+    "{\"dt\":%lld,\"main\":{\"temp\":%s%d.%02d,\"feels_like\":1.5,\"temp_min\":%s%d.%02d,\"temp_max\":%s%d.%02d," \
+    "\"pressure\":1012,\"humidity\":81,\"temp_kf\":0.71},\"weather\":[{\"id\":500,\"main\":\"Rain\",\"icon\":\"10d\"}]," \
+    "\"wind\":{\"speed\":7.2,\"deg\":250},\"pop\":0.41,\"sys\":{\"pod\":\"d\"},\"dt_txt\":\"2024-12-19 12:00:00\"}"
+
+typedef struct {
+    int64_t dt;
+    int temp;
+    int temp_min;
+    int temp_max;
+} slot_t;
+
+static slot_t s_slots[FORECAST_AGG_SLOTS_MAX];
+static char s_body[FORECAST_AGG_SLOTS_MAX * 320 + 256];
+static size_t s_body_len;
+
+static inline uint64_t ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static const char *sign(int centi) {
+    return centi < 0 ? "-" : "";
+}
+
+/* A daily swing around a drifting mean, crossing zero, with a "city" after the slots */
+static void build_body(int64_t dt0, int slots) {
+    size_t len = snprintf(s_body, sizeof(s_body), "{\"cod\":\"200\",\"message\":0,\"cnt\":%d,\"list\":[", slots);
+
+    for (int i = 0; i < slots; i++) {
+        slot_t *s = &s_slots[i];
+        s->dt = dt0 + (int64_t)i * FORECAST_AGG_SLOT_S;
+        s->temp = ((i * 613) % 900) - 300 + (i % 8 < 4 ? 250 : -250) - i * 11;
+        s->temp_min = s->temp - 40 - (i * 7) % 90;
+        s->temp_max = s->temp + 35 + (i * 13) % 120;
+        len += snprintf(s_body + len, sizeof(s_body) - len, SLOT_FMT "%s", (long long)s->dt,
+                        sign(s->temp), abs(s->temp) / 100, abs(s->temp) % 100,
+                        sign(s->temp_min), abs(s->temp_min) / 100, abs(s->temp_min) % 100,
+                        sign(s->temp_max), abs(s->temp_max) / 100, abs(s->temp_max) % 100,
+                        i == slots - 1 ? "" : ",");
+    }
+    len += snprintf(s_body + len, sizeof(s_body) - len,
+                    "],\"city\":{\"id\":2964574,\"name\":\"Dublin\",\"coord\":{\"lat\":53.344,\"lon\":-6.2672},"
+                    "\"timezone\":0,\"sunrise\":1734597822}}");
+    s_body_len = len;
+}
+
+static void parse(forecast_agg_t *agg, int32_t utc_offset_s, size_t chunk) {
+    forecast_agg_begin(agg, utc_offset_s);
+    for (size_t off = 0; off < s_body_len; off += chunk) {
+        size_t n = s_body_len - off < chunk ? s_body_len - off : chunk;
+        forecast_agg_body_cb(agg, s_body + off, n);
+    }
+    forecast_agg_finish(agg);
+}
+
+/* The next local midnight, by way of the calendar */
+static int64_t midnight_after(int64_t t, int32_t utc_offset_s) {
+    time_t local = (time_t)(t + utc_offset_s);
+    struct tm tm;
+    gmtime_r(&local, &tm);
+    return t + FORECAST_AGG_DAY_S - (tm.tm_hour * HOUR_S + tm.tm_min * 60 + tm.tm_sec);
+}
+
+/* What a window should be, from the slots themselves */
+static bool brute_force(int slots, int64_t now, int32_t utc_offset_s, forecast_window_kind_t kind,
+                        int *temp_min, int *temp_now, int *temp_max) {
+    int64_t midnight = midnight_after(now, utc_offset_s);
+    int64_t from = now;
+    int64_t to = INT64_MAX;
+    bool found = false;
+
+    switch (kind) {
+    case FORECAST_WINDOW_NEXT_24H:
+        to = now + FORECAST_AGG_DAY_S;
+        break;
+    case FORECAST_WINDOW_TODAY:
+        to = midnight;
+        break;
+    case FORECAST_WINDOW_TOMORROW:
+        from = midnight;
+        to = midnight + FORECAST_AGG_DAY_S;
+        break;
+    default:
+        break;
+    }
+    for (int i = 0; i < slots; i++) {
+        const slot_t *s = &s_slots[i];
+        /* Slots still running at from, starting before to */
+        if (s->dt + FORECAST_AGG_SLOT_S <= from || s->dt >= to) {
+            continue;
+        }
+        if (!found) {
+            *temp_now = s->temp;
+            *temp_min = s->temp_min;
+            *temp_max = s->temp_max;
+            found = true;
+        }
+        *temp_min = s->temp_min < *temp_min ? s->temp_min : *temp_min;
+        *temp_max = s->temp_max > *temp_max ? s->temp_max : *temp_max;
+    }
+    return found;
+}
+
+static void assert_windows(const forecast_agg_t *agg, int slots, int64_t now, int32_t utc_offset_s) {
+    for (int kind = 0; kind < FORECAST_WINDOWS; kind++) {
+        int want_min = 0, want_now = 0, want_max = 0;
+        int got_min = 0, got_now = 0, got_max = 0;
+        bool want = brute_force(slots, now, utc_offset_s, kind, &want_min, &want_now, &want_max);
+
+        TEST_ASSERT_EQUAL(want, forecast_agg_range(agg, kind, &got_min, &got_now, &got_max, NULL));
+        if (want) {
+            TEST_ASSERT_EQUAL_INT(want_min, got_min);
+            TEST_ASSERT_EQUAL_INT(want_now, got_now);
+            TEST_ASSERT_EQUAL_INT(want_max, got_max);
+        }
+    }
+}
+
+static const int32_t s_offsets[] = { 0, 60 * 60, -300 * 60, 330 * 60, 840 * 60, -720 * 60 };
+
+/* The whole horizon is what the parser alone folds, and the dt is the first slot's */
+static void test_horizon(void) {
+    static forecast_agg_t agg;
+    int temp_min, temp_now, temp_max;
+    int64_t dt;
+
+    build_body(FIRST_DT, 4);
+    parse(&agg, 0, s_body_len);
+    TEST_ASSERT_EQUAL(4, agg.count);
+    TEST_ASSERT_EQUAL(0, agg.dropped);
+    TEST_ASSERT_TRUE(forecast_agg_range(&agg, FORECAST_WINDOW_HORIZON, &temp_min, &temp_now, &temp_max, &dt));
+
+    forecast_parser_t parser;
+    forecast_parser_init(&parser);
+    forecast_parser_feed(&parser, s_body, s_body_len);
+    forecast_parser_finish(&parser);
+    TEST_ASSERT_EQUAL_INT(parser.temp_min, temp_min);
+    TEST_ASSERT_EQUAL_INT(parser.temp_now, temp_now);
+    TEST_ASSERT_EQUAL_INT(parser.temp_max, temp_max);
+    TEST_ASSERT_EQUAL_INT64(FIRST_DT, dt);
+}
+
+/* Bodies starting at every hour of the day, in every zone, 40 slots and fewer */
+static void test_windows(void) {
+    static forecast_agg_t agg;
+    static const int counts[] = { FORECAST_AGG_SLOTS_MAX, 16, 8, 4, 1 };
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        for (int hour = 0; hour < 24; hour += 3) {
+            int64_t dt0 = FIRST_DT - 12 * HOUR_S + hour * HOUR_S;
+            build_body(dt0, counts[c]);
+            for (size_t z = 0; z < sizeof(s_offsets) / sizeof(s_offsets[0]); z++) {
+                parse(&agg, s_offsets[z], RECV_BUF_SIZE);
+                TEST_ASSERT_EQUAL(counts[c], agg.count);
+                assert_windows(&agg, counts[c], dt0, s_offsets[z]);
+            }
+        }
+    }
+}
+
+/* The result doesn't depend on how the body is cut up */
+static void test_every_chunk_size(void) {
+    static forecast_agg_t agg;
+
+    build_body(FIRST_DT, FORECAST_AGG_SLOTS_MAX);
+    for (size_t chunk = 1; chunk <= 300; chunk++) {
+        parse(&agg, 60 * 60, chunk);
+        TEST_ASSERT_EQUAL(FORECAST_AGG_SLOTS_MAX, agg.count);
+        assert_windows(&agg, FORECAST_AGG_SLOTS_MAX, FIRST_DT, 60 * 60);
+    }
+}
+
+/* A 304 keeps the slots and moves the windows along, an hour at a time */
+static void test_slide(void) {
+    static forecast_agg_t agg;
+    int temp_min, temp_now, temp_max;
+
+    build_body(FIRST_DT, FORECAST_AGG_SLOTS_MAX);
+    for (size_t z = 0; z < sizeof(s_offsets) / sizeof(s_offsets[0]); z++) {
+        parse(&agg, s_offsets[z], RECV_BUF_SIZE);
+        for (int64_t now = FIRST_DT; now < FIRST_DT + 5 * FORECAST_AGG_DAY_S; now += HOUR_S + 7) {
+            forecast_agg_slide(&agg, now);
+            assert_windows(&agg, FORECAST_AGG_SLOTS_MAX, now, s_offsets[z]);
+        }
+    }
+
+    /* Going back is ignored, and past the last slot there's nothing to show */
+    int64_t now = agg.now;
+    forecast_agg_slide(&agg, FIRST_DT);
+    TEST_ASSERT_EQUAL_INT64(now, agg.now);
+    forecast_agg_slide(&agg, FIRST_DT + 5 * FORECAST_AGG_DAY_S);
+    TEST_ASSERT_FALSE(forecast_agg_range(&agg, FORECAST_WINDOW_HORIZON, &temp_min, &temp_now, &temp_max, NULL));
+}
+
+/* A slot out of step with the 3 hour grid is dropped, not folded in */
+static void test_dropped(void) {
+    static forecast_agg_t agg;
+    int temp_min, temp_now, temp_max;
+
+    forecast_agg_begin(&agg, 0);
+    TEST_ASSERT_TRUE(forecast_agg_slot(&agg, FIRST_DT, 500, 400, 600));
+    TEST_ASSERT_FALSE(forecast_agg_slot(&agg, FIRST_DT + HOUR_S, -2000, -2000, 3000));
+    TEST_ASSERT_FALSE(forecast_agg_slot(&agg, FIRST_DT, -2000, -2000, 3000));
+    TEST_ASSERT_TRUE(forecast_agg_slot(&agg, FIRST_DT + FORECAST_AGG_SLOT_S, 700, 300, 650));
+    TEST_ASSERT_EQUAL(2, agg.count);
+    TEST_ASSERT_EQUAL(2, agg.dropped);
+    TEST_ASSERT_TRUE(forecast_agg_range(&agg, FORECAST_WINDOW_HORIZON, &temp_min, &temp_now, &temp_max, NULL));
+    TEST_ASSERT_EQUAL_INT(300, temp_min);
+    TEST_ASSERT_EQUAL_INT(500, temp_now);
+    TEST_ASSERT_EQUAL_INT(650, temp_max);
+
+    /* No slots, no range */
+    forecast_agg_begin(&agg, 0);
+    TEST_ASSERT_FALSE(forecast_agg_range(&agg, FORECAST_WINDOW_HORIZON, &temp_min, &temp_now, &temp_max, NULL));
+}
+
+static void bench(const char *name, bool aggregate) {
+    static forecast_agg_t agg;
+    forecast_parser_t parser;
+    uint64_t t0 = ns_now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        if (aggregate) {
+            parse(&agg, 0, RECV_BUF_SIZE);
+        } else {
+            forecast_parser_init(&parser);
+            for (size_t off = 0; off < s_body_len; off += RECV_BUF_SIZE) {
+                size_t n = s_body_len - off < RECV_BUF_SIZE ? s_body_len - off : RECV_BUF_SIZE;
+                forecast_parser_feed(&parser, s_body + off, n);
+            }
+            forecast_parser_finish(&parser);
+        }
+    }
+    uint64_t ns = ns_now() - t0;
+    printf("BENCH %-32s %6zu B x %d: %8.2f MB/s %8.2f us/body\n", name, s_body_len, BENCH_ITERATIONS,
+           (double)s_body_len * BENCH_ITERATIONS * 1e3 / (double)ns, (double)ns / 1e3 / BENCH_ITERATIONS);
+    if (aggregate) {
+        TEST_ASSERT_EQUAL(FORECAST_AGG_SLOTS_MAX, agg.count);
+    }
+}
+
+static void test_benchmark(void) {
+    build_body(FIRST_DT, FORECAST_AGG_SLOTS_MAX);
+    bench("parse cnt=40 64B reads", false);
+    bench("parse+aggregate cnt=40 64B reads", true);
+    printf("BENCH forecast_agg_t %zu B, no body buffered\n", sizeof(forecast_agg_t));
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_horizon);
+    RUN_TEST(test_windows);
+    RUN_TEST(test_every_chunk_size);
+    RUN_TEST(test_slide);
+    RUN_TEST(test_dropped);
+    RUN_TEST(test_benchmark);
+    exit(UNITY_END());
+}
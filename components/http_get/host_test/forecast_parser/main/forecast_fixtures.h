@@ -0,0 +1,81 @@
+/**
+ * @file forecast_fixtures.h
+ * @author The Authors
+ * @brief Canned OpenWeatherMap /forecast responses (cnt=4, units=metric)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+/* Full HTTP/1.0 response as seen by http_get_task, headers included */
+static const char FORECAST_DUBLIN_CNT4[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Server: openresty\r\n"
+    "Date: Thu, 19 Dec 2024 10:31:02 GMT\r\n"
+    "Content-Type: application/json; charset=utf-8\r\n"
+    "Content-Length: 1842\r\n"
+    "X-Cache-Key: /data/2.5/forecast?cnt=4&q=dublin,ie&units=metric\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n"
+    "{\"cod\":\"200\",\"message\":0,\"cnt\":4,\"list\":["
+    "{\"dt\":1734609600,\"main\":{\"temp\":7.83,\"feels_like\":4.12,\"temp_min\":7.12,\"temp_max\":7.83,"
+    "\"pressure\":1012,\"sea_level\":1012,\"grnd_level\":1007,\"humidity\":81,\"temp_kf\":0.71},"
+    "\"weather\":[{\"id\":500,\"main\":\"Rain\",\"description\":\"light rain\",\"icon\":\"10d\"}],"
+    "\"clouds\":{\"all\":75},\"wind\":{\"speed\":7.2,\"deg\":250,\"gust\":12.31},\"visibility\":10000,"
+    "\"pop\":0.41,\"rain\":{\"3h\":0.32},\"sys\":{\"pod\":\"d\"},\"dt_txt\":\"2024-12-19 12:00:00\"},"
+    "{\"dt\":1734620400,\"main\":{\"temp\":6.91,\"feels_like\":3.25,\"temp_min\":6.44,\"temp_max\":6.91,"
+    "\"pressure\":1013,\"sea_level\":1013,\"grnd_level\":1008,\"humidity\":84,\"temp_kf\":0.47},"
+    "\"weather\":[{\"id\":803,\"main\":\"Clouds\",\"description\":\"broken clouds\",\"icon\":\"04d\"}],"
+    "\"clouds\":{\"all\":62},\"wind\":{\"speed\":6.8,\"deg\":262,\"gust\":11.9},\"visibility\":10000,"
+    "\"pop\":0.2,\"sys\":{\"pod\":\"d\"},\"dt_txt\":\"2024-12-19 15:00:00\"},"
+    "{\"dt\":1734631200,\"main\":{\"temp\":4.37,\"feels_like\":0.88,\"temp_min\":4.37,\"temp_max\":4.37,"
+    "\"pressure\":1015,\"sea_level\":1015,\"grnd_level\":1010,\"humidity\":88,\"temp_kf\":0},"
+    "\"weather\":[{\"id\":800,\"main\":\"Clear\",\"description\":\"clear sky\",\"icon\":\"01n\"}],"
+    "\"clouds\":{\"all\":3},\"wind\":{\"speed\":5.1,\"deg\":270,\"gust\":9.4},\"visibility\":10000,"
+    "\"pop\":0,\"sys\":{\"pod\":\"n\"},\"dt_txt\":\"2024-12-19 18:00:00\"},"
+    "{\"dt\":1734642000,\"main\":{\"temp\":-1.2,\"feels_like\":-4.6,\"temp_min\":-2.75,\"temp_max\":-1.2,"
+    "\"pressure\":1016,\"sea_level\":1016,\"grnd_level\":1011,\"humidity\":91,\"temp_kf\":0},"
+    "\"weather\":[{\"id\":800,\"main\":\"Clear\",\"description\":\"clear \\\"temp_min\\\":-40 sky\",\"icon\":\"01n\"}],"
+    "\"clouds\":{\"all\":0},\"wind\":{\"speed\":3.9,\"deg\":281,\"gust\":6.2},\"visibility\":10000,"
+    "\"pop\":0,\"sys\":{\"pod\":\"n\"},\"dt_txt\":\"2024-12-19 21:00:00\"}],"
+    "\"city\":{\"id\":2964574,\"name\":\"Dublin\",\"coord\":{\"lat\":53.344,\"lon\":-6.2672},"
+    "\"country\":\"IE\",\"population\":1024027,\"timezone\":0,\"sunrise\":1734597822,\"sunset\":1734623869}}";
+
+/* Expected results for FORECAST_DUBLIN_CNT4, centi-degrees */
+#define FORECAST_DUBLIN_CNT4_TEMP_NOW   783
+#define FORECAST_DUBLIN_CNT4_TEMP_MIN   -275
+#define FORECAST_DUBLIN_CNT4_TEMP_MAX   783
+#define FORECAST_DUBLIN_CNT4_DT_FIRST   1734609600
+#define FORECAST_DUBLIN_CNT4_DT_LAST    1734642000
+
+/* One forecast slot, used to synthesise a full 40 slot (5 day) body */
+#define FORECAST_SLOT_FMT \
+    "{\"dt\":%lld,\"main\":{\"temp\":%s%d.%02d,\"feels_like\":%s%d.%02d,\"temp_min\":%s%d.%02d,\"temp_max\":%s%d.%02d," \
+    "\"pressure\":1012,\"sea_level\":1012,\"grnd_level\":1007,\"humidity\":81,\"temp_kf\":0.71}," \
+    "\"weather\":[{\"id\":500,\"main\":\"Rain\",\"description\":\"light rain\",\"icon\":\"10d\"}]," \
+    "\"clouds\":{\"all\":75},\"wind\":{\"speed\":7.2,\"deg\":250,\"gust\":12.31},\"visibility\":10000," \
+    "\"pop\":0.41,\"rain\":{\"3h\":0.32},\"sys\":{\"pod\":\"d\"},\"dt_txt\":\"2024-12-19 12:00:00\"}"
+
+/* /group?id=2964574,2643743,2988507&units=metric body: current weather for
+ * several cities, with "id"s nested in "weather" & "sys" that aren't the city */
+static const char GROUP_CNT3_BODY[] =
+    "{\"cnt\":3,\"list\":["
+    "{\"coord\":{\"lon\":-6.2672,\"lat\":53.344},\"sys\":{\"type\":2,\"id\":2037117,\"country\":\"IE\",\"timezone\":0,"
+    "\"sunrise\":1734597822,\"sunset\":1734623869},\"weather\":[{\"id\":500,\"main\":\"Rain\",\"description\":\"light rain\","
+    "\"icon\":\"10d\"}],\"main\":{\"temp\":7.83,\"feels_like\":4.12,\"temp_min\":6.66,\"temp_max\":8.89,\"pressure\":1012,"
+    "\"humidity\":81},\"visibility\":10000,\"wind\":{\"speed\":7.2,\"deg\":250},\"clouds\":{\"all\":75},"
+    "\"dt\":1734604000,\"id\":2964574,\"name\":\"Dublin\"},"
+    "{\"coord\":{\"lon\":-0.1257,\"lat\":51.5085},\"sys\":{\"type\":2,\"id\":2075535,\"country\":\"GB\",\"timezone\":0,"
+    "\"sunrise\":1734595440,\"sunset\":1734623527},\"weather\":[{\"id\":803,\"main\":\"Clouds\",\"description\":\"broken clouds\","
+    "\"icon\":\"04d\"}],\"main\":{\"temp\":4.02,\"feels_like\":1.2,\"temp_min\":3.1,\"temp_max\":5.5,\"pressure\":1020,"
+    "\"humidity\":76},\"visibility\":10000,\"wind\":{\"speed\":3.6,\"deg\":220},\"clouds\":{\"all\":75},"
+    "\"dt\":1734604100,\"id\":2643743,\"name\":\"London\"},"
+    "{\"coord\":{\"lon\":2.3488,\"lat\":48.8534},\"sys\":{\"type\":1,\"id\":6550,\"country\":\"FR\",\"timezone\":3600,"
+    "\"sunrise\":1734593900,\"sunset\":1734623700},\"weather\":[{\"id\":600,\"main\":\"Snow\",\"description\":\"light snow\","
+    "\"icon\":\"13d\"}],\"main\":{\"temp\":-1.45,\"feels_like\":-4.8,\"temp_min\":-2.78,\"temp_max\":0.5,\"pressure\":1025,"
+    "\"humidity\":93},\"visibility\":8000,\"wind\":{\"speed\":2.1,\"deg\":40},\"clouds\":{\"all\":100},"
+    "\"dt\":1734604200,\"id\":2988507,\"name\":\"Paris\"}"
+    "]}";
@@ -0,0 +1,301 @@
+/**
+ * @file test_forecast_parser.c
+ * @author The Authors
+ * @brief Host test & benchmark for the incremental forecast tokenizer
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "common.h"
+#include "forecast_parser.h"
+#include "forecast_fixtures.h"
+
+#define FORECAST_SLOTS_MAX  40
+#define BENCH_ITERATIONS    2000
+#define RECV_BUF_SIZE       64      // same as http_get_task
+
+static char s_body_40[FORECAST_SLOTS_MAX * 512 + 64];
+static size_t s_body_40_len;
+static int s_body_40_min;
+static int s_body_40_max;
+
+static inline uint64_t cycles_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int append_centi(char *sign, int centi) {
+    strcpy(sign, centi < 0 ? "-" : "");
+    return abs(centi);
+}
+
+/* Synthesise a full 5 day body with a temperature swing that crosses zero */
+static void build_body_40(void) {
+    size_t len = snprintf(s_body_40, sizeof(s_body_40), "{\"cod\":\"200\",\"message\":0,\"cnt\":40,\"list\":[");
+    s_body_40_min = 99 * TEMP_CENTI_PER_C;
+    s_body_40_max = -40 * TEMP_CENTI_PER_C;
+
+    for (int slot = 0; slot < FORECAST_SLOTS_MAX; slot++) {
+        int now = ((slot * 37) % 1400) - 500;     // centi-degrees, -5.00 .. 8.99
+        int lo = now - 75;
+        int hi = now + 133;
+        char s_now[2], s_lo[2], s_hi[2], s_fl[2];
+        int a_now = append_centi(s_now, now);
+        int a_lo = append_centi(s_lo, lo);
+        int a_hi = append_centi(s_hi, hi);
+        int a_fl = append_centi(s_fl, now - 300);
+
+        len += snprintf(s_body_40 + len, sizeof(s_body_40) - len, FORECAST_SLOT_FMT "%s",
+                        1734609600LL + slot * 10800LL,
+                        s_now, a_now / 100, a_now % 100, s_fl, a_fl / 100, a_fl % 100,
+                        s_lo, a_lo / 100, a_lo % 100, s_hi, a_hi / 100, a_hi % 100,
+                        slot == FORECAST_SLOTS_MAX - 1 ? "" : ",");
+
+        if (lo < s_body_40_min) {
+            s_body_40_min = lo;
+        }
+        if (hi > s_body_40_max) {
+            s_body_40_max = hi;
+        }
+    }
+    len += snprintf(s_body_40 + len, sizeof(s_body_40) - len, "],\"city\":{\"id\":2964574,\"name\":\"Dublin\"}}");
+    s_body_40_len = len;
+}
+
+static void parse_chunked(forecast_parser_t *parser, const char *buf, size_t len, size_t chunk) {
+    forecast_parser_init(parser);
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = len - off < chunk ? len - off : chunk;
+        forecast_parser_feed(parser, buf + off, n);
+    }
+    forecast_parser_finish(parser);
+}
+
+static void assert_dublin(const forecast_parser_t *parser) {
+    TEST_ASSERT_EQUAL_INT(FORECAST_DUBLIN_CNT4_TEMP_NOW, parser->temp_now);
+    TEST_ASSERT_EQUAL_INT(FORECAST_DUBLIN_CNT4_TEMP_MIN, parser->temp_min);
+    TEST_ASSERT_EQUAL_INT(FORECAST_DUBLIN_CNT4_TEMP_MAX, parser->temp_max);
+    TEST_ASSERT_EQUAL_INT64(FORECAST_DUBLIN_CNT4_DT_FIRST, parser->dt_first);
+    TEST_ASSERT_EQUAL_INT64(FORECAST_DUBLIN_CNT4_DT_LAST, parser->dt_last);
+}
+
+static void test_whole_response(void) {
+    forecast_parser_t parser;
+    parse_chunked(&parser, FORECAST_DUBLIN_CNT4, strlen(FORECAST_DUBLIN_CNT4), strlen(FORECAST_DUBLIN_CNT4));
+    assert_dublin(&parser);
+}
+
+static void test_every_split_point(void) {
+    const size_t len = strlen(FORECAST_DUBLIN_CNT4);
+    forecast_parser_t parser;
+
+    for (size_t split = 1; split < len; split++) {
+        forecast_parser_init(&parser);
+        forecast_parser_feed(&parser, FORECAST_DUBLIN_CNT4, split);
+        forecast_parser_feed(&parser, FORECAST_DUBLIN_CNT4 + split, len - split);
+        forecast_parser_finish(&parser);
+        assert_dublin(&parser);
+    }
+}
+
+static void test_every_chunk_size(void) {
+    const size_t len = strlen(FORECAST_DUBLIN_CNT4);
+    forecast_parser_t parser;
+
+    for (size_t chunk = 1; chunk <= len; chunk++) {
+        parse_chunked(&parser, FORECAST_DUBLIN_CNT4, len, chunk);
+        assert_dublin(&parser);
+    }
+}
+
+static void test_full_horizon(void) {
+    forecast_parser_t parser;
+    parse_chunked(&parser, s_body_40, s_body_40_len, RECV_BUF_SIZE);
+    TEST_ASSERT_EQUAL_INT(-500, parser.temp_now);
+    TEST_ASSERT_EQUAL_INT(s_body_40_min, parser.temp_min);
+    TEST_ASSERT_EQUAL_INT(s_body_40_max, parser.temp_max);
+    TEST_ASSERT_EQUAL_INT64(1734609600LL + 39 * 10800LL, parser.dt_last);
+}
+
+/* Hundredths kept, anything past them truncated toward zero, whole numbers scaled */
+static void test_centi_degrees(void) {
+    static const struct {
+        const char *body;
+        int temp;
+    } cases[] = {
+        { "{\"temp\":7.83}", 783 },
+        { "{\"temp\":7.8}", 780 },
+        { "{\"temp\":7}", 700 },
+        { "{\"temp\":7.839}", 783 },
+        { "{\"temp\":-0.05}", -5 },
+        { "{\"temp\":-12.5}", -1250 },
+        { "{\"temp\":0.999}", 99 },
+    };
+    forecast_parser_t parser;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        for (size_t chunk = 1; chunk <= strlen(cases[i].body); chunk++) {
+            parse_chunked(&parser, cases[i].body, strlen(cases[i].body), chunk);
+            TEST_ASSERT_EQUAL_INT(cases[i].temp, parser.temp_now);
+        }
+    }
+
+    /* Ends of the stream, and dt/id aren't scaled */
+    static const char tail[] = "{\"dt\":1734609600,\"temp_max\":-3.2";
+    parse_chunked(&parser, tail, strlen(tail), 5);
+    TEST_ASSERT_EQUAL_INT(-320, parser.temp_max);
+    TEST_ASSERT_EQUAL_INT64(1734609600LL, parser.dt_first);
+}
+
+static void test_escaped_and_nested_strings(void) {
+    static const char body[] = "{\"a\":\"x\\\"temp\\\":5\",\"temp\" : -3.9 ,\"temp_mins\":-30,\"temp_min\":\"-20\"}";
+    forecast_parser_t parser;
+    parse_chunked(&parser, body, strlen(body), 1);
+    TEST_ASSERT_EQUAL_INT(-390, parser.temp_now);
+    TEST_ASSERT_FALSE(parser.has_temp_min);
+    TEST_ASSERT_FALSE(parser.has_temp_max);
+}
+
+typedef struct {
+    int count;
+    int64_t id[4];
+    int temp[4][3];     // min, now, max
+    int64_t dt[4];
+} group_result_t;
+
+static void group_element_cb(void *ctx, const forecast_parser_t *parser) {
+    group_result_t *res = ctx;
+    TEST_ASSERT_LESS_THAN(4, res->count);
+    res->id[res->count] = parser->id;
+    res->temp[res->count][0] = parser->temp_min;
+    res->temp[res->count][1] = parser->temp_now;
+    res->temp[res->count][2] = parser->temp_max;
+    res->dt[res->count] = parser->dt_first;
+    res->count++;
+}
+
+static void test_group_every_split_point(void) {
+    static const int expected[3][3] = { { 666, 783, 889 }, { 310, 402, 550 }, { -278, -145, 50 } };
+    static const int64_t ids[3] = { 2964574, 2643743, 2988507 };
+    const size_t len = strlen(GROUP_CNT3_BODY);
+    forecast_parser_t parser;
+    group_result_t res;
+
+    for (size_t split = 1; split < len; split++) {
+        memset(&res, 0, sizeof(res));
+        forecast_parser_init(&parser);
+        forecast_parser_set_element_cb(&parser, FORECAST_PARSER_LIST_ENTRY_DEPTH, group_element_cb, &res);
+        forecast_parser_feed(&parser, GROUP_CNT3_BODY, split);
+        forecast_parser_feed(&parser, GROUP_CNT3_BODY + split, len - split);
+        forecast_parser_finish(&parser);
+
+        TEST_ASSERT_EQUAL(3, res.count);
+        for (int i = 0; i < 3; i++) {
+            TEST_ASSERT_EQUAL_INT64(ids[i], res.id[i]);
+            TEST_ASSERT_EQUAL_INT_ARRAY(expected[i], res.temp[i], 3);
+            TEST_ASSERT_EQUAL_INT64(1734604000 + 100 * i, res.dt[i]);
+        }
+    }
+}
+
+/* The original per-offset sscanf() scan, kept only as a benchmark reference */
+static void legacy_sscanf_scan(const char *buf, size_t len, int *temp_min, int *temp_now, int *temp_max) {
+    char recv_buf[RECV_BUF_SIZE];
+    *temp_now = 99;
+    *temp_min = 99;
+    *temp_max = -40;
+    for (size_t off = 0; off < len; off += sizeof(recv_buf) - 1) {
+        size_t r = len - off < sizeof(recv_buf) - 1 ? len - off : sizeof(recv_buf) - 1;
+        memset(recv_buf, 0, sizeof(recv_buf));
+        memcpy(recv_buf, buf + off, r);
+        for (size_t i = 0; i < r; i++) {
+            int v;
+            if (*temp_now == 99 && sscanf(&recv_buf[i], "\"temp\":%d", &v) == 1) {
+                *temp_now = v;
+            }
+            if (sscanf(&recv_buf[i], "\"temp_min\":%d", &v) == 1 && v < *temp_min) {
+                *temp_min = v;
+            }
+            if (sscanf(&recv_buf[i], "\"temp_max\":%d", &v) == 1 && v > *temp_max) {
+                *temp_max = v;
+            }
+        }
+    }
+}
+
+static void bench_report(const char *name, size_t bytes, uint64_t ns, uint64_t cycles) {
+    double mb_per_s = (double)bytes * BENCH_ITERATIONS * 1e3 / (double)ns;
+    printf("BENCH %-28s %8zu B x %d: %9.2f MB/s %8.2f cycles/B\n",
+           name, bytes, BENCH_ITERATIONS, mb_per_s, (double)cycles / (double)bytes / BENCH_ITERATIONS);
+}
+
+static void bench_tokenizer(const char *name, const char *buf, size_t len, size_t chunk) {
+    forecast_parser_t parser;
+    uint64_t t0 = ns_now();
+    uint64_t c0 = cycles_now();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        parse_chunked(&parser, buf, len, chunk);
+    }
+    uint64_t c1 = cycles_now();
+    uint64_t t1 = ns_now();
+    bench_report(name, len, t1 - t0, c1 - c0);
+    TEST_ASSERT_NOT_EQUAL(99 * TEMP_CENTI_PER_C, parser.temp_now);
+}
+
+static void bench_legacy(const char *name, const char *buf, size_t len) {
+    int lo, now, hi;
+    uint64_t t0 = ns_now();
+    uint64_t c0 = cycles_now();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        legacy_sscanf_scan(buf, len, &lo, &now, &hi);
+    }
+    uint64_t c1 = cycles_now();
+    uint64_t t1 = ns_now();
+    bench_report(name, len, t1 - t0, c1 - c0);
+    TEST_ASSERT_NOT_EQUAL(99, now);
+}
+
+static void test_benchmark(void) {
+    const size_t len = strlen(FORECAST_DUBLIN_CNT4);
+
+    bench_legacy("legacy sscanf cnt=4", FORECAST_DUBLIN_CNT4, len);
+    bench_tokenizer("tokenizer cnt=4 64B reads", FORECAST_DUBLIN_CNT4, len, RECV_BUF_SIZE);
+    bench_tokenizer("tokenizer cnt=4 1B reads", FORECAST_DUBLIN_CNT4, len, 1);
+    bench_legacy("legacy sscanf cnt=40", s_body_40, s_body_40_len);
+    bench_tokenizer("tokenizer cnt=40 64B reads", s_body_40, s_body_40_len, RECV_BUF_SIZE);
+    bench_tokenizer("tokenizer cnt=40 1460B reads", s_body_40, s_body_40_len, 1460);
+}
+
+void app_main(void)
+{
+    build_body_40();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_whole_response);
+    RUN_TEST(test_every_split_point);
+    RUN_TEST(test_every_chunk_size);
+    RUN_TEST(test_full_horizon);
+    RUN_TEST(test_centi_degrees);
+    RUN_TEST(test_escaped_and_nested_strings);
+    RUN_TEST(test_group_every_split_point);
+    RUN_TEST(test_benchmark);
+    exit(UNITY_END());
+}
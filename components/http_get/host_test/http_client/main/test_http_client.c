@@ -0,0 +1,262 @@
+/**
+ * @file test_http_client.c
+ * @author The Authors
+ * @brief Host test for HTTP/1.1 framing and the keep-alive client
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The framing tests run standalone. The client tests need the stand-in server
+ * from pytest_http_client.py, which passes its port in STANDIN_PORT, and sets
+ * STANDIN_FAULTS for the run that injects faults.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "http_response.h"
+#include "http_client.h"
+#include "forecast_parser.h"
+
+static const char CHUNKED_RESPONSE[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/json\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "ETag: \"5f2a-1734609600\"\r\n"
+    "Last-Modified: Thu, 19 Dec 2024 09:00:00 GMT\r\n"
+    "Date: Thu, 19 Dec 2024 10:31:02 GMT\r\n"
+    "Cache-Control: public, max-age=600\r\n"
+    "\r\n"
+    "13\r\n{\"list\":[{\"dt\":1734\r\n"
+    "1c;ext=1\r\n609600,\"main\":{\"temp\":7.8,\"t\r\n"
+    "20\r\nemp_min\":-2.1,\"temp_max\":9.0}}]}\r\n"
+    "0\r\n"
+    "\r\n";
+
+static const char LENGTH_RESPONSE[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Length: 11\r\n"
+    "Connection: close\r\n"
+    "\r\n"
+    "{\"temp\":3}\n";
+
+static const char NOT_MODIFIED_RESPONSE[] =
+    "HTTP/1.1 304 Not Modified\r\n"
+    "ETag: \"5f2a-1734609600\"\r\n"
+    "\r\n";
+
+typedef struct {
+    char body[256];
+    size_t len;
+} body_sink_t;
+
+static void sink_cb(void *ctx, const char *buf, size_t len) {
+    body_sink_t *sink = ctx;
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(sink->body) - 1, sink->len + len);
+    memcpy(sink->body + sink->len, buf, len);
+    sink->len += len;
+    sink->body[sink->len] = '\0';
+}
+
+static void parser_cb(void *ctx, const char *buf, size_t len) {
+    forecast_parser_feed((forecast_parser_t *)ctx, buf, len);
+}
+
+static void feed_split(http_response_t *resp, body_sink_t *sink, const char *msg, size_t split) {
+    size_t len = strlen(msg);
+    http_response_init(resp);
+    memset(sink, 0, sizeof(*sink));
+    size_t used = http_response_feed(resp, msg, split, sink_cb, sink);
+    TEST_ASSERT_EQUAL(split, used);
+    used = http_response_feed(resp, msg + split, len - split, sink_cb, sink);
+    TEST_ASSERT_EQUAL(len - split, used);
+}
+
+static void test_chunked_every_split(void) {
+    http_response_t resp;
+    body_sink_t sink;
+
+    for (size_t split = 0; split <= strlen(CHUNKED_RESPONSE); split++) {
+        feed_split(&resp, &sink, CHUNKED_RESPONSE, split);
+        TEST_ASSERT_TRUE(http_response_done(&resp));
+        TEST_ASSERT_EQUAL(200, resp.status);
+        TEST_ASSERT_TRUE(resp.keep_alive);
+        TEST_ASSERT_EQUAL_STRING("\"5f2a-1734609600\"", resp.etag);
+        TEST_ASSERT_EQUAL_STRING("Thu, 19 Dec 2024 09:00:00 GMT", resp.last_modified);
+        TEST_ASSERT_EQUAL_INT64(1734604262, resp.date);
+        TEST_ASSERT_EQUAL(600, resp.max_age);
+        TEST_ASSERT_EQUAL_STRING("{\"list\":[{\"dt\":1734609600,\"main\":{\"temp\":7.8,\"temp_min\":-2.1,\"temp_max\":9.0}}]}", sink.body);
+    }
+}
+
+static void test_content_length_and_close(void) {
+    http_response_t resp;
+    body_sink_t sink;
+
+    for (size_t split = 0; split <= strlen(LENGTH_RESPONSE); split++) {
+        feed_split(&resp, &sink, LENGTH_RESPONSE, split);
+        TEST_ASSERT_TRUE(http_response_done(&resp));
+        TEST_ASSERT_FALSE(resp.keep_alive);
+        TEST_ASSERT_EQUAL(11, sink.len);
+        TEST_ASSERT_EQUAL_INT64(-1, resp.date);
+        TEST_ASSERT_EQUAL(-1, resp.max_age);
+    }
+}
+
+static void test_cache_headers(void) {
+    static const char leap[] = "HTTP/1.1 304 Not Modified\r\nDate: Thu, 29 Feb 2024 00:00:00 GMT\r\nCache-Control: no-cache\r\n\r\n";
+    static const char junk[] = "HTTP/1.1 304 Not Modified\r\nDate: yesterday\r\n\r\n";
+    http_response_t resp;
+
+    http_response_init(&resp);
+    http_response_feed(&resp, leap, strlen(leap), NULL, NULL);
+    TEST_ASSERT_EQUAL_INT64(1709164800, resp.date);
+    TEST_ASSERT_EQUAL(0, resp.max_age);
+
+    http_response_init(&resp);
+    http_response_feed(&resp, junk, strlen(junk), NULL, NULL);
+    TEST_ASSERT_EQUAL_INT64(-1, resp.date);
+    TEST_ASSERT_EQUAL(-1, resp.max_age);
+}
+
+static void test_not_modified_has_no_body(void) {
+    http_response_t resp;
+    body_sink_t sink;
+    char pipelined[256];
+
+    /* Anything after a 304 belongs to the next response */
+    snprintf(pipelined, sizeof(pipelined), "%s%s", NOT_MODIFIED_RESPONSE, LENGTH_RESPONSE);
+    http_response_init(&resp);
+    memset(&sink, 0, sizeof(sink));
+    size_t used = http_response_feed(&resp, pipelined, strlen(pipelined), sink_cb, &sink);
+    TEST_ASSERT_EQUAL(strlen(NOT_MODIFIED_RESPONSE), used);
+    TEST_ASSERT_TRUE(http_response_done(&resp));
+    TEST_ASSERT_EQUAL(304, resp.status);
+    TEST_ASSERT_EQUAL(0, sink.len);
+}
+
+static void test_body_until_close(void) {
+    static const char msg[] = "HTTP/1.0 200 OK\r\n\r\n{\"temp\":1}";
+    http_response_t resp;
+    body_sink_t sink = { 0 };
+
+    http_response_init(&resp);
+    http_response_feed(&resp, msg, strlen(msg), sink_cb, &sink);
+    TEST_ASSERT_FALSE(http_response_done(&resp));
+    TEST_ASSERT_TRUE(http_response_eof(&resp));
+    TEST_ASSERT_FALSE(resp.keep_alive);
+    TEST_ASSERT_EQUAL_STRING("{\"temp\":1}", sink.body);
+}
+
+static const char *s_port;
+
+static int fetch(http_client_t *client, const char *path, forecast_parser_t *parser) {
+    char recv_buf[64];
+    forecast_parser_init(parser);
+    int status = http_client_get(client, path, recv_buf, sizeof(recv_buf), parser_cb, parser);
+    forecast_parser_finish(parser);
+    return status;
+}
+
+static void test_keep_alive_and_conditional(void) {
+    http_client_t client;
+    forecast_parser_t parser;
+
+    http_client_init(&client, "127.0.0.1", s_port, "localhost");
+
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast", &parser));
+    TEST_ASSERT_EQUAL(780, parser.temp_now);
+    TEST_ASSERT_EQUAL(-210, parser.temp_min);
+    TEST_ASSERT_EQUAL(900, parser.temp_max);
+    TEST_ASSERT_LESS_OR_EQUAL(client.timing.total_us, client.timing.dns_us + client.timing.connect_us + client.timing.first_byte_us);
+
+    /* Unchanged: 304, nothing reaches the tokenizer */
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(304, fetch(&client, "/forecast", &parser));
+        TEST_ASSERT_FALSE(parser.has_temp_now);
+        /* Reused: no lookup or connect to time */
+        TEST_ASSERT_EQUAL(0, client.timing.dns_us);
+        TEST_ASSERT_EQUAL(0, client.timing.connect_us);
+        TEST_ASSERT_LESS_OR_EQUAL(client.timing.total_us, client.timing.first_byte_us);
+    }
+    TEST_ASSERT_EQUAL(1, client.stats.connects);
+    TEST_ASSERT_EQUAL(1, client.stats.dns_lookups);
+    TEST_ASSERT_EQUAL(3, client.stats.reused);
+    TEST_ASSERT_EQUAL(3, client.stats.not_modified);
+
+    /* Content-Length framing on the same connection */
+    http_client_forget_validators(&client);
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-length", &parser));
+    TEST_ASSERT_EQUAL(780, parser.temp_now);
+    TEST_ASSERT_EQUAL(1, client.stats.connects);
+
+    /* Server drops the idle connection without saying so: one transparent retry */
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-drop", &parser));
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-length", &parser));
+    TEST_ASSERT_EQUAL(2, client.stats.connects);
+    TEST_ASSERT_EQUAL(1, client.stats.dns_lookups);
+
+    /* "Connection: close" is honoured */
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-close", &parser));
+    TEST_ASSERT_EQUAL(-1, client.sock);
+
+    http_client_close(&client);
+    printf("CLIENT connects=%u requests=%u reused=%u not_modified=%u dns_lookups=%u\n",
+           (unsigned)client.stats.connects, (unsigned)client.stats.requests, (unsigned)client.stats.reused,
+           (unsigned)client.stats.not_modified, (unsigned)client.stats.dns_lookups);
+}
+
+/* Every fault fails the fetch, cleanly: the next one starts afresh */
+static void test_faults(void) {
+    http_client_t client;
+    forecast_parser_t parser;
+
+    /* Refused */
+    http_client_init(&client, "127.0.0.1", getenv("STANDIN_CLOSED_PORT"), "localhost");
+    TEST_ASSERT_EQUAL(-1, fetch(&client, "/forecast-length", &parser));
+    TEST_ASSERT_EQUAL(-1, client.sock);
+    TEST_ASSERT_FALSE(client.addr_valid);
+    TEST_ASSERT_EQUAL(0, client.stats.connects);
+    TEST_ASSERT_EQUAL(1, client.stats.errors);
+
+    http_client_init(&client, "127.0.0.1", s_port, "localhost");
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-length", &parser));
+
+    /* Reset part way through the body of a kept-alive connection: not retried, some of it was taken */
+    TEST_ASSERT_EQUAL(-1, fetch(&client, "/forecast-reset", &parser));
+    TEST_ASSERT_EQUAL(-1, client.sock);
+    TEST_ASSERT_GREATER_THAN(0, client.body_bytes);
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-length", &parser));
+    TEST_ASSERT_EQUAL(780, parser.temp_now);
+    TEST_ASSERT_EQUAL(2, client.stats.connects);
+
+    /* Stalled part way: given up on at the receive timeout, not when the server comes back */
+    TEST_ASSERT_EQUAL(-1, fetch(&client, "/forecast-stall", &parser));
+    TEST_ASSERT_EQUAL(-1, client.sock);
+    TEST_ASSERT_GREATER_OR_EQUAL(4000000, client.timing.total_us);
+    TEST_ASSERT_LESS_THAN(6500000, client.timing.total_us);
+    printf("FAULTS stall given up after %lld ms\n", (long long)client.timing.total_us / 1000);
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-length", &parser));
+    TEST_ASSERT_EQUAL(3, client.stats.connects);
+    TEST_ASSERT_EQUAL(2, client.stats.errors);
+    http_client_close(&client);
+}
+
+void app_main(void)
+{
+    s_port = getenv("STANDIN_PORT");
+
+    UNITY_BEGIN();
+    RUN_TEST(test_chunked_every_split);
+    RUN_TEST(test_content_length_and_close);
+    RUN_TEST(test_not_modified_has_no_body);
+    RUN_TEST(test_body_until_close);
+    RUN_TEST(test_cache_headers);
+    if (s_port && getenv("STANDIN_FAULTS")) {
+        RUN_TEST(test_faults);
+    } else if (s_port) {
+        RUN_TEST(test_keep_alive_and_conditional);
+    }
+    exit(UNITY_END());
+}
@@ -0,0 +1,126 @@
+#!/usr/bin/env python
+#
+# Runs the http_client host test against a local stand-in for the
+# OpenWeatherMap server that counts TCP connections and HTTP requests,
+# then again with faults injected: a refused connect, a connection reset
+# part way through the body and a server that stalls.
+#
+#   idf.py --preview set-target linux && idf.py build
+#   pytest pytest_http_client.py
+
+import os
+import socket
+import struct
+import subprocess
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+BODY = b'{"cod":"200","cnt":1,"list":[{"dt":1734609600,"main":{"temp":7.8,"temp_min":-2.1,"temp_max":9.0}}]}'
+ETAG = '"5f2a-1734609600"'
+LAST_MODIFIED = 'Thu, 19 Dec 2024 09:00:00 GMT'
+STALL_S = 7  # longer than the client's receive timeout
+
+
+class StandInHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def setup(self) -> None:
+        super().setup()
+        with self.server.lock:
+            self.server.connections += 1
+
+    def log_message(self, *args) -> None:  # keep pytest output readable
+        pass
+
+    def do_GET(self) -> None:
+        with self.server.lock:
+            self.server.requests += 1
+            if self.headers.get('If-None-Match') or self.headers.get('If-Modified-Since'):
+                self.server.conditional += 1
+
+        if self.path == '/forecast' and self.headers.get('If-None-Match') == ETAG:
+            self.send_response(304)
+            self.send_header('ETag', ETAG)
+            self.end_headers()
+            return
+
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        if self.path == '/forecast':
+            self.send_header('ETag', ETAG)
+            self.send_header('Last-Modified', LAST_MODIFIED)
+            self.send_header('Transfer-Encoding', 'chunked')
+            self.end_headers()
+            for i in range(0, len(BODY), 17):
+                chunk = BODY[i:i + 17]
+                self.wfile.write(b'%x\r\n%s\r\n' % (len(chunk), chunk))
+            self.wfile.write(b'0\r\n\r\n')
+            return
+
+        self.send_header('Content-Length', str(len(BODY)))
+        if self.path == '/forecast-close':
+            self.send_header('Connection', 'close')
+        self.end_headers()
+        if self.path in ('/forecast-reset', '/forecast-stall'):
+            self.wfile.write(BODY[:len(BODY) // 2])
+            self.wfile.flush()
+            self.close_connection = True
+            if self.path == '/forecast-stall':
+                time.sleep(STALL_S)
+            else:
+                # RST rather than FIN
+                self.connection.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack('ii', 1, 0))
+            return
+        self.wfile.write(BODY)
+        if self.path in ('/forecast-close', '/forecast-drop'):
+            # '/forecast-drop' hangs up as if an idle timeout fired, without warning the client
+            self.close_connection = True
+
+
+def start_standin() -> ThreadingHTTPServer:
+    server = ThreadingHTTPServer(('127.0.0.1', 0), StandInHandler)
+    server.lock = threading.Lock()
+    server.connections = 0
+    server.requests = 0
+    server.conditional = 0
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server
+
+
+def test_http_client_keep_alive() -> None:
+    server = start_standin()
+    elf = os.path.join(os.path.dirname(__file__), 'build', 'http_client_host_test.elf')
+    env = dict(os.environ, STANDIN_PORT=str(server.server_address[1]))
+    try:
+        result = subprocess.run([elf], env=env, capture_output=True, text=True, timeout=60)
+    finally:
+        server.shutdown()
+    print(result.stdout)
+    assert result.returncode == 0
+    # 1 + 3 conditional, '/forecast-length' and '/forecast-drop' on the first
+    # connection; the retried '/forecast-length' and '/forecast-close' on the
+    # second. The request written to the dropped connection never arrives.
+    assert server.connections == 2
+    assert server.requests == 8
+    assert server.conditional == 3
+
+
+def test_http_client_faults() -> None:
+    server = start_standin()
+    closed = socket.socket()
+    closed.bind(('127.0.0.1', 0))
+    closed_port = closed.getsockname()[1]
+    closed.close()  # nothing listens there: connects are refused
+    elf = os.path.join(os.path.dirname(__file__), 'build', 'http_client_host_test.elf')
+    env = dict(os.environ, STANDIN_PORT=str(server.server_address[1]), STANDIN_FAULTS='1',
+               STANDIN_CLOSED_PORT=str(closed_port))
+    try:
+        result = subprocess.run([elf], env=env, capture_output=True, text=True, timeout=60)
+    finally:
+        server.shutdown()
+    print(result.stdout)
+    assert result.returncode == 0
+    # Each fault is followed by a good fetch, which needs a new connection
+    assert server.connections == 3
+    assert server.requests == 5
@@ -0,0 +1,185 @@
+/**
+ * @file test_https_client.c
+ * @author The Authors
+ * @brief Host test for HTTPS fetches and TLS session resumption
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Needs the TLS stand-in server from pytest_https_client.py, which passes its
+ * port in STANDIN_PORT and its self-signed certificate (for "localhost") in
+ * STANDIN_CA. The server counts full and resumed handshakes on its side too.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "unity.h"
+#include "sdkconfig.h"
+#include "http_client.h"
+#include "tls_conn.h"
+#include "forecast_parser.h"
+
+#define RESUMES     10
+
+static const char *s_port;
+static char s_ca[4096];
+
+typedef struct {
+    uint32_t count;
+    uint64_t total_us;
+} handshakes_t;
+
+static handshakes_t s_full, s_resumed;
+static int s_temp_now;
+
+static void parser_cb(void *ctx, const char *buf, size_t len) {
+    forecast_parser_feed((forecast_parser_t *)ctx, buf, len);
+}
+
+static int fetch(http_client_t *client, const char *path) {
+    char recv_buf[64];
+    forecast_parser_t parser;
+
+    forecast_parser_init(&parser);
+    int status = http_client_get(client, path, recv_buf, sizeof(recv_buf), parser_cb, &parser);
+    forecast_parser_finish(&parser);
+    s_temp_now = parser.temp_now;
+    if (client->timing.tls_us) {
+        handshakes_t *h = client->timing.tls_resumed ? &s_resumed : &s_full;
+        h->count++;
+        h->total_us += client->timing.tls_us;
+    }
+    return status;
+}
+
+static void test_resumption(void) {
+    static tls_conn_t tls;
+    http_client_t client;
+
+    TEST_ASSERT_TRUE(tls_conn_init(&tls, "localhost", s_ca, 0));
+    http_client_init(&client, "127.0.0.1", s_port, "localhost");
+    http_client_use_tls(&client, &tls);
+
+    /* The first handshake is a full one, then the connection is kept */
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast"));
+    TEST_ASSERT_EQUAL(780, s_temp_now);
+    TEST_ASSERT_FALSE(client.timing.tls_resumed);
+    TEST_ASSERT_NOT_EQUAL(0, client.timing.tls_us);
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast"));
+    TEST_ASSERT_TRUE(client.timing.reused);
+    TEST_ASSERT_EQUAL(0, client.timing.tls_us);
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-close"));
+    TEST_ASSERT_EQUAL(-1, client.sock);
+
+    /* Every new connection after it resumes */
+    for (int i = 0; i < RESUMES; i++) {
+        TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-close"));
+        TEST_ASSERT_TRUE(client.timing.tls_resumed);
+    }
+
+    /* An idle connection the server dropped is retried, resumed */
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-drop"));
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast"));
+    TEST_ASSERT_TRUE(client.timing.tls_resumed);
+    TEST_ASSERT_EQUAL(RESUMES + 3, client.stats.connects);
+
+    /* Without the session it's a full handshake again */
+    http_client_close(&client);
+    tls_conn_forget_session(&tls);
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast-close"));
+    TEST_ASSERT_FALSE(client.timing.tls_resumed);
+
+    TEST_ASSERT_EQUAL(2, tls.stats.full);
+    TEST_ASSERT_EQUAL(RESUMES + 2, tls.stats.resumed);
+    TEST_ASSERT_EQUAL(0, tls.stats.failed);
+    TEST_ASSERT_EQUAL(s_full.count, tls.stats.full);
+    TEST_ASSERT_EQUAL(s_resumed.count, tls.stats.resumed);
+    TEST_ASSERT_TRUE(s_resumed.total_us / s_resumed.count < s_full.total_us / s_full.count);
+
+    printf("HTTPS full=%" PRIu32 " avg=%" PRIu64 "us max=%" PRIu32 "us resumed=%" PRIu32 " avg=%" PRIu64 "us max=%" PRIu32
+           "us heap_peak=%" PRIu32 "\n",
+           s_full.count, s_full.total_us / s_full.count, tls.stats.full_us_max, s_resumed.count,
+           s_resumed.total_us / s_resumed.count, tls.stats.resumed_us_max, tls.stats.heap_peak);
+
+    TEST_ASSERT_NOT_EQUAL(0, tls.stats.heap_peak);
+
+    /* A tight budget asks for small records if the buffers shrink with them,
+     * is refused up front if not, and one too tight is refused either way */
+    static tls_conn_t small;
+    TEST_ASSERT_FALSE(tls_conn_init(&small, "localhost", s_ca, 1024));
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH) || CONFIG_MBEDTLS_DYNAMIC_BUFFER
+    TEST_ASSERT_TRUE(tls_conn_init(&small, "localhost", s_ca, 27 * 1024));
+    TEST_ASSERT_EQUAL(1024, small.frag_len);
+#else
+    TEST_ASSERT_FALSE(tls_conn_init(&small, "localhost", s_ca, 27 * 1024));
+    TEST_ASSERT_TRUE(tls_conn_init(&small, "localhost", s_ca, 64 * 1024));
+    TEST_ASSERT_EQUAL(0, small.frag_len);
+#endif
+    http_client_close(&client);
+    http_client_use_tls(&client, &small);
+    TEST_ASSERT_EQUAL(200, fetch(&client, "/forecast"));
+    TEST_ASSERT_EQUAL(780, s_temp_now);
+    if (small.frag_len) {
+        TEST_ASSERT_EQUAL(small.frag_len, mbedtls_ssl_get_input_max_frag_len(&small.ssl));     // the server agreed
+    }
+    TEST_ASSERT_EQUAL(0, small.stats.frag_ignored);
+    TEST_ASSERT_EQUAL(0, small.stats.failed);
+    http_client_close(&client);
+}
+
+/* The certificate has to be for the name asked for */
+static void test_wrong_name(void) {
+    static tls_conn_t tls;
+    http_client_t client;
+
+    TEST_ASSERT_TRUE(tls_conn_init(&tls, "api.openweathermap.org", s_ca, 0));
+    http_client_init(&client, "127.0.0.1", s_port, "localhost");
+    http_client_use_tls(&client, &tls);
+    TEST_ASSERT_EQUAL(-1, fetch(&client, "/forecast"));
+    TEST_ASSERT_EQUAL(1, tls.stats.failed);
+    TEST_ASSERT_EQUAL(0, tls.stats.full);
+}
+
+/* Closed in the handshake, e.g. after the reactor failed: the context is freed, once */
+static void test_close_mid_handshake(void) {
+    static tls_conn_t tls;
+    int sv[2];
+
+    TEST_ASSERT_TRUE(tls_conn_init(&tls, "localhost", s_ca, 0));
+    TEST_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    fcntl(sv[0], F_SETFL, O_NONBLOCK);
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_TRUE(tls_conn_handshake_begin(&tls, sv[0]));
+        TEST_ASSERT_TRUE(tls.setup);
+        TEST_ASSERT_EQUAL(TLS_CONN_WANT_READ, tls_conn_handshake_step(&tls));
+        tls_conn_close(&tls);
+        TEST_ASSERT_FALSE(tls.setup);
+        tls_conn_close(&tls);
+        TEST_ASSERT_EQUAL(i + 1, tls.stats.failed);
+    }
+    close(sv[0]);
+    close(sv[1]);
+}
+
+void app_main(void)
+{
+    s_port = getenv("STANDIN_PORT");
+    const char *ca_path = getenv("STANDIN_CA");
+
+    UNITY_BEGIN();
+    if (s_port && ca_path) {
+        FILE *f = fopen(ca_path, "r");
+        TEST_ASSERT_NOT_NULL(f);
+        s_ca[fread(s_ca, 1, sizeof(s_ca) - 1, f)] = '\0';
+        fclose(f);
+        RUN_TEST(test_resumption);
+        RUN_TEST(test_wrong_name);
+        RUN_TEST(test_close_mid_handshake);
+    }
+    exit(UNITY_END());
+}
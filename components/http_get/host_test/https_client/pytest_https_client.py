@@ -0,0 +1,84 @@
+#!/usr/bin/env python
+#
+# Runs the https_client host test against a local TLS stand-in for the
+# OpenWeatherMap server, which counts full and resumed handshakes.
+#
+#   idf.py --preview set-target linux && idf.py build
+#   pytest pytest_https_client.py
+
+import os
+import ssl
+import subprocess
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+BODY = b'{"cod":"200","cnt":1,"list":[{"dt":1734609600,"main":{"temp":7.8,"temp_min":-2.1,"temp_max":9.0}}]}'
+RESUMES = 10
+
+
+class StandInHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def setup(self) -> None:
+        super().setup()
+        with self.server.lock:
+            if self.connection.session_reused:
+                self.server.resumed += 1
+            else:
+                self.server.full += 1
+
+    def log_message(self, *args) -> None:  # keep pytest output readable
+        pass
+
+    def do_GET(self) -> None:
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(BODY)))
+        if self.path == '/forecast-close':
+            self.send_header('Connection', 'close')
+        self.end_headers()
+        self.wfile.write(BODY)
+        if self.path in ('/forecast-close', '/forecast-drop'):
+            # '/forecast-drop' hangs up as if an idle timeout fired, without warning the client
+            self.close_connection = True
+
+
+def make_cert(tmp_path) -> tuple:
+    cert = str(tmp_path / 'cert.pem')
+    key = str(tmp_path / 'key.pem')
+    subprocess.run(['openssl', 'req', '-x509', '-newkey', 'ec', '-pkeyopt', 'ec_paramgen_curve:prime256v1',
+                    '-nodes', '-keyout', key, '-out', cert, '-days', '1', '-subj', '/CN=localhost',
+                    '-addext', 'subjectAltName=DNS:localhost'], check=True, capture_output=True)
+    return cert, key
+
+
+def start_standin(cert: str, key: str) -> ThreadingHTTPServer:
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    ctx.maximum_version = ssl.TLSVersion.TLSv1_2      # what the client resumes
+    ctx.load_cert_chain(cert, key)
+    server = ThreadingHTTPServer(('127.0.0.1', 0), StandInHandler)
+    server.socket = ctx.wrap_socket(server.socket, server_side=True)
+    server.lock = threading.Lock()
+    server.full = 0
+    server.resumed = 0
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server
+
+
+def test_https_resumption(tmp_path) -> None:
+    cert, key = make_cert(tmp_path)
+    server = start_standin(cert, key)
+    elf = os.path.join(os.path.dirname(__file__), 'build', 'https_client_host_test.elf')
+    env = dict(os.environ, STANDIN_PORT=str(server.server_address[1]), STANDIN_CA=cert)
+    try:
+        result = subprocess.run([elf], env=env, capture_output=True, text=True, timeout=60)
+    finally:
+        server.shutdown()
+    print(result.stdout)
+    assert result.returncode == 0
+    assert 'HTTPS full=' in result.stdout
+    # The server saw the same: three full handshakes (the last on a heap
+    # budget, with no session yet), the wrong-name one never completed, every
+    # other connection resumed
+    assert server.full == 3
+    assert server.resumed == RESUMES + 2
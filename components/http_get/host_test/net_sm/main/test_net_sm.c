@@ -0,0 +1,489 @@
+/**
+ * @file test_net_sm.c
+ * @author The Authors
+ * @brief Host test for the network state machine, faults injected on a virtual clock
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * A stand-in Wi-Fi driver answers esp_wifi_connect() & esp_wifi_disconnect()
+ * with the events the real one posts, after realistic delays, unless told to
+ * misbehave: connect attempts it never answers, associations DHCP never
+ * completes, an AP that is gone for a while, a link that dies silently
+ * before the driver notices.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "net_sm.h"
+#include "fetch_sched.h"
+
+#define ASSOC_MS        200     // connect to STA_CONNECTED
+#define DHCP_MS         500     // STA_CONNECTED to GOT_IP
+#define NO_AP_MS        3000    // a scan that finds nothing, to STA_DISCONNECTED
+#define BEACON_LOSS_MS  8000    // a silent AP, to STA_DISCONNECTED
+#define PENDING_MAX     4
+#define NEVER           INT64_MAX
+
+static const net_sm_config_t s_cfg = {
+    .connect_timeout_ms = 15000,
+    .backoff_base_ms = 1000,
+    .backoff_max_ms = 60000,
+};
+
+typedef struct {
+    int64_t at;
+    net_sm_event_t ev;
+} pending_t;
+
+typedef struct {
+    /* Faults, the next ones of each are used up in turn */
+    uint32_t drop_connects;         // attempts never answered
+    uint32_t stall_dhcp;            // associations that get no address
+    int64_t ap_gone_until;          // attempts before then find no AP
+    /* What the driver has done */
+    pending_t pending[PENDING_MAX];
+    int n_pending;
+    uint32_t connects;
+    uint32_t disconnects;
+    int64_t connect_at[16];         // the first few
+    bool ip;                        // has an address, as far as the driver has said
+    bool silent;                    // the AP has gone but the driver hasn't noticed yet
+} radio_t;
+
+static void post(radio_t *r, int64_t at, net_sm_event_t ev) {
+    TEST_ASSERT_LESS_THAN(PENDING_MAX, r->n_pending);
+    r->pending[r->n_pending++] = (pending_t){ at, ev };
+}
+
+static int64_t next_event_at(const radio_t *r) {
+    int64_t at = NEVER;
+    for (int i = 0; i < r->n_pending; i++) {
+        if (r->pending[i].at < at) {
+            at = r->pending[i].at;
+        }
+    }
+    return at;
+}
+
+/* Earliest one, in the order posted for a tie */
+static net_sm_event_t take_event(radio_t *r) {
+    int first = 0;
+    for (int i = 1; i < r->n_pending; i++) {
+        if (r->pending[i].at < r->pending[first].at) {
+            first = i;
+        }
+    }
+    net_sm_event_t ev = r->pending[first].ev;
+    memmove(&r->pending[first], &r->pending[first + 1], (r->n_pending - first - 1) * sizeof(pending_t));
+    r->n_pending--;
+    if (ev == NET_SM_EV_GOT_IP) {
+        r->ip = true;
+    } else if (ev == NET_SM_EV_WIFI_DISCONNECTED || ev == NET_SM_EV_LOST_IP) {
+        r->ip = false;
+        r->silent = false;
+    }
+    return ev;
+}
+
+static void radio_connect(radio_t *r, int64_t now) {
+    if (r->connects < sizeof(r->connect_at) / sizeof(r->connect_at[0])) {
+        r->connect_at[r->connects] = now;
+    }
+    r->connects++;
+    if (r->drop_connects) {
+        r->drop_connects--;
+    } else if (now < r->ap_gone_until) {
+        post(r, now + NO_AP_MS, NET_SM_EV_WIFI_DISCONNECTED);
+    } else {
+        post(r, now + ASSOC_MS, NET_SM_EV_WIFI_CONNECTED);
+        if (r->stall_dhcp) {
+            r->stall_dhcp--;
+        } else {
+            post(r, now + ASSOC_MS + DHCP_MS, NET_SM_EV_GOT_IP);
+        }
+    }
+}
+
+static void radio_disconnect(radio_t *r, int64_t now) {
+    r->disconnects++;
+    r->n_pending = 0;
+    post(r, now + 10, NET_SM_EV_WIFI_DISCONNECTED);
+}
+
+/* The AP goes, for gone_ms; the driver notices after notice_ms */
+static void radio_lose_ap(radio_t *r, int64_t now, int64_t gone_ms, int64_t notice_ms) {
+    r->n_pending = 0;
+    r->ap_gone_until = now + gone_ms;
+    r->silent = notice_ms > 0;
+    post(r, now + notice_ms, NET_SM_EV_WIFI_DISCONNECTED);
+}
+
+static void act(radio_t *r, net_sm_action_t action, int64_t now) {
+    if (action == NET_SM_ACT_CONNECT) {
+        radio_connect(r, now);
+    } else if (action == NET_SM_ACT_DISCONNECT) {
+        radio_disconnect(r, now);
+    }
+}
+
+/**
+ * @brief Run the network side alone, as http_get_task does, till until or
+ *        up with nothing more to come (if stop_up). Returns the time it stopped.
+ */
+static int64_t run(net_sm_t *sm, radio_t *r, int64_t now, int64_t until, bool stop_up) {
+    for (int steps = 0; now < until && !(stop_up && net_sm_up(sm) && r->n_pending == 0); steps++) {
+        TEST_ASSERT_LESS_THAN_MESSAGE(10000, steps, "spinning");
+        int64_t delay = net_sm_delay_ms(sm, now);
+        int64_t tick_at = delay < 0 ? NEVER : now + delay;
+        int64_t ev_at = next_event_at(r);
+        if (tick_at >= until && ev_at >= until) {
+            return until;
+        }
+        if (ev_at <= tick_at) {
+            now = ev_at > now ? ev_at : now;
+            act(r, net_sm_event(sm, take_event(r), now), now);
+        } else {
+            now = tick_at;
+            act(r, net_sm_event(sm, NET_SM_EV_TICK, now), now);
+        }
+    }
+    return now;
+}
+
+static uint32_t hist_total(const net_sm_t *sm) {
+    uint32_t total = 0;
+    for (int i = 0; i < NET_SM_HIST_BUCKETS; i++) {
+        total += sm->stats.reconnect_hist[i];
+    }
+    return total;
+}
+
+static void test_drop_reconnects_straight_away(void) {
+    net_sm_t sm;
+    radio_t r = { .ip = true };
+
+    net_sm_init(&sm, &s_cfg, 0, true);
+    TEST_ASSERT_TRUE(net_sm_up(&sm));
+    TEST_ASSERT_EQUAL_INT64(-1, net_sm_delay_ms(&sm, 0));
+
+    radio_lose_ap(&r, 10000, 0, 0);
+    int64_t now = run(&sm, &r, 10000, 60000, true);
+    TEST_ASSERT_TRUE(net_sm_up(&sm));
+    TEST_ASSERT_EQUAL_INT64(10000 + ASSOC_MS + DHCP_MS, now);
+    TEST_ASSERT_EQUAL_INT64(10000, r.connect_at[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.connect_attempts);
+    TEST_ASSERT_EQUAL_UINT32(0, sm.stats.connect_failures);
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.drops);
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.reconnects);
+    TEST_ASSERT_EQUAL_UINT32(ASSOC_MS + DHCP_MS, sm.stats.reconnect_ms_max);
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.reconnect_hist[2]);    // 500 to 1000 ms
+
+    /* Events that change nothing once up */
+    TEST_ASSERT_EQUAL(NET_SM_ACT_NONE, net_sm_event(&sm, NET_SM_EV_GOT_IP, now + 1));
+    TEST_ASSERT_EQUAL(NET_SM_ACT_NONE, net_sm_event(&sm, NET_SM_EV_WIFI_CONNECTED, now + 2));
+    TEST_ASSERT_EQUAL(NET_SM_ACT_NONE, net_sm_event(&sm, NET_SM_EV_TICK, now + 100000));
+    TEST_ASSERT_TRUE(net_sm_up(&sm));
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.reconnects);
+}
+
+/* Attempts nobody answers: each times out, the second failure on backs off */
+static void test_dropped_connects_time_out_and_back_off(void) {
+    net_sm_t sm;
+    radio_t r = { .ip = true, .drop_connects = 4 };
+    const int64_t T = s_cfg.connect_timeout_ms;
+
+    net_sm_init(&sm, &s_cfg, 0, true);
+    radio_lose_ap(&r, 0, 0, 0);
+    int64_t now = run(&sm, &r, 0, 10 * 60000, true);
+
+    TEST_ASSERT_TRUE(net_sm_up(&sm));
+    TEST_ASSERT_EQUAL_UINT32(5, r.connects);
+    TEST_ASSERT_EQUAL_INT64(0, r.connect_at[0]);
+    TEST_ASSERT_EQUAL_INT64(T, r.connect_at[1]);                // first retry straight away
+    TEST_ASSERT_EQUAL_INT64(2 * T + 1000, r.connect_at[2]);
+    TEST_ASSERT_EQUAL_INT64(3 * T + 3000, r.connect_at[3]);
+    TEST_ASSERT_EQUAL_INT64(4 * T + 7000, r.connect_at[4]);
+    TEST_ASSERT_EQUAL_INT64(4 * T + 7000 + ASSOC_MS + DHCP_MS, now);
+    TEST_ASSERT_EQUAL_UINT32(4, sm.stats.connect_timeouts);
+    TEST_ASSERT_EQUAL_UINT32(4, sm.stats.connect_failures);
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.reconnects);
+    TEST_ASSERT_EQUAL_UINT32(now, sm.stats.reconnect_ms_max);
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.reconnect_hist[9]);    // 64 to 128 s
+}
+
+/* Associated but DHCP never answers: drop the association, then start over */
+static void test_dhcp_stall_disassociates(void) {
+    net_sm_t sm;
+    radio_t r = { .ip = true, .stall_dhcp = 1 };
+    const int64_t T = s_cfg.connect_timeout_ms;
+
+    net_sm_init(&sm, &s_cfg, 0, true);
+    radio_lose_ap(&r, 0, 0, 0);
+    run(&sm, &r, 0, ASSOC_MS + T - 1, false);
+    TEST_ASSERT_EQUAL(NET_SM_ASSOCIATED, sm.state);
+    TEST_ASSERT_EQUAL_UINT32(0, r.disconnects);
+
+    int64_t now = run(&sm, &r, ASSOC_MS + T - 1, 10 * 60000, true);
+    TEST_ASSERT_EQUAL_UINT32(1, r.disconnects);
+    TEST_ASSERT_EQUAL_UINT32(2, r.connects);
+    /* Not before the driver said the old association was gone */
+    TEST_ASSERT_EQUAL_INT64(ASSOC_MS + T + 10, r.connect_at[1]);
+    TEST_ASSERT_EQUAL_INT64(ASSOC_MS + T + 10 + ASSOC_MS + DHCP_MS, now);
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.connect_timeouts);
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.connect_failures);
+
+    /* A driver that never reports the disconnect doesn't wedge it either */
+    radio_t mute = { .ip = true, .stall_dhcp = 1 };
+    net_sm_init(&sm, &s_cfg, 0, true);
+    radio_lose_ap(&mute, 0, 0, 0);
+    now = run(&sm, &mute, 0, ASSOC_MS + T + 1, false);
+    TEST_ASSERT_EQUAL(NET_SM_DISCONNECTING, sm.state);
+    mute.n_pending = 0;
+    now = run(&sm, &mute, now, 10 * 60000, true);
+    TEST_ASSERT_TRUE(net_sm_up(&sm));
+    TEST_ASSERT_EQUAL_INT64(ASSOC_MS + 2 * T, mute.connect_at[1]);
+}
+
+/* An hour without the AP: attempts thin out to one a backoff_max_ms, and it's back soon after the AP */
+static void test_long_outage(void) {
+    net_sm_t sm;
+    radio_t r = { .ip = true };
+    const int64_t gone = 3600 * 1000LL;
+
+    net_sm_init(&sm, &s_cfg, 0, true);
+    radio_lose_ap(&r, 0, gone, 0);
+    int64_t now = run(&sm, &r, 0, 2 * gone, true);
+
+    TEST_ASSERT_TRUE(net_sm_up(&sm));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(gone / s_cfg.backoff_max_ms + 12, r.connects);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(gone / (s_cfg.backoff_max_ms + NO_AP_MS), r.connects);
+    TEST_ASSERT_GREATER_THAN_INT64(gone, now);
+    TEST_ASSERT_LESS_OR_EQUAL_INT64(gone + s_cfg.backoff_max_ms + NO_AP_MS + ASSOC_MS + DHCP_MS, now);
+    TEST_ASSERT_EQUAL_UINT32(r.connects - 1, sm.stats.connect_failures);
+    TEST_ASSERT_EQUAL_UINT32(0, sm.stats.connect_timeouts);
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.reconnect_hist[NET_SM_HIST_BUCKETS - 1]);
+    printf("1 h outage: %u attempts, up %lld ms after the AP\n", (unsigned)r.connects, (long long)(now - gone));
+}
+
+static void test_lost_ip_and_boot_down(void) {
+    net_sm_t sm;
+
+    net_sm_init(&sm, &s_cfg, 0, true);
+    TEST_ASSERT_EQUAL(NET_SM_ACT_NONE, net_sm_event(&sm, NET_SM_EV_LOST_IP, 1000));
+    TEST_ASSERT_EQUAL(NET_SM_ASSOCIATED, sm.state);
+    TEST_ASSERT_FALSE(net_sm_up(&sm));
+    TEST_ASSERT_EQUAL_INT64(s_cfg.connect_timeout_ms - 500, net_sm_delay_ms(&sm, 1500));
+    TEST_ASSERT_EQUAL(NET_SM_ACT_NONE, net_sm_event(&sm, NET_SM_EV_GOT_IP, 3000));
+    TEST_ASSERT_TRUE(net_sm_up(&sm));
+    TEST_ASSERT_EQUAL_UINT32(1, sm.stats.drops);
+    TEST_ASSERT_EQUAL_UINT32(2000, sm.stats.reconnect_ms_max);
+    TEST_ASSERT_EQUAL_UINT32(0, sm.stats.connect_attempts);
+
+    /* Not up at the start: attempts straight away, and coming up isn't a reconnect */
+    radio_t r = { 0 };
+    net_sm_init(&sm, &s_cfg, 0, false);
+    TEST_ASSERT_EQUAL_INT64(0, net_sm_delay_ms(&sm, 0));
+    run(&sm, &r, 0, 60000, true);
+    TEST_ASSERT_TRUE(net_sm_up(&sm));
+    TEST_ASSERT_EQUAL_UINT32(1, r.connects);
+    TEST_ASSERT_EQUAL_UINT32(0, sm.stats.reconnects);
+    TEST_ASSERT_EQUAL_UINT32(0, hist_total(&sm));
+}
+
+static void test_success_rate_and_report(void) {
+    net_sm_t sm;
+    char buf[256];
+
+    net_sm_init(&sm, &s_cfg, 0, true);
+    TEST_ASSERT_EQUAL_UINT32(100, net_sm_success_pct(&sm));
+    net_sm_fetch_done(&sm, false);
+    TEST_ASSERT_EQUAL_UINT32(0, net_sm_success_pct(&sm));
+    net_sm_fetch_done(&sm, true);
+    TEST_ASSERT_EQUAL_UINT32(50, net_sm_success_pct(&sm));
+    /* Only the last NET_SM_RECENT_FETCHES count */
+    for (int i = 0; i < NET_SM_RECENT_FETCHES - 8; i++) {
+        net_sm_fetch_done(&sm, true);
+    }
+    for (int i = 0; i < 8; i++) {
+        net_sm_fetch_done(&sm, false);
+    }
+    TEST_ASSERT_EQUAL_UINT32(75, net_sm_success_pct(&sm));
+    TEST_ASSERT_EQUAL_UINT32(NET_SM_RECENT_FETCHES - 7, sm.stats.fetch_ok);
+    TEST_ASSERT_EQUAL_UINT32(9, sm.stats.fetch_failed);
+
+    TEST_ASSERT_EQUAL_UINT32(250, net_sm_hist_limit_ms(0));
+    TEST_ASSERT_EQUAL_UINT32(500, net_sm_hist_limit_ms(1));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, net_sm_hist_limit_ms(NET_SM_HIST_BUCKETS - 1));
+
+    size_t full = net_sm_report(&sm, buf, sizeof(buf));
+    printf("%s\n", buf);
+    TEST_ASSERT_EQUAL_size_t(strlen(buf), full);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "up attempts=0"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "hist=0/0/0/0/0/0/0/0/0/0/0/0 "));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "recent=75%"));
+    /* Cut short anywhere, still a string in the buffer */
+    for (size_t len = 1; len <= full + 1; len++) {
+        char small[256];
+        memset(small, 'x', sizeof(small));
+        size_t n = net_sm_report(&sm, small, len);
+        TEST_ASSERT_LESS_THAN_size_t(len, n);
+        TEST_ASSERT_EQUAL_size_t(n, strlen(small));
+        TEST_ASSERT_EQUAL_CHAR('x', small[len]);
+    }
+}
+
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* Runs the fetch loop of http_get_task, with a fault every 20 to 80 minutes */
+static void test_day_of_faults(void) {
+    static const fetch_sched_config_t sched_cfg = {
+        .min_interval_s = 300,
+        .max_interval_s = 600,
+        .default_interval_s = 600,
+        .slot_settle_s = 120,
+        .backoff_base_s = 4,
+        .backoff_max_s = 900,
+        .daily_quota = 1000,
+    };
+    const int64_t day = 24 * 3600 * 1000LL;
+    net_sm_t sm;
+    fetch_sched_t sched;
+    radio_t r = { .ip = true };
+    uint32_t rng = 12345;
+    int64_t now = 0;
+    int64_t fault_at = 20 * 60000;
+    int64_t down_at = -1;
+    int64_t worst_outage = 0;
+    int64_t worst_fetch_lag = 0;        // from coming back up to the deferred fetch
+    int64_t up_at = -1;
+    bool deferred = false;
+    uint32_t faults[5] = { 0 };
+    uint32_t fetches = 0;
+    uint32_t failed = 0;
+
+    net_sm_init(&sm, &s_cfg, now, true);
+    fetch_sched_init(&sched, &sched_cfg, now, 1);
+    for (int steps = 0; now < day; steps++) {
+        TEST_ASSERT_LESS_THAN_MESSAGE(20000, steps, "spinning");
+        int64_t delay = fetch_sched_delay_ms(&sched, now);
+        if (!net_sm_up(&sm)) {
+            if (delay == 0 && !deferred) {
+                deferred = true;
+                net_sm_fetch_deferred(&sm);
+            }
+            delay = net_sm_delay_ms(&sm, now);
+        }
+        if (delay != 0) {
+            int64_t wake = delay < 0 ? NEVER : now + delay;
+            int64_t ev_at = next_event_at(&r);
+            bool was_up = net_sm_up(&sm);
+            if (fault_at < wake && fault_at < ev_at) {
+                now = fault_at;
+                uint32_t kind = xorshift32(&rng) % 5;
+                faults[kind]++;
+                switch (kind) {
+                case 0:     // a blip, the AP is straight back
+                    radio_lose_ap(&r, now, 0, 0);
+                    break;
+                case 1:     // gone for up to 10 minutes, unnoticed for a while
+                    radio_lose_ap(&r, now, xorshift32(&rng) % 600000, BEACON_LOSS_MS);
+                    break;
+                case 2:     // the first attempts after the drop go unanswered
+                    r.drop_connects = 2;
+                    radio_lose_ap(&r, now, 0, 0);
+                    break;
+                case 3:     // DHCP stalls once
+                    r.stall_dhcp = 1;
+                    radio_lose_ap(&r, now, 0, 0);
+                    break;
+                default:    // the lease lapses, renewed a moment later
+                    post(&r, now, NET_SM_EV_LOST_IP);
+                    post(&r, now + 2000, NET_SM_EV_GOT_IP);
+                    break;
+                }
+                fault_at = now + 20 * 60000 + xorshift32(&rng) % (60 * 60000);
+                if (fault_at > day - 3600 * 1000LL) {
+                    fault_at = NEVER;       // the last one recovered from by the end
+                }
+                continue;
+            }
+            if (ev_at <= wake) {
+                now = ev_at > now ? ev_at : now;
+                act(&r, net_sm_event(&sm, take_event(&r), now), now);
+            } else {
+                now = wake;
+            }
+            if (was_up && !net_sm_up(&sm)) {
+                down_at = now;
+            } else if (!was_up && net_sm_up(&sm)) {
+                up_at = now;
+                if (now - down_at > worst_outage) {
+                    worst_outage = now - down_at;
+                }
+            }
+            continue;
+        }
+        if (!net_sm_up(&sm)) {
+            act(&r, net_sm_event(&sm, NET_SM_EV_TICK, now), now);
+            continue;
+        }
+
+        /* Up as far as the driver has said: a fetch only fails on a link that died silently */
+        TEST_ASSERT_TRUE(r.ip || r.silent);
+        if (deferred && now - up_at > worst_fetch_lag) {
+            worst_fetch_lag = now - up_at;
+        }
+        deferred = false;
+        fetches++;
+        fetch_sched_on_fetch(&sched, now);
+        if (r.silent) {
+            failed++;
+            fetch_sched_on_failure(&sched, now);
+            net_sm_fetch_done(&sm, false);
+        } else {
+            fetch_sched_on_success(&sched, now, -1, 0, -1, false);
+            net_sm_fetch_done(&sm, true);
+        }
+    }
+
+    char buf[256];
+    net_sm_report(&sm, buf, sizeof(buf));
+    printf("%u fetches, %u failed, worst outage %lld ms: %s\n", (unsigned)fetches, (unsigned)failed,
+           (long long)worst_outage, buf);
+    TEST_ASSERT_GREATER_THAN_UINT32(12, faults[0] + faults[1] + faults[2] + faults[3] + faults[4]);
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_GREATER_THAN_UINT32(0, faults[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(faults[0] + faults[1] + faults[2] + faults[3] + faults[4], sm.stats.drops);
+    TEST_ASSERT_EQUAL_UINT32(sm.stats.drops, sm.stats.reconnects);
+    TEST_ASSERT_EQUAL_UINT32(sm.stats.reconnects, hist_total(&sm));
+    TEST_ASSERT_EQUAL_UINT32(2 * faults[2], sm.stats.connect_timeouts - faults[3]);
+    TEST_ASSERT_EQUAL_UINT32(fetches, sm.stats.fetch_ok + sm.stats.fetch_failed);
+    TEST_ASSERT_EQUAL_UINT32(failed, sm.stats.fetch_failed);
+    TEST_ASSERT_LESS_OR_EQUAL_INT64(600000 + BEACON_LOSS_MS + s_cfg.backoff_max_ms + NO_AP_MS + ASSOC_MS + DHCP_MS,
+                                    worst_outage);
+    TEST_ASSERT_EQUAL_INT64(0, worst_fetch_lag);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, sm.stats.fetch_deferred);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_drop_reconnects_straight_away);
+    RUN_TEST(test_dropped_connects_time_out_and_back_off);
+    RUN_TEST(test_dhcp_stall_disassociates);
+    RUN_TEST(test_long_outage);
+    RUN_TEST(test_lost_ip_and_boot_down);
+    RUN_TEST(test_success_rate_and_report);
+    RUN_TEST(test_day_of_faults);
+    exit(UNITY_END());
+}
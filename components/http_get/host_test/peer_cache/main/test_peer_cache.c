@@ -0,0 +1,245 @@
+/**
+ * @file test_peer_cache.c
+ * @author The Authors
+ * @brief Host test for sharing one upstream fetch between devices on a LAN
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The election and format tests run standalone. With PEER_ID set, by
+ * pytest_peer_cache.py, this is instead one device: it runs PEER_CYCLES
+ * fetch cycles against the stand-in upstream server on STANDIN_PORT, or
+ * against another instance when it hears one, and prints what it did.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "peer_cache.h"
+#include "peer_node.h"
+#include "forecast_parser.h"
+
+#define KEY         0x1234abcd
+#define INTERVAL_MS 10000
+
+static const peer_snapshot_t SNAP = {
+    .count = 2,
+    .dt = 1734609600,
+    .strips = { { true, -210, 780, 900 }, { false, 0, 0, 0 } },     // centi-degrees
+};
+
+/* The beacon of a device with this ID, whose snapshot was fetched at fetched_ms */
+static size_t beacon_of(uint32_t id, uint32_t key, int64_t fetched_ms, int64_t now_ms, uint8_t *out) {
+    peer_cache_t other;
+    peer_cache_init(&other, id, key, 600, INTERVAL_MS);
+    peer_cache_publish(&other, &SNAP, -1, fetched_ms);
+    return peer_cache_beacon(&other, 8081, now_ms, out);
+}
+
+static void hear(peer_cache_t *pc, uint32_t id, uint32_t key, int64_t fetched_ms, int64_t now_ms) {
+    uint8_t beacon[PEER_CACHE_BEACON_LEN];
+    size_t len = beacon_of(id, key, fetched_ms, now_ms, beacon);
+    peer_cache_heard(pc, beacon, len, 0x0100007f + id, now_ms);
+}
+
+static void test_beacons(void) {
+    peer_cache_t pc;
+    uint8_t beacon[PEER_CACHE_BEACON_LEN];
+
+    peer_cache_init(&pc, 5, KEY, 600, INTERVAL_MS);
+    TEST_ASSERT_EQUAL(PEER_CACHE_BEACON_LEN, peer_cache_beacon(&pc, 8081, 0, beacon));
+    TEST_ASSERT_EQUAL(0, beacon[5]);                    // not a source yet
+
+    /* Its own, another place's and a short one are ignored */
+    hear(&pc, 5, KEY, 0, 0);
+    hear(&pc, 6, KEY + 1, 0, 0);
+    TEST_ASSERT_EQUAL(PEER_CACHE_BEACON_LEN, beacon_of(7, KEY, 0, 0, beacon));
+    peer_cache_heard(&pc, beacon, PEER_CACHE_BEACON_LEN - 1, 1, 0);
+    TEST_ASSERT_EQUAL(0, pc.peer_count);
+
+    peer_cache_heard(&pc, beacon, PEER_CACHE_BEACON_LEN, 0x0200007f, 1000);
+    peer_cache_heard(&pc, beacon, PEER_CACHE_BEACON_LEN, 0x0300007f, 2000);     // moved
+    TEST_ASSERT_EQUAL(1, pc.peer_count);
+    TEST_ASSERT_EQUAL(7, pc.peers[0].id);
+    TEST_ASSERT_EQUAL_HEX32(0x0300007f, pc.peers[0].addr);
+    TEST_ASSERT_EQUAL(8081, pc.peers[0].port);
+
+    /* A reader's beacon asks the sources to answer, and it's no source any more */
+    peer_cache_t reader;
+    peer_cache_init(&reader, 7, KEY, 600, INTERVAL_MS);
+    TEST_ASSERT_EQUAL(PEER_CACHE_BEACON_LEN, peer_cache_beacon(&reader, 8081, 0, beacon));
+    TEST_ASSERT_FALSE(peer_cache_heard(&pc, beacon, PEER_CACHE_BEACON_LEN, 0x0300007f, 2000));
+    TEST_ASSERT_EQUAL(0, pc.peer_count);
+    peer_cache_publish(&pc, &SNAP, -1, 2000);
+    TEST_ASSERT_TRUE(peer_cache_heard(&pc, beacon, PEER_CACHE_BEACON_LEN, 0x0300007f, 2000));
+
+    /* A full table drops the one heard from longest ago */
+    hear(&pc, 7, KEY, 0, 2000);
+    for (uint32_t id = 10; id < 10 + PEER_CACHE_PEERS_MAX; id++) {
+        hear(&pc, id, KEY, 0, 3000 + id);
+    }
+    TEST_ASSERT_EQUAL(PEER_CACHE_PEERS_MAX, pc.peer_count);
+    for (size_t i = 0; i < pc.peer_count; i++) {
+        TEST_ASSERT_NOT_EQUAL(7, pc.peers[i].id);
+    }
+}
+
+static void test_election(void) {
+    peer_cache_t pc;
+
+    peer_cache_init(&pc, 5, KEY, 600, INTERVAL_MS);
+    TEST_ASSERT_NULL(peer_cache_pick(&pc, 0));          // alone: upstream
+
+    /* The lowest ID of the fresh sources */
+    hear(&pc, 9, KEY, 0, 0);
+    hear(&pc, 7, KEY, 0, 0);
+    TEST_ASSERT_EQUAL(7, peer_cache_pick(&pc, 1000)->id);
+
+    /* A source with a lower ID keeps fetching upstream... */
+    peer_cache_publish(&pc, &SNAP, -1, 1000);
+    TEST_ASSERT_NULL(peer_cache_pick(&pc, 1000));
+    TEST_ASSERT_TRUE(pc.source);
+
+    /* ... one with a higher ID gives way */
+    hear(&pc, 3, KEY, 0, 1000);
+    TEST_ASSERT_EQUAL(3, peer_cache_pick(&pc, 1000)->id);
+    TEST_ASSERT_FALSE(pc.source);
+    TEST_ASSERT_EQUAL(1, pc.stats.deferred);
+
+    /* Failed: skipped until heard from again */
+    peer_cache_forget(&pc, 3);
+    TEST_ASSERT_EQUAL(7, peer_cache_pick(&pc, 1000)->id);
+
+    /* Gone quiet, or its snapshot stale: upstream */
+    TEST_ASSERT_NULL(peer_cache_pick(&pc, 1 + 3 * INTERVAL_MS));
+    hear(&pc, 7, KEY, 0, 599 * 1000);
+    TEST_ASSERT_EQUAL(7, peer_cache_pick(&pc, 600 * 1000)->id);
+    TEST_ASSERT_NULL(peer_cache_pick(&pc, 601 * 1000));
+}
+
+static void test_respond(void) {
+    static const char REQUEST[] = "GET " PEER_CACHE_PATH " HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    peer_cache_t pc;
+    char out[PEER_CACHE_RESPONSE_MAX];
+    char request[256];
+    peer_snapshot_t snap;
+    uint32_t age;
+
+    peer_cache_init(&pc, 0xab, KEY, 600, INTERVAL_MS);
+    size_t n = peer_cache_respond(&pc, REQUEST, strlen(REQUEST), 0, out);
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 503 ", out, 13);
+    n = peer_cache_respond(&pc, "GET / HTTP/1.1\r\n\r\n", 18, 0, out);
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 404 ", out, 13);
+
+    /* Date: upstream's at the fetch (Thu, 19 Dec 2024 10:31:02 GMT), 10 s on, less the lag */
+    peer_cache_publish(&pc, &SNAP, 1734604262, 5000);
+    n = peer_cache_respond(&pc, REQUEST, strlen(REQUEST), 15000, out);
+    out[n] = '\0';
+    TEST_ASSERT_NOT_NULL(strstr(out, "HTTP/1.1 200 OK\r\n"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "ETag: \"000000ab-1\"\r\n"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "Date: Thu, 19 Dec 2024 10:30:42 GMT\r\n"));
+    const char *body = strstr(out, "\r\n\r\n") + 4;
+    size_t body_len = n - (body - out);
+    TEST_ASSERT_EQUAL(20 + 6 * 2, body_len);
+    TEST_ASSERT_TRUE(peer_cache_decode((const uint8_t *)body, body_len, &snap, &age));
+    TEST_ASSERT_EQUAL(10, age);
+    TEST_ASSERT_EQUAL(2, snap.count);
+    TEST_ASSERT_EQUAL_INT64(1734609600, snap.dt);
+    TEST_ASSERT_TRUE(snap.strips[0].valid);
+    TEST_ASSERT_FALSE(snap.strips[1].valid);
+    TEST_ASSERT_EQUAL(-210, snap.strips[0].temp_min);
+    TEST_ASSERT_EQUAL(780, snap.strips[0].temp_now);
+    TEST_ASSERT_EQUAL(900, snap.strips[0].temp_max);
+    TEST_ASSERT_FALSE(peer_cache_decode((const uint8_t *)body, body_len - 1, &snap, &age));
+
+    /* Unchanged since: 304, a new upstream fetch: 200 again */
+    snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: x\r\nIf-None-Match: \"000000ab-1\"\r\n\r\n", PEER_CACHE_PATH);
+    peer_cache_respond(&pc, request, strlen(request), 15000, out);
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 304 ", out, 13);
+    peer_cache_publish(&pc, &SNAP, -1, 20000);
+    n = peer_cache_respond(&pc, request, strlen(request), 20000, out);
+    out[n] = '\0';
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 200 ", out, 13);
+    TEST_ASSERT_NULL(strstr(out, "Date:"));
+    TEST_ASSERT_EQUAL(2, pc.stats.served);
+    TEST_ASSERT_EQUAL(1, pc.stats.not_modified);
+}
+
+/* One device of the pytest: a fetch cycle every PEER_CYCLE_MS */
+static void parser_cb(void *ctx, const char *buf, size_t len) {
+    forecast_parser_feed(ctx, buf, len);
+}
+
+static void test_device(void) {
+    const peer_node_config_t cfg = {
+        .id = strtoul(getenv("PEER_ID"), NULL, 0),
+        .upstream_request = "/forecast",
+        .stale_s = 60,
+        .beacon_port = strtoul(getenv("PEER_BEACON_PORT"), NULL, 10),
+        .http_port = 0,
+        .beacon_addr = "127.255.255.255",
+        .beacon_interval_ms = 100,
+    };
+    int cycles = atoi(getenv("PEER_CYCLES"));
+    int cycle_ms = atoi(getenv("PEER_CYCLE_MS"));
+    static reactor_t reactor;
+    static char rx[3][512];
+    http_client_t upstream;
+    forecast_parser_t parser;
+    peer_snapshot_t snap;
+    int upstream_fetches = 0;
+    int peer_reads = 0;
+
+    /* The device's one task: the fetches and the peer's sockets on one reactor */
+    reactor_init(&reactor);
+    for (int i = 0; i < 3; i++) {
+        reactor_rx_add(&reactor, rx[i], sizeof(rx[i]));
+    }
+    http_client_init(&upstream, "127.0.0.1", getenv("STANDIN_PORT"), "localhost");
+    http_client_use_reactor(&upstream, &reactor);
+    TEST_ASSERT_TRUE(peer_node_start(&cfg, &reactor));
+    for (int i = 0; i < cycles; i++) {
+        int64_t start = reactor_now_ms();
+        int status = peer_node_fetch(&snap);
+        if (status > 0) {
+            peer_reads++;
+            if (status == 200) {
+                TEST_ASSERT_EQUAL(780, snap.strips[0].temp_now);
+            }
+        } else {
+            forecast_parser_init(&parser);
+            TEST_ASSERT_EQUAL(200, http_client_get(&upstream, "/forecast", NULL, 0, parser_cb, &parser));
+            forecast_parser_finish(&parser);
+            upstream_fetches++;
+            snap = (peer_snapshot_t){
+                .count = 1,
+                .dt = parser.dt_first,
+                .strips = { { true, parser.temp_min, parser.temp_now, parser.temp_max } },
+            };
+            peer_node_publish(&snap, upstream.resp.date);
+        }
+        printf("PEER %u cycle %d: %s (%d)\n", (unsigned)cfg.id, i, status > 0 ? "peer" : "upstream", status);
+        reactor_run(&reactor, start + cycle_ms);
+    }
+
+    peer_node_stats_t stats;
+    peer_cache_stats_t cache_stats;
+    peer_node_stats(&stats, &cache_stats);
+    printf("PEER %u upstream=%d peer=%d failures=%u served=%u not_modified=%u beacons=%u heard=%u\n", (unsigned)cfg.id,
+           upstream_fetches, peer_reads, (unsigned)stats.peer_failures, (unsigned)cache_stats.served,
+           (unsigned)cache_stats.not_modified, (unsigned)stats.beacons_sent, (unsigned)cache_stats.beacons_heard);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    if (getenv("PEER_ID")) {
+        RUN_TEST(test_device);
+    } else {
+        RUN_TEST(test_beacons);
+        RUN_TEST(test_election);
+        RUN_TEST(test_respond);
+    }
+    exit(UNITY_END());
+}
@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+#
+# Runs two instances of the peer_cache host test as two devices on the
+# loopback, with a stand-in for the OpenWeatherMap server that counts
+# requests. The first device fetches upstream and serves the second; once it
+# is gone the second fetches upstream itself.
+#
+#   idf.py --preview set-target linux && idf.py build
+#   pytest pytest_peer_cache.py
+
+import os
+import socket
+import subprocess
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+BODY = b'{"cod":"200","cnt":1,"list":[{"dt":1734609600,"main":{"temp":7.8,"temp_min":-2.1,"temp_max":9.0}}]}'
+CYCLE_MS = 400
+FIRST_CYCLES = 3
+SECOND_CYCLES = 6
+
+
+class StandInHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, *args) -> None:  # keep pytest output readable
+        pass
+
+    def do_GET(self) -> None:
+        with self.server.lock:
+            self.server.requests += 1
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(BODY)))
+        self.end_headers()
+        self.wfile.write(BODY)
+
+
+def start_standin() -> ThreadingHTTPServer:
+    server = ThreadingHTTPServer(('127.0.0.1', 0), StandInHandler)
+    server.lock = threading.Lock()
+    server.requests = 0
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server
+
+
+def free_udp_port() -> int:
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as s:
+        s.bind(('', 0))
+        return s.getsockname()[1]
+
+
+def device(elf: str, env: dict, peer_id: int, cycles: int) -> subprocess.Popen:
+    env = dict(env, PEER_ID=str(peer_id), PEER_CYCLES=str(cycles), PEER_CYCLE_MS=str(CYCLE_MS))
+    return subprocess.Popen([elf], env=env, stdout=subprocess.PIPE, text=True)
+
+
+def test_peer_cache() -> None:
+    server = start_standin()
+    elf = os.path.join(os.path.dirname(__file__), 'build', 'peer_cache_host_test.elf')
+    env = dict(os.environ, STANDIN_PORT=str(server.server_address[1]), PEER_BEACON_PORT=str(free_udp_port()))
+    try:
+        first = device(elf, env, 1, FIRST_CYCLES)
+        time.sleep(CYCLE_MS / 2000)
+        second = device(elf, env, 2, SECOND_CYCLES)
+        out_first, _ = first.communicate(timeout=60)
+        out_second, _ = second.communicate(timeout=60)
+    finally:
+        server.shutdown()
+    print(out_first)
+    print(out_second)
+    assert first.returncode == 0
+    assert second.returncode == 0
+
+    # While both run the second reads from the first: one upstream request a
+    # cycle. After the first is gone the second goes upstream.
+    assert 'PEER 2 cycle 0: peer' in out_second
+    assert 'upstream=%d peer=0' % FIRST_CYCLES in out_first
+    assert 'PEER 2 cycle %d: upstream' % (SECOND_CYCLES - 1) in out_second
+    cycles = (FIRST_CYCLES * CYCLE_MS + CYCLE_MS // 2 + (SECOND_CYCLES - FIRST_CYCLES) * CYCLE_MS) // CYCLE_MS
+    assert server.requests <= cycles + 1
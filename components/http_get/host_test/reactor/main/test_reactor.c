@@ -0,0 +1,326 @@
+/**
+ * @file test_reactor.c
+ * @author The Authors
+ * @brief Host test for the select() reactor and the requests it runs side by side
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The timer, wake-up and buffer pool tests run standalone. With
+ * STANDIN_PORT set, by pytest_reactor.py, four requests share one reactor:
+ * to a server that never accepts (a listener whose backlog is full, made
+ * here), one that stalls after the headers, one that dribbles its body a
+ * byte at a time, and a fast one made over and over meanwhile. Then the
+ * same four one after another, the way a blocking task makes them.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "unity.h"
+#include "lwip/sockets.h"
+#include "reactor.h"
+#include "http_client.h"
+
+#define CONNECT_MS      300
+#define IDLE_MS         500
+#define REQUEST_MS      1500
+#define BLACK_HOLE_FILL 8       // connects that fill the listener's backlog
+
+/* Timers: fired in deadline order, near their deadline, and never once removed */
+static int s_fired[4];
+static int s_n_fired;
+
+static void timer_cb(reactor_t *r, reactor_io_t *io, int events) {
+    TEST_ASSERT_EQUAL(REACTOR_EV_DEADLINE, events);
+    TEST_ASSERT_INT_WITHIN(20, io->deadline_ms, reactor_now_ms());
+    s_fired[s_n_fired++] = (int)(intptr_t)io->ctx;
+    reactor_remove(r, io);
+}
+
+static void test_timers(void) {
+    reactor_t r;
+    reactor_io_t timers[4] = { 0 };
+    const int after_ms[4] = { 30, 10, 20, 15 };
+    int64_t start = reactor_now_ms();
+
+    reactor_init(&r);
+    for (int i = 0; i < 4; i++) {
+        reactor_watch(&timers[i], -1, 0, start + after_ms[i]);
+        timers[i].cb = timer_cb;
+        timers[i].ctx = (void *)(intptr_t)after_ms[i];
+        TEST_ASSERT_TRUE(reactor_add(&r, &timers[i]));
+    }
+    reactor_remove(&r, &timers[3]);
+    TEST_ASSERT_FALSE(reactor_run(&r, start + 60));
+    TEST_ASSERT_EQUAL(3, s_n_fired);
+    TEST_ASSERT_EQUAL(10, s_fired[0]);
+    TEST_ASSERT_EQUAL(20, s_fired[1]);
+    TEST_ASSERT_EQUAL(30, s_fired[2]);
+    TEST_ASSERT_EQUAL(0, r.n_io);
+    TEST_ASSERT_EQUAL(3, r.stats.deadlines);
+    TEST_ASSERT_EQUAL(4, r.stats.io_peak);
+}
+
+static void *wake_later(void *arg) {
+    usleep(50 * 1000);
+    reactor_wake(arg);
+    reactor_wake(arg);
+    return NULL;
+}
+
+/* Another task's reactor_wake() ends reactor_run() early, just the once */
+static void test_wake(void) {
+    reactor_t r;
+    pthread_t thread;
+
+    reactor_init(&r);
+    TEST_ASSERT_TRUE(reactor_wake_enable(&r));
+    TEST_ASSERT_TRUE(reactor_can_wake(&r));
+    int64_t start = reactor_now_ms();
+    pthread_create(&thread, NULL, wake_later, &r);
+    TEST_ASSERT_TRUE(reactor_run(&r, start + 5000));
+    TEST_ASSERT_INT_WITHIN(40, 70, reactor_now_ms() - start);
+    pthread_join(thread, NULL);
+
+    start = reactor_now_ms();
+    TEST_ASSERT_FALSE(reactor_run(&r, start + 50));
+    TEST_ASSERT_GREATER_OR_EQUAL(50, reactor_now_ms() - start);
+    TEST_ASSERT_EQUAL(1, r.stats.wakes);
+    close(r.wake.fd);
+}
+
+static void test_rx_pool(void) {
+    reactor_t r;
+    char bufs[3][16];
+    char *out[3];
+    size_t len;
+
+    reactor_init(&r);
+    TEST_ASSERT_NULL(reactor_rx_take(&r, &len));
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(reactor_rx_add(&r, bufs[i], sizeof(bufs[i])));
+    }
+    TEST_ASSERT_EQUAL(2, reactor_rx_spare(&r));
+    for (int i = 0; i < 3; i++) {
+        out[i] = reactor_rx_take(&r, &len);
+        TEST_ASSERT_NOT_NULL(out[i]);
+        TEST_ASSERT_EQUAL(16, len);
+    }
+    TEST_ASSERT_NULL(reactor_rx_take(&r, &len));
+    TEST_ASSERT_EQUAL(-1, reactor_rx_spare(&r));
+    reactor_rx_give(&r, out[1]);
+    reactor_rx_give(&r, out[1]);        // twice is once
+    TEST_ASSERT_EQUAL_PTR(out[1], reactor_rx_take(&r, &len));
+    TEST_ASSERT_EQUAL(3, r.stats.rx_peak);
+    TEST_ASSERT_EQUAL(2, r.stats.rx_exhausted);
+}
+
+/* A socket closed while watched: select() fails once, its io is dropped and its owner told */
+static int s_dropped_events;
+
+static void dropped_cb(reactor_t *r, reactor_io_t *io, int events) {
+    s_dropped_events = events;
+}
+
+static void test_closed_socket(void) {
+    reactor_t r;
+    reactor_io_t io = { 0 };
+    reactor_io_t timer = { 0 };
+    int sv[2];
+    int64_t start = reactor_now_ms();
+
+    reactor_init(&r);
+    TEST_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    reactor_watch(&io, sv[0], REACTOR_READ, REACTOR_NEVER);
+    io.cb = dropped_cb;
+    TEST_ASSERT_TRUE(reactor_add(&r, &io));
+    reactor_watch(&timer, -1, 0, start + 20);
+    timer.cb = timer_cb;
+    s_n_fired = 0;
+    TEST_ASSERT_TRUE(reactor_add(&r, &timer));
+    close(sv[0]);
+    close(sv[1]);
+
+    TEST_ASSERT_EQUAL(-1, reactor_run(&r, start + 1000));
+    TEST_ASSERT_EQUAL(REACTOR_EV_DEADLINE, s_dropped_events);
+    TEST_ASSERT_FALSE(io.added);
+    TEST_ASSERT_EQUAL(1, r.stats.failures);
+    TEST_ASSERT_EQUAL(1, r.stats.dropped);
+    /* The rest carry on */
+    TEST_ASSERT_EQUAL(0, reactor_run(&r, start + 40));
+    TEST_ASSERT_EQUAL(1, s_n_fired);
+}
+
+/* A listener that never accepts, with its backlog full: a connect to it gets no answer */
+static int black_hole(int fill[BLACK_HOLE_FILL], char *port, size_t port_len) {
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addr_len = sizeof(addr);
+
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_EQUAL(0, bind(s, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, listen(s, 0));
+    TEST_ASSERT_EQUAL(0, getsockname(s, (struct sockaddr *)&addr, &addr_len));
+    for (int i = 0; i < BLACK_HOLE_FILL; i++) {
+        fill[i] = socket(AF_INET, SOCK_STREAM, 0);
+        fcntl(fill[i], F_SETFL, O_NONBLOCK);
+        connect(fill[i], (struct sockaddr *)&addr, sizeof(addr));
+    }
+    snprintf(port, port_len, "%u", ntohs(addr.sin_port));
+    return s;
+}
+
+typedef struct {
+    const char *path;
+    http_client_t client;
+    size_t body;
+    int status;
+    int64_t started_ms;
+    int64_t took_ms;
+    bool done;
+} request_t;
+
+static void body_cb(void *ctx, const char *buf, size_t len) {
+    *(size_t *)ctx += len;
+}
+
+static void request_done(void *ctx, int status) {
+    request_t *q = ctx;
+    q->status = status;
+    q->took_ms = reactor_now_ms() - q->started_ms;
+    q->done = true;
+}
+
+static void request_init(request_t *q, const char *port, const char *path, reactor_t *r) {
+    memset(q, 0, sizeof(*q));
+    q->path = path;
+    http_client_init(&q->client, "127.0.0.1", port, "localhost");
+    http_client_set_timeouts(&q->client, CONNECT_MS, IDLE_MS, REQUEST_MS);
+    if (r) {
+        http_client_use_reactor(&q->client, r);
+    }
+}
+
+static void request_start(request_t *q) {
+    q->done = false;
+    q->body = 0;
+    q->started_ms = reactor_now_ms();
+    TEST_ASSERT_TRUE(http_client_start(&q->client, q->path, body_cb, &q->body, request_done, q));
+}
+
+static void check_slow_ones(request_t *q) {
+    /* Black hole: the connect deadline. Stall: idle after the headers. Dribble: the request deadline. */
+    TEST_ASSERT_EQUAL(-1, q[0].status);
+    TEST_ASSERT_EQUAL(1, q[0].client.stats.timeouts);
+    TEST_ASSERT_EQUAL(0, q[0].client.stats.connects);
+    TEST_ASSERT_INT_WITHIN(150, CONNECT_MS + 50, q[0].took_ms);
+    TEST_ASSERT_EQUAL(-1, q[1].status);
+    TEST_ASSERT_EQUAL(1, q[1].client.stats.timeouts);
+    TEST_ASSERT_GREATER_THAN(0, q[1].client.resp.header_bytes);
+    TEST_ASSERT_INT_WITHIN(200, IDLE_MS + 100, q[1].took_ms);
+    TEST_ASSERT_EQUAL(-1, q[2].status);
+    TEST_ASSERT_EQUAL(1, q[2].client.stats.timeouts);
+    TEST_ASSERT_GREATER_THAN(0, q[2].client.body_wire_bytes);
+    TEST_ASSERT_INT_WITHIN(200, REQUEST_MS + 50, q[2].took_ms);
+}
+
+static void test_side_by_side(void) {
+    static reactor_t r;
+    static char rx[2][512];
+    static request_t q[4];
+    int fill[BLACK_HOLE_FILL];
+    char hole_port[6];
+    const char *port = getenv("STANDIN_PORT");
+    int64_t fast_worst = 0;
+    int fast_n = 0;
+
+    int hole = black_hole(fill, hole_port, sizeof(hole_port));
+    reactor_init(&r);
+    for (int i = 0; i < 2; i++) {
+        reactor_rx_add(&r, rx[i], sizeof(rx[i]));
+    }
+    request_init(&q[0], hole_port, "/", &r);
+    request_init(&q[1], port, "/stall", &r);
+    request_init(&q[2], port, "/slow", &r);
+    request_init(&q[3], port, "/fast", &r);
+    int64_t start = reactor_now_ms();
+    for (int i = 0; i < 4; i++) {
+        request_start(&q[i]);
+    }
+
+    /* The fast one again as soon as it's done, until the others are over */
+    while (!q[0].done || !q[1].done || !q[2].done) {
+        TEST_ASSERT_GREATER_OR_EQUAL(0, reactor_poll(&r, REACTOR_NEVER));
+        if (q[3].done) {
+            TEST_ASSERT_EQUAL(200, q[3].status);
+            TEST_ASSERT_GREATER_THAN(0, q[3].body);
+            fast_worst = q[3].took_ms > fast_worst ? q[3].took_ms : fast_worst;
+            fast_n++;
+            request_start(&q[3]);
+        }
+    }
+    while (!q[3].done) {
+        reactor_poll(&r, REACTOR_NEVER);
+    }
+    int64_t all_ms = reactor_now_ms() - start;
+    check_slow_ones(q);
+    TEST_ASSERT_GREATER_THAN(10, fast_n);
+    TEST_ASSERT_LESS_THAN(50, fast_worst);
+    TEST_ASSERT_INT_WITHIN(250, REQUEST_MS + 100, all_ms);
+    TEST_ASSERT_EQUAL(1, q[3].client.stats.connects);   // kept alive throughout
+    /* Reads give their buffer straight back: four requests, one buffer */
+    TEST_ASSERT_EQUAL(1, r.stats.rx_peak);
+    TEST_ASSERT_EQUAL(0, r.stats.rx_exhausted);
+    TEST_ASSERT_EQUAL(4, r.stats.io_peak);
+
+    printf("REACTOR side by side: black hole %lld ms, stall %lld ms, dribble %lld ms; "
+           "%d fast requests meanwhile, worst %lld ms; all over in %lld ms\n",
+           (long long)q[0].took_ms, (long long)q[1].took_ms, (long long)q[2].took_ms, fast_n,
+           (long long)fast_worst, (long long)all_ms);
+    printf("REACTOR ram: 4 requests on one task in reactor %zu B + %zu B of state each + %u of %d pooled %zu B buffers, "
+           "polls=%u events=%u deadlines=%u\n", sizeof(reactor_t), sizeof(http_client_t), (unsigned)r.stats.rx_peak,
+           r.n_rx, sizeof(rx[0]), (unsigned)r.stats.polls, (unsigned)r.stats.events, (unsigned)r.stats.deadlines);
+
+    /* The same four one after another, each waited for: the fast one is behind all of them */
+    char recv_buf[512];
+    start = reactor_now_ms();
+    for (int i = 0; i < 4; i++) {
+        request_init(&q[i], i == 0 ? hole_port : port, q[i].path, NULL);
+        q[i].started_ms = reactor_now_ms();
+        q[i].status = http_client_get(&q[i].client, q[i].path, recv_buf, sizeof(recv_buf), body_cb, &q[i].body);
+        q[i].took_ms = reactor_now_ms() - q[i].started_ms;
+    }
+    int64_t fast_queued = reactor_now_ms() - start;
+    check_slow_ones(q);
+    TEST_ASSERT_EQUAL(200, q[3].status);
+    TEST_ASSERT_GREATER_THAN(CONNECT_MS + IDLE_MS + REQUEST_MS, fast_queued);
+    printf("REACTOR one at a time: the fast request is over %lld ms after the first starts, %lld ms side by side\n",
+           (long long)fast_queued, (long long)fast_worst);
+
+    for (int i = 0; i < 4; i++) {
+        http_client_close(&q[i].client);
+    }
+    for (int i = 0; i < BLACK_HOLE_FILL; i++) {
+        close(fill[i]);
+    }
+    close(hole);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_timers);
+    RUN_TEST(test_wake);
+    RUN_TEST(test_rx_pool);
+    RUN_TEST(test_closed_socket);
+    if (getenv("STANDIN_PORT")) {
+        RUN_TEST(test_side_by_side);
+    }
+    exit(UNITY_END());
+}
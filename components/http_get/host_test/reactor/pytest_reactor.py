@@ -0,0 +1,75 @@
+#!/usr/bin/env python
+#
+# Runs the reactor host test against a local stand-in server with a slow
+# path or two: /stall sends the headers and then nothing, /slow dribbles
+# its body a byte at a time, /fast answers straight away. The test makes a
+# listener that never accepts itself.
+#
+#   idf.py --preview set-target linux && idf.py build
+#   pytest pytest_reactor.py
+
+import os
+import subprocess
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+BODY = b'{"cod":"200","cnt":1,"list":[{"dt":1734609600,"main":{"temp":7.8,"temp_min":-2.1,"temp_max":9.0}}]}'
+STALL_S = 3         # longer than the client's idle timeout
+DRIBBLE_S = 0.04    # between bytes, shorter than it
+
+
+class StandInHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+    disable_nagle_algorithm = True  # headers and body are two writes, don't hold the second for an ACK
+
+    def log_message(self, *args) -> None:  # keep pytest output readable
+        pass
+
+    def do_GET(self) -> None:
+        with self.server.lock:
+            self.server.paths[self.path] = self.server.paths.get(self.path, 0) + 1
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(BODY)))
+        self.end_headers()
+        try:
+            if self.path == '/stall':
+                self.wfile.flush()
+                time.sleep(STALL_S)
+                self.close_connection = True
+                return
+            if self.path == '/slow':
+                for i in range(len(BODY)):
+                    self.wfile.write(BODY[i:i + 1])
+                    self.wfile.flush()
+                    time.sleep(DRIBBLE_S)
+                return
+            self.wfile.write(BODY)
+        except (BrokenPipeError, ConnectionResetError):  # the client gave up, as it should
+            self.close_connection = True
+
+
+def test_reactor() -> None:
+    server = ThreadingHTTPServer(('127.0.0.1', 0), StandInHandler)
+    server.daemon_threads = True
+    server.lock = threading.Lock()
+    server.paths = {}
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+
+    elf = os.path.join(os.path.dirname(__file__), 'build', 'reactor_host_test.elf')
+    env = dict(os.environ, STANDIN_PORT=str(server.server_address[1]))
+    try:
+        result = subprocess.run([elf], env=env, stdout=subprocess.PIPE, text=True, timeout=60)
+    finally:
+        server.shutdown()
+    print(result.stdout)
+    assert result.returncode == 0
+    assert 'REACTOR side by side' in result.stdout
+    assert 'REACTOR one at a time' in result.stdout
+
+    # Side by side, then one at a time: each slow path twice, the fast one
+    # over and over the first time
+    assert server.paths['/stall'] == 2
+    assert server.paths['/slow'] == 2
+    assert server.paths['/fast'] > 10
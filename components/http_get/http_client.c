@@ -0,0 +1,593 @@
+/**
+ * @file http_client.c
+ * @author The Authors
+ * @brief Minimal HTTP/1.1 GET client: keep-alive, cached address, conditional requests, optional TLS
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "lwip/err.h"
+#include "lwip/sockets.h"
+#include "lwip/netdb.h"
+#include "sdkconfig.h"
+#include "http_client.h"
+#include "trace.h"
+
+#define PENDING             INT_MIN     // http_client_get() still waiting
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS  MSG_NOSIGNAL    // a dead peer is an error, not a SIGPIPE on the host
+#else
+#define SEND_FLAGS  0
+#endif
+
+enum {
+    STATE_IDLE = 0,
+    STATE_CONNECTING,
+    STATE_HANDSHAKE,
+    STATE_SENDING,
+    STATE_RECEIVING,
+};
+
+#if CONFIG_HTTP_GET_KEEP_ALIVE
+#define KEEP_ALIVE true
+#else
+#define KEEP_ALIVE false
+#endif
+
+#if CONFIG_HTTP_GET_COMPRESSION
+#define ACCEPT_ENCODING "Accept-Encoding: gzip, deflate\r\n"
+#else
+#define ACCEPT_ENCODING ""
+#endif
+
+static const char *TAG = "http_client";
+
+static bool resolve(http_client_t *client) {
+    const struct addrinfo hints = {
+        .ai_family = AF_INET,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct addrinfo *res;
+
+    /* lwIP doesn't hand the record TTL to getaddrinfo(), so hold the address for a fixed time */
+    if (client->addr_valid && (int32_t)(client->addr_expiry_tick - xTaskGetTickCount()) > 0) {
+        return true;
+    }
+
+    client->stats.dns_lookups++;
+    uint32_t heap = trace_heap_free();
+    uint32_t t = trace_now();
+    int64_t start = esp_timer_get_time();
+    int err = getaddrinfo(client->server, client->port, &hints, &res);
+    client->timing.dns_us = esp_timer_get_time() - start;
+    trace_end(TRACE_DNS, t);
+    uint32_t held = heap - trace_heap_free();       // until freeaddrinfo()
+    if ((int32_t)held > 0) {
+        trace_count(TRACE_CTR_DNS_HEAP, held);
+    }
+    if (err != 0 || res == NULL) {
+        ESP_LOGE(TAG, "DNS lookup failed of %s:%s err=%d res=%p", client->server, client->port, err, res);
+        client->addr_valid = false;
+        return false;
+    }
+
+    memcpy(&client->addr, res->ai_addr, sizeof(client->addr));
+    client->addr_valid = true;
+    client->addr_expiry_tick = xTaskGetTickCount() + pdMS_TO_TICKS(CONFIG_HTTP_GET_DNS_CACHE_TTL_S * 1000);
+    freeaddrinfo(res);
+
+    /* Note: inet_ntoa is non-reentrant, look at ipaddr_ntoa_r for "real" code */
+    ESP_LOGI(TAG, "DNS lookup succeeded. IP=%s", inet_ntoa(client->addr.sin_addr));
+    return true;
+}
+
+/* The plain socket's would-block as tls_conn's, so both go the same way */
+static int conn_write(http_client_t *client, const char *data, size_t len) {
+    if (client->tls) {
+        return tls_conn_write(client->tls, data, len);
+    }
+    int n = send(client->sock, data, len, SEND_FLAGS);
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ? TLS_CONN_WANT_WRITE : n;
+}
+
+static int conn_read(http_client_t *client, char *buf, size_t len) {
+    if (client->tls) {
+        return tls_conn_read(client->tls, buf, len);
+    }
+    int n = recv(client->sock, buf, len, 0);
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ? TLS_CONN_WANT_READ : n;
+}
+
+static bool would_block(int r) {
+    return r == TLS_CONN_WANT_READ || r == TLS_CONN_WANT_WRITE;
+}
+
+/* Now plus timeout_ms, but no later than the request as a whole */
+static int64_t deadline_after(http_client_t *client, uint32_t timeout_ms) {
+    int64_t deadline = reactor_now_ms() + timeout_ms;
+    return deadline < client->request_deadline_ms ? deadline : client->request_deadline_ms;
+}
+
+static void wait_for(http_client_t *client, int r, int64_t deadline_ms) {
+    reactor_watch(&client->io, client->sock, r == TLS_CONN_WANT_WRITE ? REACTOR_WRITE : REACTOR_READ, deadline_ms);
+}
+
+static int build_request(http_client_t *client, const char *path) {
+    /* The last body couldn't be inflated for want of heap: this one is asked for as is */
+    const char *accept = client->identity_next ? "" : ACCEPT_ENCODING;
+    if (client->identity_next) {
+        ESP_LOGW(TAG, "Asking for an uncompressed body, there was no heap to inflate the last");
+        client->identity_next = false;
+    }
+    int n = snprintf(client->request, sizeof(client->request),
+                     "GET %s HTTP/1.1\r\n"
+                     "Host: %s\r\n"
+                     "User-Agent: esp-idf/1.0 esp32\r\n"
+                     "Connection: %s\r\n"
+                     "%s",
+                     path, client->host_header,
+                     KEEP_ALIVE ? "keep-alive" : "close", accept);
+    if (client->etag[0] && n < (int)sizeof(client->request)) {
+        n += snprintf(client->request + n, sizeof(client->request) - n, "If-None-Match: %s\r\n", client->etag);
+    }
+    if (client->last_modified[0] && n < (int)sizeof(client->request)) {
+        n += snprintf(client->request + n, sizeof(client->request) - n, "If-Modified-Since: %s\r\n", client->last_modified);
+    }
+    if (n < (int)sizeof(client->request)) {
+        n += snprintf(client->request + n, sizeof(client->request) - n, "\r\n");
+    }
+    if (n >= (int)sizeof(client->request)) {
+        ESP_LOGE(TAG, "Request too long for %d byte buffer", HTTP_CLIENT_REQUEST_MAX);
+        return -1;
+    }
+    return n;
+}
+
+/* Between the framing and body_cb: counts the body and inflates it if it's compressed */
+static void body_slice(void *ctx, const char *buf, size_t len) {
+    http_client_t *client = ctx;
+    http_encoding_t encoding = client->resp.content_encoding;
+
+    if (!client->body_started) {
+        client->body_started = true;
+        if (encoding != HTTP_ENCODING_IDENTITY &&
+            !body_inflate_begin(&client->inflate, encoding, client->body_cb, client->body_ctx)) {
+            ESP_LOGE(TAG, "Can't inflate a body of encoding %d", encoding);
+            client->body_failed = true;
+            /* One asked for: the window and decoder weren't to be had, the retry does without */
+            client->identity_next = encoding != HTTP_ENCODING_OTHER;
+        }
+    }
+    client->body_wire_bytes += len;
+    if (client->body_failed) {
+        return;
+    }
+    if (encoding == HTTP_ENCODING_IDENTITY) {
+        client->body_bytes += len;
+        client->body_cb(client->body_ctx, buf, len);
+    } else {
+        body_inflate_feed(&client->inflate, buf, len);
+    }
+}
+
+/* False if a compressed body was cut short or corrupt */
+static bool body_finish(http_client_t *client) {
+    if (!client->body_started || client->resp.content_encoding == HTTP_ENCODING_IDENTITY) {
+        return true;
+    }
+    if (client->body_failed) {
+        return false;
+    }
+    client->body_bytes = client->inflate.out_bytes;
+    if (!body_inflate_end(&client->inflate)) {
+        ESP_LOGE(TAG, "Compressed body is incomplete or corrupt, %" PRIu32 " bytes in", client->inflate.in_bytes);
+        return false;
+    }
+    return true;
+}
+
+static void begin_attempt(http_client_t *client);
+
+/* The request is over: status, or -1 with the connection closed */
+static void complete(http_client_t *client, int status) {
+    reactor_remove(client->reactor, &client->io);
+    client->state = STATE_IDLE;
+    client->timing.total_us = esp_timer_get_time() - client->started_us;
+    if (status < 0) {
+        client->stats.errors++;
+        http_client_close(client);
+    }
+    if (client->done_cb) {
+        client->done_cb(client->done_ctx, status);
+    }
+}
+
+/* Nothing came back on a kept-alive connection: the server had dropped it, try once on a fresh one */
+static bool retry_stale(http_client_t *client) {
+    if (!client->reused || client->resp.header_bytes > 0 || client->attempt > 0) {
+        return false;
+    }
+    ESP_LOGI(TAG, "Kept-alive connection was closed by peer, reconnecting");
+    trace_count(TRACE_CTR_RECONNECTS, 1);
+    http_client_close(client);
+    client->attempt++;
+    begin_attempt(client);
+    return true;
+}
+
+static void succeeded(http_client_t *client, int status) {
+    if (client->reused) {
+        client->stats.reused++;
+    }
+    client->timing.reused = client->reused;
+
+    if (!KEEP_ALIVE || !client->resp.keep_alive) {
+        http_client_close(client);
+    }
+    if (status == 304) {
+        client->stats.not_modified++;
+    } else if (status == 200) {
+        /* Validators are replaced as a pair so a stale one never lingers */
+        strcpy(client->etag, client->resp.etag);
+        strcpy(client->last_modified, client->resp.last_modified);
+    }
+    complete(client, status);
+}
+
+/* r is the last read's: 0 at the end of the connection, -1 on an error or the deadline */
+static void received(http_client_t *client, int r) {
+    http_response_t *resp = &client->resp;
+
+    trace_end(TRACE_RECV, client->trace_t);
+    bool body_ok = body_finish(client);
+    client->stats.body_wire_bytes += client->body_wire_bytes;
+    client->stats.body_bytes += client->body_bytes;
+
+    ESP_LOGI(TAG, "... done reading from socket. Last read return=%d errno=%d.", r, r < 0 ? errno : 0);
+
+    if (r <= 0 && retry_stale(client)) {
+        return;
+    }
+    if (!http_response_done(resp) || !body_ok) {
+        complete(client, -1);
+        return;
+    }
+    succeeded(client, resp->status);
+}
+
+/* Readable: read until there is nothing more for now, into a buffer borrowed for the while */
+static void receive(http_client_t *client) {
+    http_response_t *resp = &client->resp;
+    size_t len;
+    int r;
+
+    char *buf = reactor_rx_take(client->reactor, &len);
+    if (!buf) {
+        ESP_LOGE(TAG, "No receive buffer free");
+        received(client, -1);
+        return;
+    }
+    do {
+        r = conn_read(client, buf, len);
+        if (r > 0 && client->timing.first_byte_us == 0) {
+            client->timing.first_byte_us = esp_timer_get_time() - client->step_us;
+        }
+        if (r > 0) {
+            trace_count(TRACE_CTR_RX_BYTES, r);
+            http_response_feed(resp, buf, r, body_slice, client);
+        } else if (r == 0) {
+            http_response_eof(resp);
+        }
+    } while (r > 0 && !http_response_done(resp) && !http_response_failed(resp));
+    reactor_rx_give(client->reactor, buf);
+
+    if (would_block(r)) {
+        wait_for(client, r, deadline_after(client, client->idle_timeout_ms));
+        return;
+    }
+    received(client, r);
+}
+
+static void start_receive(http_client_t *client) {
+    client->state = STATE_RECEIVING;
+    client->step_us = esp_timer_get_time();
+    client->trace_t = trace_now();
+    client->body_started = false;
+    client->body_failed = false;
+    client->body_wire_bytes = 0;
+    client->body_bytes = 0;
+    wait_for(client, TLS_CONN_WANT_READ, deadline_after(client, client->idle_timeout_ms));
+}
+
+static void send_request(http_client_t *client) {
+    while (client->sent < client->request_len) {
+        int w = conn_write(client, client->request + client->sent, client->request_len - client->sent);
+        if (would_block(w)) {
+            wait_for(client, w, deadline_after(client, client->idle_timeout_ms));
+            return;
+        }
+        if (w < 0) {
+            ESP_LOGE(TAG, "... socket send failed errno=%d", errno);
+            if (!retry_stale(client)) {
+                complete(client, -1);
+            }
+            return;
+        }
+        client->sent += w;
+    }
+    trace_end(TRACE_SEND, client->trace_t);
+    ESP_LOGI(TAG, "... socket send success");
+    client->stats.requests++;
+    start_receive(client);
+}
+
+static void start_send(http_client_t *client) {
+    client->state = STATE_SENDING;
+    client->sent = 0;
+    client->trace_t = trace_now();
+    send_request(client);
+}
+
+static void handshake(http_client_t *client) {
+    int r = tls_conn_handshake_step(client->tls);
+    if (would_block(r)) {
+        int64_t deadline = deadline_after(client, client->idle_timeout_ms);
+        wait_for(client, r, deadline < client->handshake_deadline_ms ? deadline : client->handshake_deadline_ms);
+        return;
+    }
+    client->timing.tls_us = client->tls->stats.last_us;
+    if (r < 0) {
+        complete(client, -1);
+        return;
+    }
+    client->timing.tls_resumed = tls_conn_resumed(client->tls);
+    ESP_LOGI(TAG, "... TLS %s in %" PRIu32 " ms, heap peak %" PRIu32, client->timing.tls_resumed ? "resumed" : "handshake",
+             client->tls->stats.last_us / 1000, client->tls->stats.last_heap_peak);
+    start_send(client);
+}
+
+static void connected(http_client_t *client) {
+    client->timing.connect_us = esp_timer_get_time() - client->step_us;
+    trace_end(TRACE_CONNECT, client->trace_t);
+    ESP_LOGI(TAG, "... connected");
+    client->stats.connects++;
+
+    if (!client->tls) {
+        start_send(client);
+        return;
+    }
+    if (!tls_conn_handshake_begin(client->tls, client->sock)) {
+        complete(client, -1);
+        return;
+    }
+    client->state = STATE_HANDSHAKE;
+    /* Each round trip has the idle timeout, the whole handshake as long as a connect */
+    client->handshake_deadline_ms = deadline_after(client, client->connect_timeout_ms);
+    handshake(client);
+}
+
+static void connect_failed(http_client_t *client, int err) {
+    ESP_LOGE(TAG, "... socket connect failed errno=%d", err);
+    client->addr_valid = false;     // maybe the address moved, look it up again next time
+    complete(client, -1);
+}
+
+static void begin_attempt(http_client_t *client) {
+    client->reused = client->sock >= 0;
+    http_response_init(&client->resp);
+    if (client->reused) {
+        start_send(client);
+        return;
+    }
+    if (!resolve(client)) {
+        complete(client, -1);
+        return;
+    }
+
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s < 0) {
+        ESP_LOGE(TAG, "... Failed to allocate socket.");
+        complete(client, -1);
+        return;
+    }
+    ESP_LOGI(TAG, "... allocated socket");
+    client->sock = s;
+    if (fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        ESP_LOGE(TAG, "... failed to make the socket non-blocking");
+        complete(client, -1);
+        return;
+    }
+
+    client->trace_t = trace_now();
+    client->step_us = esp_timer_get_time();
+    if (connect(s, (struct sockaddr *)&client->addr, sizeof(client->addr)) == 0) {
+        connected(client);
+    } else if (errno == EINPROGRESS) {
+        client->state = STATE_CONNECTING;
+        reactor_watch(&client->io, s, REACTOR_WRITE, deadline_after(client, client->connect_timeout_ms));
+    } else {
+        connect_failed(client, errno);
+    }
+}
+
+static void timed_out(http_client_t *client) {
+    static const char *const steps[] = {
+        [STATE_CONNECTING] = "connecting",
+        [STATE_HANDSHAKE] = "in the TLS handshake",
+        [STATE_SENDING] = "sending",
+        [STATE_RECEIVING] = "receiving",
+    };
+
+    ESP_LOGW(TAG, "... timed out %s after %" PRIu32 " ms", steps[client->state],
+             (uint32_t)((esp_timer_get_time() - client->started_us) / 1000));
+    client->stats.timeouts++;
+    errno = ETIMEDOUT;
+    switch (client->state) {
+    case STATE_CONNECTING:
+        client->addr_valid = false;
+        complete(client, -1);
+        break;
+    case STATE_HANDSHAKE:
+        tls_conn_handshake_abort(client->tls);
+        client->timing.tls_us = client->tls->stats.last_us;
+        complete(client, -1);
+        break;
+    case STATE_SENDING:
+        if (!retry_stale(client)) {
+            complete(client, -1);
+        }
+        break;
+    case STATE_RECEIVING:
+    default:
+        received(client, -1);
+        break;
+    }
+}
+
+static void io_cb(reactor_t *r, reactor_io_t *io, int events) {
+    http_client_t *client = io->ctx;
+    int err = 0;
+    socklen_t err_len = sizeof(err);
+
+    if (events & REACTOR_EV_DEADLINE) {
+        timed_out(client);
+        return;
+    }
+    switch (client->state) {
+    case STATE_CONNECTING:
+        if (getsockopt(client->sock, SOL_SOCKET, SO_ERROR, &err, &err_len) != 0) {
+            err = errno;
+        }
+        if (err != 0) {
+            connect_failed(client, err);
+        } else {
+            connected(client);
+        }
+        break;
+    case STATE_HANDSHAKE:
+        handshake(client);
+        break;
+    case STATE_SENDING:
+        send_request(client);
+        break;
+    case STATE_RECEIVING:
+        receive(client);
+        break;
+    default:
+        break;
+    }
+}
+
+void http_client_init(http_client_t *client, const char *server, const char *port, const char *host_header) {
+    memset(client, 0, sizeof(*client));
+    client->server = server;
+    client->port = port;
+    client->host_header = host_header;
+    client->sock = -1;
+    client->io.fd = -1;
+    client->io.cb = io_cb;
+    client->io.ctx = client;
+    http_client_set_timeouts(client, CONFIG_HTTP_GET_TCP_CONNECT_TIMEOUT_MS, CONFIG_HTTP_GET_IDLE_TIMEOUT_MS,
+                             CONFIG_HTTP_GET_REQUEST_TIMEOUT_S * 1000);
+}
+
+void http_client_use_tls(http_client_t *client, tls_conn_t *tls) {
+    http_client_close(client);
+    client->tls = tls;
+}
+
+void http_client_use_reactor(http_client_t *client, reactor_t *reactor) {
+    client->reactor = reactor;
+}
+
+void http_client_set_timeouts(http_client_t *client, uint32_t connect_ms, uint32_t idle_ms, uint32_t request_ms) {
+    client->connect_timeout_ms = connect_ms;
+    client->idle_timeout_ms = idle_ms;
+    client->request_timeout_ms = request_ms;
+}
+
+bool http_client_start(http_client_t *client, const char *path, http_response_body_cb_t body_cb, void *ctx,
+                       http_client_done_cb_t done_cb, void *done_ctx) {
+    if (!client->reactor || http_client_busy(client)) {
+        return false;
+    }
+    client->request_len = build_request(client, path);
+    if (client->request_len < 0) {
+        return false;
+    }
+    /* Nothing to wait for until the first step says what */
+    reactor_watch(&client->io, -1, 0, REACTOR_NEVER);
+    if (!reactor_add(client->reactor, &client->io)) {
+        return false;
+    }
+
+    memset(&client->timing, 0, sizeof(client->timing));
+    client->started_us = esp_timer_get_time();
+    client->request_deadline_ms = reactor_now_ms() + client->request_timeout_ms;
+    client->body_cb = body_cb;
+    client->body_ctx = ctx;
+    client->done_cb = done_cb;
+    client->done_ctx = done_ctx;
+    client->attempt = 0;
+    client->state = STATE_SENDING;      // busy from here, begin_attempt() says which step
+    begin_attempt(client);
+    return true;
+}
+
+static void get_done(void *ctx, int status) {
+    *(int *)ctx = status;
+}
+
+int http_client_get(http_client_t *client, const char *path, char *recv_buf, size_t recv_len,
+                    http_response_body_cb_t body_cb, void *ctx) {
+    reactor_t *shared = client->reactor;
+    reactor_t own;
+    int status = PENDING;
+
+    if (!shared) {
+        reactor_init(&own);
+        reactor_rx_add(&own, recv_buf, recv_len);
+        client->reactor = &own;
+    }
+    if (!http_client_start(client, path, body_cb, ctx, get_done, &status)) {
+        status = -1;
+    }
+    while (status == PENDING) {
+        if (reactor_poll(client->reactor, REACTOR_NEVER) < 0) {
+            complete(client, -1);
+        }
+    }
+    client->reactor = shared;
+    return status;
+}
+
+void http_client_close(http_client_t *client) {
+    if (client->sock >= 0) {
+        if (client->tls) {
+            tls_conn_close(client->tls);
+        }
+        if (close(client->sock) != 0) {
+            ESP_LOGE(TAG, "... socket close failed errno=%d", errno);
+        }
+        client->sock = -1;
+    }
+}
+
+void http_client_forget_validators(http_client_t *client) {
+    client->etag[0] = '\0';
+    client->last_modified[0] = '\0';
+}
@@ -6,176 +6,609 @@
    software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
    CONDITIONS OF ANY KIND, either express or implied.
 */
+#include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
+#include "esp_netif.h"
 #include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_mac.h"
 
-#include "lwip/err.h"
-#include "lwip/sockets.h"
-#include "lwip/sys.h"
-#include "lwip/netdb.h"
-#include "lwip/dns.h"
 #include "sdkconfig.h"
 #include "http_get.h"
+#include "forecast_parser.h"
+#include "forecast_agg.h"
+#include "http_client.h"
+#include "fetch_sched.h"
+#include "net_sm.h"
+#include "reactor.h"
+#include "sites.h"
+#include "peer_node.h"
+#include "power.h"
+#include "trace_sys.h"
+#include "log_sink.h"
 
 /* Constants that aren't configurable in menuconfig */
 #define WEB_SERVER "eu-api.openweathermap.org"
+#if CONFIG_HTTP_GET_HTTPS
+#define WEB_PORT "443"
+#else
 #define WEB_PORT "80"
+#endif
+#define WEB_HOST "api.openweathermap.org"
 
 // Current weather
 // #define WEB_PATH "/data/2.5/weather?q="OPENWEATHERMAP_LOCATION"&appid="OPENWEATHERMAP_API_KEY"&units=metric"
 
-// 5 day forecast - 3 hour intervals. Change cnt=4 to cnt=8 for 24 hour intervals
-#define WEB_PATH "/data/2.5/forecast?q="OPENWEATHERMAP_LOCATION"&cnt=4&appid="OPENWEATHERMAP_API_KEY"&units=metric"
+#define STR_(x) #x
+#define STR(x) STR_(x)
+
+// 5 day forecast - 3 hour slots, CONFIG_HTTP_GET_FORECAST_SLOTS of them (40 is all 5 days)
+#define WEB_PATH "/data/2.5/forecast?q="OPENWEATHERMAP_LOCATION"&cnt="STR(CONFIG_HTTP_GET_FORECAST_SLOTS)"&appid="OPENWEATHERMAP_API_KEY"&units=metric"
+
+// Current weather for every city in CONFIG_HTTP_GET_CITY_IDS, one per strip
+#define GROUP_PATH "/data/2.5/group?id="CONFIG_HTTP_GET_CITY_IDS"&appid="OPENWEATHERMAP_API_KEY"&units=metric"
+#define GROUP_MODE (sizeof(CONFIG_HTTP_GET_CITY_IDS) > 1)
 
 #ifndef OPENWEATHERMAP_API_KEY
     #error "OPENWEATHERMAP_API_KEY is not defined"
 #endif
 
+#define UPSTREAM_PATH (GROUP_MODE ? GROUP_PATH : WEB_PATH)
+
+#if CONFIG_HTTP_GET_WINDOW_NEXT_24H
+#define WINDOW              FORECAST_WINDOW_NEXT_24H
+#elif CONFIG_HTTP_GET_WINDOW_TODAY
+#define WINDOW              FORECAST_WINDOW_TODAY
+#elif CONFIG_HTTP_GET_WINDOW_TOMORROW
+#define WINDOW              FORECAST_WINDOW_TOMORROW
+#else
+#define WINDOW              FORECAST_WINDOW_HORIZON
+#endif
+#ifndef CONFIG_HTTP_GET_UTC_OFFSET_MIN
+#define CONFIG_HTTP_GET_UTC_OFFSET_MIN 0
+#endif
+
 static const char *TAG = "http_get";
 
-static const char *REQUEST = "GET "WEB_PATH" HTTP/1.0\r\n"
-    "Host: api.openweathermap.org\r\n"
-    "User-Agent: esp-idf/1.0 esp32\r\n"
-    "\r\n";
+#define EVENT_QUEUE_LEN     16
+#define EVENT_REFRESH       0xff    // http_get_refresh_now(), the other events are net_sm_event_t
+#define NO_WAKE_POLL_MS     1000    // how soon events are seen without the reactor's wake socket, or the link without events
 
-light_animate_and_set_cb_t light_animate_and_set_cb;
+light_strip_set_cb_t light_animate_and_set_cb;
+static forecast_record_cb_t forecast_record_cb;     // optional
+static fetch_report_cb_t fetch_report_cb;           // optional
+static TaskHandle_t s_task;
+static QueueHandle_t s_events;                      // uint8_t, to the task
+static reactor_t s_reactor;                         // the task's sockets, woken for s_events
+static char s_rx[CONFIG_HTTP_GET_RX_BUFS][CONFIG_HTTP_GET_RX_BUF_LEN];
+static char s_net_report[256];
+static bool s_net_polled;                           // no Wi-Fi events, the link is polled
+static sites_t s_sites;
+static forecast_agg_t s_agg[2];                     // the one shown & the one being parsed
+static uint8_t s_agg_shown;
+static uint32_t s_parse_us;                         // this fetch's, in the body callbacks
+static uint32_t s_parse_cycles;                     // ... the same for the trace
 
-typedef void (*light_animate_and_set_wrapper_t)(int, int, int);
+static const fetch_sched_config_t s_sched_cfg = {
+    .min_interval_s = CONFIG_HTTP_GET_MIN_INTERVAL_S,
+    .max_interval_s = CONFIG_HTTP_GET_MAX_INTERVAL_S,
+    .default_interval_s = CONFIG_HTTP_GET_DEFAULT_INTERVAL_S,
+    .slot_settle_s = CONFIG_HTTP_GET_SLOT_SETTLE_S,
+    .backoff_base_s = CONFIG_HTTP_GET_BACKOFF_BASE_S,
+    .backoff_max_s = CONFIG_HTTP_GET_BACKOFF_MAX_S,
+    .daily_quota = CONFIG_HTTP_GET_DAILY_QUOTA,
+};
+
+static const net_sm_config_t s_net_cfg = {
+    .connect_timeout_ms = CONFIG_HTTP_GET_CONNECT_TIMEOUT_S * 1000,
+    .backoff_base_ms = CONFIG_HTTP_GET_RECONNECT_BACKOFF_BASE_MS,
+    .backoff_max_ms = CONFIG_HTTP_GET_RECONNECT_BACKOFF_MAX_S * 1000,
+};
+
+typedef void (*light_animate_and_set_wrapper_t)(int, int, int, int);
 
 /**
- * @brief Wrapper to access light_animate_and_set function in light_driver.c
+ * @brief Wrapper to access light_strip_animate_and_set function in light_driver.c
  */
-void light_animate_and_set_wrapper(int temp_min, int temp_now, int temp_max) {
+void light_animate_and_set_wrapper(int strip, int temp_min, int temp_now, int temp_max) {
   if (0) {
-    ESP_LOGI(TAG, "%s, temp_min=%d, temp_now=%d, temp_max=%d", __func__, temp_min, temp_now, temp_max);
+    ESP_LOGI(TAG, "%s, strip=%d, temp_min=" TEMP_C_FMT ", temp_now=" TEMP_C_FMT ", temp_max=" TEMP_C_FMT, __func__, strip,
+             TEMP_C_ARGS(temp_min), TEMP_C_ARGS(temp_now), TEMP_C_ARGS(temp_max));
   }
-  light_animate_and_set_cb(temp_min, temp_now, temp_max);
+  light_animate_and_set_cb(strip, temp_min, temp_now, temp_max);
 }
 
-void http_get_task(void *pvParameters)
-{
-    light_animate_and_set_wrapper_t light_animateSet = (light_animate_and_set_wrapper_t)pvParameters;
+/**
+ * @brief Body sink: feed the tokenizer, and echo to the console if configured
+ */
+static void forecast_body_cb(void *ctx, const char *buf, size_t len) {
+    uint32_t t = trace_now();
+    int64_t start = esp_timer_get_time();
+    forecast_agg_body_cb(ctx, buf, len);
+    s_parse_us += esp_timer_get_time() - start;
+    s_parse_cycles += trace_now() - t;
+#if CONFIG_HTTP_GET_ECHO_BODY
+    log_sink_echo(buf, len);
+#endif
+}
+
+static void group_body_cb(void *ctx, const char *buf, size_t len) {
+    uint32_t t = trace_now();
+    int64_t start = esp_timer_get_time();
+    sites_body_cb(ctx, buf, len);
+    s_parse_us += esp_timer_get_time() - start;
+    s_parse_cycles += trace_now() - t;
+}
 
-    const struct addrinfo hints = {
-        .ai_family = AF_INET,
-        .ai_socktype = SOCK_STREAM,
+/**
+ * @brief Telemetry for the cycle: the reading on the first strip & where the time went
+ */
+static void report_fetch(const http_client_t *client, int status, int64_t dt, int temp_min, int temp_now, int temp_max) {
+    if (!fetch_report_cb) {
+        return;
+    }
+    const fetch_report_t report = {
+        .status = status,
+        .reused = client->timing.reused,
+        .dt = dt,
+        .temp_min = temp_min,
+        .temp_now = temp_now,
+        .temp_max = temp_max,
+        .dns_us = client->timing.dns_us,
+        .connect_us = client->timing.connect_us,
+        .first_byte_us = client->timing.first_byte_us,
+        .parse_us = s_parse_us,
     };
-    struct addrinfo *res;
-    struct in_addr *addr;
-    int s, r;
-    char recv_buf[64];
-    int temp_min;
-    int temp_now;
-    int temp_max;
+    fetch_report_cb(&report);
+}
 
-    while (1) {
-        while (esp_wifi_connect() != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to connect to wifi");
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
+static inline int64_t now_ms(void) {
+    return esp_timer_get_time() / 1000;
+}
+
+/**
+ * @brief WIFI_EVENT & IP_EVENT, on the default event loop: queued for the task,
+ *        which owns the state machine
+ */
+static void net_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data) {
+    uint8_t ev;
+
+    if (base == WIFI_EVENT && id == WIFI_EVENT_STA_CONNECTED) {
+        ev = NET_SM_EV_WIFI_CONNECTED;
+    } else if (base == WIFI_EVENT && id == WIFI_EVENT_STA_DISCONNECTED) {
+        ev = NET_SM_EV_WIFI_DISCONNECTED;
+    } else if (base == IP_EVENT && id == IP_EVENT_STA_GOT_IP) {
+        ev = NET_SM_EV_GOT_IP;
+    } else if (base == IP_EVENT && id == IP_EVENT_STA_LOST_IP) {
+        ev = NET_SM_EV_LOST_IP;
+    } else {
+        return;
+    }
+    if (xQueueSend(s_events, &ev, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Event queue full, Wi-Fi event %" PRId32 " dropped", id);
+    }
+    reactor_wake(&s_reactor);
+}
+
+/* What the station is now: associated, and with an address */
+static void net_link(bool *associated, bool *addressed) {
+    wifi_ap_record_t ap;
+    esp_netif_ip_info_t ip = { 0 };
+    esp_netif_t *sta = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+
+    *associated = esp_wifi_sta_get_ap_info(&ap) == ESP_OK;
+    *addressed = *associated && sta && esp_netif_get_ip_info(sta, &ip) == ESP_OK && ip.ip.addr != 0;
+}
+
+/* The station may have come up before the handlers were registered */
+static bool net_start(void) {
+    esp_event_handler_instance_t wifi_handler = NULL;
+    esp_err_t err = esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, net_event_handler, NULL,
+                                                        &wifi_handler);
+    if (err == ESP_OK) {
+        err = esp_event_handler_instance_register(IP_EVENT, ESP_EVENT_ANY_ID, net_event_handler, NULL, NULL);
+        if (err != ESP_OK) {
+            esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_handler);
         }
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "No Wi-Fi events (%s), polling the link every %d ms", esp_err_to_name(err), NO_WAKE_POLL_MS);
+        s_net_polled = true;
+    }
 
-        int err = getaddrinfo(WEB_SERVER, WEB_PORT, &hints, &res);
+    bool associated, addressed;
+    net_link(&associated, &addressed);
+    return addressed;
+}
 
-        if (err != 0 || res == NULL) {
-            ESP_LOGE(TAG, "DNS lookup failed of %s:%s err=%d res=%p", WEB_SERVER, WEB_PORT, err, res);
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
-            continue;
+/**
+ * @brief Feed an event to the state machine and carry out what it asks.
+ *        A call into the driver that fails is only logged: the attempt
+ *        times out and is retried.
+ */
+static void net_step(net_sm_t *net, net_sm_event_t ev) {
+    bool was_up = net_sm_up(net);
+    esp_err_t err = ESP_OK;
+
+    switch (net_sm_event(net, ev, now_ms())) {
+    case NET_SM_ACT_CONNECT:
+        err = esp_wifi_connect();
+        break;
+    case NET_SM_ACT_DISCONNECT:
+        err = esp_wifi_disconnect();
+        break;
+    case NET_SM_ACT_NONE:
+    default:
+        break;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Wi-Fi %s: %s", ev == NET_SM_EV_TICK ? "retry" : "reconnect", esp_err_to_name(err));
+    }
+    if (was_up != net_sm_up(net)) {
+        net_sm_report(net, s_net_report, sizeof(s_net_report));
+        if (was_up) {
+            ESP_LOGW(TAG, "Network down: %s", s_net_report);
+        } else {
+            ESP_LOGI(TAG, "Network up: %s", s_net_report);
         }
+    }
+}
 
-        /* Code to print the resolved IP.
-        Note: inet_ntoa is non-reentrant, look at ipaddr_ntoa_r for "real" code */
-        addr = &((struct sockaddr_in *)res->ai_addr)->sin_addr;
-        ESP_LOGI(TAG, "DNS lookup succeeded. IP=%s", inet_ntoa(*addr));
+/* Without events: the ones that would have come, from the station's state */
+static void net_poll(net_sm_t *net) {
+    bool associated, addressed;
 
-        s = socket(res->ai_family, res->ai_socktype, 0);
-        if (s < 0) {
-            ESP_LOGE(TAG, "... Failed to allocate socket.");
-            freeaddrinfo(res);
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
-            continue;
+    net_link(&associated, &addressed);
+    if (associated && (net->state == NET_SM_DOWN || net->state == NET_SM_CONNECTING)) {
+        net_step(net, NET_SM_EV_WIFI_CONNECTED);
+    } else if (!associated && net->state != NET_SM_DOWN && net->state != NET_SM_CONNECTING) {
+        net_step(net, NET_SM_EV_WIFI_DISCONNECTED);
+    }
+    if (addressed && net->state == NET_SM_ASSOCIATED) {
+        net_step(net, NET_SM_EV_GOT_IP);
+    } else if (!addressed && net_sm_up(net)) {
+        net_step(net, NET_SM_EV_LOST_IP);
+    }
+}
+
+#if CONFIG_HTTP_GET_PEER
+_Static_assert(CONFIG_HTTP_GET_RX_BUF_LEN >= PEER_CACHE_RESPONSE_MAX, "peer responses are built in a receive buffer");
+
+static void peer_start(void) {
+    uint8_t mac[6];
+    esp_efuse_mac_get_default(mac);
+    const peer_node_config_t cfg = {
+        .id = (uint32_t)mac[2] << 24 | mac[3] << 16 | mac[4] << 8 | mac[5],
+        .upstream_request = UPSTREAM_PATH,
+        .stale_s = CONFIG_HTTP_GET_PEER_STALE_S,
+        .beacon_port = CONFIG_HTTP_GET_PEER_BEACON_PORT,
+        .http_port = CONFIG_HTTP_GET_PEER_HTTP_PORT,
+        .beacon_addr = "255.255.255.255",
+        .beacon_interval_ms = CONFIG_HTTP_GET_PEER_BEACON_INTERVAL_S * 1000,
+    };
+    if (!peer_node_start(&cfg, &s_reactor)) {
+        ESP_LOGE(TAG, "Peer sharing didn't start, fetching upstream only");
+    }
+}
+
+/* What this device serves after fetching upstream: what it shows */
+static void peer_publish(int64_t dt, int temp_min, int temp_now, int temp_max, int64_t server_date) {
+    peer_snapshot_t snap = { 0 };
+    if (GROUP_MODE) {
+        snap.count = s_sites.count;
+        snap.dt = s_sites.sites[0].dt;
+        for (size_t i = 0; i < s_sites.count; i++) {
+            const site_t *site = &s_sites.sites[i];
+            snap.strips[i] = (peer_strip_t){ site->valid, site->temp_min, site->temp_now, site->temp_max };
         }
-        ESP_LOGI(TAG, "... allocated socket");
+    } else {
+        snap.count = 1;
+        snap.dt = dt;
+        snap.strips[0] = (peer_strip_t){ true, temp_min, temp_now, temp_max };
+    }
+    peer_node_publish(&snap, server_date);
+}
 
-        if (connect(s, res->ai_addr, res->ai_addrlen) != 0) {
-            ESP_LOGE(TAG, "... socket connect failed errno=%d", errno);
-            close(s);
-            freeaddrinfo(res);
-            vTaskDelay(4000 / portTICK_PERIOD_MS);
-            continue;
+/* A snapshot read from a peer, into what an upstream fetch would have left. Returns the sites updated. */
+static size_t peer_apply(const peer_snapshot_t *snap, int *temp_min, int *temp_now, int *temp_max, int64_t *dt) {
+    size_t updated = 0;
+    if (GROUP_MODE) {
+        for (size_t i = 0; i < s_sites.count && i < snap->count; i++) {
+            const peer_strip_t *strip = &snap->strips[i];
+            site_t *site = &s_sites.sites[i];
+            site->updated = strip->valid;
+            site->valid = site->valid || strip->valid;
+            if (strip->valid) {
+                site->temp_min = strip->temp_min;
+                site->temp_now = strip->temp_now;
+                site->temp_max = strip->temp_max;
+                site->dt = i == 0 ? snap->dt : 0;
+                updated++;
+            }
         }
+    } else {
+        *temp_min = snap->strips[0].temp_min;
+        *temp_now = snap->strips[0].temp_now;
+        *temp_max = snap->strips[0].temp_max;
+        *dt = snap->dt;
+        updated = 1;
+    }
+    return updated;
+}
+#endif
+
+void http_get_task(void *pvParameters)
+{
+    light_animate_and_set_wrapper_t light_animateSet = (light_animate_and_set_wrapper_t)pvParameters;
+
+    static http_client_t client;
+#if CONFIG_HTTP_GET_PEER
+    peer_snapshot_t snapshot;
+#endif
+#if CONFIG_HTTP_GET_HTTPS
+    static tls_conn_t tls;
+#endif
+    static fetch_sched_t sched;
+    static net_sm_t net;
+    bool deferred = false;
+    char power_buf[192];
+    forecast_agg_t *agg = &s_agg[1];
+    int temp_min = 0;
+    int temp_now = 0;
+    int temp_max = 0;
+    int64_t dt_first = 0;
+    bool have_forecast = false;
 
-        ESP_LOGI(TAG, "... connected");
-        ESP_LOGI(TAG, "Request: %s", REQUEST);
-        freeaddrinfo(res);
+    http_client_init(&client, WEB_SERVER, WEB_PORT, WEB_HOST);
+    http_client_use_reactor(&client, &s_reactor);
+#if CONFIG_HTTP_GET_HTTPS
+    /* The certificate is for the name in the Host header. Without it the
+       upstream fetches fail, but the lights, peers and MQTT carry on. */
+    bool tls_ok = tls_conn_init(&tls, WEB_HOST, NULL, CONFIG_HTTP_GET_TLS_HEAP_MAX);
+    if (tls_ok) {
+        http_client_use_tls(&client, &tls);
+    } else {
+        ESP_LOGE(TAG, "TLS setup failed, not fetching upstream in the clear");
+    }
+#endif
+    fetch_sched_init(&sched, &s_sched_cfg, now_ms(), esp_random());
+    net_sm_init(&net, &s_net_cfg, now_ms(), net_start());
+    if (GROUP_MODE) {
+        ESP_LOGI(TAG, "%u sites, one request for all of them", (unsigned)sites_init(&s_sites, CONFIG_HTTP_GET_CITY_IDS));
+    }
+#if CONFIG_HTTP_GET_PEER
+    peer_start();
+#endif
 
-        if (write(s, REQUEST, strlen(REQUEST)) < 0) {
-            ESP_LOGE(TAG, "... socket send failed");
-            ESP_ERROR_CHECK(close(s));
-            vTaskDelay(4000 / portTICK_PERIOD_MS);
+    while (1) {
+        if (s_net_polled) {
+            net_poll(&net);
+        }
+        /* Up: wait for the next fetch. Down: for the next attempt, or the link. */
+        int64_t delay = fetch_sched_delay_ms(&sched, now_ms());
+        if (!net_sm_up(&net)) {
+            if (delay == 0 && !deferred) {
+                deferred = true;
+                net_sm_fetch_deferred(&net);
+                ESP_LOGI(TAG, "Fetch due, waiting for the network");
+            }
+            delay = net_sm_delay_ms(&net, now_ms());
+        }
+        if (delay != 0) {
+            /* Serve the sockets till then, or till an event or http_get_refresh_now() wakes the reactor */
+            uint8_t ev;
+            if (xQueueReceive(s_events, &ev, 0) != pdTRUE) {
+                if ((s_net_polled || !reactor_can_wake(&s_reactor)) && (delay < 0 || delay > NO_WAKE_POLL_MS)) {
+                    delay = NO_WAKE_POLL_MS;
+                }
+                if (reactor_run(&s_reactor, delay < 0 ? REACTOR_NEVER : now_ms() + delay) < 0) {
+                    vTaskDelay(pdMS_TO_TICKS(NO_WAKE_POLL_MS));     // select() failing returns at once, don't spin on it
+                }
+                continue;
+            }
+            if (ev == EVENT_REFRESH) {
+                ESP_LOGI(TAG, "Refresh requested");
+                fetch_sched_refresh_now(&sched, now_ms());
+            } else {
+                net_step(&net, ev);
+            }
             continue;
         }
-        ESP_LOGI(TAG, "... socket send success");
-
-        struct timeval receiving_timeout;
-        receiving_timeout.tv_sec = 5;
-        receiving_timeout.tv_usec = 0;
-        if (setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &receiving_timeout,
-                sizeof(receiving_timeout)) < 0) {
-            ESP_LOGE(TAG, "... failed to set socket receiving timeout");
-            ESP_ERROR_CHECK(close(s));
-            vTaskDelay(4000 / portTICK_PERIOD_MS);
+        if (!net_sm_up(&net)) {
+            net_step(&net, NET_SM_EV_TICK);
             continue;
         }
-        ESP_LOGI(TAG, "... set socket receiving timeout success");
+        deferred = false;
 
         /* Read HTTP response */
-        temp_now = 99;
-        temp_min = 99;
-        temp_max = -40;
-        do {
-            bzero(recv_buf, sizeof(recv_buf));
-            r = read(s, recv_buf, sizeof(recv_buf)-1);
-            for (int i = 0; i < r; i++) {
-                if (temp_now == 99 && (sscanf(&recv_buf[i], "\"temp\":%d", &temp_now) == 1)) {
-                    printf("temp_now=%d\n", temp_now);
+        power_begin(POWER_FETCH);
+        fetch_sched_on_fetch(&sched, now_ms());
+        s_parse_us = 0;
+        s_parse_cycles = 0;
+        trace_count(TRACE_CTR_FETCHES, 1);
+        int status = 0;
+        http_client_t *used = &client;     // upstream, or the peer read instead
+        size_t peer_updated = 0;
+        if (GROUP_MODE) {
+            sites_begin(&s_sites);
+        } else {
+            /* Into the spare, a 304 slides the one shown */
+            agg = &s_agg[!s_agg_shown];
+            forecast_agg_begin(agg, CONFIG_HTTP_GET_UTC_OFFSET_MIN * 60);
+        }
+#if CONFIG_HTTP_GET_PEER
+        /* A fresh snapshot on the LAN saves the upstream fetch */
+        status = peer_node_fetch(&snapshot);
+        if (status > 0) {
+            used = peer_node_client();
+            if (status == 200) {
+                peer_updated = peer_apply(&snapshot, &temp_min, &temp_now, &temp_max, &dt_first);
+            }
+        }
+#endif
+#if CONFIG_HTTP_GET_HTTPS
+        if (status <= 0 && !tls_ok) {
+            status = -1;
+        } else
+#endif
+        if (status <= 0 && GROUP_MODE) {
+            status = http_client_get(&client, GROUP_PATH, NULL, 0, group_body_cb, &s_sites);
+        } else if (status <= 0) {
+            status = http_client_get(&client, WEB_PATH, NULL, 0, forecast_body_cb, agg);
+#if CONFIG_HTTP_GET_ECHO_BODY
+            log_sink_echo("\n", 1);
+#endif
+        }
+        if (s_parse_cycles) {
+            trace_record(TRACE_PARSE, s_parse_cycles);
+        }
+        power_end(POWER_FETCH);
+        if (status == 200 && !GROUP_MODE && used == &client) {
+            size_t slots = forecast_agg_finish(agg);
+            if (forecast_agg_range(agg, WINDOW, &temp_min, &temp_now, &temp_max, &dt_first)) {
+                s_agg_shown = agg - s_agg;
+            } else if (forecast_agg_range(agg, FORECAST_WINDOW_HORIZON, &temp_min, &temp_now, &temp_max, &dt_first)) {
+                ESP_LOGW(TAG, "None of the %u slots is in the window, showing them all", (unsigned)slots);
+                s_agg_shown = agg - s_agg;
+            } else {
+                ESP_LOGE(TAG, "No forecast slots in the response");
+                status = -1;
+            }
+        } else if (status == 304 && !GROUP_MODE && used == &client && used->resp.date > 0) {
+            /* Same forecast, later time: the window moves on without a body */
+            forecast_agg_t *shown = &s_agg[s_agg_shown];
+            forecast_agg_slide(shown, used->resp.date);
+            if (!forecast_agg_range(shown, WINDOW, &temp_min, &temp_now, &temp_max, &dt_first)) {
+                if (forecast_agg_range(shown, FORECAST_WINDOW_HORIZON, &temp_min, &temp_now, &temp_max, &dt_first)) {
+                    ESP_LOGW(TAG, "None of the kept slots is in the window any more, showing the rest");
+                } else {
+                    /* Nothing left to slide to: the last values aren't current, fetch the body again */
+                    ESP_LOGW(TAG, "Every kept slot has passed, fetching the forecast again");
+                    http_client_forget_validators(used);
+                    status = -1;
                 }
-                int new_temp_min = 99;
-                if (sscanf(&recv_buf[i], "\"temp_min\":%d", &new_temp_min) == 1) {
-                    if (new_temp_min < temp_min) {
-                        temp_min = new_temp_min;
-                        printf("new temp_min=%d\n", temp_min);
-                    }
+            }
+        }
+
+        if (status == 200 && GROUP_MODE) {
+            size_t updated = used == &client ? sites_finish(&s_sites) : peer_updated;
+            for (size_t i = 0; i < s_sites.count; i++) {
+                const site_t *site = &s_sites.sites[i];
+                if (site->updated) {
+                    ESP_LOGI(TAG, "Site %u (%lld): temp_min=" TEMP_C_FMT ", temp_now=" TEMP_C_FMT ", temp_max=" TEMP_C_FMT
+                             ", dt=%lld", (unsigned)i, (long long)site->city_id, TEMP_C_ARGS(site->temp_min),
+                             TEMP_C_ARGS(site->temp_now), TEMP_C_ARGS(site->temp_max), (long long)site->dt);
                 }
-                int new_temp_max = -40;
-                if (sscanf(&recv_buf[i], "\"temp_max\":%d", &new_temp_max) == 1) {
-                    if (new_temp_max > temp_max) {
-                        temp_max = new_temp_max;
-                        printf("new temp_max=%d\n", temp_max);
-                    }
+            }
+            ESP_LOGI(TAG, "%u of %u sites updated, %" PRIu32 " unknown", (unsigned)updated, (unsigned)s_sites.count, s_sites.unknown);
+            /* The history and telemetry are of the first site */
+            const site_t *first = &s_sites.sites[0];
+            if (first->updated) {
+                temp_min = first->temp_min;
+                temp_now = first->temp_now;
+                temp_max = first->temp_max;
+                dt_first = first->dt;
+                if (forecast_record_cb) {
+                    forecast_record_cb(first->dt, first->temp_min, first->temp_now, first->temp_max);
                 }
-                // Output to console
-                putchar(recv_buf[i]);
             }
-        } while (r > 0);
-        putchar('\n');
-        ESP_LOGI(TAG, "... done reading from socket. Last read return=%d errno=%d.", r, errno);
-        ESP_ERROR_CHECK(close(s));
-        light_animateSet(temp_min, temp_now, temp_max);
-
-        for (int countdown = 60; countdown >= 0; countdown--) {
-            ESP_LOGI(TAG, "%d... ", countdown);
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
+            have_forecast = have_forecast || updated > 0;
+        } else if (status == 200) {
+            have_forecast = true;
+            ESP_LOGI(TAG, "temp_min=" TEMP_C_FMT ", temp_now=" TEMP_C_FMT ", temp_max=" TEMP_C_FMT ", dt=%lld, slots=%u",
+                     TEMP_C_ARGS(temp_min), TEMP_C_ARGS(temp_now), TEMP_C_ARGS(temp_max), (long long)dt_first,
+                     (unsigned)(used == &client ? agg->count : 1));
+            if (forecast_record_cb) {
+                forecast_record_cb(dt_first, temp_min, temp_now, temp_max);
+            }
+        } else if (status == 304 && have_forecast) {
+            ESP_LOGI(TAG, "Forecast not modified");
+        } else {
+            ESP_LOGE(TAG, "Fetch failed, status=%d", status);
+            if (status == 304) {
+                http_client_forget_validators(used);
+            }
+            fetch_sched_on_failure(&sched, now_ms());
+            net_sm_fetch_done(&net, false);
+            ESP_LOGI(TAG, "Retry in %lld ms", (long long)fetch_sched_delay_ms(&sched, now_ms()));
+            report_fetch(used, status, dt_first, temp_min, temp_now, temp_max);
+            continue;
+        }
+        /* Current weather has no 3 hour slots to align to. The first slot, not the window's. */
+        int64_t slot_dt = GROUP_MODE ? 0 : used == &client ? s_agg[s_agg_shown].dt0 : dt_first;
+        fetch_sched_on_success(&sched, now_ms(), used->resp.date, slot_dt, used->resp.max_age, status == 304);
+        net_sm_fetch_done(&net, true);
+#if CONFIG_HTTP_GET_PEER
+        if (used == &client) {
+            peer_publish(slot_dt, temp_min, temp_now, temp_max, client.resp.date);
+        } else {
+            ESP_LOGI(TAG, "Read from a peer, upstream not fetched");
+        }
+#endif
+        ESP_LOGI(TAG, "connects=%" PRIu32 " requests=%" PRIu32 " reused=%" PRIu32 " not_modified=%" PRIu32 " dns_lookups=%" PRIu32,
+                 client.stats.connects, client.stats.requests, client.stats.reused, client.stats.not_modified, client.stats.dns_lookups);
+#if CONFIG_HTTP_GET_HTTPS
+        ESP_LOGI(TAG, "tls full=%" PRIu32 " resumed=%" PRIu32 " failed=%" PRIu32 " full_max=%" PRIu32 "ms resumed_max=%" PRIu32 "ms heap_peak=%" PRIu32
+                 " frag_ignored=%" PRIu32,
+                 tls.stats.full, tls.stats.resumed, tls.stats.failed, tls.stats.full_us_max / 1000, tls.stats.resumed_us_max / 1000,
+                 tls.stats.heap_peak, tls.stats.frag_ignored);
+#endif
+        ESP_LOGI(TAG, "body %" PRIu32 " bytes over the air, %" PRIu32 " parsed (total %" PRIu32 " / %" PRIu32 ")",
+                 client.body_wire_bytes, client.body_bytes, client.stats.body_wire_bytes, client.stats.body_bytes);
+        ESP_LOGI(TAG, "Next fetch in %lld s: fetches=%" PRIu32 " avoided=%" PRIu32 " failures=%" PRIu32 " quota=%" PRIu32 "/%d",
+                 (long long)fetch_sched_delay_ms(&sched, now_ms()) / 1000, sched.stats.fetches, sched.stats.avoided,
+                 sched.stats.failures, sched.stats.quota_used, CONFIG_HTTP_GET_DAILY_QUOTA);
+        net_sm_report(&net, s_net_report, sizeof(s_net_report));
+        ESP_LOGI(TAG, "Network: %s", s_net_report);
+        ESP_LOGI(TAG, "Reactor: polls=%" PRIu32 " events=%" PRIu32 " deadlines=%" PRIu32 " timeouts=%" PRIu32
+                 " sockets_peak=%u rx_peak=%u/%d rx_exhausted=%" PRIu32 " failures=%" PRIu32 " dropped=%" PRIu32,
+                 s_reactor.stats.polls, s_reactor.stats.events, s_reactor.stats.deadlines, client.stats.timeouts,
+                 s_reactor.stats.io_peak, s_reactor.stats.rx_peak, CONFIG_HTTP_GET_RX_BUFS, s_reactor.stats.rx_exhausted,
+                 s_reactor.stats.failures, s_reactor.stats.dropped);
+        power_report(power_buf, sizeof(power_buf));
+        ESP_LOGI(TAG, "Power: %s", power_buf);
+        report_fetch(used, status, dt_first, temp_min, temp_now, temp_max);
+        if (GROUP_MODE) {
+            for (size_t i = 0; i < s_sites.count; i++) {
+                const site_t *site = &s_sites.sites[i];
+                if (site->valid) {
+                    light_animateSet(i, site->temp_min, site->temp_now, site->temp_max);
+                }
+            }
+        } else {
+            light_animateSet(0, temp_min, temp_now, temp_max);
         }
-        ESP_LOGI(TAG, "Starting again!");
     }
 }
 
-void http_get_init(void(*light_animate_and_set_cb_remote)(int temp_min, int temp_now, int temp_max)){
+void http_get_init(light_strip_set_cb_t light_animate_and_set_cb_remote, forecast_record_cb_t forecast_record_cb_remote,
+                   fetch_report_cb_t fetch_report_cb_remote){
     light_animate_and_set_cb = light_animate_and_set_cb_remote;
-    xTaskCreate(&http_get_task, "http_get_task", 4096, (void *)&light_animate_and_set_wrapper, 5, NULL);
+    forecast_record_cb = forecast_record_cb_remote;
+    fetch_report_cb = fetch_report_cb_remote;
+    s_events = xQueueCreate(EVENT_QUEUE_LEN, sizeof(uint8_t));
+    reactor_init(&s_reactor);
+    reactor_wake_enable(&s_reactor);
+    for (int i = 0; i < CONFIG_HTTP_GET_RX_BUFS; i++) {
+        reactor_rx_add(&s_reactor, s_rx[i], sizeof(s_rx[i]));
+    }
+    xTaskCreate(&http_get_task, "http_get_task", CONFIG_HTTP_GET_TASK_STACK, (void *)&light_animate_and_set_wrapper, 5, &s_task);
+    trace_watch_task(s_task);
+}
+
+void http_get_refresh_now(void) {
+    const uint8_t ev = EVENT_REFRESH;
+
+    if (s_events) {
+        xQueueSend(s_events, &ev, 0);
+        reactor_wake(&s_reactor);
+    }
 }
\ No newline at end of file
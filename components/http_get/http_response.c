@@ -0,0 +1,253 @@
+/**
+ * @file http_response.c
+ * @author The Authors
+ * @brief Incremental HTTP/1.x response framing (Content-Length / chunked)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Headers are assembled a line at a time into a small fixed buffer; the body
+ * is never copied, slices of the caller's buffer are handed to body_cb.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include "http_response.h"
+
+static bool header_is(const char *line, const char *name, const char **value) {
+    size_t n = strlen(name);
+    if (strncasecmp(line, name, n) != 0 || line[n] != ':') {
+        return false;
+    }
+    const char *v = line + n + 1;
+    while (*v == ' ' || *v == '\t') {
+        v++;
+    }
+    *value = v;
+    return true;
+}
+
+static const char *value_find(const char *value, const char *token) {
+    size_t n = strlen(token);
+    for (; *value; value++) {
+        if (strncasecmp(value, token, n) == 0) {
+            return value;
+        }
+    }
+    return NULL;
+}
+
+static bool value_has(const char *value, const char *token) {
+    return value_find(value, token) != NULL;
+}
+
+static void copy_header(char *dst, size_t dst_len, const char *value) {
+    size_t n = strlen(value);
+    if (n >= dst_len) {
+        dst[0] = '\0';      // a truncated validator is worse than none
+        return;
+    }
+    memcpy(dst, value, n + 1);
+}
+
+/* Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's days_from_civil) */
+static int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+/* IMF-fixdate, the only form servers may send: "Thu, 19 Dec 2024 10:31:02 GMT" */
+static int64_t parse_http_date(const char *value) {
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    char mon[4];
+    int day, year, hour, min, sec;
+
+    if (sscanf(value, "%*3s, %d %3s %d %d:%d:%d", &day, mon, &year, &hour, &min, &sec) != 6) {
+        return -1;
+    }
+    const char *m = strstr(months, mon);
+    if (!m || strlen(mon) != 3 || (m - months) % 3) {
+        return -1;
+    }
+    return days_from_civil(year, (unsigned)((m - months) / 3 + 1), (unsigned)day) * 86400 + hour * 3600 + min * 60 + sec;
+}
+
+static void parse_status_line(http_response_t *resp) {
+    /* "HTTP/1.1 200 OK" */
+    if (resp->line_len < 12 || strncmp(resp->line, "HTTP/1.", 7) != 0) {
+        resp->state = HTTP_RS_ERROR;
+        return;
+    }
+    resp->keep_alive = resp->line[7] == '1';
+    resp->status = atoi(&resp->line[9]);
+    resp->state = HTTP_RS_HEADER_LINE;
+}
+
+static void end_of_headers(http_response_t *resp) {
+    /* No body for 1xx, 204 and 304 */
+    if ((resp->status >= 100 && resp->status < 200) || resp->status == 204 || resp->status == 304) {
+        resp->state = HTTP_RS_DONE;
+    } else if (resp->chunked) {
+        resp->state = HTTP_RS_CHUNK_SIZE;
+    } else if (resp->content_length >= 0) {
+        resp->remaining = resp->content_length;
+        resp->state = resp->remaining > 0 ? HTTP_RS_BODY_LENGTH : HTTP_RS_DONE;
+    } else {
+        resp->keep_alive = false;
+        resp->state = HTTP_RS_BODY_UNTIL_CLOSE;
+    }
+}
+
+static void parse_header_line(http_response_t *resp) {
+    const char *value;
+
+    if (resp->line_len == 0) {
+        end_of_headers(resp);
+    } else if (header_is(resp->line, "Content-Length", &value)) {
+        resp->content_length = strtoll(value, NULL, 10);
+    } else if (header_is(resp->line, "Transfer-Encoding", &value)) {
+        resp->chunked = value_has(value, "chunked");
+    } else if (header_is(resp->line, "Content-Encoding", &value)) {
+        if (strcasecmp(value, "gzip") == 0 || strcasecmp(value, "x-gzip") == 0) {
+            resp->content_encoding = HTTP_ENCODING_GZIP;
+        } else if (strcasecmp(value, "deflate") == 0) {
+            resp->content_encoding = HTTP_ENCODING_DEFLATE;
+        } else if (strcasecmp(value, "identity") != 0) {
+            resp->content_encoding = HTTP_ENCODING_OTHER;
+        }
+    } else if (header_is(resp->line, "Connection", &value)) {
+        if (value_has(value, "close")) {
+            resp->keep_alive = false;
+        } else if (value_has(value, "keep-alive")) {
+            resp->keep_alive = true;
+        }
+    } else if (header_is(resp->line, "ETag", &value)) {
+        copy_header(resp->etag, sizeof(resp->etag), value);
+    } else if (header_is(resp->line, "Last-Modified", &value)) {
+        copy_header(resp->last_modified, sizeof(resp->last_modified), value);
+    } else if (header_is(resp->line, "Date", &value)) {
+        resp->date = parse_http_date(value);
+    } else if (header_is(resp->line, "Cache-Control", &value)) {
+        const char *max_age = value_find(value, "max-age=");
+        if (max_age) {
+            resp->max_age = (int32_t)strtol(max_age + 8, NULL, 10);
+        } else if (value_has(value, "no-cache") || value_has(value, "no-store")) {
+            resp->max_age = 0;
+        }
+    }
+}
+
+static void parse_chunk_size(http_response_t *resp) {
+    char *end;
+    resp->remaining = strtoll(resp->line, &end, 16);
+    if (end == resp->line || resp->remaining < 0) {
+        resp->state = HTTP_RS_ERROR;
+    } else {
+        resp->state = resp->remaining > 0 ? HTTP_RS_CHUNK_DATA : HTTP_RS_TRAILER;
+    }
+}
+
+void http_response_init(http_response_t *resp) {
+    memset(resp, 0, sizeof(*resp));
+    resp->state = HTTP_RS_STATUS_LINE;
+    resp->content_length = -1;
+    resp->date = -1;
+    resp->max_age = -1;
+}
+
+size_t http_response_feed(http_response_t *resp, const char *buf, size_t len, http_response_body_cb_t body_cb, void *ctx) {
+    size_t i = 0;
+
+    while (i < len) {
+        switch (resp->state) {
+        case HTTP_RS_STATUS_LINE:
+        case HTTP_RS_HEADER_LINE:
+        case HTTP_RS_CHUNK_SIZE:
+        case HTTP_RS_CHUNK_DATA_END:
+        case HTTP_RS_TRAILER: {
+            /* Line oriented states: gather up to '\n', dropping '\r' */
+            const char *nl = memchr(buf + i, '\n', len - i);
+            size_t end = nl ? (size_t)(nl - buf) : len;
+            for (size_t j = i; j < end; j++) {
+                if (buf[j] != '\r' && resp->line_len < sizeof(resp->line) - 1) {
+                    resp->line[resp->line_len++] = buf[j];
+                }
+            }
+            if (resp->state == HTTP_RS_STATUS_LINE || resp->state == HTTP_RS_HEADER_LINE) {
+                resp->header_bytes += end - i + (nl ? 1 : 0);
+            }
+            i = nl ? end + 1 : end;
+            if (!nl) {
+                break;
+            }
+            resp->line[resp->line_len] = '\0';
+
+            switch (resp->state) {
+            case HTTP_RS_STATUS_LINE:
+                parse_status_line(resp);
+                break;
+            case HTTP_RS_HEADER_LINE:
+                parse_header_line(resp);
+                break;
+            case HTTP_RS_CHUNK_SIZE:
+                parse_chunk_size(resp);
+                break;
+            case HTTP_RS_CHUNK_DATA_END:
+                resp->state = HTTP_RS_CHUNK_SIZE;
+                break;
+            case HTTP_RS_TRAILER:
+                if (resp->line_len == 0) {
+                    resp->state = HTTP_RS_DONE;
+                }
+                break;
+            default:
+                break;
+            }
+            resp->line_len = 0;
+            break;
+        }
+
+        case HTTP_RS_BODY_LENGTH:
+        case HTTP_RS_CHUNK_DATA:
+        case HTTP_RS_BODY_UNTIL_CLOSE: {
+            size_t n = len - i;
+            if (resp->state != HTTP_RS_BODY_UNTIL_CLOSE && (int64_t)n > resp->remaining) {
+                n = (size_t)resp->remaining;
+            }
+            if (body_cb) {
+                body_cb(ctx, buf + i, n);
+            }
+            resp->body_bytes += n;
+            i += n;
+            if (resp->state != HTTP_RS_BODY_UNTIL_CLOSE) {
+                resp->remaining -= n;
+                if (resp->remaining == 0) {
+                    resp->state = resp->state == HTTP_RS_CHUNK_DATA ? HTTP_RS_CHUNK_DATA_END : HTTP_RS_DONE;
+                }
+            }
+            break;
+        }
+
+        case HTTP_RS_DONE:
+        case HTTP_RS_ERROR:
+            return i;
+        }
+    }
+    return i;
+}
+
+bool http_response_eof(http_response_t *resp) {
+    if (resp->state == HTTP_RS_BODY_UNTIL_CLOSE) {
+        resp->state = HTTP_RS_DONE;
+    } else if (resp->state != HTTP_RS_DONE) {
+        resp->state = HTTP_RS_ERROR;
+    }
+    resp->keep_alive = false;
+    return resp->state == HTTP_RS_DONE;
+}
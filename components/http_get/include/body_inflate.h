@@ -0,0 +1,90 @@
+/**
+ * @file body_inflate.h
+ * @author The Authors
+ * @brief Streaming gzip / deflate decoder between the response framing and the parser
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Fed the compressed body slice by slice as it is read, it hands the
+ * inflated bytes to the body callback as they come out; the body is never
+ * held whole. On the device the raw deflate decoder is the ROM's tinfl
+ * (miniz); on the host, where there is no ROM, zlib stands in for it. The
+ * gzip and zlib wrappers are read here, and the gzip CRC-32 and length or
+ * the zlib Adler-32 checked.
+ *
+ * Deflate may refer back up to 32 KB, and a server's window can't be
+ * negotiated down, so that is the output window. It and the decoder state
+ * (~11 KB) are only allocated between body_inflate_begin() and _end().
+ */
+
+#ifndef __BODY_INFLATE_H
+#define __BODY_INFLATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "http_response.h"
+
+#define BODY_INFLATE_WINDOW     32768
+
+typedef enum {
+    BODY_INFLATE_HEADER = 0,    // gzip or zlib wrapper
+    BODY_INFLATE_DATA,
+    BODY_INFLATE_TRAILER,
+    BODY_INFLATE_DONE,
+    BODY_INFLATE_ERROR,
+} body_inflate_state_t;
+
+typedef struct {
+    http_encoding_t encoding;
+    body_inflate_state_t state;
+    http_response_body_cb_t out_cb;
+    void *out_ctx;
+
+    uint8_t hdr_stage;          // which part of the gzip header
+    uint16_t hdr_left;          // bytes left in it
+    uint16_t hdr_value;         // gzip XLEN
+    uint8_t gzip_flags;
+    uint8_t trailer[8];         // ... and the first two bytes of a deflate body
+    uint8_t trailer_len;
+    uint8_t trailer_want;
+    uint32_t check;             // CRC-32 (gzip) or Adler-32 (zlib) of what came out
+
+    uint32_t in_bytes;          // compressed, as received
+    uint32_t out_bytes;         // inflated, as parsed
+
+    void *decoder;              // tinfl_decompressor, or z_stream on the host
+    uint8_t *window;
+    size_t window_pos;
+} body_inflate_t;
+
+/**
+ * @brief Start a body
+ *
+ * @param z
+ * @param encoding  gzip or deflate (zlib wrapped, or raw as some servers send it)
+ * @param out_cb    receives the inflated body
+ * @param out_ctx
+ * @return false if the encoding isn't one of those or there's no memory
+ */
+bool body_inflate_begin(body_inflate_t *z, http_encoding_t encoding, http_response_body_cb_t out_cb, void *out_ctx);
+
+/**
+ * @brief Feed a slice of compressed body, an http_response_body_cb_t
+ *
+ * @param ctx   the body_inflate_t
+ * @param buf
+ * @param len
+ */
+void body_inflate_feed(void *ctx, const char *buf, size_t len);
+
+/**
+ * @brief Free the decoder
+ *
+ * @return true if the stream was complete and its checks passed
+ */
+bool body_inflate_end(body_inflate_t *z);
+
+#endif // __BODY_INFLATE_H
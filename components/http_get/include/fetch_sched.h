@@ -0,0 +1,115 @@
+/**
+ * @file fetch_sched.h
+ * @author The Authors
+ * @brief Decides when the next forecast fetch is due
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * OpenWeatherMap only changes the forecast when its first 3 hour slot rolls
+ * over, so polling every minute mostly fetches the same data. The next fetch
+ * is aimed just after the rollover, measured on the server's own clock (the
+ * Date header, the device may have no SNTP), or sooner if Cache-Control says
+ * so. Failures back off exponentially with jitter and a rolling 24 hour quota
+ * caps the API calls.
+ *
+ * No FreeRTOS or esp_timer in here: times are passed in, in milliseconds, so
+ * the host test can run days on a virtual clock.
+ */
+
+#ifndef __FETCH_SCHED_H
+#define __FETCH_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FETCH_SCHED_SLOT_S          (3 * 3600)  // OpenWeatherMap forecast step
+#define FETCH_SCHED_LEGACY_POLL_S   60          // the fixed poll this replaces, for stats.avoided
+
+typedef struct {
+    uint32_t min_interval_s;        // never sooner than this after a success
+    uint32_t max_interval_s;        // never later, keeps "now" fresh
+    uint32_t default_interval_s;    // no Date / Cache-Control to go on
+    uint32_t slot_settle_s;         // after the rollover, time for the server to catch up
+    uint32_t backoff_base_s;        // first retry after a failure
+    uint32_t backoff_max_s;
+    uint32_t daily_quota;           // fetches per rolling 24 hours, 0 for no limit
+} fetch_sched_config_t;
+
+typedef struct {
+    uint32_t fetches;
+    uint32_t not_modified;
+    uint32_t failures;
+    uint32_t avoided;               // FETCH_SCHED_LEGACY_POLL_S polls not made
+    uint32_t refresh_now;
+    uint32_t quota_used;            // in the current 24 hour window
+} fetch_sched_stats_t;
+
+typedef struct {
+    fetch_sched_config_t cfg;
+    fetch_sched_stats_t stats;
+    int64_t next_ms;
+    int64_t last_fetch_ms;
+    int64_t window_start_ms;
+    uint32_t failures_in_row;
+    uint32_t rng;
+} fetch_sched_t;
+
+/**
+ * @brief First fetch is due straight away
+ *
+ * @param sched
+ * @param cfg
+ * @param now_ms
+ * @param seed      for the backoff jitter, devices shouldn't retry in step
+ */
+void fetch_sched_init(fetch_sched_t *sched, const fetch_sched_config_t *cfg, int64_t now_ms, uint32_t seed);
+
+/**
+ * @brief How long to wait before the next fetch
+ *
+ * @param sched
+ * @param now_ms
+ * @return int64_t  0 if it's due now
+ */
+int64_t fetch_sched_delay_ms(fetch_sched_t *sched, int64_t now_ms);
+
+/**
+ * @brief A fetch is being made, counts against the quota
+ *
+ * @param sched
+ * @param now_ms
+ */
+void fetch_sched_on_fetch(fetch_sched_t *sched, int64_t now_ms);
+
+/**
+ * @brief The fetch got a 200 or 304
+ *
+ * @param sched
+ * @param now_ms
+ * @param server_date   unix seconds from the Date header, -1 if absent
+ * @param dt_first      unix seconds of the first forecast slot, 0 if unknown
+ * @param max_age       Cache-Control max-age in seconds, -1 if absent
+ * @param not_modified
+ */
+void fetch_sched_on_success(fetch_sched_t *sched, int64_t now_ms, int64_t server_date, int64_t dt_first,
+                            int32_t max_age, bool not_modified);
+
+/**
+ * @brief The fetch failed, back off
+ *
+ * @param sched
+ * @param now_ms
+ */
+void fetch_sched_on_failure(fetch_sched_t *sched, int64_t now_ms);
+
+/**
+ * @brief Make the next fetch due now, the quota still applies
+ *
+ * @param sched
+ * @param now_ms
+ */
+void fetch_sched_refresh_now(fetch_sched_t *sched, int64_t now_ms);
+
+#endif // __FETCH_SCHED_H
@@ -0,0 +1,131 @@
+/**
+ * @file forecast_agg.h
+ * @author The Authors
+ * @brief Min/max of the /forecast slots over time windows, as the body streams in
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * /forecast returns up to 40 slots of 3 hours (5 days). Each slot is folded
+ * in as the parser finishes it: its temperatures are kept (a few bytes, not
+ * the body) and pushed into every window it falls in. A window holds two
+ * monotonic deques of slot indices, rising temp_min and falling temp_max, so
+ * the front of each is the window's min or max and every slot costs O(1)
+ * amortised however long the window.
+ *
+ * Windows are ranges of time from "now": the first slot after a fetch, or
+ * the time passed to forecast_agg_slide() while the forecast is reused (a
+ * 304). Sliding drops the slots that have ended off the front of the deques
+ * and pushes the kept ones that have come into range onto the back, so the
+ * range shown follows the clock between fetches.
+ *
+ * No FreeRTOS or esp_timer in here, the host test runs it as is.
+ */
+
+#ifndef __FORECAST_AGG_H
+#define __FORECAST_AGG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "forecast_parser.h"
+
+#define FORECAST_AGG_SLOTS_MAX  40              // all /forecast returns
+#define FORECAST_AGG_SLOT_S     (3 * 3600)
+#define FORECAST_AGG_DAY_S      (24 * 3600)
+
+typedef enum {
+    FORECAST_WINDOW_HORIZON = 0,    // every slot fetched
+    FORECAST_WINDOW_NEXT_24H,
+    FORECAST_WINDOW_TODAY,          // till the next local midnight
+    FORECAST_WINDOW_TOMORROW,       // the local day after that
+    FORECAST_WINDOWS,
+} forecast_window_kind_t;
+
+typedef struct {
+    uint8_t idx[FORECAST_AGG_SLOTS_MAX];    // slot indices, a slot is pushed once per response
+    uint8_t head;
+    uint8_t tail;
+} forecast_deque_t;
+
+typedef struct {
+    forecast_deque_t lo;        // rising temp_min, the front is the window's min
+    forecast_deque_t hi;        // falling temp_max, the front is its max
+    uint8_t start;              // first slot in the window
+    uint8_t end;                // past the last one
+    uint8_t next;               // next slot to push, start <= next <= end
+} forecast_window_t;
+
+typedef struct {
+    forecast_parser_t parser;
+    int32_t utc_offset_s;       // local time, for the day windows
+    int64_t dt0;                // start of slot 0
+    int64_t now;                // the windows are from here
+    uint8_t count;              // slots so far
+    uint8_t current;            // the slot now is in
+    uint32_t dropped;           // slots out of order or past FORECAST_AGG_SLOTS_MAX
+    int16_t temp[FORECAST_AGG_SLOTS_MAX];       // centi-degrees C
+    int16_t temp_min[FORECAST_AGG_SLOTS_MAX];
+    int16_t temp_max[FORECAST_AGG_SLOTS_MAX];
+    forecast_window_t windows[FORECAST_WINDOWS];
+} forecast_agg_t;
+
+/**
+ * @brief Start a new response: resets the slots and the parser, which reports
+ *        every entry of "list" to the aggregation
+ *
+ * @param agg
+ * @param utc_offset_s  local time - UTC, where the day windows start
+ */
+void forecast_agg_begin(forecast_agg_t *agg, int32_t utc_offset_s);
+
+/**
+ * @brief http_response_body_cb_t for the /forecast body, ctx is the forecast_agg_t
+ */
+void forecast_agg_body_cb(void *ctx, const char *buf, size_t len);
+
+/**
+ * @brief Flush the parser at the end of the body
+ *
+ * @param agg
+ * @return slots read
+ */
+size_t forecast_agg_finish(forecast_agg_t *agg);
+
+/**
+ * @brief Fold in one slot, for bodies that aren't parsed here. Slots must
+ *        come in order, 3 hours apart, as /forecast sends them.
+ *
+ * @param agg
+ * @param dt        start of the slot, unix seconds
+ * @param temp      centi-degrees C
+ * @param temp_min
+ * @param temp_max
+ * @return false if it was dropped
+ */
+bool forecast_agg_slot(forecast_agg_t *agg, int64_t dt, int temp, int temp_min, int temp_max);
+
+/**
+ * @brief Move the windows to a later time, e.g. the server's Date on a 304
+ *
+ * @param agg
+ * @param now   unix seconds, earlier than the windows' is ignored
+ */
+void forecast_agg_slide(forecast_agg_t *agg, int64_t now);
+
+/**
+ * @brief A window's range, and the temperature of its first slot: the one
+ *        now is in, but for tomorrow the first of tomorrow's
+ *
+ * @param agg
+ * @param kind
+ * @param[out] temp_min
+ * @param[out] temp_now
+ * @param[out] temp_max
+ * @param[out] dt       start of that first slot, may be NULL
+ * @return false if no slot is in the window (e.g. tomorrow with too short a horizon)
+ */
+bool forecast_agg_range(const forecast_agg_t *agg, forecast_window_kind_t kind, int *temp_min, int *temp_now,
+                        int *temp_max, int64_t *dt);
+
+#endif // __FORECAST_AGG_H
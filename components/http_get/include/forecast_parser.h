@@ -0,0 +1,116 @@
+/**
+ * @file forecast_parser.h
+ * @author The Authors
+ * @brief Incremental tokenizer for the OpenWeatherMap /forecast response
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Also reads /group (several cities in one response): with an element
+ * callback set, the results are handed over & reset at the end of every
+ * object at that nesting depth, i.e. once per city.
+ */
+
+#ifndef __FORECAST_PARSER_H
+#define __FORECAST_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FORECAST_PARSER_KEY_MAX 8   // strlen("temp_min"), longest key we match
+
+/* Nesting depth of the entries of "list": { "list": [ { ... */
+#define FORECAST_PARSER_LIST_ENTRY_DEPTH    3
+
+typedef enum {
+    FORECAST_PS_SCAN = 0,
+    FORECAST_PS_STRING,
+    FORECAST_PS_ESCAPE,
+    FORECAST_PS_AFTER_STRING,
+    FORECAST_PS_VALUE_START,
+    FORECAST_PS_INT,
+    FORECAST_PS_FRAC,
+} forecast_parser_state_t;
+
+typedef enum {
+    FORECAST_KEY_NONE = 0,
+    FORECAST_KEY_TEMP,
+    FORECAST_KEY_TEMP_MIN,
+    FORECAST_KEY_TEMP_MAX,
+    FORECAST_KEY_DT,
+    FORECAST_KEY_ID,
+} forecast_key_t;
+
+typedef struct forecast_parser forecast_parser_t;
+
+/* End of an element: its results are in parser, reset after the call */
+typedef void (*forecast_element_cb_t)(void *ctx, const forecast_parser_t *parser);
+
+/**
+ * @brief Parser state, kept across read() calls so keys and numbers may
+ *        straddle any buffer boundary.
+ */
+struct forecast_parser {
+    forecast_parser_state_t state;
+    forecast_key_t key;
+    char key_buf[FORECAST_PARSER_KEY_MAX];
+    uint8_t key_len;
+    bool key_overflow;
+    bool negative;
+    int64_t value;          // digits so far, fraction digits included
+    uint8_t frac_digits;
+    uint8_t depth;          // of '{' & '[' outside strings
+
+    forecast_element_cb_t element_cb;   // optional
+    void *element_ctx;
+    uint8_t element_depth;
+
+    /* Results, per element with element_cb set */
+    int temp_now;           // first "temp" seen, centi-degrees C
+    int temp_min;           // lowest "temp_min" seen
+    int temp_max;           // highest "temp_max" seen
+    int64_t dt_first;       // first "dt" seen, 0 if none
+    int64_t dt_last;        // last "dt" seen, 0 if none
+    bool has_temp_now;
+    bool has_temp_min;
+    bool has_temp_max;
+    int64_t id;             // "id" directly in the element, 0 if none
+};
+
+/**
+ * @brief Reset parser to the start of a new response
+ *
+ * @param parser
+ */
+void forecast_parser_init(forecast_parser_t *parser);
+
+/**
+ * @brief Report (and reset) the results per element instead of for the whole
+ *        response. Call after forecast_parser_init().
+ *
+ * @param parser
+ * @param depth     e.g. FORECAST_PARSER_LIST_ENTRY_DEPTH
+ * @param cb
+ * @param ctx
+ */
+void forecast_parser_set_element_cb(forecast_parser_t *parser, uint8_t depth, forecast_element_cb_t cb, void *ctx);
+
+/**
+ * @brief Feed the next chunk of the response. Every byte is looked at once.
+ *
+ * @param parser
+ * @param buf
+ * @param len
+ */
+void forecast_parser_feed(forecast_parser_t *parser, const char *buf, size_t len);
+
+/**
+ * @brief Flush a number still pending at end of stream
+ *
+ * @param parser
+ */
+void forecast_parser_finish(forecast_parser_t *parser);
+
+#endif // __FORECAST_PARSER_H
@@ -0,0 +1,202 @@
+/**
+ * @file http_client.h
+ * @author The Authors
+ * @brief Minimal HTTP/1.1 GET client: keep-alive, cached address, conditional requests, optional TLS
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The socket is non-blocking and driven by a reactor (reactor.h), so each
+ * step has a deadline: connecting, then any wait for the server with
+ * nothing arriving, then the request as a whole. Several clients can be in
+ * flight on one reactor with http_client_start(); http_client_get() waits
+ * for one, running the reactor meanwhile. Only the DNS lookup blocks, and
+ * its answer is cached.
+ */
+
+#ifndef __HTTP_CLIENT_H
+#define __HTTP_CLIENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/sockets.h"
+#include "http_response.h"
+#include "tls_conn.h"
+#include "body_inflate.h"
+#include "reactor.h"
+
+#define HTTP_CLIENT_REQUEST_MAX 512
+
+typedef struct {
+    uint32_t dns_lookups;
+    uint32_t connects;
+    uint32_t requests;
+    uint32_t reused;            // requests sent on an already open connection
+    uint32_t not_modified;      // 304 responses
+    uint32_t errors;
+    uint32_t timeouts;          // ... of them, a deadline passed
+    uint32_t body_wire_bytes;   // bodies as received, de-chunked but still compressed
+    uint32_t body_bytes;        // ... and as handed to body_cb
+} http_client_stats_t;
+
+/* Where the time of the last http_client_get() went, microseconds. A step
+ * that wasn't needed (cached address, reused connection) is 0. */
+typedef struct {
+    uint32_t dns_us;
+    uint32_t connect_us;
+    uint32_t tls_us;            // handshake, when there was one
+    bool tls_resumed;           // ... and it resumed the kept session
+    uint32_t first_byte_us;     // request sent -> first response bytes
+    uint32_t total_us;
+    bool reused;                // sent on an already open connection
+} http_client_timing_t;
+
+/* Called once the request of http_client_start() is over */
+typedef void (*http_client_done_cb_t)(void *ctx, int status);
+
+typedef struct {
+    const char *server;         // name to resolve
+    const char *port;
+    const char *host_header;    // value of the Host: header
+
+    int sock;
+    tls_conn_t *tls;            // NULL for plain HTTP
+    struct sockaddr_in addr;
+    bool addr_valid;
+    uint32_t addr_expiry_tick;
+
+    reactor_t *reactor;         // NULL: http_client_get() runs one of its own
+    reactor_io_t io;
+    uint32_t connect_timeout_ms;    // see http_client_set_timeouts()
+    uint32_t idle_timeout_ms;
+    uint32_t request_timeout_ms;
+
+    char etag[HTTP_RESPONSE_ETAG_MAX];
+    char last_modified[HTTP_RESPONSE_LAST_MODIFIED_MAX];
+    char request[HTTP_CLIENT_REQUEST_MAX];
+
+    http_response_t resp;       // last response, valid after http_client_get()
+    http_client_timing_t timing;    // ... and its timings
+    uint32_t body_wire_bytes;       // ... its body as received
+    uint32_t body_bytes;            // ... and inflated
+    http_client_stats_t stats;
+
+    /* The body on its way to body_cb */
+    http_response_body_cb_t body_cb;
+    void *body_ctx;
+    bool body_started;
+    bool body_failed;
+    bool identity_next;         // no heap to inflate the last body, the next request asks for it uncompressed
+    body_inflate_t inflate;
+
+    /* The request in flight */
+    uint8_t state;
+    uint8_t attempt;
+    bool reused;
+    int request_len;
+    int sent;
+    int64_t started_us;
+    int64_t step_us;            // the step under way
+    int64_t request_deadline_ms;
+    int64_t handshake_deadline_ms;
+    uint32_t trace_t;
+    http_client_done_cb_t done_cb;
+    void *done_ctx;
+} http_client_t;
+
+/**
+ * @brief Prepare a client, nothing is resolved or connected until the first
+ *        GET. The deadlines are the menuconfig ones.
+ *
+ * @param client
+ * @param server
+ * @param port
+ * @param host_header
+ */
+void http_client_init(http_client_t *client, const char *server, const char *port, const char *host_header);
+
+/**
+ * @brief Speak HTTPS: every new connection gets a handshake on tls, which
+ *        resumes the session of the one before where it can
+ *
+ * @param client
+ * @param tls       set up with tls_conn_init()
+ */
+void http_client_use_tls(http_client_t *client, tls_conn_t *tls);
+
+/**
+ * @brief Run on a shared reactor, whose pool the receive buffers then come from
+ *
+ * @param client
+ * @param reactor
+ */
+void http_client_use_reactor(http_client_t *client, reactor_t *reactor);
+
+/**
+ * @brief Set the deadlines, in milliseconds
+ *
+ * @param client
+ * @param connect_ms    TCP connect
+ * @param idle_ms       any wait for the server: TLS handshake step, send,
+ *                      first byte, next bytes
+ * @param request_ms    the whole request, however it's going
+ */
+void http_client_set_timeouts(http_client_t *client, uint32_t connect_ms, uint32_t idle_ms, uint32_t request_ms);
+
+/**
+ * @brief Start a GET on the client's reactor and return; done_cb gets the
+ *        outcome, as http_client_get() would return it. It can be called
+ *        before this returns, if the request fails straight away.
+ *
+ * @param client    on a reactor, and not busy
+ * @param path
+ * @param body_cb
+ * @param ctx
+ * @param done_cb
+ * @param done_ctx
+ * @return false if it wasn't started, done_cb then isn't called
+ */
+bool http_client_start(http_client_t *client, const char *path, http_response_body_cb_t body_cb, void *ctx,
+                       http_client_done_cb_t done_cb, void *done_ctx);
+
+/**
+ * @return true while a request is in flight
+ */
+static inline bool http_client_busy(const http_client_t *client) {
+    return client->state != 0;
+}
+
+/**
+ * @brief GET path, reusing the open connection where possible. A stale
+ *        kept-alive connection is retried once on a fresh one. Returns
+ *        when it's done, the client's reactor serving its other sockets
+ *        meanwhile.
+ *
+ * @param client
+ * @param path
+ * @param recv_buf  scratch receive buffer, unused on a shared reactor
+ * @param recv_len
+ * @param body_cb   receives the de-chunked, inflated body, not called for 304
+ * @param ctx
+ * @return int      HTTP status, or -1 on a network error or a body that
+ *                  didn't inflate
+ */
+int http_client_get(http_client_t *client, const char *path, char *recv_buf, size_t recv_len,
+                    http_response_body_cb_t body_cb, void *ctx);
+
+/**
+ * @brief Close the connection (if any). The cached address is kept.
+ *
+ * @param client
+ */
+void http_client_close(http_client_t *client);
+
+/**
+ * @brief Forget the ETag / Last-Modified so the next GET is unconditional
+ *
+ * @param client
+ */
+void http_client_forget_validators(http_client_t *client);
+
+#endif // __HTTP_CLIENT_H
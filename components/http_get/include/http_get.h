@@ -15,6 +15,13 @@
 #define __HTTP_GET_H
 
 void http_get_task(void *pvParameters);
-void http_get_init(void(*light_animate_and_set_cb_remote)(const int temp_min, const int temp_now, const int temp_max));
+void http_get_init(light_strip_set_cb_t light_animate_and_set_cb_remote, forecast_record_cb_t forecast_record_cb_remote,
+                   fetch_report_cb_t fetch_report_cb_remote);
+
+/**
+ * @brief Fetch now rather than at the scheduled time, still within the
+ *        daily quota. Safe from any task.
+ */
+void http_get_refresh_now(void);
 
 #endif // __HTTP_GET_H
\ No newline at end of file
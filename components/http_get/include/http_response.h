@@ -0,0 +1,105 @@
+/**
+ * @file http_response.h
+ * @author The Authors
+ * @brief Incremental HTTP/1.x response framing (Content-Length / chunked)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __HTTP_RESPONSE_H
+#define __HTTP_RESPONSE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HTTP_RESPONSE_LINE_MAX          128     // longer header lines are truncated
+#define HTTP_RESPONSE_ETAG_MAX          64
+#define HTTP_RESPONSE_LAST_MODIFIED_MAX 40
+
+typedef enum {
+    HTTP_RS_STATUS_LINE = 0,
+    HTTP_RS_HEADER_LINE,
+    HTTP_RS_BODY_LENGTH,
+    HTTP_RS_BODY_UNTIL_CLOSE,
+    HTTP_RS_CHUNK_SIZE,
+    HTTP_RS_CHUNK_DATA,
+    HTTP_RS_CHUNK_DATA_END,
+    HTTP_RS_TRAILER,
+    HTTP_RS_DONE,
+    HTTP_RS_ERROR,
+} http_response_state_t;
+
+typedef enum {
+    HTTP_ENCODING_IDENTITY = 0,
+    HTTP_ENCODING_GZIP,
+    HTTP_ENCODING_DEFLATE,
+    HTTP_ENCODING_OTHER,        // not one asked for
+} http_encoding_t;
+
+/**
+ * @brief Called with each slice of (de-chunked) body, pointing into the
+ *        buffer passed to http_response_feed()
+ */
+typedef void (*http_response_body_cb_t)(void *ctx, const char *buf, size_t len);
+
+typedef struct {
+    http_response_state_t state;
+    char line[HTTP_RESPONSE_LINE_MAX];
+    size_t line_len;
+    int64_t remaining;          // body or chunk bytes still to come
+
+    /* Parsed from the status line & headers */
+    int status;
+    bool keep_alive;
+    bool chunked;
+    http_encoding_t content_encoding;
+    int64_t content_length;     // -1 if absent
+    char etag[HTTP_RESPONSE_ETAG_MAX];
+    char last_modified[HTTP_RESPONSE_LAST_MODIFIED_MAX];
+    int64_t date;               // server clock from "Date:", unix seconds, -1 if absent
+    int32_t max_age;            // "Cache-Control: max-age=", seconds, -1 if absent
+
+    size_t header_bytes;
+    size_t body_bytes;
+} http_response_t;
+
+/**
+ * @brief Reset for the next response on the connection
+ *
+ * @param resp
+ */
+void http_response_init(http_response_t *resp);
+
+/**
+ * @brief Feed bytes read from the socket
+ *
+ * @param resp
+ * @param buf
+ * @param len
+ * @param body_cb   may be NULL to discard the body
+ * @param ctx
+ * @return size_t   bytes consumed, less than len only once the response is done
+ */
+size_t http_response_feed(http_response_t *resp, const char *buf, size_t len, http_response_body_cb_t body_cb, void *ctx);
+
+/**
+ * @brief Tell the parser the peer closed the connection
+ *
+ * @param resp
+ * @return true if that completes the response (body delimited by close)
+ */
+bool http_response_eof(http_response_t *resp);
+
+static inline bool http_response_done(const http_response_t *resp) {
+    return resp->state == HTTP_RS_DONE;
+}
+
+static inline bool http_response_failed(const http_response_t *resp) {
+    return resp->state == HTTP_RS_ERROR;
+}
+
+#endif // __HTTP_RESPONSE_H
@@ -0,0 +1,158 @@
+/**
+ * @file net_sm.h
+ * @author The Authors
+ * @brief The network side of the fetch loop, as a state machine fed Wi-Fi & IP events
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The fetch loop only fetches while the station is up (associated, with an
+ * address). WIFI_EVENT and IP_EVENT notifications move it between states,
+ * and it asks for esp_wifi_connect() itself when the link has gone: straight
+ * away after a drop, then backing off exponentially while attempts keep
+ * failing. An attempt that hears nothing back within connect_timeout_ms
+ * (the AP dropped it, or DHCP stalled) counts as failed, so a silent radio
+ * can't wedge the loop.
+ *
+ * It keeps the numbers for the link: how long each outage took to recover
+ * (a log2 histogram), and how many of the recent fetches succeeded.
+ *
+ * No FreeRTOS or esp_timer in here: events come with the time, in
+ * milliseconds, so the host test can inject faults on a virtual clock.
+ */
+
+#ifndef __NET_SM_H
+#define __NET_SM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define NET_SM_HIST_BUCKETS     12      // reconnect times, see net_sm_hist_limit_ms()
+#define NET_SM_HIST_FIRST_MS    250     // bucket 0 is under this, each one after double
+#define NET_SM_RECENT_FETCHES   32
+
+typedef enum {
+    NET_SM_DOWN = 0,                // waiting to try again
+    NET_SM_CONNECTING,              // esp_wifi_connect() called, not associated yet
+    NET_SM_ASSOCIATED,              // no address yet, or lost it
+    NET_SM_DISCONNECTING,           // gave up on getting an address, waiting to be told it's off
+    NET_SM_UP,
+} net_sm_state_t;
+
+typedef enum {
+    NET_SM_EV_TICK = 0,             // time passed, see net_sm_delay_ms()
+    NET_SM_EV_WIFI_CONNECTED,       // WIFI_EVENT_STA_CONNECTED
+    NET_SM_EV_WIFI_DISCONNECTED,    // WIFI_EVENT_STA_DISCONNECTED
+    NET_SM_EV_GOT_IP,               // IP_EVENT_STA_GOT_IP
+    NET_SM_EV_LOST_IP,              // IP_EVENT_STA_LOST_IP
+} net_sm_event_t;
+
+typedef enum {
+    NET_SM_ACT_NONE = 0,
+    NET_SM_ACT_CONNECT,             // call esp_wifi_connect()
+    NET_SM_ACT_DISCONNECT,          // call esp_wifi_disconnect(), associated but no address
+} net_sm_action_t;
+
+typedef struct {
+    uint32_t connect_timeout_ms;    // an attempt with no outcome by then has failed
+    uint32_t backoff_base_ms;       // wait after the second failed attempt in a row
+    uint32_t backoff_max_ms;
+} net_sm_config_t;
+
+typedef struct {
+    uint32_t connect_attempts;
+    uint32_t connect_failures;      // disconnected or timed out before getting up
+    uint32_t connect_timeouts;      // ... of them, heard nothing back
+    uint32_t drops;                 // went down from up: disconnected, or lost the address
+    uint32_t reconnects;            // back up after a drop
+    uint32_t reconnect_ms_max;
+    uint64_t reconnect_ms_total;
+    uint32_t reconnect_hist[NET_SM_HIST_BUCKETS];
+    uint32_t fetch_ok;
+    uint32_t fetch_failed;
+    uint32_t fetch_deferred;        // came due while down, made once back up
+    uint32_t fetch_recent;          // the last NET_SM_RECENT_FETCHES, bit 0 the latest, 1 ok
+    uint8_t fetch_recent_n;
+} net_sm_stats_t;
+
+typedef struct {
+    net_sm_config_t cfg;
+    net_sm_stats_t stats;
+    net_sm_state_t state;
+    int64_t since_ms;               // entered the state
+    int64_t retry_ms;               // DOWN: when to attempt again
+    int64_t down_ms;                // the drop being recovered from, -1 if none
+    uint32_t failures_in_row;
+} net_sm_t;
+
+/**
+ * @brief Start in the state the station is already in
+ *
+ * @param sm
+ * @param cfg
+ * @param now_ms
+ * @param up        associated with an address, e.g. after example_connect()
+ */
+void net_sm_init(net_sm_t *sm, const net_sm_config_t *cfg, int64_t now_ms, bool up);
+
+/**
+ * @brief Feed one event
+ *
+ * @param sm
+ * @param ev
+ * @param now_ms
+ * @return what the caller should do about it
+ */
+net_sm_action_t net_sm_event(net_sm_t *sm, net_sm_event_t ev, int64_t now_ms);
+
+/**
+ * @brief How long until a NET_SM_EV_TICK is needed
+ *
+ * @param sm
+ * @param now_ms
+ * @return int64_t  0 if one is due now, -1 if none is (up)
+ */
+int64_t net_sm_delay_ms(const net_sm_t *sm, int64_t now_ms);
+
+static inline bool net_sm_up(const net_sm_t *sm) {
+    return sm->state == NET_SM_UP;
+}
+
+/**
+ * @brief A fetch came due while down, and waits for the link
+ *
+ * @param sm
+ */
+void net_sm_fetch_deferred(net_sm_t *sm);
+
+/**
+ * @brief Outcome of a fetch, for the success rate
+ *
+ * @param sm
+ * @param ok    got a 200 or 304
+ */
+void net_sm_fetch_done(net_sm_t *sm, bool ok);
+
+/**
+ * @brief Percentage of the recent fetches that succeeded, 100 before the first
+ */
+uint32_t net_sm_success_pct(const net_sm_t *sm);
+
+/**
+ * @brief Upper end of a reconnect histogram bucket, UINT32_MAX for the last
+ */
+uint32_t net_sm_hist_limit_ms(int bucket);
+
+/**
+ * @brief One line of the counters and histogram, for the log
+ *
+ * @param sm
+ * @param buf
+ * @param len
+ * @return size_t   length written, not counting the NUL
+ */
+size_t net_sm_report(const net_sm_t *sm, char *buf, size_t len);
+
+#endif // __NET_SM_H
@@ -0,0 +1,189 @@
+/**
+ * @file peer_cache.h
+ * @author The Authors
+ * @brief Sharing one upstream fetch between the thermometers on a LAN
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * A device that fetched from OpenWeatherMap is a source: it keeps the
+ * parsed reading as a snapshot, serves it over HTTP and announces itself
+ * with a UDP broadcast beacon. A device that hears a fresh source reads the
+ * snapshot from it instead of the API. Sources defer to the lowest device
+ * ID, so two devices that both fetched upstream settle on one. A device
+ * that knows of no source broadcasts its own beacon, not flagged a source,
+ * before going upstream: sources answer it straight away.
+ *
+ * Beacon, 20 bytes little endian, to CONFIG_HTTP_GET_PEER_BEACON_PORT:
+ *
+ *      0   u32 magic "LTPC"
+ *      4   u8  version
+ *      5   u8  flags, bit 0: a source
+ *      6   u16 HTTP port of the snapshot
+ *      8   u32 device ID
+ *      12  u32 key: hash of the upstream request, peers only share the same one
+ *      16  u32 age of the snapshot (s), all ones if not a source
+ *
+ * Snapshot, the body of GET /peer/forecast, little endian:
+ *
+ *      0   u32 magic "LTPC"
+ *      4   u8  version
+ *      5   u8  strip count
+ *      6   u8  strips with a reading, bit per strip
+ *      7   u8  0
+ *      8   u32 age (s), since the source fetched it
+ *      12  i64 dt of the first strip's reading (unix s)
+ *      20  i16 temp_min, temp_now, temp_max per strip, centi-degrees C
+ *
+ * The response's Date is the upstream clock at the source, less
+ * PEER_CACHE_LAG_S, so a reader's fetch schedule comes in just after the
+ * source's. Its ETag changes with each upstream fetch, so an unchanged
+ * snapshot is a 304.
+ *
+ * No sockets or FreeRTOS in here, peer_node.c has those: times are passed
+ * in, in milliseconds.
+ */
+
+#ifndef __PEER_CACHE_H
+#define __PEER_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sites.h"
+
+#define PEER_CACHE_MAGIC            0x4350544c  // "LTPC"
+#define PEER_CACHE_VERSION          2           // 1 had whole degrees
+#define PEER_CACHE_STRIPS_MAX       SITES_MAX
+#define PEER_CACHE_PEERS_MAX        4
+#define PEER_CACHE_BEACON_LEN       20
+#define PEER_CACHE_SNAPSHOT_MAX     (20 + 6 * PEER_CACHE_STRIPS_MAX)
+#define PEER_CACHE_RESPONSE_MAX     (256 + PEER_CACHE_SNAPSHOT_MAX)
+#define PEER_CACHE_PATH             "/peer/forecast"
+#define PEER_CACHE_LAG_S            30          // readers fetch this long after the source
+#define PEER_CACHE_QUERY_MS         200         // wait for sources to answer a query
+#define PEER_CACHE_HEARD_MS(interval_ms)    (3 * (interval_ms))    // a source not heard for longer is gone
+
+typedef struct {
+    bool valid;
+    int16_t temp_min;       // centi-degrees C
+    int16_t temp_now;
+    int16_t temp_max;
+} peer_strip_t;
+
+typedef struct {
+    uint8_t count;
+    int64_t dt;                 // of the first strip's reading
+    peer_strip_t strips[PEER_CACHE_STRIPS_MAX];
+} peer_snapshot_t;
+
+/* A source heard on the LAN */
+typedef struct {
+    uint32_t id;
+    uint32_t addr;              // IPv4, network order
+    uint16_t port;
+    uint32_t age_s;             // of its snapshot, when heard
+    int64_t heard_ms;
+} peer_t;
+
+typedef struct {
+    uint32_t beacons_heard;
+    uint32_t served;
+    uint32_t not_modified;
+    uint32_t deferred;          // times this source gave way to a lower ID
+} peer_cache_stats_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t key;
+    uint32_t stale_s;           // older snapshots aren't read
+    uint32_t heard_ms;          // sources not heard from for longer are gone
+
+    bool source;                // has a snapshot of its own upstream fetch
+    peer_snapshot_t snapshot;
+    uint32_t seq;               // upstream fetches, for the ETag
+    int64_t server_date;        // upstream Date at the fetch, -1 if none
+    int64_t fetched_ms;
+
+    peer_t peers[PEER_CACHE_PEERS_MAX];
+    size_t peer_count;
+    peer_cache_stats_t stats;
+} peer_cache_t;
+
+/**
+ * @brief Not a source, no peers known
+ *
+ * @param pc
+ * @param id        unique on the LAN, e.g. from the MAC
+ * @param key       peer_cache_key() of the upstream request
+ * @param stale_s
+ * @param heard_ms  PEER_CACHE_HEARD_MS() of the beacon interval
+ */
+void peer_cache_init(peer_cache_t *pc, uint32_t id, uint32_t key, uint32_t stale_s, uint32_t heard_ms);
+
+/**
+ * @brief FNV-1a of the upstream request, so only devices showing the same
+ *        place share
+ */
+uint32_t peer_cache_key(const char *request);
+
+/**
+ * @brief A fresh snapshot from upstream: this device is a source now
+ *
+ * @param server_date   upstream Date, -1 if none
+ */
+void peer_cache_publish(peer_cache_t *pc, const peer_snapshot_t *snap, int64_t server_date, int64_t now_ms);
+
+/**
+ * @brief The source to read from this cycle
+ *
+ * The lowest ID of the sources heard lately whose snapshot isn't stale. A
+ * source with a lower ID than all of those keeps fetching upstream;
+ * otherwise it stops being one.
+ *
+ * @return NULL to fetch upstream
+ */
+const peer_t *peer_cache_pick(peer_cache_t *pc, int64_t now_ms);
+
+/**
+ * @brief Reading from this peer failed, don't try it again until it's heard
+ *        from again
+ */
+void peer_cache_forget(peer_cache_t *pc, uint32_t id);
+
+/**
+ * @brief This device's beacon, flagged a source if it is one
+ *
+ * @param out   PEER_CACHE_BEACON_LEN bytes
+ * @return its length
+ */
+size_t peer_cache_beacon(const peer_cache_t *pc, uint16_t http_port, int64_t now_ms, uint8_t *out);
+
+/**
+ * @brief A beacon came in from addr (network order). Other keys, bad
+ *        beacons and this device's own are ignored.
+ *
+ * @return true if it asks for sources and this device is one: answer with
+ *         a beacon
+ */
+bool peer_cache_heard(peer_cache_t *pc, const uint8_t *buf, size_t len, uint32_t addr, int64_t now_ms);
+
+/**
+ * @brief The whole HTTP response to a request for the snapshot
+ *
+ * @param request   the request head, up to the blank line
+ * @param out       PEER_CACHE_RESPONSE_MAX bytes
+ * @return its length
+ */
+size_t peer_cache_respond(peer_cache_t *pc, const char *request, size_t len, int64_t now_ms, char *out);
+
+/**
+ * @brief Read a snapshot body
+ *
+ * @param age_s     how old it was when served
+ * @return false if it isn't one
+ */
+bool peer_cache_decode(const uint8_t *buf, size_t len, peer_snapshot_t *out, uint32_t *age_s);
+
+#endif // __PEER_CACHE_H
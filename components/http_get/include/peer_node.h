@@ -0,0 +1,83 @@
+/**
+ * @file peer_node.h
+ * @author The Authors
+ * @brief This device on the LAN: serves its snapshot, hears the others', reads from the source
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * On the fetch task's reactor, with no task of its own: it answers GET
+ * /peer/forecast (one short request per connection, read into a pooled
+ * receive buffer), listens for beacons and broadcasts this device's while
+ * it is a source. All of it, the calls below included, is on the one task.
+ * See peer_cache.h for the election and the formats.
+ */
+
+#ifndef __PEER_NODE_H
+#define __PEER_NODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "http_client.h"
+#include "reactor.h"
+#include "peer_cache.h"
+
+typedef struct {
+    uint32_t id;
+    const char *upstream_request;   // its hash is the key
+    uint32_t stale_s;
+    uint16_t beacon_port;
+    uint16_t http_port;             // 0 for any free one, the one bound is announced
+    const char *beacon_addr;        // broadcast address
+    uint32_t beacon_interval_ms;
+} peer_node_config_t;
+
+typedef struct {
+    uint32_t beacons_sent;
+    uint32_t peer_reads;            // snapshots read from a source, 200 or 304
+    uint32_t peer_failures;         // ... that failed, and went upstream instead
+    uint32_t connections;           // to this device's server
+} peer_node_stats_t;
+
+/**
+ * @brief Open the sockets and watch them on reactor
+ *
+ * @param cfg
+ * @param reactor   with at least two receive buffers, one more for each
+ *                  request to be served at once
+ * @return false if a socket couldn't be set up, the device then only
+ *         fetches upstream
+ */
+bool peer_node_start(const peer_node_config_t *cfg, reactor_t *reactor);
+
+/**
+ * @brief This device fetched upstream: serve the result and announce it
+ *
+ * @param snap
+ * @param server_date   upstream Date, -1 if none
+ */
+void peer_node_publish(const peer_snapshot_t *snap, int64_t server_date);
+
+/**
+ * @brief Read the snapshot from the source picked for this cycle, if any.
+ *        The reactor runs meanwhile.
+ *
+ * @param out       the snapshot, on 200
+ * @return HTTP status (200 or 304), 0 if there is no fresh source to read
+ *         from, -1 if reading it failed. Fetch upstream on 0 or -1.
+ */
+int peer_node_fetch(peer_snapshot_t *out);
+
+/**
+ * @brief The client peer_node_fetch() reads with, for the response headers
+ *        and timings
+ */
+http_client_t *peer_node_client(void);
+
+/**
+ * @brief Copy out the counters
+ */
+void peer_node_stats(peer_node_stats_t *out, peer_cache_stats_t *cache_out);
+
+#endif // __PEER_NODE_H
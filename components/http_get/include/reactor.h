@@ -0,0 +1,215 @@
+/**
+ * @file reactor.h
+ * @author The Authors
+ * @brief One select() loop for the non-blocking sockets of the http_get task
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Everything the task talks to on the network (the upstream fetch, the
+ * peer's beacons, its server and its reads) is a reactor_io_t: a socket,
+ * what it waits for on it, and a deadline. One select() waits for all of
+ * them at once, so a slow server holds up its own request and nothing else,
+ * and each kind of traffic costs a few dozen bytes of state instead of a
+ * task and its stack.
+ *
+ * Receive buffers come from a small shared pool. A handler that takes one
+ * and gives it back before returning can always have one, provided the
+ * handlers that hold one between polls (a request head being read) leave
+ * one free, see reactor_rx_spare().
+ *
+ * Handlers run on the task calling reactor_poll(). Only reactor_wake() may
+ * be called from another task. A handler can be called for a socket that
+ * turns out not to be ready after all (another handler closed it and the
+ * number was reused), so its sockets should all be non-blocking.
+ */
+
+#ifndef __REACTOR_H
+#define __REACTOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define REACTOR_IO_MAX      8           // the wake socket's included
+#define REACTOR_RX_MAX      4
+#define REACTOR_NEVER       INT64_MAX   // no deadline
+
+/* What an io waits for */
+#define REACTOR_READ        0x01
+#define REACTOR_WRITE       0x02
+
+/* What its handler is told, REACTOR_DEADLINE only when neither came first */
+#define REACTOR_EV_READ     0x01
+#define REACTOR_EV_WRITE    0x02
+#define REACTOR_EV_DEADLINE 0x04
+
+typedef struct reactor reactor_t;
+typedef struct reactor_io reactor_io_t;
+
+typedef void (*reactor_cb_t)(reactor_t *r, reactor_io_t *io, int events);
+
+struct reactor_io {
+    int fd;                     // -1 for a timer
+    uint8_t want;               // REACTOR_READ | REACTOR_WRITE
+    int64_t deadline_ms;        // reactor_now_ms() time, REACTOR_NEVER for none
+    reactor_cb_t cb;
+    void *ctx;
+    bool added;
+};
+
+typedef struct {
+    uint32_t polls;
+    uint32_t events;            // handler calls
+    uint32_t deadlines;         // ... of them for a deadline
+    uint32_t wakes;
+    uint8_t io_peak;
+    uint8_t rx_peak;            // most receive buffers out at once
+    uint32_t rx_exhausted;      // asked for one with none free
+    uint32_t failures;          // select() failed
+    uint32_t dropped;           // ... ios dropped for a socket closed under them
+} reactor_stats_t;
+
+typedef struct {
+    char *buf;
+    size_t len;
+    bool out;
+} reactor_rx_t;
+
+struct reactor {
+    reactor_io_t *io[REACTOR_IO_MAX];
+    uint8_t n_io;
+    reactor_rx_t rx[REACTOR_RX_MAX];
+    uint8_t n_rx;
+    uint8_t rx_out;
+    reactor_io_t wake;
+    bool woken;
+    reactor_stats_t stats;
+};
+
+/**
+ * @brief An empty reactor: no ios, no buffers, no wake socket
+ *
+ * @param r
+ */
+void reactor_init(reactor_t *r);
+
+/**
+ * @brief Open the loopback socket reactor_wake() sends to
+ *
+ * @param r
+ * @return false if it couldn't be opened, reactor_run() then only returns
+ *         at its deadline
+ */
+bool reactor_wake_enable(reactor_t *r);
+
+static inline bool reactor_can_wake(const reactor_t *r) {
+    return r->wake.fd >= 0;
+}
+
+/**
+ * @brief Make reactor_run() return early. From any task.
+ *
+ * @param r
+ */
+void reactor_wake(reactor_t *r);
+
+/**
+ * @brief Start watching io, as set with reactor_watch(). Adding one that is
+ *        already added does nothing.
+ *
+ * @param r
+ * @param io    zeroed before its first use; stays the caller's, and must
+ *              outlive its reactor_remove()
+ * @return false if REACTOR_IO_MAX are already watched
+ */
+bool reactor_add(reactor_t *r, reactor_io_t *io);
+
+/**
+ * @brief Stop watching io, its handler isn't called again. Safe from a handler.
+ *
+ * @param r
+ * @param io
+ */
+void reactor_remove(reactor_t *r, reactor_io_t *io);
+
+/**
+ * @brief What io waits for next
+ *
+ * @param io
+ * @param fd
+ * @param want          REACTOR_READ | REACTOR_WRITE, 0 for the deadline only
+ * @param deadline_ms   REACTOR_NEVER for none
+ */
+static inline void reactor_watch(reactor_io_t *io, int fd, uint8_t want, int64_t deadline_ms) {
+    io->fd = fd;
+    io->want = want;
+    io->deadline_ms = deadline_ms;
+}
+
+/**
+ * @brief The clock deadlines are in, milliseconds since boot
+ */
+int64_t reactor_now_ms(void);
+
+/**
+ * @brief Wait for the first io to be ready or reach its deadline, but not
+ *        past until_ms, and call the handlers of all that are
+ *
+ * If select() fails because a watched socket was closed, the ios on closed
+ * sockets are removed and their handlers told REACTOR_EV_DEADLINE, so their
+ * owners clean up as after a timeout.
+ *
+ * @param r
+ * @param until_ms  REACTOR_NEVER to wait as long as it takes
+ * @return int      handlers called, -1 if select() failed
+ */
+int reactor_poll(reactor_t *r, int64_t until_ms);
+
+/**
+ * @brief Poll until until_ms or reactor_wake()
+ *
+ * @param r
+ * @param until_ms
+ * @return 1 if woken, 0 at until_ms, -1 if select() failed: it returns
+ *         straight away, so back off before running it again
+ */
+int reactor_run(reactor_t *r, int64_t until_ms);
+
+/**
+ * @brief Give the pool a receive buffer
+ *
+ * @param r
+ * @param buf
+ * @param len
+ * @return false if it already has REACTOR_RX_MAX
+ */
+bool reactor_rx_add(reactor_t *r, char *buf, size_t len);
+
+/**
+ * @brief Take a receive buffer from the pool
+ *
+ * @param r
+ * @param len   its size
+ * @return NULL if they are all out
+ */
+char *reactor_rx_take(reactor_t *r, size_t *len);
+
+/**
+ * @brief Give back a buffer from reactor_rx_take()
+ *
+ * @param r
+ * @param buf
+ */
+void reactor_rx_give(reactor_t *r, char *buf);
+
+/**
+ * @brief Buffers that can be held between polls without starving the
+ *        handlers that only borrow one for a read
+ */
+static inline int reactor_rx_spare(const reactor_t *r) {
+    return r->n_rx - r->rx_out - 1;
+}
+
+#endif // __REACTOR_H
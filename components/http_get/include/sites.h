@@ -0,0 +1,71 @@
+/**
+ * @file sites.h
+ * @author The Authors
+ * @brief Several locations from one OpenWeatherMap /group response
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * One batched request per refresh instead of one per location. /group only
+ * has current weather, so a site's min/max are the range currently observed
+ * around the city rather than the forecast's.
+ */
+
+#ifndef __SITES_H
+#define __SITES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "forecast_parser.h"
+
+#define SITES_MAX   4       // one per strip, /group itself takes up to 20
+
+typedef struct {
+    int64_t city_id;
+    bool valid;             // has a reading, maybe from an earlier response
+    bool updated;           // in the last response
+    int temp_min;           // centi-degrees C
+    int temp_now;
+    int temp_max;
+    int64_t dt;             // time of the reading, unix seconds
+} site_t;
+
+typedef struct {
+    site_t sites[SITES_MAX];
+    size_t count;
+    forecast_parser_t parser;
+    uint32_t unknown;       // entries for a city not asked for, since sites_begin()
+} sites_t;
+
+/**
+ * @brief Sites from a list of OpenWeatherMap city IDs
+ *
+ * @param sites
+ * @param city_ids  comma separated, e.g. "2964574,2643743", extras past SITES_MAX are dropped
+ * @return size_t   number of sites
+ */
+size_t sites_init(sites_t *sites, const char *city_ids);
+
+/**
+ * @brief Before each response
+ *
+ * @param sites
+ */
+void sites_begin(sites_t *sites);
+
+/**
+ * @brief http_response_body_cb_t for the /group body, ctx is the sites_t
+ */
+void sites_body_cb(void *ctx, const char *buf, size_t len);
+
+/**
+ * @brief End of the body
+ *
+ * @param sites
+ * @return size_t   sites updated by this response
+ */
+size_t sites_finish(sites_t *sites);
+
+#endif // __SITES_H
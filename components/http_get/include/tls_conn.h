@@ -0,0 +1,155 @@
+/**
+ * @file tls_conn.h
+ * @author The Authors
+ * @brief TLS over an open socket, with the session kept for resumption
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The first handshake is a full one: certificate chain, ECDHE, a few
+ * hundred ms and tens of KB of heap on an ESP32-C3. Its session (a TLS 1.2
+ * ticket or session ID) is kept after the connection closes, so the next
+ * handshake, e.g. after the server dropped an idle keep-alive connection,
+ * resumes it in one round trip without either.
+ *
+ * mbedTLS allocates through the system heap like every other user of it.
+ * The budget given to tls_conn_init() bounds the records (max_fragment_length)
+ * so that a handshake fits in it, which needs CONFIG_MBEDTLS_DYNAMIC_BUFFER
+ * for the buffers to shrink with them, and only holds if the server agrees;
+ * one that doesn't is warned of and counted in stats.frag_ignored. A
+ * handshake doesn't start with less than the budget free, so it can't take
+ * the last of the heap from the rest. What each handshake took is the rise
+ * in heap use seen between its steps.
+ *
+ * The socket is non-blocking: where it would have to wait, a call returns
+ * TLS_CONN_WANT_READ or TLS_CONN_WANT_WRITE, to be made again once the
+ * socket is ready for that.
+ */
+
+#ifndef __TLS_CONN_H
+#define __TLS_CONN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "mbedtls/ssl.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/x509_crt.h"
+
+#define TLS_CONN_WANT_READ      (-2)
+#define TLS_CONN_WANT_WRITE     (-3)
+
+typedef struct {
+    uint32_t full;              // full handshakes
+    uint32_t resumed;           // abbreviated ones, on a kept session
+    uint32_t failed;
+    uint32_t last_us;           // the last handshake
+    uint32_t full_us_max;
+    uint32_t resumed_us_max;
+    uint32_t last_heap_peak;    // most heap in use above its start, during the last handshake
+    uint32_t heap_peak;         // ... the most of any handshake
+    uint32_t frag_ignored;      // handshakes where the server didn't take up frag_len
+} tls_conn_stats_t;
+
+typedef struct {
+    const char *hostname;       // for SNI and to check the certificate against
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_x509_crt ca;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_ssl_session session;
+    bool have_session;
+    bool setup;                 // ssl holds a connection, from handshake_begin until freed
+    bool open;
+    bool sent_key_exchange;     // this handshake was a full one
+    int sock;
+    int64_t started_us;         // the handshake in progress
+    size_t heap_max;            // 0 for no budget
+    size_t frag_len;            // record content asked for to fit it, 0 for the default
+    size_t heap_base;           // heap in use when the handshake started
+    size_t heap_high;           // ... and the most seen since
+    tls_conn_stats_t stats;
+} tls_conn_t;
+
+/**
+ * @brief Set up the configuration, nothing is connected
+ *
+ * @param tls
+ * @param hostname
+ * @param ca_pem    NUL terminated PEM of the CAs to trust, NULL for the
+ *                  ESP-IDF certificate bundle
+ * @param heap_max  heap budget for a connection (bytes), 0 for none
+ * @return false if the configuration couldn't be set up, or the budget is
+ *         too small even for 512 byte records
+ */
+bool tls_conn_init(tls_conn_t *tls, const char *hostname, const char *ca_pem, size_t heap_max);
+
+/**
+ * @brief Start a handshake on a connected socket, resuming the kept session
+ *        if there is one. The socket stays the caller's to close.
+ *
+ * @param tls
+ * @param sock      non-blocking
+ * @return false if the connection couldn't be set up, or less than the
+ *         budget is free
+ */
+bool tls_conn_handshake_begin(tls_conn_t *tls, int sock);
+
+/**
+ * @brief Take the handshake as far as the socket lets it
+ *
+ * @param tls
+ * @return 0 once done, stats.last_us is how long it took since
+ *         tls_conn_handshake_begin(), TLS_CONN_WANT_READ or _WRITE, or -1
+ *         if it failed
+ */
+int tls_conn_handshake_step(tls_conn_t *tls);
+
+/**
+ * @brief Give up on a handshake in progress, e.g. its deadline passed
+ *
+ * @param tls
+ */
+void tls_conn_handshake_abort(tls_conn_t *tls);
+
+/**
+ * @return true if the last handshake resumed a session
+ */
+static inline bool tls_conn_resumed(const tls_conn_t *tls) {
+    return !tls->sent_key_exchange;
+}
+
+/**
+ * @brief Write some of data. After TLS_CONN_WANT_*, make the same call again.
+ *
+ * @return bytes written, TLS_CONN_WANT_READ or _WRITE, or -1 on error
+ */
+int tls_conn_write(tls_conn_t *tls, const void *data, size_t len);
+
+/**
+ * @brief Read what's there, up to len
+ *
+ * @return bytes read, 0 at the end of the connection, TLS_CONN_WANT_READ or
+ *         _WRITE if nothing is, -1 on error
+ */
+int tls_conn_read(tls_conn_t *tls, void *buf, size_t len);
+
+/**
+ * @brief End the TLS connection, before the socket is closed, or free one
+ *        still in its handshake. The session is kept for the next handshake.
+ *
+ * @param tls
+ */
+void tls_conn_close(tls_conn_t *tls);
+
+/**
+ * @brief Drop the kept session so the next handshake is a full one
+ *
+ * @param tls
+ */
+void tls_conn_forget_session(tls_conn_t *tls);
+
+#endif // __TLS_CONN_H
@@ -0,0 +1,229 @@
+/**
+ * @file net_sm.c
+ * @author The Authors
+ * @brief The network side of the fetch loop, as a state machine fed Wi-Fi & IP events
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "net_sm.h"
+
+#define BACKOFF_SHIFT_MAX   16
+
+static const char *const s_state_names[] = {
+    [NET_SM_DOWN] = "down",
+    [NET_SM_CONNECTING] = "connecting",
+    [NET_SM_ASSOCIATED] = "associated",
+    [NET_SM_DISCONNECTING] = "disconnecting",
+    [NET_SM_UP] = "up",
+};
+
+static void enter(net_sm_t *sm, net_sm_state_t state, int64_t now_ms) {
+    sm->state = state;
+    sm->since_ms = now_ms;
+}
+
+/* Down and due: try now */
+static net_sm_action_t attempt(net_sm_t *sm, int64_t now_ms) {
+    if (now_ms < sm->retry_ms) {
+        return NET_SM_ACT_NONE;
+    }
+    sm->stats.connect_attempts++;
+    enter(sm, NET_SM_CONNECTING, now_ms);
+    return NET_SM_ACT_CONNECT;
+}
+
+/* The first retry is straight away, a second failure in a row starts the backoff */
+static void failed(net_sm_t *sm, int64_t now_ms) {
+    uint32_t shift = sm->failures_in_row < BACKOFF_SHIFT_MAX ? sm->failures_in_row : BACKOFF_SHIFT_MAX;
+    int64_t backoff = 0;
+
+    if (sm->failures_in_row > 0) {
+        backoff = (int64_t)sm->cfg.backoff_base_ms << (shift - 1);
+        if (backoff > sm->cfg.backoff_max_ms) {
+            backoff = sm->cfg.backoff_max_ms;
+        }
+    }
+    sm->failures_in_row++;
+    sm->stats.connect_failures++;
+    sm->retry_ms = now_ms + backoff;
+    enter(sm, NET_SM_DOWN, now_ms);
+}
+
+static void dropped(net_sm_t *sm, int64_t now_ms) {
+    sm->stats.drops++;
+    sm->down_ms = now_ms;
+    sm->failures_in_row = 0;
+    sm->retry_ms = now_ms;
+}
+
+static void came_up(net_sm_t *sm, int64_t now_ms) {
+    if (sm->down_ms >= 0) {
+        uint32_t took = (uint32_t)(now_ms - sm->down_ms);
+        int bucket = 0;
+        while (bucket < NET_SM_HIST_BUCKETS - 1 && took >= net_sm_hist_limit_ms(bucket)) {
+            bucket++;
+        }
+        sm->stats.reconnect_hist[bucket]++;
+        sm->stats.reconnects++;
+        sm->stats.reconnect_ms_total += took;
+        if (took > sm->stats.reconnect_ms_max) {
+            sm->stats.reconnect_ms_max = took;
+        }
+        sm->down_ms = -1;
+    }
+    sm->failures_in_row = 0;
+    enter(sm, NET_SM_UP, now_ms);
+}
+
+void net_sm_init(net_sm_t *sm, const net_sm_config_t *cfg, int64_t now_ms, bool up) {
+    memset(sm, 0, sizeof(*sm));
+    sm->cfg = *cfg;
+    sm->down_ms = -1;
+    sm->retry_ms = now_ms;
+    enter(sm, up ? NET_SM_UP : NET_SM_DOWN, now_ms);
+}
+
+net_sm_action_t net_sm_event(net_sm_t *sm, net_sm_event_t ev, int64_t now_ms) {
+    bool timed_out = now_ms - sm->since_ms >= sm->cfg.connect_timeout_ms;
+
+    switch (ev) {
+    case NET_SM_EV_TICK:
+        if (sm->state == NET_SM_DOWN) {
+            return attempt(sm, now_ms);
+        }
+        if (sm->state == NET_SM_UP || !timed_out) {
+            return NET_SM_ACT_NONE;
+        }
+        if (sm->state == NET_SM_DISCONNECTING) {
+            /* Never told, go ahead anyway */
+            enter(sm, NET_SM_DOWN, now_ms);
+            return attempt(sm, now_ms);
+        }
+        sm->stats.connect_timeouts++;
+        if (sm->state == NET_SM_ASSOCIATED) {
+            /* No address: drop the association first, the retry follows its DISCONNECTED */
+            failed(sm, now_ms);
+            enter(sm, NET_SM_DISCONNECTING, now_ms);
+            return NET_SM_ACT_DISCONNECT;
+        }
+        failed(sm, now_ms);
+        return attempt(sm, now_ms);
+
+    case NET_SM_EV_WIFI_CONNECTED:
+        if (sm->state == NET_SM_DOWN || sm->state == NET_SM_CONNECTING) {
+            enter(sm, NET_SM_ASSOCIATED, now_ms);
+        }
+        return NET_SM_ACT_NONE;
+
+    case NET_SM_EV_GOT_IP:
+        if (sm->state != NET_SM_UP && sm->state != NET_SM_DISCONNECTING) {
+            came_up(sm, now_ms);
+        }
+        return NET_SM_ACT_NONE;
+
+    case NET_SM_EV_LOST_IP:
+        if (sm->state == NET_SM_UP) {
+            dropped(sm, now_ms);
+            enter(sm, NET_SM_ASSOCIATED, now_ms);
+        }
+        return NET_SM_ACT_NONE;
+
+    case NET_SM_EV_WIFI_DISCONNECTED:
+        switch (sm->state) {
+        case NET_SM_UP:
+            dropped(sm, now_ms);
+            return attempt(sm, now_ms);
+        case NET_SM_CONNECTING:
+        case NET_SM_ASSOCIATED:
+            failed(sm, now_ms);
+            return attempt(sm, now_ms);
+        case NET_SM_DISCONNECTING:
+            enter(sm, NET_SM_DOWN, now_ms);
+            return attempt(sm, now_ms);
+        case NET_SM_DOWN:
+        default:
+            return NET_SM_ACT_NONE;
+        }
+    }
+    return NET_SM_ACT_NONE;
+}
+
+int64_t net_sm_delay_ms(const net_sm_t *sm, int64_t now_ms) {
+    int64_t due;
+
+    switch (sm->state) {
+    case NET_SM_UP:
+        return -1;
+    case NET_SM_DOWN:
+        due = sm->retry_ms;
+        break;
+    default:
+        due = sm->since_ms + sm->cfg.connect_timeout_ms;
+        break;
+    }
+    return due > now_ms ? due - now_ms : 0;
+}
+
+void net_sm_fetch_deferred(net_sm_t *sm) {
+    sm->stats.fetch_deferred++;
+}
+
+void net_sm_fetch_done(net_sm_t *sm, bool ok) {
+    if (ok) {
+        sm->stats.fetch_ok++;
+    } else {
+        sm->stats.fetch_failed++;
+    }
+    sm->stats.fetch_recent = sm->stats.fetch_recent << 1 | ok;
+    if (sm->stats.fetch_recent_n < NET_SM_RECENT_FETCHES) {
+        sm->stats.fetch_recent_n++;
+    }
+}
+
+uint32_t net_sm_success_pct(const net_sm_t *sm) {
+    uint32_t n = sm->stats.fetch_recent_n;
+    uint32_t ok = 0;
+
+    if (n == 0) {
+        return 100;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        ok += sm->stats.fetch_recent >> i & 1;
+    }
+    return ok * 100 / n;
+}
+
+uint32_t net_sm_hist_limit_ms(int bucket) {
+    return bucket >= NET_SM_HIST_BUCKETS - 1 ? UINT32_MAX : (uint32_t)NET_SM_HIST_FIRST_MS << bucket;
+}
+
+size_t net_sm_report(const net_sm_t *sm, char *buf, size_t len) {
+    const net_sm_stats_t *st = &sm->stats;
+    size_t used = 0;
+    int n;
+
+    if (len == 0) {
+        return 0;
+    }
+    n = snprintf(buf, len, "%s attempts=%" PRIu32 " failures=%" PRIu32 " timeouts=%" PRIu32 " drops=%" PRIu32
+                 " reconnects=%" PRIu32 " reconnect_ms avg=%" PRIu32 " max=%" PRIu32 " hist=",
+                 s_state_names[sm->state], st->connect_attempts, st->connect_failures, st->connect_timeouts,
+                 st->drops, st->reconnects, st->reconnects ? (uint32_t)(st->reconnect_ms_total / st->reconnects) : 0,
+                 st->reconnect_ms_max);
+    for (int i = 0; n >= 0 && (used += n) < len && i < NET_SM_HIST_BUCKETS; i++) {
+        n = snprintf(buf + used, len - used, "%s%" PRIu32, i ? "/" : "", st->reconnect_hist[i]);
+    }
+    if (n >= 0 && used < len) {
+        n = snprintf(buf + used, len - used, " fetch ok=%" PRIu32 " failed=%" PRIu32 " deferred=%" PRIu32
+                     " recent=%" PRIu32 "%%", st->fetch_ok, st->fetch_failed, st->fetch_deferred,
+                     net_sm_success_pct(sm));
+        used += n > 0 ? n : 0;
+    }
+    return used < len ? used : len - 1;
+}
@@ -0,0 +1,262 @@
+/**
+ * @file peer_cache.c
+ * @author The Authors
+ * @brief Sharing one upstream fetch between the thermometers on a LAN
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include "peer_cache.h"
+
+#define FLAG_SOURCE     0x01
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, v);
+    put_u16(p + 2, v >> 16);
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, v);
+    put_u32(p + 4, v >> 32);
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return p[0] | p[1] << 8;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+void peer_cache_init(peer_cache_t *pc, uint32_t id, uint32_t key, uint32_t stale_s, uint32_t heard_ms) {
+    memset(pc, 0, sizeof(*pc));
+    pc->id = id;
+    pc->key = key;
+    pc->stale_s = stale_s;
+    pc->heard_ms = heard_ms;
+    pc->server_date = -1;
+}
+
+uint32_t peer_cache_key(const char *request) {
+    uint32_t h = 2166136261u;
+    for (; *request; request++) {
+        h = (h ^ (uint8_t)*request) * 16777619u;
+    }
+    return h;
+}
+
+static uint32_t age_s(const peer_cache_t *pc, int64_t now_ms) {
+    return (now_ms - pc->fetched_ms) / 1000;
+}
+
+void peer_cache_publish(peer_cache_t *pc, const peer_snapshot_t *snap, int64_t server_date, int64_t now_ms) {
+    pc->snapshot = *snap;
+    pc->server_date = server_date;
+    pc->fetched_ms = now_ms;
+    pc->source = true;
+    pc->seq++;
+}
+
+static bool fresh(const peer_cache_t *pc, const peer_t *p, int64_t now_ms) {
+    int64_t since = now_ms - p->heard_ms;
+    return since <= pc->heard_ms && p->age_s + since / 1000 <= pc->stale_s;
+}
+
+const peer_t *peer_cache_pick(peer_cache_t *pc, int64_t now_ms) {
+    const peer_t *best = NULL;
+
+    for (size_t i = 0; i < pc->peer_count; i++) {
+        const peer_t *p = &pc->peers[i];
+        if (fresh(pc, p, now_ms) && (!best || p->id < best->id)) {
+            best = p;
+        }
+    }
+    if (!best || (pc->source && pc->id < best->id)) {
+        return NULL;
+    }
+    if (pc->source) {
+        pc->source = false;
+        pc->stats.deferred++;
+    }
+    return best;
+}
+
+void peer_cache_forget(peer_cache_t *pc, uint32_t id) {
+    for (size_t i = 0; i < pc->peer_count; i++) {
+        if (pc->peers[i].id == id) {
+            pc->peers[i] = pc->peers[--pc->peer_count];
+            return;
+        }
+    }
+}
+
+size_t peer_cache_beacon(const peer_cache_t *pc, uint16_t http_port, int64_t now_ms, uint8_t *out) {
+    put_u32(out, PEER_CACHE_MAGIC);
+    out[4] = PEER_CACHE_VERSION;
+    out[5] = pc->source ? FLAG_SOURCE : 0;
+    put_u16(out + 6, http_port);
+    put_u32(out + 8, pc->id);
+    put_u32(out + 12, pc->key);
+    put_u32(out + 16, pc->source ? age_s(pc, now_ms) : UINT32_MAX);
+    return PEER_CACHE_BEACON_LEN;
+}
+
+bool peer_cache_heard(peer_cache_t *pc, const uint8_t *buf, size_t len, uint32_t addr, int64_t now_ms) {
+    if (len < PEER_CACHE_BEACON_LEN || get_u32(buf) != PEER_CACHE_MAGIC || buf[4] != PEER_CACHE_VERSION ||
+        get_u32(buf + 12) != pc->key) {
+        return false;
+    }
+    uint32_t id = get_u32(buf + 8);
+    if (id == pc->id) {
+        return false;                   // broadcasts come back to the sender too
+    }
+    pc->stats.beacons_heard++;
+    if (!(buf[5] & FLAG_SOURCE)) {
+        peer_cache_forget(pc, id);      // a reader now, whatever it was
+        return pc->source;
+    }
+
+    peer_t *p = NULL;
+    for (size_t i = 0; i < pc->peer_count && !p; i++) {
+        if (pc->peers[i].id == id) {
+            p = &pc->peers[i];
+        }
+    }
+    if (!p && pc->peer_count < PEER_CACHE_PEERS_MAX) {
+        p = &pc->peers[pc->peer_count++];
+    }
+    if (!p) {
+        /* Full: take the place of the one heard from longest ago */
+        p = &pc->peers[0];
+        for (size_t i = 1; i < pc->peer_count; i++) {
+            if (pc->peers[i].heard_ms < p->heard_ms) {
+                p = &pc->peers[i];
+            }
+        }
+    }
+    p->id = id;
+    p->addr = addr;
+    p->port = get_u16(buf + 6);
+    p->age_s = get_u32(buf + 16);
+    p->heard_ms = now_ms;
+    return false;
+}
+
+static size_t encode(const peer_cache_t *pc, int64_t now_ms, uint8_t *out) {
+    const peer_snapshot_t *snap = &pc->snapshot;
+    uint8_t valid = 0;
+
+    put_u32(out, PEER_CACHE_MAGIC);
+    out[4] = PEER_CACHE_VERSION;
+    out[5] = snap->count;
+    out[7] = 0;
+    put_u32(out + 8, age_s(pc, now_ms));
+    put_u64(out + 12, snap->dt);
+    uint8_t *p = out + 20;
+    for (size_t i = 0; i < snap->count; i++, p += 6) {
+        const peer_strip_t *s = &snap->strips[i];
+        valid |= s->valid << i;
+        put_u16(p, s->temp_min);
+        put_u16(p + 2, s->temp_now);
+        put_u16(p + 4, s->temp_max);
+    }
+    out[6] = valid;
+    return p - out;
+}
+
+bool peer_cache_decode(const uint8_t *buf, size_t len, peer_snapshot_t *out, uint32_t *age) {
+    if (len < 20 || get_u32(buf) != PEER_CACHE_MAGIC || buf[4] != PEER_CACHE_VERSION ||
+        buf[5] > PEER_CACHE_STRIPS_MAX || len != 20 + 6u * buf[5]) {
+        return false;
+    }
+    memset(out, 0, sizeof(*out));
+    out->count = buf[5];
+    *age = get_u32(buf + 8);
+    out->dt = (int64_t)get_u64(buf + 12);
+    const uint8_t *p = buf + 20;
+    for (size_t i = 0; i < out->count; i++, p += 6) {
+        peer_strip_t *s = &out->strips[i];
+        s->valid = buf[6] >> i & 1;
+        s->temp_min = (int16_t)get_u16(p);
+        s->temp_now = (int16_t)get_u16(p + 2);
+        s->temp_max = (int16_t)get_u16(p + 4);
+    }
+    return true;
+}
+
+/* The value of header name in the request head, NULL if it isn't there */
+static const char *header_value(const char *request, const char *name, size_t *len) {
+    size_t name_len = strlen(name);
+    for (const char *line = strstr(request, "\r\n"); line; line = strstr(line, "\r\n")) {
+        line += 2;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *v = line + name_len + 1;
+            while (*v == ' ') {
+                v++;
+            }
+            const char *end = strstr(v, "\r\n");
+            *len = end ? (size_t)(end - v) : strlen(v);
+            return v;
+        }
+    }
+    return NULL;
+}
+
+size_t peer_cache_respond(peer_cache_t *pc, const char *request, size_t len, int64_t now_ms, char *out) {
+    static const char GET[] = "GET " PEER_CACHE_PATH " ";
+    char etag[24];
+    char date[40] = "";
+    uint8_t body[PEER_CACHE_SNAPSHOT_MAX];
+
+    if (len < sizeof(GET) - 1 || strncmp(request, GET, sizeof(GET) - 1) != 0) {
+        return snprintf(out, PEER_CACHE_RESPONSE_MAX, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    }
+    if (!pc->source) {
+        return snprintf(out, PEER_CACHE_RESPONSE_MAX, "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    }
+
+    snprintf(etag, sizeof(etag), "\"%08x-%u\"", (unsigned)pc->id, (unsigned)pc->seq);
+    if (pc->server_date >= 0) {
+        time_t t = pc->server_date + (now_ms - pc->fetched_ms) / 1000 - PEER_CACHE_LAG_S;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        strftime(date, sizeof(date), "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &tm);
+    }
+
+    size_t match_len;
+    const char *match = header_value(request, "If-None-Match", &match_len);
+    if (match && match_len == strlen(etag) && strncmp(match, etag, match_len) == 0) {
+        pc->stats.not_modified++;
+        return snprintf(out, PEER_CACHE_RESPONSE_MAX, "HTTP/1.1 304 Not Modified\r\nETag: %s\r\n%sConnection: close\r\n\r\n",
+                        etag, date);
+    }
+
+    size_t body_len = encode(pc, now_ms, body);
+    int n = snprintf(out, PEER_CACHE_RESPONSE_MAX,
+                     "HTTP/1.1 200 OK\r\n"
+                     "Content-Type: application/octet-stream\r\n"
+                     "Content-Length: %u\r\n"
+                     "ETag: %s\r\n"
+                     "%s"
+                     "Connection: close\r\n"
+                     "\r\n",
+                     (unsigned)body_len, etag, date);
+    memcpy(out + n, body, body_len);
+    pc->stats.served++;
+    return n + body_len;
+}
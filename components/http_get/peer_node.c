@@ -0,0 +1,334 @@
+/**
+ * @file peer_node.c
+ * @author The Authors
+ * @brief This device on the LAN: serves its snapshot, hears the others', reads from the source
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "lwip/sockets.h"
+#include "peer_node.h"
+
+#define SERVE_MAX                   2       // requests read at once, each holds a receive buffer
+#define REQUEST_TIMEOUT_MS          1000    // a slow peer holds a buffer this long at most
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS  MSG_NOSIGNAL    // a reader gone is an error, not a SIGPIPE on the host
+#else
+#define SEND_FLAGS  0
+#endif
+
+/* A connection to the server, its request head on the way in */
+typedef struct {
+    reactor_io_t io;
+    char *buf;                      // from the pool, NULL while the slot is free
+    size_t cap;
+    size_t len;
+} serve_t;
+
+static const char *TAG = "peer_node";
+
+static peer_node_config_t s_cfg;
+static peer_cache_t s_pc;
+static reactor_t *s_reactor;                // NULL until started
+static peer_node_stats_t s_stats;
+static reactor_io_t s_udp;                  // beacons, and the timer for this device's
+static reactor_io_t s_listen;
+static serve_t s_serve[SERVE_MAX];
+static uint16_t s_http_port;
+
+/* The client for sources, the one it points at, and its snapshot on the way in */
+static http_client_t s_client;
+static uint32_t s_peer_addr;
+static uint16_t s_peer_port;
+static char s_peer_host[16];
+static char s_peer_port_str[6];
+static uint8_t s_body[PEER_CACHE_SNAPSHOT_MAX];
+static size_t s_body_len;
+static bool s_body_overflow;
+
+static inline int64_t now_ms(void) {
+    return esp_timer_get_time() / 1000;
+}
+
+/* Periodic ones only while a source; a reader's asks the sources to answer */
+static void send_beacon(void) {
+    uint8_t beacon[PEER_CACHE_BEACON_LEN];
+    struct sockaddr_in to = {
+        .sin_family = AF_INET,
+        .sin_port = htons(s_cfg.beacon_port),
+    };
+
+    size_t len = peer_cache_beacon(&s_pc, s_http_port, now_ms(), beacon);
+    inet_aton(s_cfg.beacon_addr, &to.sin_addr);
+    if (sendto(s_udp.fd, beacon, len, 0, (struct sockaddr *)&to, sizeof(to)) == (int)len) {
+        s_stats.beacons_sent++;
+    } else {
+        ESP_LOGW(TAG, "Beacon not sent, errno=%d", errno);
+    }
+}
+
+static void receive_beacons(void) {
+    uint8_t buf[PEER_CACHE_BEACON_LEN + 1];
+    struct sockaddr_in from;
+    socklen_t from_len = sizeof(from);
+    int n;
+
+    while ((n = recvfrom(s_udp.fd, buf, sizeof(buf), 0, (struct sockaddr *)&from, &from_len)) > 0) {
+        if (peer_cache_heard(&s_pc, buf, n, from.sin_addr.s_addr, now_ms())) {
+            send_beacon();
+        }
+        from_len = sizeof(from);
+    }
+}
+
+static void udp_cb(reactor_t *r, reactor_io_t *io, int events) {
+    if (events & REACTOR_EV_READ) {
+        receive_beacons();
+    }
+    if (now_ms() >= io->deadline_ms) {
+        if (s_pc.source) {
+            send_beacon();
+        }
+        io->deadline_ms = now_ms() + s_cfg.beacon_interval_ms;
+    }
+}
+
+/* Accept only while a slot and a buffer it can hold are free; the backlog waits meanwhile */
+static void listen_update(void) {
+    bool slot = false;
+    for (int i = 0; i < SERVE_MAX; i++) {
+        slot |= s_serve[i].buf == NULL;
+    }
+    s_listen.want = slot && reactor_rx_spare(s_reactor) > 0 ? REACTOR_READ : 0;
+}
+
+/* Answer with what came of the request head, in a buffer borrowed for the while, and hang up */
+static void serve_end(serve_t *c) {
+    size_t cap;
+
+    if (c->len > 0) {
+        char *response = reactor_rx_take(s_reactor, &cap);
+        if (response && cap >= PEER_CACHE_RESPONSE_MAX) {
+            size_t n = peer_cache_respond(&s_pc, c->buf, c->len, now_ms(), response);
+            /* A few hundred bytes on a fresh connection: its send buffer takes them whole */
+            if (send(c->io.fd, response, n, SEND_FLAGS) != (int)n) {
+                ESP_LOGW(TAG, "Response not sent whole, errno=%d", errno);
+            }
+        } else {
+            ESP_LOGE(TAG, "No %d byte buffer to respond in", PEER_CACHE_RESPONSE_MAX);
+        }
+        if (response) {
+            reactor_rx_give(s_reactor, response);
+        }
+    }
+    reactor_remove(s_reactor, &c->io);
+    close(c->io.fd);
+    reactor_rx_give(s_reactor, c->buf);
+    c->buf = NULL;
+    listen_update();
+}
+
+static void serve_cb(reactor_t *r, reactor_io_t *io, int events) {
+    serve_t *c = io->ctx;
+
+    /* The request head is all there is */
+    while (!(events & REACTOR_EV_DEADLINE) && c->len < c->cap - 1) {
+        int n = recv(io->fd, c->buf + c->len, c->cap - 1 - c->len, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (n <= 0) {
+            break;
+        }
+        c->len += n;
+        c->buf[c->len] = '\0';
+        if (strstr(c->buf, "\r\n\r\n")) {
+            break;
+        }
+    }
+    c->buf[c->len] = '\0';
+    serve_end(c);
+}
+
+static void accept_cb(reactor_t *r, reactor_io_t *io, int events) {
+    serve_t *c = NULL;
+
+    for (int i = 0; i < SERVE_MAX && !c; i++) {
+        c = s_serve[i].buf == NULL ? &s_serve[i] : NULL;
+    }
+    if (!c || reactor_rx_spare(r) <= 0) {
+        listen_update();
+        return;
+    }
+    int s = accept(io->fd, NULL, NULL);
+    if (s < 0) {
+        return;
+    }
+    s_stats.connections++;
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+    c->buf = reactor_rx_take(r, &c->cap);
+    c->len = 0;
+    reactor_watch(&c->io, s, REACTOR_READ, now_ms() + REQUEST_TIMEOUT_MS);
+    c->io.cb = serve_cb;
+    c->io.ctx = c;
+    reactor_add(r, &c->io);
+    listen_update();
+}
+
+static int open_socket(int type, uint16_t port) {
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    int one = 1;
+
+    int s = socket(AF_INET, type, 0);
+    if (s < 0) {
+        return -1;
+    }
+    /* Every device on the host test's loopback listens on the one beacon port */
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (type == SOCK_DGRAM) {
+        setsockopt(s, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+    }
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) != 0 || (type == SOCK_STREAM && listen(s, 2) != 0)) {
+        ESP_LOGE(TAG, "Can't listen on port %u, errno=%d", port, errno);
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+bool peer_node_start(const peer_node_config_t *cfg, reactor_t *reactor) {
+    struct sockaddr_in bound;
+    socklen_t bound_len = sizeof(bound);
+
+    s_cfg = *cfg;
+    peer_cache_init(&s_pc, cfg->id, peer_cache_key(cfg->upstream_request), cfg->stale_s,
+                    PEER_CACHE_HEARD_MS(cfg->beacon_interval_ms));
+    int udp = open_socket(SOCK_DGRAM, cfg->beacon_port);
+    int tcp = open_socket(SOCK_STREAM, cfg->http_port);
+    reactor_watch(&s_udp, udp, REACTOR_READ, 0);      // a beacon straight away, if a source
+    s_udp.cb = udp_cb;
+    reactor_watch(&s_listen, tcp, REACTOR_READ, REACTOR_NEVER);
+    s_listen.cb = accept_cb;
+    if (udp < 0 || tcp < 0 || getsockname(tcp, (struct sockaddr *)&bound, &bound_len) != 0
+            || !reactor_add(reactor, &s_udp) || !reactor_add(reactor, &s_listen)) {
+        reactor_remove(reactor, &s_udp);
+        if (udp >= 0) {
+            close(udp);
+        }
+        if (tcp >= 0) {
+            close(tcp);
+        }
+        return false;
+    }
+    s_http_port = ntohs(bound.sin_port);
+    s_reactor = reactor;
+    http_client_init(&s_client, "", "", "");
+    http_client_use_reactor(&s_client, reactor);
+    listen_update();
+    ESP_LOGI(TAG, "Peer %08x, snapshot on port %u, beacons on %u", (unsigned)cfg->id, s_http_port, cfg->beacon_port);
+    return true;
+}
+
+void peer_node_publish(const peer_snapshot_t *snap, int64_t server_date) {
+    if (!s_reactor) {
+        return;
+    }
+    peer_cache_publish(&s_pc, snap, server_date, now_ms());
+    send_beacon();                      // readers needn't wait for the next one
+}
+
+static void snapshot_body_cb(void *ctx, const char *buf, size_t len) {
+    if (s_body_len + len > sizeof(s_body)) {
+        s_body_overflow = true;
+        return;
+    }
+    memcpy(s_body + s_body_len, buf, len);
+    s_body_len += len;
+}
+
+/* The source to read from; with none known, ask and give them a moment to answer */
+static bool pick(peer_t *out) {
+    const peer_t *p = peer_cache_pick(&s_pc, now_ms());
+    if (p) {
+        *out = *p;
+        return true;
+    }
+    if (s_pc.source) {
+        return false;                   // the source fetches upstream
+    }
+    send_beacon();
+    int64_t until = now_ms() + PEER_CACHE_QUERY_MS;
+    while (now_ms() < until && reactor_poll(s_reactor, until) >= 0) {
+        if ((p = peer_cache_pick(&s_pc, now_ms())) != NULL) {
+            *out = *p;
+            return true;
+        }
+    }
+    return false;
+}
+
+int peer_node_fetch(peer_snapshot_t *out) {
+    if (!s_reactor) {
+        return 0;
+    }
+    peer_t peer;
+    if (!pick(&peer)) {
+        return 0;
+    }
+
+    if (peer.addr != s_peer_addr || peer.port != s_peer_port) {
+        struct in_addr addr = { .s_addr = peer.addr };
+        http_client_close(&s_client);
+        inet_ntop(AF_INET, &addr, s_peer_host, sizeof(s_peer_host));
+        snprintf(s_peer_port_str, sizeof(s_peer_port_str), "%u", peer.port);
+        http_client_init(&s_client, s_peer_host, s_peer_port_str, s_peer_host);
+        http_client_use_reactor(&s_client, s_reactor);
+        s_peer_addr = peer.addr;
+        s_peer_port = peer.port;
+        ESP_LOGI(TAG, "Reading from peer %08x at %s:%s", (unsigned)peer.id, s_peer_host, s_peer_port_str);
+    }
+
+    s_body_len = 0;
+    s_body_overflow = false;
+    int status = http_client_get(&s_client, PEER_CACHE_PATH, NULL, 0, snapshot_body_cb, NULL);
+    uint32_t age = 0;
+    if (status == 200 && (s_body_overflow || !peer_cache_decode(s_body, s_body_len, out, &age) || age > s_cfg.stale_s)) {
+        status = -1;
+    }
+    if (status != 200 && status != 304) {
+        ESP_LOGW(TAG, "Peer %08x failed (status=%d), fetching upstream", (unsigned)peer.id, status);
+        s_stats.peer_failures++;
+        peer_cache_forget(&s_pc, peer.id);
+        return -1;
+    }
+    s_stats.peer_reads++;
+    return status;
+}
+
+http_client_t *peer_node_client(void) {
+    return &s_client;
+}
+
+void peer_node_stats(peer_node_stats_t *out, peer_cache_stats_t *cache_out) {
+    *out = s_stats;
+    if (s_reactor) {
+        *cache_out = s_pc.stats;
+    } else {
+        memset(cache_out, 0, sizeof(*cache_out));
+    }
+}
@@ -0,0 +1,259 @@
+/**
+ * @file reactor.c
+ * @author The Authors
+ * @brief One select() loop for the non-blocking sockets of the http_get task
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "lwip/sockets.h"
+#include "reactor.h"
+
+static const char *TAG = "reactor";
+
+int64_t reactor_now_ms(void) {
+    return esp_timer_get_time() / 1000;
+}
+
+void reactor_init(reactor_t *r) {
+    memset(r, 0, sizeof(*r));
+    r->wake.fd = -1;
+}
+
+/* A wake-up or several: drain them, one return from reactor_run() is enough */
+static void wake_cb(reactor_t *r, reactor_io_t *io, int events) {
+    char buf[8];
+
+    while (recv(io->fd, buf, sizeof(buf), 0) > 0) {
+    }
+    r->woken = true;
+    r->stats.wakes++;
+}
+
+bool reactor_wake_enable(reactor_t *r) {
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addr_len = sizeof(addr);
+
+    if (r->wake.fd >= 0) {
+        return true;
+    }
+    /* Sent to itself: select() can't wait on a queue, but it can on this */
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0) {
+        ESP_LOGE(TAG, "No wake socket, errno=%d", errno);
+        return false;
+    }
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) != 0
+            || getsockname(s, (struct sockaddr *)&addr, &addr_len) != 0
+            || connect(s, (struct sockaddr *)&addr, sizeof(addr)) != 0
+            || fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        ESP_LOGE(TAG, "Wake socket not set up, errno=%d", errno);
+        close(s);
+        return false;
+    }
+    reactor_watch(&r->wake, s, REACTOR_READ, REACTOR_NEVER);
+    r->wake.cb = wake_cb;
+    if (!reactor_add(r, &r->wake)) {
+        close(s);
+        r->wake.fd = -1;
+        return false;
+    }
+    return true;
+}
+
+void reactor_wake(reactor_t *r) {
+    if (r->wake.fd >= 0) {
+        send(r->wake.fd, "", 1, 0);     // a full queue is a wake-up already pending
+    }
+}
+
+bool reactor_add(reactor_t *r, reactor_io_t *io) {
+    if (io->added) {
+        return true;
+    }
+    if (r->n_io == REACTOR_IO_MAX) {
+        ESP_LOGE(TAG, "More than %d sockets to watch", REACTOR_IO_MAX);
+        return false;
+    }
+    r->io[r->n_io++] = io;
+    io->added = true;
+    if (r->n_io > r->stats.io_peak) {
+        r->stats.io_peak = r->n_io;
+    }
+    return true;
+}
+
+void reactor_remove(reactor_t *r, reactor_io_t *io) {
+    if (!io->added) {
+        return;
+    }
+    for (int i = 0; i < r->n_io; i++) {
+        if (r->io[i] == io) {
+            r->io[i] = r->io[--r->n_io];
+            break;
+        }
+    }
+    io->added = false;
+}
+
+/* select() refused the set: drop the ios on sockets closed under them, their owners see a deadline */
+static void drop_closed(reactor_t *r, reactor_io_t **io, int n_io) {
+    for (int i = 0; i < n_io; i++) {
+        if (!io[i]->added || io[i]->fd < 0 || !io[i]->want || fcntl(io[i]->fd, F_GETFL, 0) >= 0 || errno != EBADF) {
+            continue;
+        }
+        ESP_LOGE(TAG, "Socket %d closed while watched, dropped", io[i]->fd);
+        reactor_remove(r, io[i]);
+        r->stats.dropped++;
+        if (io[i] == &r->wake) {
+            r->wake.fd = -1;
+            continue;
+        }
+        io[i]->cb(r, io[i], REACTOR_EV_DEADLINE);
+    }
+}
+
+int reactor_poll(reactor_t *r, int64_t until_ms) {
+    reactor_io_t *io[REACTOR_IO_MAX];
+    int ready[REACTOR_IO_MAX];
+    int n_io = r->n_io;
+    int max_fd = -1;
+    int called = 0;
+    fd_set rd;
+    fd_set wr;
+
+    /* Handlers may add and remove ios, so go by what was there to wait for */
+    memcpy(io, r->io, n_io * sizeof(io[0]));
+    FD_ZERO(&rd);
+    FD_ZERO(&wr);
+    for (int i = 0; i < n_io; i++) {
+        if (io[i]->deadline_ms < until_ms) {
+            until_ms = io[i]->deadline_ms;
+        }
+        if (io[i]->fd < 0 || !io[i]->want) {
+            continue;
+        }
+        if (io[i]->want & REACTOR_READ) {
+            FD_SET(io[i]->fd, &rd);
+        }
+        if (io[i]->want & REACTOR_WRITE) {
+            FD_SET(io[i]->fd, &wr);
+        }
+        if (io[i]->fd > max_fd) {
+            max_fd = io[i]->fd;
+        }
+    }
+
+    struct timeval tv;
+    struct timeval *timeout = NULL;
+    if (until_ms != REACTOR_NEVER) {
+        int64_t wait = until_ms - reactor_now_ms();
+        if (wait < 0) {
+            wait = 0;
+        }
+        tv.tv_sec = wait / 1000;
+        tv.tv_usec = (wait % 1000) * 1000;
+        timeout = &tv;
+    }
+    r->stats.polls++;
+    int n = select(max_fd + 1, &rd, &wr, NULL, timeout);
+    if (n < 0) {
+        int err = errno;
+        if (err == EINTR) {
+            return 0;
+        }
+        ESP_LOGE(TAG, "select() failed, errno=%d", err);
+        r->stats.failures++;
+        if (err == EBADF) {
+            drop_closed(r, io, n_io);
+        }
+        return -1;
+    }
+
+    int64_t now = reactor_now_ms();
+    for (int i = 0; i < n_io; i++) {
+        ready[i] = 0;
+        if (io[i]->fd >= 0 && (io[i]->want & REACTOR_READ) && FD_ISSET(io[i]->fd, &rd)) {
+            ready[i] |= REACTOR_EV_READ;
+        }
+        if (io[i]->fd >= 0 && (io[i]->want & REACTOR_WRITE) && FD_ISSET(io[i]->fd, &wr)) {
+            ready[i] |= REACTOR_EV_WRITE;
+        }
+        if (!ready[i] && io[i]->deadline_ms <= now) {
+            ready[i] = REACTOR_EV_DEADLINE;
+        }
+    }
+    for (int i = 0; i < n_io; i++) {
+        /* Removed by a handler before it: its readiness is stale */
+        if (!ready[i] || !io[i]->added) {
+            continue;
+        }
+        r->stats.events++;
+        if (ready[i] == REACTOR_EV_DEADLINE) {
+            r->stats.deadlines++;
+        }
+        io[i]->cb(r, io[i], ready[i]);
+        called++;
+    }
+    return called;
+}
+
+int reactor_run(reactor_t *r, int64_t until_ms) {
+    int ret = 0;
+
+    while (!r->woken && reactor_now_ms() < until_ms) {
+        if (reactor_poll(r, until_ms) < 0) {
+            ret = -1;
+            break;
+        }
+    }
+    if (r->woken && ret == 0) {
+        ret = 1;
+    }
+    r->woken = false;
+    return ret;
+}
+
+bool reactor_rx_add(reactor_t *r, char *buf, size_t len) {
+    if (r->n_rx == REACTOR_RX_MAX) {
+        return false;
+    }
+    r->rx[r->n_rx++] = (reactor_rx_t){ .buf = buf, .len = len };
+    return true;
+}
+
+char *reactor_rx_take(reactor_t *r, size_t *len) {
+    for (int i = 0; i < r->n_rx; i++) {
+        if (!r->rx[i].out) {
+            r->rx[i].out = true;
+            if (++r->rx_out > r->stats.rx_peak) {
+                r->stats.rx_peak = r->rx_out;
+            }
+            *len = r->rx[i].len;
+            return r->rx[i].buf;
+        }
+    }
+    r->stats.rx_exhausted++;
+    return NULL;
+}
+
+void reactor_rx_give(reactor_t *r, char *buf) {
+    for (int i = 0; i < r->n_rx; i++) {
+        if (r->rx[i].buf == buf && r->rx[i].out) {
+            r->rx[i].out = false;
+            r->rx_out--;
+            return;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file sites.c
+ * @author The Authors
+ * @brief Several locations from one OpenWeatherMap /group response
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "sites.h"
+
+/* Entries come back in request order, but match on the id to be sure */
+static void site_element_cb(void *ctx, const forecast_parser_t *parser) {
+    sites_t *sites = ctx;
+
+    for (size_t i = 0; i < sites->count; i++) {
+        site_t *site = &sites->sites[i];
+        if (site->city_id == parser->id) {
+            if (parser->has_temp_now) {
+                site->temp_now = parser->temp_now;
+                site->temp_min = parser->has_temp_min ? parser->temp_min : parser->temp_now;
+                site->temp_max = parser->has_temp_max ? parser->temp_max : parser->temp_now;
+                site->dt = parser->dt_first;
+                site->valid = true;
+                site->updated = true;
+            }
+            return;
+        }
+    }
+    sites->unknown++;
+}
+
+size_t sites_init(sites_t *sites, const char *city_ids) {
+    memset(sites, 0, sizeof(*sites));
+    while (*city_ids && sites->count < SITES_MAX) {
+        char *end;
+        long long id = strtoll(city_ids, &end, 10);
+        if (end == city_ids) {
+            city_ids++;         // separator or stray character
+            continue;
+        }
+        sites->sites[sites->count++].city_id = id;
+        city_ids = end;
+    }
+    return sites->count;
+}
+
+void sites_begin(sites_t *sites) {
+    for (size_t i = 0; i < sites->count; i++) {
+        sites->sites[i].updated = false;
+    }
+    sites->unknown = 0;
+    forecast_parser_init(&sites->parser);
+    forecast_parser_set_element_cb(&sites->parser, FORECAST_PARSER_LIST_ENTRY_DEPTH, site_element_cb, sites);
+}
+
+void sites_body_cb(void *ctx, const char *buf, size_t len) {
+    forecast_parser_feed(&((sites_t *)ctx)->parser, buf, len);
+}
+
+size_t sites_finish(sites_t *sites) {
+    size_t updated = 0;
+
+    forecast_parser_finish(&sites->parser);
+    for (size_t i = 0; i < sites->count; i++) {
+        updated += sites->sites[i].updated;
+    }
+    return updated;
+}
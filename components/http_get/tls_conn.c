@@ -0,0 +1,373 @@
+/**
+ * @file tls_conn.c
+ * @author The Authors
+ * @brief TLS over an open socket, with the session kept for resumption
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "sdkconfig.h"
+#include "mbedtls/version.h"
+#include "mbedtls/net_sockets.h"
+#include "tls_conn.h"
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_crt_bundle.h"
+#include "esp_heap_caps.h"
+#else
+#include <malloc.h>
+#endif
+
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000 && defined(MBEDTLS_PSA_CRYPTO_C)
+#include "psa/crypto.h"
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS  MSG_NOSIGNAL    // a dead peer is an error, not a SIGPIPE on the host
+#else
+#define SEND_FLAGS  0
+#endif
+
+/* mbedTLS 3 hides the handshake state, 2.x doesn't */
+#ifndef MBEDTLS_PRIVATE
+#define MBEDTLS_PRIVATE(member) member
+#endif
+#define HANDSHAKE_STATE(tls)    ((tls)->ssl.MBEDTLS_PRIVATE(state))
+
+static const char *TAG = "tls_conn";
+
+/* Besides the record buffers: the contexts, certificate chain, ECDHE and
+ * the handshake messages. The host test's full handshake (one P-256
+ * certificate) peaks at about 12.8 KB above its record buffers; this leaves
+ * room for a two or three certificate RSA chain like OpenWeatherMap's. */
+#define TLS_HANDSHAKE_HEAP      24576
+
+/* Smaller records only take less heap if the buffers shrink to them */
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH) || CONFIG_MBEDTLS_DYNAMIC_BUFFER
+#define RECORDS_SHRINK          1
+#else
+#define RECORDS_SHRINK          0
+#endif
+
+/* mbedTLS keeps IDF's allocator, shared with the Wi-Fi supplicant and
+ * anything else on TLS, so the heap is only watched, not capped. */
+static size_t heap_in_use(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return mallinfo2().uordblks;
+#else
+    return heap_caps_get_total_size(MALLOC_CAP_8BIT) - heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#endif
+}
+
+static size_t heap_free(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return SIZE_MAX;
+#else
+    return heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#endif
+}
+
+/* Between handshake steps: the high-water mark of the heap since the start */
+static void heap_sample(tls_conn_t *tls) {
+    size_t in_use = heap_in_use();
+    if (in_use > tls->heap_high) {
+        tls->heap_high = in_use;
+    }
+}
+
+/*
+ * The largest record content that keeps the record buffers and a handshake
+ * within heap_max, asked for with the max_fragment_length extension. Only
+ * with CONFIG_MBEDTLS_DYNAMIC_BUFFER (or MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+ * do the buffers shrink to it; without, a budget the full size buffers
+ * don't fit is refused. The server may still ignore the extension, see
+ * check_records().
+ */
+static bool fit_records(tls_conn_t *tls) {
+    size_t records = MBEDTLS_SSL_IN_CONTENT_LEN + MBEDTLS_SSL_OUT_CONTENT_LEN;
+
+    if (!tls->heap_max || records + TLS_HANDSHAKE_HEAP <= tls->heap_max) {
+        return true;
+    }
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH) && RECORDS_SHRINK
+    static const struct { uint16_t len; unsigned char code; } frags[] = {
+        { 4096, MBEDTLS_SSL_MAX_FRAG_LEN_4096 },
+        { 2048, MBEDTLS_SSL_MAX_FRAG_LEN_2048 },
+        { 1024, MBEDTLS_SSL_MAX_FRAG_LEN_1024 },
+        { 512,  MBEDTLS_SSL_MAX_FRAG_LEN_512 },
+    };
+    for (size_t i = 0; i < sizeof(frags) / sizeof(frags[0]); i++) {
+        size_t out = frags[i].len < MBEDTLS_SSL_OUT_CONTENT_LEN ? frags[i].len : MBEDTLS_SSL_OUT_CONTENT_LEN;
+        if (frags[i].len + out + TLS_HANDSHAKE_HEAP <= tls->heap_max
+                && mbedtls_ssl_conf_max_frag_len(&tls->conf, frags[i].code) == 0) {
+            tls->frag_len = frags[i].len;
+            ESP_LOGI(TAG, "Records of at most %u bytes, to fit %u bytes of heap", frags[i].len, (unsigned)tls->heap_max);
+            return true;
+        }
+    }
+#endif
+    ESP_LOGE(TAG, "%u bytes of heap is too little for TLS%s", (unsigned)tls->heap_max,
+             RECORDS_SHRINK ? "" : " without CONFIG_MBEDTLS_DYNAMIC_BUFFER");
+    return false;
+}
+
+/* Most servers don't take up max_fragment_length: their records, and the
+ * buffer for them, are then full size, over the budget. Warned of rather
+ * than refused, which would leave the device without a forecast. */
+static void check_records(tls_conn_t *tls) {
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    size_t in = mbedtls_ssl_get_input_max_frag_len(&tls->ssl);
+    if (tls->frag_len && in > tls->frag_len) {
+        tls->stats.frag_ignored++;
+        ESP_LOGW(TAG, "Server ignored the %u byte record limit, records of up to %u bytes take the heap over budget",
+                 (unsigned)tls->frag_len, (unsigned)in);
+    }
+#endif
+}
+
+static int bio_send(void *ctx, const unsigned char *buf, size_t len) {
+    tls_conn_t *tls = ctx;
+
+    int n = send(tls->sock, buf, len, SEND_FLAGS);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? MBEDTLS_ERR_SSL_WANT_WRITE : MBEDTLS_ERR_NET_SEND_FAILED;
+    }
+    return n;
+}
+
+static int bio_recv(void *ctx, unsigned char *buf, size_t len) {
+    tls_conn_t *tls = ctx;
+
+    int n = recv(tls->sock, buf, len, 0);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_RECV_FAILED;
+    }
+    return n;
+}
+
+bool tls_conn_init(tls_conn_t *tls, const char *hostname, const char *ca_pem, size_t heap_max) {
+    int err;
+
+    memset(tls, 0, sizeof(*tls));
+    tls->hostname = hostname;
+    tls->sock = -1;
+    tls->heap_max = heap_max;
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000 && defined(MBEDTLS_PSA_CRYPTO_C)
+    psa_crypto_init();
+#endif
+
+    mbedtls_ssl_init(&tls->ssl);
+    mbedtls_ssl_config_init(&tls->conf);
+    mbedtls_x509_crt_init(&tls->ca);
+    mbedtls_entropy_init(&tls->entropy);
+    mbedtls_ctr_drbg_init(&tls->drbg);
+    mbedtls_ssl_session_init(&tls->session);
+
+    err = mbedtls_ctr_drbg_seed(&tls->drbg, mbedtls_entropy_func, &tls->entropy, (const unsigned char *)TAG, strlen(TAG));
+    if (err != 0) {
+        ESP_LOGE(TAG, "mbedtls_ctr_drbg_seed returned -0x%04x", -err);
+        return false;
+    }
+    err = mbedtls_ssl_config_defaults(&tls->conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    if (err != 0) {
+        ESP_LOGE(TAG, "mbedtls_ssl_config_defaults returned -0x%04x", -err);
+        return false;
+    }
+    mbedtls_ssl_conf_authmode(&tls->conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_rng(&tls->conf, mbedtls_ctr_drbg_random, &tls->drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&tls->conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+#if MBEDTLS_VERSION_NUMBER >= 0x03020000
+    /* A TLS 1.3 ticket only comes after the handshake; 1.2's is what's kept here */
+    mbedtls_ssl_conf_max_tls_version(&tls->conf, MBEDTLS_SSL_VERSION_TLS1_2);
+#endif
+
+    if (ca_pem) {
+        err = mbedtls_x509_crt_parse(&tls->ca, (const unsigned char *)ca_pem, strlen(ca_pem) + 1);
+        if (err != 0) {
+            ESP_LOGE(TAG, "mbedtls_x509_crt_parse returned -0x%04x", -err);
+            return false;
+        }
+        mbedtls_ssl_conf_ca_chain(&tls->conf, &tls->ca, NULL);
+    } else {
+#if CONFIG_IDF_TARGET_LINUX
+        ESP_LOGE(TAG, "No certificate bundle on the host, give a CA");
+        return false;
+#else
+        if (esp_crt_bundle_attach(&tls->conf) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to attach the certificate bundle");
+            return false;
+        }
+#endif
+    }
+    return fit_records(tls);
+}
+
+/* mbedTLS's would-block codes as the caller's */
+static int want(int err) {
+    return err == MBEDTLS_ERR_SSL_WANT_WRITE ? TLS_CONN_WANT_WRITE : TLS_CONN_WANT_READ;
+}
+
+static bool would_block(int err) {
+    return err == MBEDTLS_ERR_SSL_WANT_READ || err == MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+bool tls_conn_handshake_begin(tls_conn_t *tls, int sock) {
+    int err;
+
+    tls_conn_close(tls);    // never set up over a live context
+    tls->sock = sock;
+    tls->open = false;
+    tls->sent_key_exchange = false;
+    tls->started_us = esp_timer_get_time();
+
+    /* Not when it could take the last of the heap from the rest */
+    size_t avail = heap_free();
+    if (avail < tls->heap_max) {
+        ESP_LOGE(TAG, "%u bytes of heap free, a handshake may need %u", (unsigned)avail, (unsigned)tls->heap_max);
+        tls->stats.failed++;
+        return false;
+    }
+    tls->heap_base = heap_in_use();
+    tls->heap_high = tls->heap_base;
+
+    /* Set up afresh: the record buffers are only held while connected */
+    mbedtls_ssl_init(&tls->ssl);
+    err = mbedtls_ssl_setup(&tls->ssl, &tls->conf);
+    if (err == 0) {
+        err = mbedtls_ssl_set_hostname(&tls->ssl, tls->hostname);
+    }
+    if (err != 0) {
+        ESP_LOGE(TAG, "mbedtls_ssl_setup returned -0x%04x", -err);
+        tls->stats.failed++;
+        mbedtls_ssl_free(&tls->ssl);
+        return false;
+    }
+    tls->setup = true;
+    heap_sample(tls);
+    mbedtls_ssl_set_bio(&tls->ssl, tls, bio_send, bio_recv, NULL);
+    if (tls->have_session && mbedtls_ssl_set_session(&tls->ssl, &tls->session) != 0) {
+        tls_conn_forget_session(tls);
+    }
+    return true;
+}
+
+/* The handshake is over, one way or the other */
+static void handshake_end(tls_conn_t *tls) {
+    tls->stats.last_us = esp_timer_get_time() - tls->started_us;
+    tls->stats.last_heap_peak = tls->heap_high - tls->heap_base;
+    tls->stats.heap_peak = tls->stats.last_heap_peak > tls->stats.heap_peak ? tls->stats.last_heap_peak : tls->stats.heap_peak;
+    if (tls->heap_max && tls->stats.last_heap_peak > tls->heap_max) {
+        ESP_LOGW(TAG, "Handshake took %" PRIu32 " bytes of heap, over the %u budgeted", tls->stats.last_heap_peak,
+                 (unsigned)tls->heap_max);
+    }
+}
+
+int tls_conn_handshake_step(tls_conn_t *tls) {
+    int err = 0;
+
+    /* A step at a time, as mbedtls_ssl_handshake() would, to see the way it
+     * goes: a resumed handshake jumps from the ServerHello to the server's
+     * ChangeCipherSpec, only a full one gets to the ClientKeyExchange */
+    while (err == 0 && HANDSHAKE_STATE(tls) != MBEDTLS_SSL_HANDSHAKE_OVER) {
+        if (HANDSHAKE_STATE(tls) == MBEDTLS_SSL_CLIENT_KEY_EXCHANGE) {
+            tls->sent_key_exchange = true;
+        }
+        err = mbedtls_ssl_handshake_step(&tls->ssl);
+    }
+    heap_sample(tls);
+    if (would_block(err)) {
+        return want(err);
+    }
+    handshake_end(tls);
+    if (err != 0) {
+        ESP_LOGE(TAG, "Handshake failed -0x%04x, verify flags 0x%" PRIx32, -err, (uint32_t)mbedtls_ssl_get_verify_result(&tls->ssl));
+        tls_conn_forget_session(tls);   // in case it was the session that was refused
+        tls->stats.failed++;
+        mbedtls_ssl_free(&tls->ssl);
+        tls->setup = false;
+        return -1;
+    }
+    tls->open = true;
+    check_records(tls);
+
+    if (tls->sent_key_exchange) {
+        tls->stats.full++;
+        tls->stats.full_us_max = tls->stats.last_us > tls->stats.full_us_max ? tls->stats.last_us : tls->stats.full_us_max;
+    } else {
+        tls->stats.resumed++;
+        tls->stats.resumed_us_max = tls->stats.last_us > tls->stats.resumed_us_max ? tls->stats.last_us : tls->stats.resumed_us_max;
+    }
+
+    /* Kept for the next connection, with its ticket if the server gave one */
+    mbedtls_ssl_session_free(&tls->session);
+    mbedtls_ssl_session_init(&tls->session);
+    tls->have_session = mbedtls_ssl_get_session(&tls->ssl, &tls->session) == 0;
+    return 0;
+}
+
+void tls_conn_handshake_abort(tls_conn_t *tls) {
+    handshake_end(tls);
+    tls->stats.failed++;
+    mbedtls_ssl_free(&tls->ssl);
+    tls->setup = false;
+}
+
+int tls_conn_write(tls_conn_t *tls, const void *data, size_t len) {
+    int n = mbedtls_ssl_write(&tls->ssl, data, len);
+    if (would_block(n)) {
+        return want(n);
+    }
+    if (n < 0) {
+        ESP_LOGE(TAG, "mbedtls_ssl_write returned -0x%04x", -n);
+        return -1;
+    }
+    return n;
+}
+
+int tls_conn_read(tls_conn_t *tls, void *buf, size_t len) {
+    int n = mbedtls_ssl_read(&tls->ssl, buf, len);
+    if (n >= 0) {
+        return n;
+    }
+    if (would_block(n)) {
+        return want(n);
+    }
+    if (n == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY || n == MBEDTLS_ERR_SSL_CONN_EOF) {
+        return 0;
+    }
+    ESP_LOGI(TAG, "mbedtls_ssl_read returned -0x%04x", -n);
+    return -1;
+}
+
+void tls_conn_close(tls_conn_t *tls) {
+    if (!tls->setup) {
+        return;
+    }
+    if (!tls->open) {
+        tls_conn_handshake_abort(tls);          // still in the handshake, e.g. the reactor failed
+        tls->sock = -1;
+        return;
+    }
+    mbedtls_ssl_close_notify(&tls->ssl);    // best effort, the peer may be gone
+    mbedtls_ssl_free(&tls->ssl);
+    tls->setup = false;
+    tls->open = false;
+    tls->sock = -1;
+}
+
+void tls_conn_forget_session(tls_conn_t *tls) {
+    mbedtls_ssl_session_free(&tls->session);
+    mbedtls_ssl_session_init(&tls->session);
+    tls->have_session = false;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file test_light_driver.h
+ * @author The Authors
+ * @brief Test groups of the light_driver host test
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+void run_light_tables_tests(void);
+void run_light_fb_tests(void);
+void run_light_seq_tests(void);
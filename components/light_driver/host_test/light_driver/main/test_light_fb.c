@@ -0,0 +1,200 @@
+/**
+ * @file test_light_fb.c
+ * @author The Authors
+ * @brief Host tests for the light_driver framebuffer & animation
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "led_strip.h"
+#include "light_driver.h"
+#include "light_fb.h"
+#include "light_anim.h"
+#include "test_light_driver.h"
+
+#define ANIMATION_TICKS_MAX 1000
+
+static const light_display_state_t s_state = {
+    .temp_min = -300,       // centi-degrees, whole ones draw as the old animation did
+    .temp_now = 700,
+    .temp_max = 1200,
+    .brightness = LIGHT_DEFAULT_BRIGHTNESS,
+};
+
+/* The animation as light_animate_and_set() used to draw it, minus the delays */
+static void legacy_animate(led_strip_handle_t strip, const light_display_state_t *state) {
+    for (int index = 0; index < LIGHT_STRIP_LEDS; index++) {
+        led_strip_set_pixel(strip, index, 5, 5, 5);
+        led_strip_refresh(strip);
+        led_strip_set_pixel(strip, index, 0, 0, 0);
+    }
+    for (int index = LIGHT_STRIP_LEDS - 1; index > 0; index--) {
+        led_strip_set_pixel(strip, index, 5, 5, 5);
+        led_strip_refresh(strip);
+        led_strip_set_pixel(strip, index, 0, 0, 0);
+    }
+    int animate_time = 10;
+    bool led_on_off = false;
+    while (animate_time > 0) {
+        if (led_on_off) {
+            led_strip_set_pixel(strip, LIGHT_ZERO_CELSIUS_LED + state->temp_min / TEMP_CENTI_PER_C, 5, 5, 5);
+            led_strip_set_pixel(strip, LIGHT_ZERO_CELSIUS_LED + state->temp_now / TEMP_CENTI_PER_C, 5, 5, 5);
+            led_strip_set_pixel(strip, LIGHT_ZERO_CELSIUS_LED + state->temp_max / TEMP_CENTI_PER_C, 5, 5, 5);
+        } else {
+            led_strip_set_pixel(strip, LIGHT_ZERO_CELSIUS_LED + state->temp_min / TEMP_CENTI_PER_C, 0, 0, 0);
+            led_strip_set_pixel(strip, LIGHT_ZERO_CELSIUS_LED + state->temp_max / TEMP_CENTI_PER_C, 0, 0, 0);
+        }
+        led_strip_refresh(strip);
+        led_on_off = !led_on_off;
+        --animate_time;
+    }
+    led_strip_clear(strip);
+}
+
+/* Every render tick, as light_render_task drives it */
+static int fb_animate(light_fb_t *fb, const light_display_state_t *state) {
+    int frame = 0;
+    bool animating;
+    do {
+        animating = light_anim_render(fb, state, frame++);
+        TEST_ASSERT_EQUAL(ESP_OK, light_fb_flush(fb));
+    } while (animating && frame < ANIMATION_TICKS_MAX);
+    return frame;
+}
+
+static void test_dirty_range(void) {
+    led_strip_handle_t strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    led_strip_mock_log_t *log = led_strip_mock_log(strip);
+    light_fb_t fb;
+
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&fb, strip, LIGHT_STRIP_LEDS));
+
+    /* Nothing written, nothing sent */
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_flush(&fb));
+    TEST_ASSERT_EQUAL(0, log->refreshes);
+
+    light_fb_set_pixel(&fb, 7, 1, 2, 3);
+    light_fb_set_pixel(&fb, 3, 4, 5, 6);
+    light_fb_set_pixel(&fb, 3, 4, 5, 7);
+    light_fb_set_pixel(&fb, LIGHT_STRIP_LEDS, 9, 9, 9);    // out of range, ignored
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_flush(&fb));
+    TEST_ASSERT_EQUAL(1, log->refreshes);
+    TEST_ASSERT_EQUAL(2, log->set_pixel_calls);     // 3 and 7 only, 4..6 are unchanged
+    TEST_ASSERT_EQUAL(7, led_strip_mock_shown(strip)[3 * 3 + 2]);
+
+    /* Rewriting the same values is not a change */
+    light_fb_set_pixel(&fb, 7, 1, 2, 3);
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_flush(&fb));
+    TEST_ASSERT_EQUAL(1, log->refreshes);
+    TEST_ASSERT_FALSE(light_fb_is_dark(&fb));
+
+    light_fb_clear(&fb);
+    TEST_ASSERT_TRUE(light_fb_is_dark(&fb));
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_flush(&fb));
+    TEST_ASSERT_EQUAL(2, log->refreshes);
+
+    TEST_ASSERT_EQUAL(4, fb.stats.frames);
+    TEST_ASSERT_EQUAL(2, fb.stats.refreshes);
+    led_strip_del(strip);
+}
+
+static void test_animation_refreshes(void) {
+    led_strip_handle_t legacy_strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    led_strip_handle_t fb_strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    led_strip_mock_log_t *legacy = led_strip_mock_log(legacy_strip);
+    led_strip_mock_log_t *fb_log = led_strip_mock_log(fb_strip);
+    light_fb_t fb;
+
+    legacy_animate(legacy_strip, &s_state);
+
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&fb, fb_strip, LIGHT_STRIP_LEDS));
+    int ticks = fb_animate(&fb, &s_state);
+
+    uint32_t legacy_updates = legacy->refreshes + legacy->clears;
+    printf("ANIMATION ticks=%d legacy: refreshes=%u set_pixel=%u | framebuffer: refreshes=%u set_pixel=%u\n",
+           ticks, (unsigned)legacy_updates, (unsigned)legacy->set_pixel_calls,
+           (unsigned)fb_log->refreshes, (unsigned)fb_log->set_pixel_calls);
+
+    /* Same LEDs lit, in the same order, less legacy's back to back repeats
+     * (e.g. the top LED is sent again at the start of the down sweep) */
+    uint32_t distinct = 0;
+    for (uint32_t i = 0; i < legacy->frames_logged; i++) {
+        if (i == 0 || legacy->lit_hash[i] != legacy->lit_hash[i - 1]) {
+            legacy->lit_hash[distinct++] = legacy->lit_hash[i];
+        }
+    }
+    TEST_ASSERT_EQUAL(distinct, fb_log->frames_logged);
+    TEST_ASSERT_EQUAL_MEMORY(legacy->lit_hash, fb_log->lit_hash, distinct * sizeof(uint32_t));
+
+    /* A refresh per render tick would be `ticks`; unchanged ticks are skipped */
+    TEST_ASSERT_LESS_THAN(ticks, fb_log->refreshes);
+    TEST_ASSERT_LESS_OR_EQUAL(legacy_updates, fb_log->refreshes);
+
+    /* Posting the same state again changes nothing until the animation moves */
+    led_strip_mock_reset_log(fb_strip);
+    TEST_ASSERT_TRUE(light_fb_is_dark(&fb));
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_flush(&fb));
+    TEST_ASSERT_EQUAL(0, fb_log->refreshes);
+
+    led_strip_del(legacy_strip);
+    led_strip_del(fb_strip);
+}
+
+static void test_skip_sweep(void) {
+    led_strip_handle_t strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    light_display_state_t state = s_state;
+    light_fb_t fb;
+
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&fb, strip, LIGHT_STRIP_LEDS));
+    state.skip_sweep = true;
+
+    /* The values are on the strip from the very first frame */
+    TEST_ASSERT_TRUE(light_anim_render(&fb, &state, 0));
+    const uint8_t *now = fb.rgb[light_anim_temp_to_led(state.temp_now / TEMP_CENTI_PER_C)];
+    const uint8_t *min = fb.rgb[light_anim_temp_to_led(state.temp_min / TEMP_CENTI_PER_C)];
+    TEST_ASSERT_TRUE(now[0] | now[1] | now[2]);
+    TEST_ASSERT_TRUE(min[0] | min[1] | min[2]);
+
+    int ticks = fb_animate(&fb, &state);
+    TEST_ASSERT_TRUE(light_fb_is_dark(&fb));
+    state.skip_sweep = false;
+    TEST_ASSERT_LESS_THAN(fb_animate(&fb, &state), ticks);
+
+    led_strip_del(strip);
+}
+
+/* Low-power mode deletes the RMT device while dark & makes a new one to draw */
+static void test_strip_reattach(void) {
+    led_strip_handle_t strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    light_fb_t fb;
+
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&fb, strip, LIGHT_STRIP_LEDS));
+    fb_animate(&fb, &s_state);
+    TEST_ASSERT_TRUE(light_fb_is_dark(&fb));
+    led_strip_del(strip);
+    light_fb_set_strip(&fb, NULL);
+
+    strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    light_fb_set_strip(&fb, strip);
+    TEST_ASSERT_TRUE(light_anim_render(&fb, &s_state, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_flush(&fb));
+
+    /* The whole frame went out, not just what changed since the old strip */
+    TEST_ASSERT_EQUAL(1, led_strip_mock_log(strip)->refreshes);
+    TEST_ASSERT_EQUAL_MEMORY(fb.rgb, led_strip_mock_shown(strip), LIGHT_STRIP_LEDS * 3);
+
+    led_strip_del(strip);
+}
+
+void run_light_fb_tests(void)
+{
+    RUN_TEST(test_dirty_range);
+    RUN_TEST(test_animation_refreshes);
+    RUN_TEST(test_skip_sweep);
+    RUN_TEST(test_strip_reattach);
+}
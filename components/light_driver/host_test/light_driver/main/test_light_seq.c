@@ -0,0 +1,374 @@
+/**
+ * @file test_light_seq.c
+ * @author The Authors
+ * @brief Host tests & frame time benchmark of the keyframe sequences
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "led_strip.h"
+#include "light_driver.h"
+#include "light_fb.h"
+#include "light_anim.h"
+#include "light_seq.h"
+#include "test_light_driver.h"
+
+#define BENCH_ITERATIONS    200
+#define FRAMES_MAX          1000
+
+static const light_display_state_t s_state = {
+    .temp_min = -300,       // centi-degrees, whole ones draw as the old animation did
+    .temp_now = 700,
+    .temp_max = 1200,
+    .brightness = LIGHT_DEFAULT_BRIGHTNESS,
+};
+
+static inline uint64_t ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* light_anim_render() as it was before the sequences, coded frame by frame */
+static bool legacy_render(light_fb_t *fb, const light_display_state_t *state, int frame) {
+    uint8_t level = state->brightness < LIGHT_BRIGHTNESS_LEVELS ? state->brightness : LIGHT_BRIGHTNESS_LEVELS - 1;
+    uint8_t dim = level > 0 ? level - 1 : 0;
+    const int phase_frames = 500 / LIGHT_ANIM_TICK_MS;
+
+    light_fb_clear(fb);
+    if (state->skip_sweep) {
+        frame += 2 * LIGHT_STRIP_LEDS - 1 + phase_frames;
+    }
+    if (frame < LIGHT_STRIP_LEDS) {
+        const uint8_t *rgb = light_palette[dim][frame];
+        light_fb_set_pixel(fb, frame, rgb[0], rgb[1], rgb[2]);
+        return true;
+    }
+    frame -= LIGHT_STRIP_LEDS;
+    if (frame < LIGHT_STRIP_LEDS - 1) {
+        const uint8_t *rgb = light_palette[dim][LIGHT_STRIP_LEDS - 1 - frame];
+        light_fb_set_pixel(fb, LIGHT_STRIP_LEDS - 1 - frame, rgb[0], rgb[1], rgb[2]);
+        return true;
+    }
+    frame -= LIGHT_STRIP_LEDS - 1;
+    if (frame < 10 * phase_frames) {
+        int phase = frame / phase_frames;
+        int leds[3] = {
+            light_anim_temp_to_led(state->temp_min / TEMP_CENTI_PER_C),
+            light_anim_temp_to_led(state->temp_max / TEMP_CENTI_PER_C),
+            light_anim_temp_to_led(state->temp_now / TEMP_CENTI_PER_C),
+        };
+        for (int i = 0; i < 3; i++) {
+            if ((i < 2 && phase % 2) || (i == 2 && phase > 0)) {
+                const uint8_t *rgb = light_palette[i < 2 ? dim : level][leds[i]];
+                light_fb_set_pixel(fb, leds[i], rgb[0], rgb[1], rgb[2]);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+/* Brightness-weighted centre of the lit LEDs in [lo, hi], Q8 */
+static int32_t lit_centre(const light_fb_t *fb, int lo, int hi) {
+    uint32_t sum = 0, weighted = 0;
+    for (int i = lo; i <= hi; i++) {
+        uint32_t v = fb->rgb[i][0] + fb->rgb[i][1] + fb->rgb[i][2];
+        sum += v;
+        weighted += v * LIGHT_SEQ_LED(i);
+    }
+    return sum ? (int32_t)(weighted / sum) : -1;
+}
+
+static void test_ease(void) {
+    for (light_ease_t ease = LIGHT_EASE_STEP; ease <= LIGHT_EASE_IN_OUT; ease++) {
+        TEST_ASSERT_EQUAL(0, light_ease(ease, 0));
+        TEST_ASSERT_EQUAL(0, light_ease(ease, -5));
+        TEST_ASSERT_EQUAL(LIGHT_SEQ_ONE, light_ease(ease, LIGHT_SEQ_ONE));
+        TEST_ASSERT_EQUAL(LIGHT_SEQ_ONE, light_ease(ease, LIGHT_SEQ_ONE + 5));
+
+        int32_t prev = 0;
+        for (int32_t t = 0; t <= LIGHT_SEQ_ONE; t += 64) {
+            int32_t e = light_ease(ease, t);
+            TEST_ASSERT_GREATER_OR_EQUAL(prev, e);
+            TEST_ASSERT_LESS_OR_EQUAL(LIGHT_SEQ_ONE, e);
+            prev = e;
+        }
+    }
+
+    /* Halfway: smoothstep is symmetric, the quadratics are a quarter off */
+    const int32_t half = LIGHT_SEQ_ONE / 2;
+    TEST_ASSERT_EQUAL(half, light_ease(LIGHT_EASE_LINEAR, half));
+    TEST_ASSERT_EQUAL(half, light_ease(LIGHT_EASE_IN_OUT, half));
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_ONE / 4, light_ease(LIGHT_EASE_IN, half));
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_ONE * 3 / 4, light_ease(LIGHT_EASE_OUT, half));
+    TEST_ASSERT_EQUAL(0, light_ease(LIGHT_EASE_STEP, LIGHT_SEQ_ONE - 1));
+    for (int32_t t = 0; t <= LIGHT_SEQ_ONE; t += 1024) {
+        int32_t sum = light_ease(LIGHT_EASE_IN_OUT, t) + light_ease(LIGHT_EASE_IN_OUT, LIGHT_SEQ_ONE - t);
+        TEST_ASSERT_INT32_WITHIN(2, LIGHT_SEQ_ONE, sum);
+    }
+}
+
+static void test_track(void) {
+    static const light_key_t keys[] = {
+        { 10, LIGHT_EASE_STEP, LIGHT_SEQ_ABS, LIGHT_SEQ_LED(2) },
+        { 17, LIGHT_EASE_LINEAR, 1, LIGHT_SEQ_LED(3) },
+        { 20, LIGHT_EASE_STEP, LIGHT_SEQ_ABS, 0 },
+    };
+    const light_track_t track = { keys, 3 };
+    light_seq_ctx_t ctx = { .anchor = { [1] = LIGHT_SEQ_LED(30) } };
+
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(2), light_track_eval(&track, &ctx, 0));     // the first key holds before it
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(2), light_track_eval(&track, &ctx, 10));
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(33), light_track_eval(&track, &ctx, 17));   // anchor + value
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(33), light_track_eval(&track, &ctx, 19));   // step holds ...
+    TEST_ASSERT_EQUAL(0, light_track_eval(&track, &ctx, 20));                   // ... then jumps
+    TEST_ASSERT_EQUAL(0, light_track_eval(&track, &ctx, 1000));
+
+    /* Linear over 7 frames: 31 LEDs in sevenths, rounded to nearest Q8 */
+    for (int f = 10; f <= 17; f++) {
+        int32_t exact = LIGHT_SEQ_LED(2) + (LIGHT_SEQ_LED(31) * (f - 10) + 3) / 7;
+        TEST_ASSERT_INT32_WITHIN(1, exact, light_track_eval(&track, &ctx, f));
+    }
+
+    /* Moved anchors move the whole track, the sequence itself is const */
+    ctx.anchor[1] = LIGHT_SEQ_LED(10);
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(13), light_track_eval(&track, &ctx, 17));
+}
+
+/* The sweep & blink sequences draw what the hand-coded animation did, frame for frame */
+static void test_builtin_parity(void) {
+    led_strip_handle_t strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    light_fb_t seq_fb, legacy_fb;
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&seq_fb, strip, LIGHT_STRIP_LEDS));
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&legacy_fb, strip, LIGHT_STRIP_LEDS));
+
+    for (int skip = 0; skip < 2; skip++) {
+        for (uint8_t level = 0; level < LIGHT_BRIGHTNESS_LEVELS; level++) {
+            light_display_state_t state = s_state;
+            state.skip_sweep = skip;
+            state.brightness = level;
+            int frame = 0;
+            bool more;
+            do {
+                more = light_anim_render(&seq_fb, &state, frame);
+                TEST_ASSERT_EQUAL(legacy_render(&legacy_fb, &state, frame), more);
+                TEST_ASSERT_EQUAL_MEMORY(legacy_fb.rgb, seq_fb.rgb, LIGHT_STRIP_LEDS * 3);
+                frame++;
+            } while (more && frame < FRAMES_MAX);
+            TEST_ASSERT_TRUE(light_fb_is_dark(&seq_fb));
+        }
+    }
+    TEST_ASSERT_EQUAL(2 * LIGHT_STRIP_LEDS - 1, light_seq_sweep.frames);
+    led_strip_del(strip);
+}
+
+/* A new reading glides from the old one, through sub-LED positions */
+static void test_tween(void) {
+    led_strip_handle_t strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    light_fb_t fb;
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&fb, strip, LIGHT_STRIP_LEDS));
+
+    /* min & max stay put at the ends, so whatever lies between them is the now dot */
+    light_display_state_t state = s_state;
+    state.temp_min = state.prev_min = -1200;
+    state.temp_max = state.prev_max = 3000;
+    state.prev_now = -500;
+    state.tween = true;
+    int min_led = light_anim_temp_to_led(state.temp_min / TEMP_CENTI_PER_C);
+    int max_led = light_anim_temp_to_led(state.temp_max / TEMP_CENTI_PER_C);
+    int32_t prev_pos = -1;
+    int fractional = 0;
+
+    for (int frame = 0; frame < light_seq_tween.frames; frame++) {
+        TEST_ASSERT_TRUE(light_anim_render(&fb, &state, frame));
+
+        int first = -1, count = 0;
+        for (int i = min_led + 1; i < max_led; i++) {
+            if (fb.rgb[i][0] | fb.rgb[i][1] | fb.rgb[i][2]) {
+                first = first < 0 ? i : first;
+                count++;
+            }
+        }
+        /* One LED, or two next to each other between positions */
+        TEST_ASSERT_GREATER_OR_EQUAL(0, first);
+        TEST_ASSERT_LESS_OR_EQUAL(2, count);
+        fractional += count == 2;
+
+        int32_t pos = lit_centre(&fb, first, first + count - 1);
+        if (frame == 0) {
+            TEST_ASSERT_EQUAL(light_anim_temp_to_pos(state.prev_now), pos);
+        }
+        TEST_ASSERT_GREATER_OR_EQUAL(prev_pos, pos);
+        prev_pos = pos;
+    }
+    TEST_ASSERT_EQUAL(light_anim_temp_to_pos(state.temp_now), prev_pos);
+    TEST_ASSERT_GREATER_THAN(light_seq_tween.frames / 2, fractional);
+
+    /* Then the blink carries on with all three shown, and the strip ends dark */
+    int frame = light_seq_tween.frames;
+    TEST_ASSERT_TRUE(light_anim_render(&fb, &state, frame));
+    TEST_ASSERT_EQUAL_MEMORY(light_palette[LIGHT_DEFAULT_BRIGHTNESS - 1][min_led], fb.rgb[min_led], 3);
+    while (light_anim_render(&fb, &state, ++frame) && frame < FRAMES_MAX) {
+    }
+    TEST_ASSERT_TRUE(light_fb_is_dark(&fb));
+    TEST_ASSERT_LESS_THAN(light_seq_sweep.frames + light_seq_blink.frames, frame);
+    led_strip_del(strip);
+}
+
+/* A reading between two whole degrees shows on both their LEDs, weighted */
+static void test_sub_degree(void) {
+    led_strip_handle_t strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    light_fb_t fb;
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&fb, strip, LIGHT_STRIP_LEDS));
+
+    light_display_state_t state = s_state;
+    state.skip_sweep = true;        // now is on from the first frame
+    int led = light_anim_temp_to_led(state.temp_now / TEMP_CENTI_PER_C);
+    const uint8_t *bright = light_palette[LIGHT_DEFAULT_BRIGHTNESS][led];
+    const uint8_t *bright_p = light_palette_perceptual[LIGHT_DEFAULT_BRIGHTNESS][led];
+    const uint8_t *above_p = light_palette_perceptual[LIGHT_DEFAULT_BRIGHTNESS][led + 1];
+
+    TEST_ASSERT_TRUE(light_anim_render(&fb, &state, 0));
+    TEST_ASSERT_EQUAL_MEMORY(bright, fb.rgb[led], 3);
+    TEST_ASSERT_FALSE(fb.rgb[led + 1][0] | fb.rgb[led + 1][1] | fb.rgb[led + 1][2]);
+
+    /* From 7.00 to 8.00 the weight moves steadily from one LED to the next */
+    int32_t prev = -1;
+    for (int centi = state.temp_now; centi <= state.temp_now + TEMP_CENTI_PER_C; centi += 5) {
+        light_display_state_t moved = state;
+        moved.temp_now = centi;
+        TEST_ASSERT_TRUE(light_anim_render(&fb, &moved, 0));
+        int32_t pos = lit_centre(&fb, led, led + 1);
+        TEST_ASSERT_GREATER_OR_EQUAL(prev, pos);
+        prev = pos;
+
+        if (centi == state.temp_now + TEMP_CENTI_PER_C / 2) {
+            /* Halfway, both at about half their full colour's brightness, not its PWM value */
+            for (int c = 0; c < 3; c++) {
+                TEST_ASSERT_INT32_WITHIN(1, light_gamma[(bright_p[c] + 1) / 2], fb.rgb[led][c]);
+                TEST_ASSERT_INT32_WITHIN(1, light_gamma[(above_p[c] + 1) / 2], fb.rgb[led + 1][c]);
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(led + 1), prev);
+    led_strip_del(strip);
+}
+
+/* The band lights min to max dimly, ends weighted, with now bright on it */
+static void test_band(void) {
+    led_strip_handle_t strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    light_fb_t fb, dot_fb;
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&fb, strip, LIGHT_STRIP_LEDS));
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&dot_fb, strip, LIGHT_STRIP_LEDS));
+
+    light_display_state_t state = s_state;
+    state.band = true;
+    state.skip_sweep = true;
+    state.temp_max = 1250;          // half way to the next LED
+    int min_led = light_anim_temp_to_led(state.temp_min / TEMP_CENTI_PER_C);
+    int now_led = light_anim_temp_to_led(state.temp_now / TEMP_CENTI_PER_C);
+    int max_led = light_anim_temp_to_led(state.temp_max / TEMP_CENTI_PER_C);
+    const uint8_t (*dim)[3] = light_palette[LIGHT_DEFAULT_BRIGHTNESS - 1];
+
+    TEST_ASSERT_TRUE(light_anim_render(&fb, &state, 0));
+    for (int i = 0; i < LIGHT_STRIP_LEDS; i++) {
+        if (i == now_led) {
+            TEST_ASSERT_EQUAL_MEMORY(light_palette[LIGHT_DEFAULT_BRIGHTNESS][i], fb.rgb[i], 3);
+        } else if (i >= min_led && i <= max_led) {
+            TEST_ASSERT_EQUAL_MEMORY(dim[i], fb.rgb[i], 3);
+        } else if (i == max_led + 1) {
+            const uint8_t *dim_p = light_palette_perceptual[LIGHT_DEFAULT_BRIGHTNESS - 1][i];
+            for (int c = 0; c < 3; c++) {
+                TEST_ASSERT_INT32_WITHIN(1, light_gamma[(dim_p[c] + 1) / 2], fb.rgb[i][c]);
+            }
+        } else {
+            TEST_ASSERT_FALSE(fb.rgb[i][0] | fb.rgb[i][1] | fb.rgb[i][2]);
+        }
+    }
+
+    /* After the sweep it fades in, and the strip ends dark */
+    state.skip_sweep = false;
+    int frame = light_seq_sweep.frames;
+    TEST_ASSERT_TRUE(light_anim_render(&fb, &state, frame));
+    TEST_ASSERT_FALSE(fb.rgb[min_led][0] | fb.rgb[min_led][1] | fb.rgb[min_led][2]);
+    while (light_anim_render(&fb, &state, ++frame) && frame < FRAMES_MAX) {
+    }
+    TEST_ASSERT_EQUAL(light_seq_sweep.frames + light_seq_band.frames, frame);
+    TEST_ASSERT_TRUE(light_fb_is_dark(&fb));
+
+    /* A band with both ends at one position is a dot */
+    static const light_key_t at[] = { { 0, LIGHT_EASE_STEP, LIGHT_SEQ_ABS, LIGHT_SEQ_LED(20) + 77 } };
+    static const light_key_t full[] = { { 0, LIGHT_EASE_STEP, LIGHT_SEQ_ABS, LIGHT_SEQ_FULL } };
+    const light_layer_t band_layer = { .pos = { at, 1 }, .level = { full, 1 }, .end = { at, 1 } };
+    const light_layer_t dot_layer = { .pos = { at, 1 }, .level = { full, 1 } };
+    const light_seq_t band = { &band_layer, 1, 1 };
+    const light_seq_t dot = { &dot_layer, 1, 1 };
+    const light_seq_ctx_t ctx = { .level = LIGHT_DEFAULT_BRIGHTNESS, .dim = LIGHT_DEFAULT_BRIGHTNESS - 1 };
+    TEST_ASSERT_TRUE(light_seq_render(&fb, &band, &ctx, 0));
+    TEST_ASSERT_TRUE(light_seq_render(&dot_fb, &dot, &ctx, 0));
+    TEST_ASSERT_EQUAL_MEMORY(dot_fb.rgb, fb.rgb, LIGHT_STRIP_LEDS * 3);
+    led_strip_del(strip);
+}
+
+static uint64_t bench_frames(light_fb_t *fb, const light_display_state_t *state, int *frames) {
+    uint64_t t0 = ns_now();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int frame = 0;
+        while (light_anim_render(fb, state, frame) && frame < FRAMES_MAX) {
+            frame++;
+        }
+        *frames = frame;
+    }
+    return ns_now() - t0;
+}
+
+/* Composing only, no strip: what a render tick costs before light_fb_flush() */
+static void test_frame_benchmark(void) {
+    led_strip_handle_t strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    light_fb_t fb;
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&fb, strip, LIGHT_STRIP_LEDS));
+
+    light_display_state_t state = s_state;
+    int sweep_frames, tween_frames, legacy_frames = 0;
+    uint64_t sweep_ns = bench_frames(&fb, &state, &sweep_frames);
+    state.tween = true;
+    state.prev_now = -500;
+    uint64_t tween_ns = bench_frames(&fb, &state, &tween_frames);
+    state.tween = false;
+
+    uint64_t t0 = ns_now();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        legacy_frames = 0;
+        while (legacy_render(&fb, &state, legacy_frames)) {
+            legacy_frames++;
+        }
+    }
+    uint64_t legacy_ns = ns_now() - t0;
+
+    printf("SEQ %d LEDs, ns/frame: sweep+blink=%.0f tween+blink=%.0f hand-coded=%.0f (%d/%d/%d frames x %d)\n",
+           LIGHT_STRIP_LEDS,
+           (double)sweep_ns / sweep_frames / BENCH_ITERATIONS,
+           (double)tween_ns / tween_frames / BENCH_ITERATIONS,
+           (double)legacy_ns / legacy_frames / BENCH_ITERATIONS,
+           sweep_frames, tween_frames, legacy_frames, BENCH_ITERATIONS);
+    TEST_ASSERT_EQUAL(legacy_frames, sweep_frames);
+    led_strip_del(strip);
+}
+
+void run_light_seq_tests(void)
+{
+    RUN_TEST(test_ease);
+    RUN_TEST(test_track);
+    RUN_TEST(test_builtin_parity);
+    RUN_TEST(test_tween);
+    RUN_TEST(test_sub_degree);
+    RUN_TEST(test_band);
+    RUN_TEST(test_frame_benchmark);
+}
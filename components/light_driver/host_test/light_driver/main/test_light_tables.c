@@ -0,0 +1,131 @@
+/**
+ * @file test_light_tables.c
+ * @author The Authors
+ * @brief Host tests for the generated colormap/gamma/position tables & boundary_checks
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "sdkconfig.h"
+#include "unity.h"
+#include "light_driver.h"
+#include "light_anim.h"
+#include "test_light_driver.h"
+
+#define C(degrees)  ((degrees) * TEMP_CENTI_PER_C)
+
+static void test_positions(void) {
+    TEST_ASSERT_EQUAL(0, light_anim_temp_to_led(LIGHT_TEMP_MIN_C));
+    TEST_ASSERT_EQUAL(LIGHT_ZERO_CELSIUS_LED, light_anim_temp_to_led(0));
+    TEST_ASSERT_LESS_OR_EQUAL(LIGHT_STRIP_LEDS - 1, light_anim_temp_to_led(LIGHT_TEMP_MAX_C));
+
+    for (int t = LIGHT_TEMP_MIN_C + 1; t <= LIGHT_TEMP_MAX_C; t++) {
+        TEST_ASSERT_GREATER_OR_EQUAL(light_anim_temp_to_led(t - 1), light_anim_temp_to_led(t));
+#if CONFIG_EXAMPLE_STRIP_TEMP_SPAN == CONFIG_EXAMPLE_STRIP_LED_NUMBER
+        /* One LED per degree, as the strip was originally wired */
+        TEST_ASSERT_EQUAL(LIGHT_ZERO_CELSIUS_LED + t, light_anim_temp_to_led(t));
+#endif
+    }
+    TEST_ASSERT_EQUAL(0, light_anim_temp_to_led(-100));
+    TEST_ASSERT_EQUAL(light_anim_temp_to_led(LIGHT_TEMP_MAX_C), light_anim_temp_to_led(100));
+}
+
+static void test_gamma(void) {
+    TEST_ASSERT_EQUAL(0, light_gamma[0]);
+    TEST_ASSERT_EQUAL(255, light_gamma[255]);
+    for (int i = 1; i < 256; i++) {
+        TEST_ASSERT_GREATER_OR_EQUAL(light_gamma[i - 1], light_gamma[i]);
+    }
+}
+
+static void test_palette(void) {
+    for (int level = 0; level < LIGHT_BRIGHTNESS_LEVELS; level++) {
+        for (int led = 0; led < LIGHT_STRIP_LEDS; led++) {
+            const uint8_t *px = light_palette[level][led];
+            /* Every LED visible at every level */
+            TEST_ASSERT_TRUE(px[0] | px[1] | px[2]);
+            /* The gamma corrected colour of the perceptual one, unless kept off black */
+            const uint8_t *p = light_palette_perceptual[level][led];
+            if (light_gamma[p[0]] | light_gamma[p[1]] | light_gamma[p[2]]) {
+                for (int c = 0; c < 3; c++) {
+                    TEST_ASSERT_EQUAL(light_gamma[p[c]], px[c]);
+                }
+            }
+            if (level > 0) {
+                const uint8_t *dimmer = light_palette[level - 1][led];
+                TEST_ASSERT_GREATER_OR_EQUAL(dimmer[0] + dimmer[1] + dimmer[2], px[0] + px[1] + px[2]);
+            }
+        }
+    }
+
+#if CONFIG_LIGHT_DRIVER_COLORMAP
+    /* Cold end blue, warm end red */
+    const uint8_t *cold = light_palette[LIGHT_BRIGHTNESS_LEVELS - 1][0];
+    const uint8_t *warm = light_palette[LIGHT_BRIGHTNESS_LEVELS - 1][LIGHT_STRIP_LEDS - 1];
+    TEST_ASSERT_GREATER_THAN(cold[0], cold[2]);
+    TEST_ASSERT_GREATER_THAN(warm[2], warm[0]);
+#endif
+}
+
+/* Sub-degree positions fall between the whole degrees' LEDs, in order */
+static void test_sub_degree_positions(void) {
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(light_anim_temp_to_led(0)), light_anim_temp_to_pos(0));
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(light_anim_temp_to_led(LIGHT_TEMP_MIN_C)), light_anim_temp_to_pos(-100000));
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(light_anim_temp_to_led(LIGHT_TEMP_MAX_C)), light_anim_temp_to_pos(100000));
+
+    int32_t prev = light_anim_temp_to_pos(C(LIGHT_TEMP_MIN_C));
+    for (int centi = C(LIGHT_TEMP_MIN_C) + 1; centi <= C(LIGHT_TEMP_MAX_C); centi++) {
+        int32_t pos = light_anim_temp_to_pos(centi);
+        TEST_ASSERT_GREATER_OR_EQUAL(prev, pos);
+        prev = pos;
+        if (centi % TEMP_CENTI_PER_C == 0) {
+            TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(light_anim_temp_to_led(centi / TEMP_CENTI_PER_C)), pos);
+        }
+    }
+#if CONFIG_EXAMPLE_STRIP_TEMP_SPAN == CONFIG_EXAMPLE_STRIP_LED_NUMBER
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(LIGHT_ZERO_CELSIUS_LED + 7) + 128, light_anim_temp_to_pos(750));
+    TEST_ASSERT_EQUAL(LIGHT_SEQ_LED(LIGHT_ZERO_CELSIUS_LED - 3) - 64, light_anim_temp_to_pos(-325));
+#endif
+}
+
+static void test_boundary_checks(void) {
+    static const struct {
+        int in[3];
+        int out[3];
+    } cases[] = {
+        { { C(5), C(7), C(9) }, { C(5), C(7), C(9) } },
+        { { 712, 783, 1050 }, { 683, 783, 1050 } },                  // a degree either side of now
+        { { 712, 783, 783 }, { 683, 783, 883 } },
+        { { C(-40), C(-30), C(-20) }, { C(LIGHT_TEMP_MIN_C), C(LIGHT_TEMP_MIN_C + 1), C(LIGHT_TEMP_MIN_C + 2) } },
+        { { C(40), C(50), C(60) }, { C(LIGHT_TEMP_MAX_C - 2), C(LIGHT_TEMP_MAX_C - 1), C(LIGHT_TEMP_MAX_C) } },
+        { { C(8), C(7), C(6) }, { C(6), C(7), C(8) } },
+        { { C(99), C(99), C(-40) }, { C(LIGHT_TEMP_MAX_C - 2), C(LIGHT_TEMP_MAX_C - 1), C(LIGHT_TEMP_MAX_C) } },  // nothing parsed
+        { { C(LIGHT_TEMP_MIN_C), C(LIGHT_TEMP_MIN_C), C(LIGHT_TEMP_MIN_C) }, { C(LIGHT_TEMP_MIN_C), C(LIGHT_TEMP_MIN_C), C(LIGHT_TEMP_MIN_C + 1) } },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        int t_min = cases[i].in[0], t_now = cases[i].in[1], t_max = cases[i].in[2];
+        boundary_checks(&t_min, &t_now, &t_max);
+        TEST_ASSERT_EQUAL(cases[i].out[0], t_min);
+        TEST_ASSERT_EQUAL(cases[i].out[1], t_now);
+        TEST_ASSERT_EQUAL(cases[i].out[2], t_max);
+
+        /* Everything lands on the strip, min <= now <= max */
+        TEST_ASSERT_GREATER_OR_EQUAL(C(LIGHT_TEMP_MIN_C), t_min);
+        TEST_ASSERT_LESS_OR_EQUAL(C(LIGHT_TEMP_MAX_C), t_max);
+        TEST_ASSERT_LESS_OR_EQUAL(t_now, t_min);
+        TEST_ASSERT_GREATER_OR_EQUAL(t_now, t_max);
+        TEST_ASSERT_LESS_THAN(LIGHT_SEQ_LED(LIGHT_STRIP_LEDS), light_anim_temp_to_pos(t_max));
+    }
+}
+
+void run_light_tables_tests(void)
+{
+    RUN_TEST(test_positions);
+    RUN_TEST(test_gamma);
+    RUN_TEST(test_palette);
+    RUN_TEST(test_sub_degree_positions);
+    RUN_TEST(test_boundary_checks);
+}
@@ -0,0 +1,22 @@
+/**
+ * @file test_main.c
+ * @author The Authors
+ * @brief light_driver host test runner
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdlib.h>
+#include "unity.h"
+#include "test_light_driver.h"
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    run_light_tables_tests();
+    run_light_fb_tests();
+    run_light_seq_tests();
+    exit(UNITY_END());
+}
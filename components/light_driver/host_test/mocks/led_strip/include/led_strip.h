@@ -0,0 +1,96 @@
+/**
+ * @file led_strip.h
+ * @author The Authors
+ * @brief The subset of the espressif/led_strip API used by light_driver,
+ *        backed by an in-memory recording strip for host tests
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct led_strip_t *led_strip_handle_t;
+
+typedef enum {
+    LED_MODEL_WS2812,
+    LED_MODEL_SK6812,
+} led_model_t;
+
+typedef struct {
+    uint32_t r_pos: 2;
+    uint32_t g_pos: 2;
+    uint32_t b_pos: 2;
+    uint32_t w_pos: 2;
+    uint32_t reserved: 21;
+    uint32_t num_components: 3;
+} led_color_component_format_t;
+
+#define LED_STRIP_COLOR_COMPONENT_FMT_GRB (led_color_component_format_t){ .g_pos = 0, .r_pos = 1, .b_pos = 2, .num_components = 3 }
+
+typedef struct {
+    int strip_gpio_num;
+    uint32_t max_leds;
+    led_model_t led_model;
+    led_color_component_format_t color_component_format;
+    struct {
+        uint32_t invert_out: 1;
+    } flags;
+} led_strip_config_t;
+
+#define RMT_CLK_SRC_DEFAULT 0
+
+typedef struct {
+    int clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    struct {
+        uint32_t with_dma: 1;
+    } flags;
+} led_strip_rmt_config_t;
+
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, led_strip_handle_t *ret_strip);
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue);
+esp_err_t led_strip_refresh(led_strip_handle_t strip);
+esp_err_t led_strip_clear(led_strip_handle_t strip);
+esp_err_t led_strip_del(led_strip_handle_t strip);
+
+/* Mock only */
+
+#define LED_STRIP_MOCK_FRAME_LOG 512
+
+typedef struct {
+    uint32_t set_pixel_calls;
+    uint32_t refreshes;
+    uint32_t clears;
+    uint32_t frames_logged;
+    uint32_t lit_hash[LED_STRIP_MOCK_FRAME_LOG];    // hash of which pixels were lit at each refresh
+} led_strip_mock_log_t;
+
+/**
+ * @brief Create a strip without any RMT config
+ */
+led_strip_handle_t led_strip_mock_new(uint32_t max_leds);
+
+/**
+ * @brief Pixels as last shown (i.e. at the last refresh/clear), 3 bytes RGB each
+ */
+const uint8_t *led_strip_mock_shown(led_strip_handle_t strip);
+
+led_strip_mock_log_t *led_strip_mock_log(led_strip_handle_t strip);
+
+void led_strip_mock_reset_log(led_strip_handle_t strip);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
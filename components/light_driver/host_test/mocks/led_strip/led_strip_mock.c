@@ -0,0 +1,93 @@
+/**
+ * @file led_strip_mock.c
+ * @author The Authors
+ * @brief Recording in-memory led_strip for host tests
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "led_strip.h"
+
+struct led_strip_t {
+    uint32_t max_leds;
+    uint8_t *pending;           // written by set_pixel
+    uint8_t *shown;             // copied from pending on refresh
+    led_strip_mock_log_t log;
+};
+
+/* FNV-1a over which LEDs are lit, so frames compare independent of colour */
+static uint32_t lit_hash(const uint8_t *px, size_t num_leds) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < num_leds; i++) {
+        h = (h ^ (px[i * 3] | px[i * 3 + 1] | px[i * 3 + 2] ? 1 : 0)) * 16777619u;
+    }
+    return h;
+}
+
+static void show(led_strip_handle_t strip) {
+    memcpy(strip->shown, strip->pending, strip->max_leds * 3);
+    if (strip->log.frames_logged < LED_STRIP_MOCK_FRAME_LOG) {
+        strip->log.lit_hash[strip->log.frames_logged++] = lit_hash(strip->shown, strip->max_leds);
+    }
+}
+
+led_strip_handle_t led_strip_mock_new(uint32_t max_leds) {
+    led_strip_handle_t strip = calloc(1, sizeof(*strip));
+    strip->max_leds = max_leds;
+    strip->pending = calloc(max_leds, 3);
+    strip->shown = calloc(max_leds, 3);
+    return strip;
+}
+
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, led_strip_handle_t *ret_strip) {
+    (void)rmt_config;
+    *ret_strip = led_strip_mock_new(led_config->max_leds);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue) {
+    if (index >= strip->max_leds) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    strip->pending[index * 3 + 0] = red;
+    strip->pending[index * 3 + 1] = green;
+    strip->pending[index * 3 + 2] = blue;
+    strip->log.set_pixel_calls++;
+    return ESP_OK;
+}
+
+esp_err_t led_strip_refresh(led_strip_handle_t strip) {
+    strip->log.refreshes++;
+    show(strip);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_clear(led_strip_handle_t strip) {
+    memset(strip->pending, 0, strip->max_leds * 3);
+    strip->log.clears++;
+    show(strip);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_del(led_strip_handle_t strip) {
+    free(strip->pending);
+    free(strip->shown);
+    free(strip);
+    return ESP_OK;
+}
+
+const uint8_t *led_strip_mock_shown(led_strip_handle_t strip) {
+    return strip->shown;
+}
+
+led_strip_mock_log_t *led_strip_mock_log(led_strip_handle_t strip) {
+    return &strip->log;
+}
+
+void led_strip_mock_reset_log(led_strip_handle_t strip) {
+    memset(&strip->log, 0, sizeof(strip->log));
+}
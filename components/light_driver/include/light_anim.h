@@ -0,0 +1,88 @@
+/**
+ * @file light_anim.h
+ * @author The Authors
+ * @brief Sweep, glide & blink animation, one stateless frame at a time
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "light_fb.h"
+#include "light_seq.h"
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LIGHT_ANIM_TICK_MS  50
+
+typedef struct {
+    int temp_min;           // centi-degrees C, as all the temperatures here
+    int temp_now;
+    int temp_max;
+    uint8_t brightness;     // palette level for temp_now, min/max & the sweep are one dimmer
+    bool skip_sweep;        // start straight at the values, e.g. the last known reading at boot
+    bool tween;             // glide from the prev_ values instead of the sweep
+    bool band;              // min to max as a band under temp_now, instead of blinking min & max
+    int prev_min;
+    int prev_now;
+    int prev_max;
+} light_display_state_t;
+
+/* The built-in sequences: a dot sweeping up & down the strip, the values
+ * with min & max blinking, the previous values gliding to the new ones, and
+ * the range as a band with temp_now on it */
+extern const light_seq_t light_seq_sweep;
+extern const light_seq_t light_seq_blink;
+extern const light_seq_t light_seq_tween;
+extern const light_seq_t light_seq_band;
+
+/**
+ * @brief Clamp the values onto the strip, keeping min at least a degree below
+ *        now and max at least a degree above it, so the three dots don't merge
+ *
+ * @param temp_min
+ * @param temp_now
+ * @param temp_max
+ */
+void boundary_checks(int *temp_min, int *temp_now, int *temp_max);
+
+/**
+ * @brief LED showing a whole degree, clamped to the strip
+ *
+ * @param temp
+ * @return int
+ */
+int light_anim_temp_to_led(int temp);
+
+/**
+ * @brief Position showing a temperature, between the LEDs of the whole
+ *        degrees either side, clamped to the strip
+ *
+ * @param centi     centi-degrees C
+ * @return Q8 LED position, see light_seq.h
+ */
+int32_t light_anim_temp_to_pos(int centi);
+
+/**
+ * @brief Compose frame number `frame` of the animation into fb: the sweep,
+ *        the tween or neither, then the blink or the band. Every pixel is written, so the
+ *        result doesn't depend on the previous frame.
+ *
+ * @param fb
+ * @param state     already passed through boundary_checks()
+ * @param frame
+ * @return false once frame is past the end (fb is then dark)
+ */
+bool light_anim_render(light_fb_t *fb, const light_display_state_t *state, int frame);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -38,6 +38,8 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "light_tables.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,23 +49,21 @@ extern "C" {
 #define LIGHT_DEFAULT_ON  1
 #define LIGHT_DEFAULT_OFF 0
 
-/* LED strip configuration */
-// Highest recorded temperature = 34
-// Lowest recorded temperature = -14
-// so use -15 to 35
-#define CONFIG_EXAMPLE_STRIP_LED_GPIO   10
-#define CONFIG_EXAMPLE_STRIP_LED_NUMBER (15 + 35)
-#define ZERO_CELSIUS_POSITION 15
+/* LED strip configuration: see the Kconfig menu. Positions, colours & brightness
+ * come from tables generated at build time, in light_tables.h */
+#define LIGHT_DEFAULT_BRIGHTNESS (LIGHT_BRIGHTNESS_LEVELS - 1)
 
 /**
-* @brief Set light power (on/off).
+* @brief Set light power (on/off), on every strip.
 *
 * @param  power  The light power to be set
 */
 void light_driver_set_power(bool power);
 
 /**
- * @brief Set light color using RGB values.
+ * @brief Set the colour of the status pixel, the first LED of every strip,
+ *        that light_driver_set_power() turns on and off. Readings keep
+ *        their colormap.
  *
  * @param red
  * @param green
@@ -71,6 +71,20 @@ void light_driver_set_power(bool power);
  */
 void light_driver_set_color(uint32_t red, uint32_t green, uint32_t blue);
 
+/**
+ * @brief Set the brightness level used for the next animation
+ *
+ * @param level 0 (dimmest) to LIGHT_BRIGHTNESS_LEVELS - 1, larger values are clamped
+ */
+void light_driver_set_brightness(uint8_t level);
+
+/**
+ * @brief Show the readings on the strips again, at the current brightness,
+ *        without the sweep. Doesn't block; strips with nothing shown yet
+ *        are left alone.
+ */
+void light_driver_redraw(void);
+
 /**
 * @brief color light driver init, be invoked where you want to use color light
 *
@@ -79,14 +93,48 @@ void light_driver_set_color(uint32_t red, uint32_t green, uint32_t blue);
 void light_driver_init(bool power);
 
 /**
- * @brief Used to animate LED display & then set relevant values
+ * @brief Have the render task report once every strip has finished animating
  *
- * @param temp_min
+ * @param cb    render_us: CPU time spent composing & sending the frames, NULL to stop
+ */
+void light_driver_set_render_report_cb(void (*cb)(uint32_t render_us));
+
+/**
+ * @brief Used to animate LED display & then set relevant values.
+ *
+ * Doesn't block: the values are posted to the render task, replacing any
+ * not yet picked up. A post during an animation restarts it. A value
+ * between two whole degrees lights the LEDs of both, weighted by how close
+ * it is to each.
+ *
+ * @param temp_min  centi-degrees C, as all the temperatures here
  * @param temp_now
  * @param temp_max
  */
 void light_animate_and_set(int temp_min, int temp_now, int temp_max);
 
+/**
+ * @brief light_animate_and_set() on one of CONFIG_LIGHT_DRIVER_STRIPS strips,
+ *        each animates independently
+ *
+ * @param strip     0 is the one light_animate_and_set() drives, past the last is ignored
+ * @param temp_min
+ * @param temp_now
+ * @param temp_max
+ */
+void light_strip_animate_and_set(int strip, int temp_min, int temp_now, int temp_max);
+
+/**
+ * @brief Like light_animate_and_set(), but without the sweep: the values show
+ *        from the first frame. For a stored reading at boot, before the
+ *        network is up.
+ *
+ * @param temp_min
+ * @param temp_now
+ * @param temp_max
+ */
+void light_show_last_known(int temp_min, int temp_now, int temp_max);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
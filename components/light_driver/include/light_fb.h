@@ -0,0 +1,114 @@
+/**
+ * @file light_fb.h
+ * @author The Authors
+ * @brief In-RAM framebuffer in front of led_strip, at most one refresh per frame
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "led_strip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* WS2812: 24 bits at 1.25 us each, plus the >= 50 us reset/latch low time */
+#define LIGHT_FB_WIRE_TIME_US(num_leds) ((num_leds) * 24 * 125 / 100 + 50)
+
+typedef struct {
+    uint32_t frames;            // light_fb_flush() calls
+    uint32_t refreshes;         // ... that pushed data to the strip
+    uint32_t pixel_writes;      // led_strip_set_pixel() calls
+    uint64_t bus_time_us;       // time spent in led_strip_refresh()
+} light_fb_stats_t;
+
+typedef struct {
+    led_strip_handle_t strip;
+    uint16_t num_leds;
+    uint8_t (*rgb)[3];          // frame being drawn
+    uint8_t (*sent)[3];         // as last sent to the strip
+    int dirty_lo;               // inclusive, dirty_lo > dirty_hi when clean
+    int dirty_hi;
+    light_fb_stats_t stats;
+    int64_t report_start_us;
+} light_fb_t;
+
+/**
+ * @brief Allocate the framebuffer, all pixels off
+ *
+ * @param fb
+ * @param strip
+ * @param num_leds
+ * @return esp_err_t
+ */
+esp_err_t light_fb_init(light_fb_t *fb, led_strip_handle_t strip, uint16_t num_leds);
+
+/**
+ * @brief Set a pixel. Writing the value it already has doesn't dirty it.
+ *
+ * @param fb
+ * @param index     out of range indices are ignored
+ * @param red
+ * @param green
+ * @param blue
+ */
+void light_fb_set_pixel(light_fb_t *fb, int index, uint8_t red, uint8_t green, uint8_t blue);
+
+/**
+ * @brief Set every pixel off
+ *
+ * @param fb
+ */
+void light_fb_clear(light_fb_t *fb);
+
+/**
+ * @brief True if every pixel is off
+ *
+ * @param fb
+ */
+bool light_fb_is_dark(const light_fb_t *fb);
+
+/**
+ * @brief End of frame: copy the dirty range to the strip and refresh once,
+ *        or do nothing if no pixel changed
+ *
+ * @param fb
+ * @return esp_err_t
+ */
+esp_err_t light_fb_flush(light_fb_t *fb);
+
+/**
+ * @brief Force the next flush to resend every pixel
+ *
+ * @param fb
+ */
+void light_fb_invalidate(light_fb_t *fb);
+
+/**
+ * @brief Draw on a different (e.g. re-created) strip, or NULL while there's
+ *        none. The next flush resends every pixel.
+ *
+ * @param fb
+ * @param strip
+ */
+void light_fb_set_strip(light_fb_t *fb, led_strip_handle_t strip);
+
+/**
+ * @brief Log refreshes/sec and bus time since the previous call, then reset the counters
+ *
+ * @param fb
+ * @param tag
+ */
+void light_fb_report(light_fb_t *fb, const char *tag);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
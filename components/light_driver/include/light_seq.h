@@ -0,0 +1,115 @@
+/**
+ * @file light_seq.h
+ * @author The Authors
+ * @brief Keyframe sequences of dots on the strip, eased in fixed point
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * An animation is declared, not coded: a sequence is a few layers, each a
+ * dot with a position track and a level track. A track is a list of
+ * keyframes; between two keys the value follows the easing curve of the
+ * later one. A key's value can be relative to an anchor (e.g. the LED
+ * showing temp_now) that the caller fills in, so one const sequence serves
+ * every reading.
+ *
+ * All of it is integer arithmetic, the ESP32-C3 has no FPU: time within a
+ * segment and the easing curves are Q16 (LIGHT_SEQ_ONE is 1.0), positions
+ * and levels Q8. A position between two LEDs lights both, each in its own
+ * palette colour weighted by how close the dot is, so a moving dot glides
+ * instead of stepping. A layer with an end track is a band from pos to end
+ * instead of a dot, its first and last LEDs weighted the same way, so a band
+ * of zero width is a dot. Overlapping layers keep the brighter of each
+ * channel.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "light_fb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LIGHT_SEQ_ONE           (1 << 16)   // 1.0 in Q16
+#define LIGHT_SEQ_LED(n)        ((n) << 8)  // LED index to a Q8 position
+#define LIGHT_SEQ_FULL          256         // level: the full palette colour
+#define LIGHT_SEQ_ANCHORS       8
+#define LIGHT_SEQ_ABS           0           // anchor of an absolute value
+
+typedef enum {
+    LIGHT_EASE_STEP = 0,        // hold the previous value, jump at the key
+    LIGHT_EASE_LINEAR,
+    LIGHT_EASE_IN,              // quadratic, slow start
+    LIGHT_EASE_OUT,             // quadratic, slow end
+    LIGHT_EASE_IN_OUT,          // smoothstep, slow at both ends
+} light_ease_t;
+
+typedef struct {
+    uint16_t frame;
+    uint8_t ease;               // light_ease_t, the curve from the previous key to this one
+    uint8_t anchor;             // LIGHT_SEQ_ABS or an index into light_seq_ctx_t.anchor
+    int32_t value;              // Q8, added to the anchor
+} light_key_t;
+
+typedef struct {
+    const light_key_t *keys;    // by frame, the first holds before it & the last after
+    uint8_t count;
+} light_track_t;
+
+typedef struct {
+    light_track_t pos;          // Q8 LED position
+    light_track_t level;        // Q8, LIGHT_SEQ_FULL is the palette colour
+    bool bright;                // palette at ctx.level, else at ctx.dim
+    light_track_t end;          // Q8, the other end of a band, no keys for a dot
+} light_layer_t;
+
+typedef struct {
+    const light_layer_t *layers;
+    uint8_t layer_count;
+    uint16_t frames;
+} light_seq_t;
+
+typedef struct {
+    int32_t anchor[LIGHT_SEQ_ANCHORS];  // Q8 positions, [LIGHT_SEQ_ABS] is unused
+    uint8_t level;              // palette levels
+    uint8_t dim;
+} light_seq_ctx_t;
+
+/**
+ * @brief An easing curve
+ *
+ * @param ease
+ * @param t     Q16, 0..LIGHT_SEQ_ONE
+ * @return Q16, 0 at t = 0, LIGHT_SEQ_ONE at t = LIGHT_SEQ_ONE, never decreasing
+ */
+int32_t light_ease(light_ease_t ease, int32_t t);
+
+/**
+ * @brief A track's value at a frame
+ *
+ * @param track     at least one key
+ * @param ctx
+ * @param frame
+ * @return Q8, rounded to nearest
+ */
+int32_t light_track_eval(const light_track_t *track, const light_seq_ctx_t *ctx, int frame);
+
+/**
+ * @brief Compose one frame of a sequence into fb. Every pixel is written,
+ *        so the result doesn't depend on the previous frame.
+ *
+ * @param fb
+ * @param seq
+ * @param ctx
+ * @param frame
+ * @return false once frame is past the end of seq (fb is then dark)
+ */
+bool light_seq_render(light_fb_t *fb, const light_seq_t *seq, const light_seq_ctx_t *ctx, int frame);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
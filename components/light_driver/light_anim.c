@@ -0,0 +1,223 @@
+/**
+ * @file light_anim.c
+ * @author The Authors
+ * @brief Sweep, glide & blink animation, one stateless frame at a time
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "light_driver.h"
+#include "light_anim.h"
+
+#include "light_seq.h"
+
+#define SWEEP_UP_FRAMES         LIGHT_STRIP_LEDS
+#define SWEEP_DOWN_FRAMES       (LIGHT_STRIP_LEDS - 1)
+#define BLINK_PHASES            10
+#define BLINK_PHASE_FRAMES      (500 / LIGHT_ANIM_TICK_MS)
+#define TWEEN_FRAMES            (1000 / LIGHT_ANIM_TICK_MS)
+
+/* Anchors of the built-in sequences */
+enum {
+    AT_MIN = 1,
+    AT_NOW,
+    AT_MAX,
+    AT_PREV_MIN,
+    AT_PREV_NOW,
+    AT_PREV_MAX,
+};
+
+#define KEY(frame, ease, anchor, value)     { (frame), LIGHT_EASE_##ease, (anchor), (value) }
+#define TRACK(keys)                         { (keys), sizeof(keys) / sizeof((keys)[0]) }
+#define ON(phase)                           KEY((phase) * BLINK_PHASE_FRAMES, STEP, LIGHT_SEQ_ABS, LIGHT_SEQ_FULL)
+#define OFF(phase)                          KEY((phase) * BLINK_PHASE_FRAMES, STEP, LIGHT_SEQ_ABS, 0)
+
+static const light_key_t s_full[] = { KEY(0, STEP, LIGHT_SEQ_ABS, LIGHT_SEQ_FULL) };
+
+/* A single dot sweeps up, then back down, one LED a frame */
+static const light_key_t s_sweep_pos[] = {
+    KEY(0, STEP, LIGHT_SEQ_ABS, 0),
+    KEY(SWEEP_UP_FRAMES - 1, LINEAR, LIGHT_SEQ_ABS, LIGHT_SEQ_LED(LIGHT_STRIP_LEDS - 1)),
+    KEY(SWEEP_UP_FRAMES, STEP, LIGHT_SEQ_ABS, LIGHT_SEQ_LED(LIGHT_STRIP_LEDS - 1)),
+    KEY(SWEEP_UP_FRAMES + SWEEP_DOWN_FRAMES - 1, LINEAR, LIGHT_SEQ_ABS, LIGHT_SEQ_LED(1)),
+};
+static const light_layer_t s_sweep_layers[] = {
+    { .pos = TRACK(s_sweep_pos), .level = TRACK(s_full) },
+};
+
+/* Set the values & blink min & max, temp_now stays on after the first phase */
+static const light_key_t s_blink_level[] = {
+    OFF(0), ON(1), OFF(2), ON(3), OFF(4), ON(5), OFF(6), ON(7), OFF(8), ON(9),
+};
+static const light_key_t s_now_level[] = { OFF(0), ON(1) };
+static const light_key_t s_min_pos[] = { KEY(0, STEP, AT_MIN, 0) };
+static const light_key_t s_now_pos[] = { KEY(0, STEP, AT_NOW, 0) };
+static const light_key_t s_max_pos[] = { KEY(0, STEP, AT_MAX, 0) };
+static const light_layer_t s_blink_layers[] = {
+    { .pos = TRACK(s_min_pos), .level = TRACK(s_blink_level) },
+    { .pos = TRACK(s_max_pos), .level = TRACK(s_blink_level) },
+    { .pos = TRACK(s_now_pos), .level = TRACK(s_now_level), .bright = true },
+};
+
+/* The previous reading's dots glide to the new one's */
+static const light_key_t s_tween_min[] = {
+    KEY(0, STEP, AT_PREV_MIN, 0),
+    KEY(TWEEN_FRAMES - 1, IN_OUT, AT_MIN, 0),
+};
+static const light_key_t s_tween_now[] = {
+    KEY(0, STEP, AT_PREV_NOW, 0),
+    KEY(TWEEN_FRAMES - 1, IN_OUT, AT_NOW, 0),
+};
+static const light_key_t s_tween_max[] = {
+    KEY(0, STEP, AT_PREV_MAX, 0),
+    KEY(TWEEN_FRAMES - 1, IN_OUT, AT_MAX, 0),
+};
+static const light_layer_t s_tween_layers[] = {
+    { .pos = TRACK(s_tween_min), .level = TRACK(s_full) },
+    { .pos = TRACK(s_tween_max), .level = TRACK(s_full) },
+    { .pos = TRACK(s_tween_now), .level = TRACK(s_full), .bright = true },
+};
+
+/* The range as a band fading in under temp_now, instead of the blinking dots */
+static const light_key_t s_band_level[] = {
+    KEY(0, STEP, LIGHT_SEQ_ABS, 0),
+    KEY(BLINK_PHASE_FRAMES, OUT, LIGHT_SEQ_ABS, LIGHT_SEQ_FULL),
+};
+static const light_layer_t s_band_layers[] = {
+    { .pos = TRACK(s_min_pos), .end = TRACK(s_max_pos), .level = TRACK(s_band_level) },
+    { .pos = TRACK(s_now_pos), .level = TRACK(s_now_level), .bright = true },
+};
+
+#define SEQ(layers, frames) { (layers), sizeof(layers) / sizeof((layers)[0]), (frames) }
+
+const light_seq_t light_seq_sweep = SEQ(s_sweep_layers, SWEEP_UP_FRAMES + SWEEP_DOWN_FRAMES);
+const light_seq_t light_seq_blink = SEQ(s_blink_layers, BLINK_PHASES * BLINK_PHASE_FRAMES);
+const light_seq_t light_seq_tween = SEQ(s_tween_layers, TWEEN_FRAMES);
+const light_seq_t light_seq_band = SEQ(s_band_layers, BLINK_PHASES * BLINK_PHASE_FRAMES);
+
+/* What to play for a state, one sequence after another */
+typedef struct {
+    const light_seq_t *seq;
+    int from;                   // first frame of it
+} play_step_t;
+
+static const play_step_t s_play_sweep[] = {
+    { &light_seq_sweep, 0 },
+    { &light_seq_blink, 0 },
+    { NULL },
+};
+static const play_step_t s_play_tween[] = {
+    { &light_seq_tween, 0 },
+    { &light_seq_blink, BLINK_PHASE_FRAMES },  // min & max are still on from the tween
+    { NULL },
+};
+static const play_step_t s_play_values[] = {
+    { &light_seq_blink, BLINK_PHASE_FRAMES },  // the first phase that shows anything
+    { NULL },
+};
+static const play_step_t s_play_sweep_band[] = {
+    { &light_seq_sweep, 0 },
+    { &light_seq_band, 0 },
+    { NULL },
+};
+static const play_step_t s_play_tween_band[] = {
+    { &light_seq_tween, 0 },
+    { &light_seq_band, 0 },
+    { NULL },
+};
+static const play_step_t s_play_values_band[] = {
+    { &light_seq_band, BLINK_PHASE_FRAMES },   // faded in already
+    { NULL },
+};
+
+#define TEMP_LO     (LIGHT_TEMP_MIN_C * TEMP_CENTI_PER_C)
+#define TEMP_HI     (LIGHT_TEMP_MAX_C * TEMP_CENTI_PER_C)
+#define TEMP_GAP    TEMP_CENTI_PER_C        // between min, now & max
+
+void boundary_checks(int *temp_min, int *temp_now, int *temp_max) {
+    if (*temp_min < TEMP_LO) {
+        *temp_min = TEMP_LO;
+    }
+    if (*temp_max > TEMP_HI) {
+        *temp_max = TEMP_HI;
+    }
+    if (*temp_now < TEMP_LO) {
+        *temp_now = TEMP_LO + TEMP_GAP;
+    }
+    if (*temp_now > TEMP_HI) {
+        *temp_now = TEMP_HI - TEMP_GAP;
+    }
+
+    // Logic checks
+    if (*temp_now - *temp_min < TEMP_GAP) {
+        *temp_min = *temp_now - TEMP_GAP;
+    }
+    if (*temp_max - *temp_now < TEMP_GAP) {
+        *temp_max = *temp_now + TEMP_GAP;
+    }
+    if (*temp_min < TEMP_LO) {
+        *temp_min = TEMP_LO;
+    }
+    if (*temp_max > TEMP_HI) {
+        *temp_max = TEMP_HI;
+    }
+}
+
+int light_anim_temp_to_led(int temp) {
+    if (temp < LIGHT_TEMP_MIN_C) {
+        temp = LIGHT_TEMP_MIN_C;
+    } else if (temp > LIGHT_TEMP_MAX_C) {
+        temp = LIGHT_TEMP_MAX_C;
+    }
+    return light_temp_to_led[temp - LIGHT_TEMP_MIN_C];
+}
+
+int32_t light_anim_temp_to_pos(int centi) {
+    if (centi <= TEMP_LO) {
+        return LIGHT_SEQ_LED(light_temp_to_led[0]);
+    }
+    if (centi >= TEMP_HI) {
+        return LIGHT_SEQ_LED(light_temp_to_led[LIGHT_TEMP_MAX_C - LIGHT_TEMP_MIN_C]);
+    }
+    int index = (centi - TEMP_LO) / TEMP_CENTI_PER_C;
+    int frac = (centi - TEMP_LO) % TEMP_CENTI_PER_C;
+    int32_t led = LIGHT_SEQ_LED(light_temp_to_led[index]);
+    int32_t next = LIGHT_SEQ_LED(light_temp_to_led[index + 1]);
+
+    return led + ((next - led) * frac + TEMP_CENTI_PER_C / 2) / TEMP_CENTI_PER_C;
+}
+
+bool light_anim_render(light_fb_t *fb, const light_display_state_t *state, int frame) {
+    light_seq_ctx_t ctx = {
+        .anchor = {
+            [AT_MIN] = light_anim_temp_to_pos(state->temp_min),
+            [AT_NOW] = light_anim_temp_to_pos(state->temp_now),
+            [AT_MAX] = light_anim_temp_to_pos(state->temp_max),
+            [AT_PREV_MIN] = light_anim_temp_to_pos(state->prev_min),
+            [AT_PREV_NOW] = light_anim_temp_to_pos(state->prev_now),
+            [AT_PREV_MAX] = light_anim_temp_to_pos(state->prev_max),
+        },
+    };
+    ctx.level = state->brightness < LIGHT_BRIGHTNESS_LEVELS ? state->brightness : LIGHT_BRIGHTNESS_LEVELS - 1;
+    ctx.dim = ctx.level > 0 ? ctx.level - 1 : 0;
+
+    const play_step_t *step;
+    if (state->band) {
+        step = state->skip_sweep ? s_play_values_band : state->tween ? s_play_tween_band : s_play_sweep_band;
+    } else {
+        step = state->skip_sweep ? s_play_values : state->tween ? s_play_tween : s_play_sweep;
+    }
+    for (; step->seq; step++) {
+        int frames = step->seq->frames - step->from;
+        if (frame < frames) {
+            return light_seq_render(fb, step->seq, &ctx, step->from + frame);
+        }
+        frame -= frames;
+    }
+
+    // Then turn all off
+    light_fb_clear(fb);
+    return false;
+}
@@ -35,32 +35,84 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <assert.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_bit_defs.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "soc/soc_caps.h"
 #include "led_strip.h"
 #include "light_driver.h"
+#include "light_fb.h"
+#include "light_anim.h"
+#include "power.h"
+#include "trace_sys.h"
+
+#define RENDER_TASK_STACK       3072
+#define RENDER_TASK_PRIORITY    6       // above http_get_task so frames stay on time
+
+#if CONFIG_LIGHT_DRIVER_RMT_WITH_DMA
+#define RMT_WITH_DMA            true
+#define RMT_MEM_BLOCK_SYMBOLS   1024    // with DMA this sizes the DMA buffer
+#else
+#define RMT_WITH_DMA            false
+#define RMT_MEM_BLOCK_SYMBOLS   64
+#endif
 
 static const char *TAG = __FILE__;
 
-static led_strip_handle_t s_led_strip;
-static uint8_t s_red = 255, s_green = 255, s_blue = 255;
+#define STRIPS                  CONFIG_LIGHT_DRIVER_STRIPS
 
-void light_driver_set_power(bool power) {
-    ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, 0, s_red * power, s_green * power, s_blue * power));
-    ESP_ERROR_CHECK(led_strip_refresh(s_led_strip));
-}
+_Static_assert(STRIPS <= SOC_RMT_TX_CANDIDATES_PER_GROUP, "each strip takes an RMT TX channel");
 
-void light_driver_set_color(uint32_t red, uint32_t green, uint32_t blue) {
-    s_red = red;
-    s_green = green;
-    s_blue = blue;
-    ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, 0, s_red, s_green, s_blue));
-    ESP_ERROR_CHECK(led_strip_refresh(s_led_strip));
-}
+/* Render task notification bits */
+#define RENDER_TICK             BIT0    // s_frame_timer
+#define RENDER_POST             BIT1    // a new display state in some strip's mailbox
+#define RENDER_REDRAW           BIT2    // the shown states again, at s_brightness
 
-void light_driver_init(bool power) {
+typedef struct {
+    int gpio;
+    led_strip_handle_t handle;      // NULL while released
+    light_fb_t fb;
+    QueueHandle_t mailbox;          // depth 1, newest state overwrites
+    light_display_state_t state;    // render task only, from here down
+    int frame;
+    bool animating;
+    bool shown;                     // state has been drawn, the next one can glide from it
+    uint32_t render_cycles;         // this animation's, for the trace
+} light_strip_t;
+
+static const int s_strip_gpios[STRIPS] = {
+    CONFIG_EXAMPLE_STRIP_LED_GPIO,
+#if STRIPS > 1
+    CONFIG_LIGHT_DRIVER_STRIP1_GPIO,
+#endif
+#if STRIPS > 2
+    CONFIG_LIGHT_DRIVER_STRIP2_GPIO,
+#endif
+#if STRIPS > 3
+    CONFIG_LIGHT_DRIVER_STRIP3_GPIO,
+#endif
+};
+
+static light_strip_t s_strips[STRIPS];
+static uint8_t s_red = 255, s_green = 255, s_blue = 255;
+static uint8_t s_brightness = LIGHT_DEFAULT_BRIGHTNESS;
+
+static SemaphoreHandle_t s_strip_lock;      // render task vs. set_power/set_color
+static TaskHandle_t s_render_task;
+static esp_timer_handle_t s_frame_timer;
+static void (*s_render_report_cb)(uint32_t render_us);     // optional
+
+static led_strip_handle_t strip_new(int gpio) {
+    led_strip_handle_t strip;
     led_strip_config_t led_strip_conf = {
         .max_leds = CONFIG_EXAMPLE_STRIP_LED_NUMBER,
-        .strip_gpio_num = CONFIG_EXAMPLE_STRIP_LED_GPIO,
+        .strip_gpio_num = gpio,
         .led_model = LED_MODEL_WS2812,           // LED strip model
         .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,    // The color order of the strip: GRB
         .flags = {
@@ -70,77 +122,235 @@ void light_driver_init(bool power) {
     led_strip_rmt_config_t rmt_conf = {
         .clk_src = RMT_CLK_SRC_DEFAULT,        // different clock source can lead to different power consumption
         .resolution_hz = 10 * 1000 * 1000,      // 10MHz
-        .mem_block_symbols = 64,               // the memory size of each RMT channel, in words (4 bytes)
+        .mem_block_symbols = RMT_MEM_BLOCK_SYMBOLS, // the memory size of each RMT channel, in words (4 bytes)
         .flags = {
-            .with_dma = false,                  // DMA feature is available on chips like ESP32-S3/P4
+            .with_dma = RMT_WITH_DMA,           // DMA feature is available on chips like ESP32-S3/P4
         }
     };
 
-    ESP_ERROR_CHECK(led_strip_new_rmt_device(&led_strip_conf, &rmt_conf, &s_led_strip));
-    light_driver_set_power(power);
+    ESP_ERROR_CHECK(led_strip_new_rmt_device(&led_strip_conf, &rmt_conf, &strip));
+    return strip;
 }
 
-void boundary_checks(int *temp_min, int *temp_now, int *temp_max) {
-    if (*temp_min < -15) {
-        *temp_min = -15;
+/* Called with s_strip_lock held: the RMT device may have been released */
+static void strip_attach(light_strip_t *st) {
+    if (!st->handle) {
+        st->handle = strip_new(st->gpio);
+        light_fb_set_strip(&st->fb, st->handle);
     }
-    if (*temp_max > 35) {
-        *temp_max = 35;
+}
+
+/* Called with s_strip_lock held. The WS2812s latch the last frame, so once
+ * it's all off the RMT channel (and the PM lock it holds while enabled) can go. */
+static void strip_release_if_dark(light_strip_t *st) {
+#if CONFIG_POWER_SAVE
+    if (st->handle && light_fb_is_dark(&st->fb)) {
+        ESP_ERROR_CHECK(led_strip_del(st->handle));
+        st->handle = NULL;
+        light_fb_set_strip(&st->fb, NULL);
     }
-    if (*temp_now < -15) {
-        *temp_now = -14;
+#endif
+}
+
+/* Pixel 0 of every strip */
+static void set_first_pixel(uint8_t red, uint8_t green, uint8_t blue) {
+    for (int i = 0; i < STRIPS; i++) {
+        light_strip_t *st = &s_strips[i];
+        strip_attach(st);
+        light_fb_set_pixel(&st->fb, 0, red, green, blue);
+        ESP_ERROR_CHECK(light_fb_flush(&st->fb));
+        strip_release_if_dark(st);
     }
-    if (*temp_now > 35) {
-        *temp_now = 34;
+}
+
+void light_driver_set_power(bool power) {
+    xSemaphoreTake(s_strip_lock, portMAX_DELAY);
+    set_first_pixel(s_red * power, s_green * power, s_blue * power);
+    xSemaphoreGive(s_strip_lock);
+}
+
+void light_driver_set_color(uint32_t red, uint32_t green, uint32_t blue) {
+    xSemaphoreTake(s_strip_lock, portMAX_DELAY);
+    s_red = red;
+    s_green = green;
+    s_blue = blue;
+    set_first_pixel(s_red, s_green, s_blue);
+    xSemaphoreGive(s_strip_lock);
+}
+
+void light_driver_set_brightness(uint8_t level) {
+    s_brightness = level < LIGHT_BRIGHTNESS_LEVELS ? level : LIGHT_BRIGHTNESS_LEVELS - 1;
+}
+
+void light_driver_redraw(void) {
+    if (s_render_task) {
+        xTaskNotify(s_render_task, RENDER_REDRAW, eSetBits);
     }
+}
+
+static void frame_timer_cb(void *arg) {
+    xTaskNotify(s_render_task, RENDER_TICK, eSetBits);
+}
 
-    // Logic checks
-    if (*temp_now <= *temp_min) {
-        *temp_min = *temp_now - 1;
+/* From the first frame of st->state; starts the frame timer for the first strip */
+static void start_animation(light_strip_t *st, int *animating) {
+    st->frame = 0;
+    if (!st->animating) {
+        st->animating = true;
+        st->render_cycles = 0;
+        if ((*animating)++ == 0) {
+            power_begin(POWER_RENDER);
+            ESP_ERROR_CHECK(esp_timer_start_periodic(s_frame_timer, LIGHT_ANIM_TICK_MS * 1000));
+        }
     }
-    if (*temp_max < *temp_now) {
-        *temp_max = *temp_now + 1;
+}
+
+/**
+ * @brief Owns the strips while animating. Frames are paced by s_frame_timer,
+ *        shared by all strips and running while any of them animates. A
+ *        newer display state restarts that strip's animation from the first
+ *        frame.
+ */
+static void light_render_task(void *pvParameters) {
+    int animating = 0;      // strips
+    int64_t render_us = 0;  // composing & sending frames, since the first strip started
+
+    while (1) {
+        uint32_t events;
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+
+        if (events & RENDER_POST) {
+            for (int i = 0; i < STRIPS; i++) {
+                light_strip_t *st = &s_strips[i];
+                light_display_state_t state;
+                if (xQueueReceive(st->mailbox, &state, 0) != pdTRUE) {
+                    continue;
+                }
+#if CONFIG_LIGHT_DRIVER_TWEEN
+                if (st->shown) {
+                    state.tween = true;
+                    state.prev_min = st->state.temp_min;
+                    state.prev_now = st->state.temp_now;
+                    state.prev_max = st->state.temp_max;
+                }
+#endif
+                st->state = state;
+                st->shown = true;
+                ESP_LOGI(TAG, "%s strip %d temp_min=" TEMP_C_FMT ", temp_now=" TEMP_C_FMT ", temp_max=" TEMP_C_FMT,
+                         st->animating ? "New display, restarting" : "Display", i, TEMP_C_ARGS(st->state.temp_min),
+                         TEMP_C_ARGS(st->state.temp_now), TEMP_C_ARGS(st->state.temp_max));
+                start_animation(st, &animating);
+            }
+        }
+        if (events & RENDER_REDRAW) {
+            /* Same values, new brightness: straight to them, no sweep or glide */
+            for (int i = 0; i < STRIPS; i++) {
+                light_strip_t *st = &s_strips[i];
+                if (!st->shown) {
+                    continue;
+                }
+                st->state.brightness = s_brightness;
+                st->state.skip_sweep = true;
+                st->state.tween = false;
+                start_animation(st, &animating);
+            }
+        }
+        if (!(events & RENDER_TICK)) {
+            continue;
+        }
+
+        for (int i = 0; i < STRIPS; i++) {
+            light_strip_t *st = &s_strips[i];
+            if (!st->animating) {
+                continue;
+            }
+            xSemaphoreTake(s_strip_lock, portMAX_DELAY);
+            uint32_t t = trace_now();
+            int64_t start = esp_timer_get_time();
+            strip_attach(st);
+            st->animating = light_anim_render(&st->fb, &st->state, st->frame++);
+            ESP_ERROR_CHECK(light_fb_flush(&st->fb));
+            if (!st->animating) {
+                strip_release_if_dark(st);
+            }
+            render_us += esp_timer_get_time() - start;
+            st->render_cycles += trace_now() - t;
+            xSemaphoreGive(s_strip_lock);
+
+            if (!st->animating) {
+                trace_record(TRACE_RENDER, st->render_cycles);
+                light_fb_report(&st->fb, TAG);
+                if (--animating == 0) {
+                    ESP_ERROR_CHECK(esp_timer_stop(s_frame_timer));
+                    power_end(POWER_RENDER);
+                    if (s_render_report_cb) {
+                        s_render_report_cb(render_us);
+                    }
+                    render_us = 0;
+                }
+            }
+        }
     }
-    if (*temp_min < -15) {
-        *temp_min = -15;
+}
+
+static void post_display_state(int strip, int temp_min, int temp_now, int temp_max, bool skip_sweep) {
+    if (strip < 0 || strip >= STRIPS) {
+        ESP_LOGW(TAG, "No strip %d, %d configured", strip, STRIPS);
+        return;
     }
+    boundary_checks(&temp_min, &temp_now, &temp_max);
+
+    light_display_state_t state = {
+        .temp_min = temp_min,
+        .temp_now = temp_now,
+        .temp_max = temp_max,
+        .brightness = s_brightness,
+        .skip_sweep = skip_sweep,
+#if CONFIG_LIGHT_DRIVER_BAND
+        .band = true,
+#endif
+    };
+    xQueueOverwrite(s_strips[strip].mailbox, &state);
+    xTaskNotify(s_render_task, RENDER_POST, eSetBits);
+}
+
+void light_strip_animate_and_set(int strip, int temp_min, int temp_now, int temp_max) {
+    post_display_state(strip, temp_min, temp_now, temp_max, false);
 }
 
 void light_animate_and_set(int temp_min, int temp_now, int temp_max) {
-    ESP_LOGI(TAG, "light_animate_and_set: temp_min=%d, temp_now=%d, temp_max=%d", temp_min, temp_now, temp_max);
-    boundary_checks(&temp_min, &temp_now, &temp_max);
-    // First animate
-    for (int index = 0; index < CONFIG_EXAMPLE_STRIP_LED_NUMBER; index++) {
-        ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, index, 5, 5, 5));
-        ESP_ERROR_CHECK(led_strip_refresh(s_led_strip));
-        vTaskDelay(pdMS_TO_TICKS(50));
-        ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, index, 0, 0, 0));
-    }
-    for (int index = CONFIG_EXAMPLE_STRIP_LED_NUMBER - 1; index > 0; index--) {
-        ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, index, 5, 5, 5));
-        ESP_ERROR_CHECK(led_strip_refresh(s_led_strip));
-        vTaskDelay(pdMS_TO_TICKS(50));
-        ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, index, 0, 0, 0));
-    }
-    // Second set values & blink min & max
-    int animate_time = 10;
-    bool led_on_off = false;
-    while (animate_time > 0) {
-        if (led_on_off) {
-            ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, ZERO_CELSIUS_POSITION + temp_min, 5, 5, 5));
-            ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, ZERO_CELSIUS_POSITION + temp_now, 5, 5, 5));
-            ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, ZERO_CELSIUS_POSITION + temp_max, 5, 5, 5));
-        } else {
-            /* Turn off min & max but leave on temp_now */
-            ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, ZERO_CELSIUS_POSITION + temp_min, 0, 0, 0));
-            ESP_ERROR_CHECK(led_strip_set_pixel(s_led_strip, ZERO_CELSIUS_POSITION + temp_max, 0, 0, 0));
-        }
-        /* Refresh the strip to send data */
-        ESP_ERROR_CHECK(led_strip_refresh(s_led_strip));
-        led_on_off = !led_on_off;
-        vTaskDelay(pdMS_TO_TICKS(500));
-        --animate_time;
+    post_display_state(0, temp_min, temp_now, temp_max, false);
+}
+
+void light_show_last_known(int temp_min, int temp_now, int temp_max) {
+    post_display_state(0, temp_min, temp_now, temp_max, true);
+}
+
+void light_driver_set_render_report_cb(void (*cb)(uint32_t render_us)) {
+    s_render_report_cb = cb;
+}
+
+void light_driver_init(bool power) {
+    for (int i = 0; i < STRIPS; i++) {
+        light_strip_t *st = &s_strips[i];
+        st->gpio = s_strip_gpios[i];
+        st->handle = strip_new(st->gpio);
+        ESP_ERROR_CHECK(light_fb_init(&st->fb, st->handle, CONFIG_EXAMPLE_STRIP_LED_NUMBER));
+        light_fb_invalidate(&st->fb);   // strip state is unknown until the first flush
+        st->mailbox = xQueueCreate(1, sizeof(light_display_state_t));
+        assert(st->mailbox);
     }
-    // Third turn all off
-    ESP_ERROR_CHECK(led_strip_clear(s_led_strip));
+
+    s_strip_lock = xSemaphoreCreateMutex();
+    assert(s_strip_lock);
+
+    light_driver_set_power(power);
+
+    const esp_timer_create_args_t frame_timer_args = {
+        .callback = frame_timer_cb,
+        .name = "light_frame",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&frame_timer_args, &s_frame_timer));
+    xTaskCreate(&light_render_task, "light_render_task", RENDER_TASK_STACK, NULL, RENDER_TASK_PRIORITY, &s_render_task);
+    trace_watch_task(s_render_task);
 }
@@ -0,0 +1,145 @@
+/**
+ * @file light_fb.c
+ * @author The Authors
+ * @brief In-RAM framebuffer in front of led_strip, at most one refresh per frame
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * WS2812s can't be partially updated, every refresh clocks out the whole
+ * strip. So the saving comes from not refreshing at all when a frame didn't
+ * change anything, and from only copying the dirty range into led_strip.
+ * `sent` mirrors what the strip shows so frames can be redrawn from scratch.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "light_fb.h"
+
+static inline void mark_dirty(light_fb_t *fb, int index) {
+    if (index < fb->dirty_lo) {
+        fb->dirty_lo = index;
+    }
+    if (index > fb->dirty_hi) {
+        fb->dirty_hi = index;
+    }
+}
+
+static inline void mark_clean(light_fb_t *fb) {
+    fb->dirty_lo = fb->num_leds;
+    fb->dirty_hi = -1;
+}
+
+esp_err_t light_fb_init(light_fb_t *fb, led_strip_handle_t strip, uint16_t num_leds) {
+    memset(fb, 0, sizeof(*fb));
+    fb->rgb = calloc(num_leds, sizeof(fb->rgb[0]));
+    fb->sent = calloc(num_leds, sizeof(fb->sent[0]));
+    if (!fb->rgb || !fb->sent) {
+        free(fb->rgb);
+        free(fb->sent);
+        return ESP_ERR_NO_MEM;
+    }
+    fb->strip = strip;
+    fb->num_leds = num_leds;
+    mark_clean(fb);
+    fb->report_start_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+void light_fb_set_pixel(light_fb_t *fb, int index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index < 0 || index >= fb->num_leds) {
+        return;
+    }
+    uint8_t *px = fb->rgb[index];
+    if (px[0] == red && px[1] == green && px[2] == blue) {
+        return;
+    }
+    px[0] = red;
+    px[1] = green;
+    px[2] = blue;
+    mark_dirty(fb, index);
+}
+
+void light_fb_clear(light_fb_t *fb) {
+    for (int i = 0; i < fb->num_leds; i++) {
+        light_fb_set_pixel(fb, i, 0, 0, 0);
+    }
+}
+
+bool light_fb_is_dark(const light_fb_t *fb) {
+    for (int i = 0; i < fb->num_leds; i++) {
+        if (fb->rgb[i][0] | fb->rgb[i][1] | fb->rgb[i][2]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void light_fb_invalidate(light_fb_t *fb) {
+    memset(fb->sent, 0xff, fb->num_leds * sizeof(fb->sent[0]));     // can't match anything we'd draw
+    fb->dirty_lo = 0;
+    fb->dirty_hi = fb->num_leds - 1;
+}
+
+void light_fb_set_strip(light_fb_t *fb, led_strip_handle_t strip) {
+    fb->strip = strip;
+    light_fb_invalidate(fb);
+}
+
+esp_err_t light_fb_flush(light_fb_t *fb) {
+    fb->stats.frames++;
+
+    /* A pixel cleared and redrawn within the frame isn't a change, trim those off */
+    while (fb->dirty_lo <= fb->dirty_hi && memcmp(fb->rgb[fb->dirty_lo], fb->sent[fb->dirty_lo], 3) == 0) {
+        fb->dirty_lo++;
+    }
+    while (fb->dirty_hi >= fb->dirty_lo && memcmp(fb->rgb[fb->dirty_hi], fb->sent[fb->dirty_hi], 3) == 0) {
+        fb->dirty_hi--;
+    }
+    if (fb->dirty_lo > fb->dirty_hi) {
+        mark_clean(fb);
+        return ESP_OK;
+    }
+
+    for (int i = fb->dirty_lo; i <= fb->dirty_hi; i++) {
+        if (memcmp(fb->rgb[i], fb->sent[i], 3) == 0) {
+            continue;
+        }
+        esp_err_t err = led_strip_set_pixel(fb->strip, i, fb->rgb[i][0], fb->rgb[i][1], fb->rgb[i][2]);
+        if (err != ESP_OK) {
+            return err;
+        }
+        fb->stats.pixel_writes++;
+    }
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = led_strip_refresh(fb->strip);
+    fb->stats.bus_time_us += esp_timer_get_time() - start;
+    if (err != ESP_OK) {
+        return err;
+    }
+    fb->stats.refreshes++;
+    memcpy(fb->sent[fb->dirty_lo], fb->rgb[fb->dirty_lo], (fb->dirty_hi - fb->dirty_lo + 1) * sizeof(fb->rgb[0]));
+    mark_clean(fb);
+    return ESP_OK;
+}
+
+void light_fb_report(light_fb_t *fb, const char *tag) {
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed_ms = (now - fb->report_start_us) / 1000;
+    if (elapsed_ms <= 0) {
+        elapsed_ms = 1;
+    }
+
+    ESP_LOGI(tag, "frames=%" PRIu32 " refreshes=%" PRIu32 " (%" PRIu32 ".%02" PRIu32 "/s) pixel_writes=%" PRIu32
+             " bus_time=%" PRIu64 "us (wire %dus/refresh)",
+             fb->stats.frames, fb->stats.refreshes,
+             (uint32_t)(fb->stats.refreshes * 1000 / elapsed_ms), (uint32_t)(fb->stats.refreshes * 100000 / elapsed_ms % 100),
+             fb->stats.pixel_writes, fb->stats.bus_time_us, LIGHT_FB_WIRE_TIME_US(fb->num_leds));
+
+    memset(&fb->stats, 0, sizeof(fb->stats));
+    fb->report_start_us = now;
+}
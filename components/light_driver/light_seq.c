@@ -0,0 +1,129 @@
+/**
+ * @file light_seq.c
+ * @author The Authors
+ * @brief Keyframe sequences of dots on the strip, eased in fixed point
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include "light_tables.h"
+#include "light_seq.h"
+
+#define POS_MAX     LIGHT_SEQ_LED(LIGHT_STRIP_LEDS - 1)
+
+int32_t light_ease(light_ease_t ease, int32_t t) {
+    if (t <= 0) {
+        return 0;
+    }
+    if (t >= LIGHT_SEQ_ONE) {
+        return LIGHT_SEQ_ONE;
+    }
+    int64_t t2 = ((int64_t)t * t) >> 16;
+    int64_t u = LIGHT_SEQ_ONE - t;
+
+    switch (ease) {
+    case LIGHT_EASE_STEP:
+        return 0;
+    case LIGHT_EASE_IN:
+        return t2;
+    case LIGHT_EASE_OUT:
+        return LIGHT_SEQ_ONE - ((u * u) >> 16);
+    case LIGHT_EASE_IN_OUT:                             // 3t^2 - 2t^3
+        return (t2 * (3 * LIGHT_SEQ_ONE - 2 * (int64_t)t)) >> 16;
+    case LIGHT_EASE_LINEAR:
+    default:
+        return t;
+    }
+}
+
+static inline int32_t key_value(const light_key_t *key, const light_seq_ctx_t *ctx) {
+    return key->value + (key->anchor != LIGHT_SEQ_ABS ? ctx->anchor[key->anchor] : 0);
+}
+
+int32_t light_track_eval(const light_track_t *track, const light_seq_ctx_t *ctx, int frame) {
+    const light_key_t *keys = track->keys;
+    uint8_t i = 0;
+
+    while (i + 1 < track->count && keys[i + 1].frame <= frame) {
+        i++;
+    }
+    if (i + 1 >= track->count || frame <= keys[i].frame) {
+        return key_value(&keys[i], ctx);
+    }
+
+    const light_key_t *from = &keys[i];
+    const light_key_t *to = &keys[i + 1];
+    int32_t t = ((int32_t)(frame - from->frame) << 16) / (to->frame - from->frame);
+    int32_t v0 = key_value(from, ctx);
+    int64_t span = (int64_t)key_value(to, ctx) - v0;
+
+    return v0 + (int32_t)((span * light_ease(to->ease, t) + (LIGHT_SEQ_ONE / 2)) >> 16);
+}
+
+static inline int32_t clamp_pos(int32_t pos) {
+    return pos < 0 ? 0 : pos > POS_MAX ? POS_MAX : pos;
+}
+
+/*
+ * Lighten one LED towards its palette colour at weight (Q8). A part weight
+ * scales the colour before gamma correction, so half weight looks half as
+ * bright rather than being half the PWM value.
+ */
+static void blend(light_fb_t *fb, int index, uint8_t palette, uint32_t weight) {
+    if (weight == 0 || index < 0 || index >= fb->num_leds || index >= LIGHT_STRIP_LEDS) {
+        return;
+    }
+    const uint8_t *old = fb->rgb[index];
+    uint8_t px[3];
+    if (weight >= LIGHT_SEQ_FULL) {
+        memcpy(px, light_palette[palette][index], 3);
+    } else {
+        const uint8_t *rgb = light_palette_perceptual[palette][index];
+        for (int c = 0; c < 3; c++) {
+            px[c] = light_gamma[(rgb[c] * weight + 128) >> 8];
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        px[c] = px[c] > old[c] ? px[c] : old[c];
+    }
+    light_fb_set_pixel(fb, index, px[0], px[1], px[2]);
+}
+
+bool light_seq_render(light_fb_t *fb, const light_seq_t *seq, const light_seq_ctx_t *ctx, int frame) {
+    light_fb_clear(fb);
+    if (frame < 0 || frame >= seq->frames) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < seq->layer_count; i++) {
+        const light_layer_t *layer = &seq->layers[i];
+        int32_t level = light_track_eval(&layer->level, ctx, frame);
+        if (level <= 0) {
+            continue;
+        }
+        if (level > LIGHT_SEQ_FULL) {
+            level = LIGHT_SEQ_FULL;
+        }
+        int32_t pos = clamp_pos(light_track_eval(&layer->pos, ctx, frame));
+        int32_t end = layer->end.count ? clamp_pos(light_track_eval(&layer->end, ctx, frame)) : pos;
+        if (end < pos) {
+            int32_t swap = pos;
+            pos = end;
+            end = swap;
+        }
+
+        /* The LEDs either side of the ends in part, every one between in full */
+        int led = pos >> 8;
+        int last = end >> 8;
+        uint8_t palette = layer->bright ? ctx->level : ctx->dim;
+        blend(fb, led, palette, (level * (LIGHT_SEQ_FULL - (pos & 0xff))) >> 8);
+        for (int i = led + 1; i <= last; i++) {
+            blend(fb, i, palette, level);
+        }
+        blend(fb, last + 1, palette, (level * (end & 0xff)) >> 8);
+    }
+    return true;
+}
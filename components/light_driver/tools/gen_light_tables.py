@@ -0,0 +1,148 @@
+#!/usr/bin/env python
+#
+# Generates light_tables.c/.h for the configured strip: temperature -> LED
+# index, a gamma table, and the colormap pre-multiplied by each brightness
+# level, both before and after gamma correction, so the render path is table
+# lookups only.
+
+import argparse
+import colorsys
+import os
+
+GAMMA = 2.8
+BRIGHTNESS_LEVELS = 4
+
+
+def temp_range(leds: int, zero: int, span: int) -> tuple:
+    # floor division, so the coldest/warmest whole degrees still land on the strip
+    return (-zero * span) // leds, ((leds - 1 - zero) * span) // leds
+
+
+def temp_to_led(temp: int, leds: int, zero: int, span: int) -> int:
+    # round half away from zero, in integers
+    num = temp * leds
+    pos = zero + (abs(num) * 2 + span) // (2 * span) * (1 if num >= 0 else -1)
+    return min(max(pos, 0), leds - 1)
+
+
+def gamma_table() -> list:
+    return [round(((i / 255.0) ** GAMMA) * 255) for i in range(256)]
+
+
+def colormap(leds: int, enabled: bool) -> list:
+    # blue (cold) -> red (warm) through cyan, green & yellow
+    rgb = []
+    for i in range(leds):
+        if not enabled:
+            rgb.append((255, 255, 255))
+            continue
+        hue = (240.0 - 240.0 * i / max(leds - 1, 1)) / 360.0
+        rgb.append(tuple(round(c * 255) for c in colorsys.hsv_to_rgb(hue, 1.0, 1.0)))
+    return rgb
+
+
+def palette(cmap: list, gamma: list, max_brightness: int) -> tuple:
+    levels, perceptual = [], []
+    for level in range(1, BRIGHTNESS_LEVELS + 1):
+        scale = max_brightness * level / BRIGHTNESS_LEVELS / 255.0
+        row, row_perceptual = [], []
+        for r, g, b in cmap:
+            p = [round(c * scale) for c in (r, g, b)]
+            px = [gamma[c] for c in p]
+            if any(c * scale >= 0.5 for c in (r, g, b)) and not any(px):
+                # never let a lit LED round to black
+                px = [1 if c == max(r, g, b) else 0 for c in (r, g, b)]
+            row.append(px)
+            row_perceptual.append(p)
+        levels.append(row)
+        perceptual.append(row_perceptual)
+    return levels, perceptual
+
+
+def c_rows(values: list, per_line: int = 16, indent: str = '    ') -> str:
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append(indent + ', '.join(str(v) for v in values[i:i + per_line]) + ',')
+    return '\n'.join(lines)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--leds', type=int, required=True)
+    parser.add_argument('--zero', type=int, required=True)
+    parser.add_argument('--span', type=int, required=True)
+    parser.add_argument('--max-brightness', type=int, required=True)
+    parser.add_argument('--colormap', type=int, default=1)
+    parser.add_argument('--out-dir', required=True)
+    args = parser.parse_args()
+
+    if not 0 <= args.zero < args.leds:
+        parser.error('zero position must be on the strip')
+    if args.span < 1:
+        parser.error('temperature span must be at least 1 degree')
+
+    t_min, t_max = temp_range(args.leds, args.zero, args.span)
+    positions = [temp_to_led(t, args.leds, args.zero, args.span) for t in range(t_min, t_max + 1)]
+    gamma = gamma_table()
+    levels, perceptual = palette(colormap(args.leds, bool(args.colormap)), gamma, args.max_brightness)
+
+    header = f'''/* Generated by gen_light_tables.py, do not edit */
+#pragma once
+
+#include <stdint.h>
+
+#define LIGHT_STRIP_LEDS            {args.leds}
+#define LIGHT_ZERO_CELSIUS_LED      {args.zero}
+#define LIGHT_TEMP_MIN_C            ({t_min})
+#define LIGHT_TEMP_MAX_C            ({t_max})
+#define LIGHT_BRIGHTNESS_LEVELS     {BRIGHTNESS_LEVELS}
+
+/* LED index for each whole degree LIGHT_TEMP_MIN_C..LIGHT_TEMP_MAX_C */
+extern const uint8_t light_temp_to_led[LIGHT_TEMP_MAX_C - LIGHT_TEMP_MIN_C + 1];
+
+/* Perceptual (gamma {GAMMA}) to PWM value */
+extern const uint8_t light_gamma[256];
+
+/* Colormap per LED, gamma corrected, at each brightness level (dimmest first) */
+extern const uint8_t light_palette[LIGHT_BRIGHTNESS_LEVELS][LIGHT_STRIP_LEDS][3];
+
+/* The same before gamma correction, to scale part-lit LEDs by before light_gamma */
+extern const uint8_t light_palette_perceptual[LIGHT_BRIGHTNESS_LEVELS][LIGHT_STRIP_LEDS][3];
+'''
+
+    def palette_rows(levels: list) -> str:
+        return '\n'.join('    {\n' + '\n'.join(f'        {{ {r}, {g}, {b} }},' for r, g, b in level) + '\n    },'
+                         for level in levels)
+
+    source = f'''/* Generated by gen_light_tables.py, do not edit */
+#include "light_tables.h"
+
+const uint8_t light_temp_to_led[LIGHT_TEMP_MAX_C - LIGHT_TEMP_MIN_C + 1] = {{
+{c_rows(positions)}
+}};
+
+const uint8_t light_gamma[256] = {{
+{c_rows(gamma)}
+}};
+
+const uint8_t light_palette[LIGHT_BRIGHTNESS_LEVELS][LIGHT_STRIP_LEDS][3] = {{
+{palette_rows(levels)}
+}};
+
+const uint8_t light_palette_perceptual[LIGHT_BRIGHTNESS_LEVELS][LIGHT_STRIP_LEDS][3] = {{
+{palette_rows(perceptual)}
+}};
+'''
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    for name, text in (('light_tables.h', header), ('light_tables.c', source)):
+        path = os.path.join(args.out_dir, name)
+        # leave the file alone when unchanged so dependents don't rebuild
+        if os.path.exists(path) and open(path).read() == text:
+            continue
+        with open(path, 'w') as f:
+            f.write(text)
+
+
+if __name__ == '__main__':
+    main()
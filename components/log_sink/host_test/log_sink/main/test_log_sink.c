@@ -0,0 +1,237 @@
+/**
+ * @file test_log_sink.c
+ * @author The Authors
+ * @brief Host test for the log ring, its rate limits, and what it saves the
+ *        body read loop
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The benchmark reads a body in recv_buf sized chunks, as http_get_task
+ * does, echoing each one to a stand-in UART that takes as long as 115200
+ * baud would: once written straight to it, once through a ring big enough
+ * for the whole body with a thread draining it, and once with the echo
+ * compiled out.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "unity.h"
+#include "log_ring.h"
+
+#define S                   1000000LL
+#define BODY_LEN            8192
+#define CHUNK               64          // http_get_task's recv_buf
+#define RING_LEN            4096
+#define BENCH_RING_LEN      BODY_LEN    // every chunk echoed, none dropped
+#define UART_NS_PER_BYTE    86806       // 10 bits at 115200 baud
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void test_write_read_wrap(void) {
+    char buf[16];
+    char out[32];
+    log_ring_t r;
+
+    log_ring_init(&r, buf, sizeof(buf), 0, 0);
+    TEST_ASSERT_EQUAL(0, log_ring_read(&r, out, sizeof(out)));
+    TEST_ASSERT_TRUE(log_ring_write(&r, NULL, "0123456789", 10, 0));
+    TEST_ASSERT_FALSE(log_ring_write(&r, NULL, "abcdefg", 7, 0));      // all or nothing
+    TEST_ASSERT_EQUAL(1, r.stats.dropped_full);
+    TEST_ASSERT_EQUAL(4, log_ring_read(&r, out, 4));
+    TEST_ASSERT_EQUAL_MEMORY("0123", out, 4);
+
+    /* Now it fits, across the end */
+    TEST_ASSERT_TRUE(log_ring_write(&r, NULL, "abcdefg", 7, 0));
+    TEST_ASSERT_EQUAL(13, log_ring_used(&r));
+    TEST_ASSERT_EQUAL(13, log_ring_read(&r, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY("456789abcdefg", out, 13);
+    TEST_ASSERT_EQUAL(0, log_ring_used(&r));
+    TEST_ASSERT_EQUAL(2, r.stats.lines);
+    TEST_ASSERT_EQUAL(17, r.stats.bytes);
+}
+
+static void test_parse_tag(void) {
+    char tag[LOG_RING_TAG_MAX];
+    static const char plain[] = "I (1234) http_get: Refresh requested\n";
+    static const char colour[] = "\033[0;33mW (99) light_driver: slow frame\033[0m\n";
+
+    TEST_ASSERT_TRUE(log_ring_parse_tag(plain, strlen(plain), tag));
+    TEST_ASSERT_EQUAL_STRING("http_get", tag);
+    TEST_ASSERT_TRUE(log_ring_parse_tag(colour, strlen(colour), tag));
+    TEST_ASSERT_EQUAL_STRING("light_driver", tag);
+    TEST_ASSERT_TRUE(log_ring_parse_tag("E (1) a_rather_long_tag_name: x", 31, tag));
+    TEST_ASSERT_EQUAL_STRING("a_rather_long_t", tag);
+    TEST_ASSERT_FALSE(log_ring_parse_tag("{\"temp\":3}\n", 11, tag));
+    TEST_ASSERT_EQUAL_STRING("", tag);
+    TEST_ASSERT_FALSE(log_ring_parse_tag("I (12) no colon\n", 16, tag));
+    TEST_ASSERT_FALSE(log_ring_parse_tag("I (12", 5, tag));
+}
+
+static void test_rate_limit(void) {
+    static char buf[RING_LEN];
+    char out[RING_LEN];
+    log_ring_t r;
+    int chatty = 0, quiet = 0;
+
+    /* 10 lines a second, 5 at once */
+    log_ring_init(&r, buf, sizeof(buf), 10, 5);
+
+    /* A tag logging every ms for 2 s next to one logging every 500 ms */
+    for (int64_t t = 0; t < 2 * S; t += 1000) {
+        chatty += log_ring_write(&r, "chatty", "c\n", 2, t);
+        if (t % (S / 2) == 0) {
+            quiet += log_ring_write(&r, "quiet", "q\n", 2, t);
+        }
+        log_ring_read(&r, out, sizeof(out));
+    }
+    TEST_ASSERT_EQUAL(5 + 19, chatty);                      // the burst, then one every 100 ms
+    TEST_ASSERT_EQUAL(4, quiet);                            // untouched by the chatty one
+    TEST_ASSERT_EQUAL(2000 - chatty, r.stats.dropped_rate);
+    TEST_ASSERT_EQUAL(2000 - chatty, r.buckets[0].dropped);
+
+    /* Quiet for a while, the burst is back but no more */
+    int again = 0;
+    for (int i = 0; i < 10; i++) {
+        again += log_ring_write(&r, "chatty", "c\n", 2, 60 * S);
+    }
+    TEST_ASSERT_EQUAL(5, again);
+
+    /* No limit on untagged writes */
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(log_ring_write(&r, NULL, "b", 1, 60 * S));
+    }
+}
+
+static void test_tags_past_table(void) {
+    static char buf[RING_LEN];
+    log_ring_t r;
+    char tag[8];
+
+    log_ring_init(&r, buf, sizeof(buf), 1, 1);
+    for (int i = 0; i < LOG_RING_TAGS - 1; i++) {
+        snprintf(tag, sizeof(tag), "t%d", i);
+        TEST_ASSERT_TRUE(log_ring_write(&r, tag, "x", 1, 0));
+    }
+    /* The rest share the last bucket: one line between them */
+    TEST_ASSERT_TRUE(log_ring_write(&r, "late_a", "x", 1, 0));
+    TEST_ASSERT_FALSE(log_ring_write(&r, "late_b", "x", 1, 0));
+    TEST_ASSERT_TRUE(log_ring_write(&r, "late_b", "x", 1, S));
+    TEST_ASSERT_EQUAL(LOG_RING_TAGS - 1, r.bucket_count);
+}
+
+/* The console: takes as long as the UART would, counts what it was given */
+static atomic_size_t s_uart_bytes;
+
+static void uart_write(const char *data, size_t len) {
+    (void)data;
+    struct timespec ts = { 0, (long)(len * UART_NS_PER_BYTE) };
+    nanosleep(&ts, NULL);
+    atomic_fetch_add(&s_uart_bytes, len);
+}
+
+typedef enum { ECHO_UART, ECHO_RING, ECHO_NONE } echo_t;
+
+static log_ring_t s_ring;
+static char s_ring_buf[BENCH_RING_LEN];
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_bool s_reading;
+
+static void *drain(void *arg) {
+    char chunk[CHUNK];
+    bool last;
+    do {
+        last = !atomic_load(&s_reading);
+        size_t n;
+        do {
+            pthread_mutex_lock(&s_lock);
+            n = log_ring_read(&s_ring, chunk, sizeof(chunk));
+            pthread_mutex_unlock(&s_lock);
+            if (n) {
+                uart_write(chunk, n);
+            }
+        } while (n);
+        struct timespec ts = { 0, 1000000 };
+        nanosleep(&ts, NULL);
+    } while (!last);
+    return NULL;
+}
+
+static volatile uint32_t s_sum;
+
+/* The read loop, its time in ns */
+static int64_t read_body(const char *body, echo_t echo) {
+    char recv_buf[CHUNK];
+    uint32_t sum = 0;
+
+    int64_t start = now_ns();
+    for (size_t at = 0; at < BODY_LEN; at += CHUNK) {
+        memcpy(recv_buf, body + at, CHUNK);
+        for (size_t i = 0; i < CHUNK; i++) {               // stands in for the parser
+            sum += (unsigned char)recv_buf[i];
+        }
+        if (echo == ECHO_UART) {
+            uart_write(recv_buf, CHUNK);
+        } else if (echo == ECHO_RING) {
+            pthread_mutex_lock(&s_lock);
+            log_ring_write(&s_ring, NULL, recv_buf, CHUNK, 0);
+            pthread_mutex_unlock(&s_lock);
+        }
+    }
+    int64_t elapsed = now_ns() - start;
+    s_sum = sum;
+    return elapsed;
+}
+
+static void test_read_loop_benchmark(void) {
+    static char body[BODY_LEN];
+    pthread_t drainer;
+
+    for (size_t i = 0; i < BODY_LEN; i++) {
+        body[i] = "{\"list\":[{\"dt\":1760680800,\"main\":{\"temp\":11.2}}]}"[i % 50];
+    }
+
+    atomic_store(&s_uart_bytes, 0);
+    int64_t direct = read_body(body, ECHO_UART);
+    TEST_ASSERT_EQUAL(BODY_LEN, atomic_load(&s_uart_bytes));
+
+    atomic_store(&s_uart_bytes, 0);
+    log_ring_init(&s_ring, s_ring_buf, sizeof(s_ring_buf), 0, 0);
+    atomic_store(&s_reading, true);
+    TEST_ASSERT_EQUAL(0, pthread_create(&drainer, NULL, drain, NULL));
+    int64_t ring = read_body(body, ECHO_RING);
+    atomic_store(&s_reading, false);
+    pthread_join(drainer, NULL);
+
+    int64_t none = read_body(body, ECHO_NONE);
+
+    /* Every chunk reached the console, whole */
+    TEST_ASSERT_EQUAL(0, s_ring.stats.dropped_full);
+    TEST_ASSERT_EQUAL(BODY_LEN / CHUNK, s_ring.stats.lines);
+    TEST_ASSERT_EQUAL(BODY_LEN, atomic_load(&s_uart_bytes));
+    printf("LOG_SINK %d byte body, %d byte reads: echo to UART %" PRId64 " us, through a %d byte ring %" PRId64
+           " us (all %d chunks echoed), no echo %" PRId64 " us\n",
+           BODY_LEN, CHUNK, direct / 1000, BENCH_RING_LEN, ring / 1000, BODY_LEN / CHUNK, none / 1000);
+    TEST_ASSERT_TRUE(direct > (int64_t)BODY_LEN * UART_NS_PER_BYTE);
+    TEST_ASSERT_TRUE(ring * 20 < direct);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_write_read_wrap);
+    RUN_TEST(test_parse_tag);
+    RUN_TEST(test_rate_limit);
+    RUN_TEST(test_tags_past_table);
+    RUN_TEST(test_read_loop_benchmark);
+    exit(UNITY_END());
+}
@@ -0,0 +1,100 @@
+/**
+ * @file log_ring.h
+ * @author The Authors
+ * @brief Bounded byte ring for console output, with per-tag rate limits
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Writers put whole lines in or drop them, they never wait for the console;
+ * one reader streams the bytes out. Each tag has a token bucket of `burst`
+ * lines refilled at `rate_per_s`, so one chatty tag can't crowd out the
+ * rest. Tags past LOG_RING_TAGS share one bucket.
+ *
+ * Not thread safe by itself: log_sink.c holds a spinlock around each call,
+ * which is short (a memcpy of one line). Times are passed in, for the host
+ * test.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_RING_TAGS       16
+#define LOG_RING_TAG_MAX    16      // longer tags are told apart by their start only
+
+typedef struct {
+    char tag[LOG_RING_TAG_MAX];     // "" for the shared bucket
+    uint32_t tokens_milli;          // lines * 1000
+    int64_t refilled_us;            // times start at 0, so a new bucket is full
+    uint32_t dropped;
+} log_ring_bucket_t;
+
+typedef struct {
+    uint32_t lines;
+    uint32_t bytes;
+    uint32_t dropped_full;          // lines that didn't fit
+    uint32_t dropped_rate;          // lines over their tag's rate
+} log_ring_stats_t;
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t head;                    // bytes ever written
+    size_t tail;                    // bytes ever read
+    uint32_t rate_per_s;            // 0: no limit
+    uint32_t burst;
+    log_ring_bucket_t buckets[LOG_RING_TAGS];
+    size_t bucket_count;
+    log_ring_stats_t stats;
+} log_ring_t;
+
+/**
+ * @brief Empty ring over buf
+ *
+ * @param r
+ * @param buf
+ * @param size
+ * @param rate_per_s    lines per second per tag, 0 for no limit
+ * @param burst         lines a quiet tag may write at once
+ */
+void log_ring_init(log_ring_t *r, char *buf, size_t size, uint32_t rate_per_s, uint32_t burst);
+
+/**
+ * @brief One line, all of it or nothing
+ *
+ * @param tag       NULL to skip the rate limit
+ * @return false if dropped: over the tag's rate or no room
+ */
+bool log_ring_write(log_ring_t *r, const char *tag, const char *data, size_t len, int64_t now_us);
+
+/**
+ * @brief Take up to max bytes, oldest first
+ *
+ * @return bytes copied to out, 0 when empty
+ */
+size_t log_ring_read(log_ring_t *r, char *out, size_t max);
+
+static inline size_t log_ring_used(const log_ring_t *r) {
+    return r->head - r->tail;
+}
+
+/**
+ * @brief The tag of a formatted ESP_LOGx line: "I (1234) tag: text", maybe
+ *        after a colour escape
+ *
+ * @param out   at least LOG_RING_TAG_MAX bytes, "" if there is none
+ * @return true if found
+ */
+bool log_ring_parse_tag(const char *line, size_t len, char *out);
+
+#ifdef __cplusplus
+}
+#endif
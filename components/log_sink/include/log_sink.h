@@ -0,0 +1,55 @@
+/**
+ * @file log_sink.h
+ * @author The Authors
+ * @brief Console output through a ring, drained by a low priority task
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Once started, every ESP_LOGx line is formatted on the caller's stack and
+ * copied into the ring (log_ring.h) instead of waiting on the UART, ~87 us
+ * a byte at 115200 baud. Lines over their tag's rate or that don't fit are
+ * dropped and counted; the drain task says how many every so often.
+ *
+ * With CONFIG_LOG_SINK_ENABLE off, logging goes straight to the UART as
+ * before and log_sink_echo() is a plain fwrite().
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_LOG_SINK_ENABLE
+
+/**
+ * @brief Route ESP_LOGx through the ring. Call early in app_main().
+ */
+void log_sink_start(void);
+
+/**
+ * @brief Raw bytes to the console, e.g. a body being read, without the
+ *        per-tag rate limit. Dropped if they don't fit.
+ */
+void log_sink_echo(const char *data, size_t len);
+
+#else
+
+static inline void log_sink_start(void) {
+}
+
+static inline void log_sink_echo(const char *data, size_t len) {
+    fwrite(data, 1, len, stdout);
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file log_ring.c
+ * @author The Authors
+ * @brief Bounded byte ring for console output, with per-tag rate limits
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include "log_ring.h"
+
+void log_ring_init(log_ring_t *r, char *buf, size_t size, uint32_t rate_per_s, uint32_t burst) {
+    memset(r, 0, sizeof(*r));
+    r->buf = buf;
+    r->size = size;
+    r->rate_per_s = rate_per_s;
+    r->burst = burst ? burst : 1;
+    for (size_t i = 0; i < LOG_RING_TAGS; i++) {
+        r->buckets[i].tokens_milli = r->burst * 1000;
+    }
+}
+
+/* The tag's bucket, a new one while there's room, else the shared last one */
+static log_ring_bucket_t *bucket_of(log_ring_t *r, const char *tag) {
+    for (size_t i = 0; i < r->bucket_count; i++) {
+        if (strncmp(r->buckets[i].tag, tag, LOG_RING_TAG_MAX - 1) == 0) {
+            return &r->buckets[i];
+        }
+    }
+    log_ring_bucket_t *b = &r->buckets[r->bucket_count];
+    if (r->bucket_count < LOG_RING_TAGS - 1) {
+        r->bucket_count++;
+        strncpy(b->tag, tag, LOG_RING_TAG_MAX - 1);
+        b->tag[LOG_RING_TAG_MAX - 1] = '\0';
+    }
+    return b;
+}
+
+static bool take_token(log_ring_t *r, const char *tag, int64_t now_us) {
+    log_ring_bucket_t *b = bucket_of(r, tag);
+    uint64_t cap = (uint64_t)r->burst * 1000;
+    int64_t elapsed = now_us - b->refilled_us;
+
+    uint64_t refill = elapsed > 0 ? (uint64_t)elapsed * r->rate_per_s / 1000 : 0;
+    if (refill) {                       // else the fraction keeps accruing
+        b->tokens_milli = b->tokens_milli + refill >= cap ? cap : b->tokens_milli + refill;
+        b->refilled_us = now_us;
+    }
+    if (b->tokens_milli < 1000) {
+        b->dropped++;
+        return false;
+    }
+    b->tokens_milli -= 1000;
+    return true;
+}
+
+bool log_ring_write(log_ring_t *r, const char *tag, const char *data, size_t len, int64_t now_us) {
+    if (tag && r->rate_per_s && !take_token(r, tag, now_us)) {
+        r->stats.dropped_rate++;
+        return false;
+    }
+    if (len > r->size - log_ring_used(r)) {
+        r->stats.dropped_full++;
+        return false;
+    }
+
+    size_t at = r->head % r->size;
+    size_t first = r->size - at < len ? r->size - at : len;
+    memcpy(r->buf + at, data, first);
+    memcpy(r->buf, data + first, len - first);
+    r->head += len;
+    r->stats.lines++;
+    r->stats.bytes += len;
+    return true;
+}
+
+size_t log_ring_read(log_ring_t *r, char *out, size_t max) {
+    size_t n = log_ring_used(r) < max ? log_ring_used(r) : max;
+    size_t at = r->tail % r->size;
+    size_t first = r->size - at < n ? r->size - at : n;
+
+    memcpy(out, r->buf + at, first);
+    memcpy(out + first, r->buf, n - first);
+    r->tail += n;
+    return n;
+}
+
+bool log_ring_parse_tag(const char *line, size_t len, char *out) {
+    const char *p = line;
+    const char *end = line + len;
+
+    out[0] = '\0';
+    if (p < end && *p == '\033') {              // "\033[0;32m"
+        while (p < end && *p != 'm') {
+            p++;
+        }
+        p++;
+    }
+    /* "I (1234) " */
+    if (end - p < 2 || !strchr("EWIDV", p[0]) || p[1] != ' ') {
+        return false;
+    }
+    p = memchr(p, ')', end - p);
+    if (!p || end - p < 2 || p[1] != ' ') {
+        return false;
+    }
+    p += 2;
+
+    const char *colon = memchr(p, ':', end - p);
+    if (!colon || colon == p) {
+        return false;
+    }
+    size_t n = colon - p < LOG_RING_TAG_MAX - 1 ? (size_t)(colon - p) : LOG_RING_TAG_MAX - 1;
+    memcpy(out, p, n);
+    out[n] = '\0';
+    return true;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file log_sink.c
+ * @author The Authors
+ * @brief Console output through a ring, drained by a low priority task
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "log_sink.h"
+#include "log_ring.h"
+
+#define LOG_SINK_LINE_MAX       160     // on the logging task's stack, longer lines are cut
+#define LOG_SINK_CHUNK          64
+#define LOG_SINK_TASK_STACK     2048
+#define LOG_SINK_TASK_PRIORITY  1       // below everything but idle
+#define LOG_SINK_DROPS_MS       10000   // how often to say what was dropped
+
+static const char *TAG = "log_sink";
+
+static char s_buf[CONFIG_LOG_SINK_BUFFER];
+static log_ring_t s_ring;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_task;
+
+static bool put(const char *tag, const char *data, size_t len) {
+    taskENTER_CRITICAL(&s_lock);
+    bool ok = log_ring_write(&s_ring, tag, data, len, esp_timer_get_time());
+    taskEXIT_CRITICAL(&s_lock);
+    if (ok && s_task) {
+        xTaskNotifyGive(s_task);
+    }
+    return ok;
+}
+
+static int sink_vprintf(const char *fmt, va_list args) {
+    char line[LOG_SINK_LINE_MAX];
+    char tag[LOG_RING_TAG_MAX];
+
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    if (n < 0) {
+        return n;
+    }
+    size_t len = (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1;
+    if ((size_t)n >= sizeof(line)) {
+        line[len - 1] = '\n';
+    }
+    log_ring_parse_tag(line, len, tag);
+    put(tag, line, len);                // untagged output shares one bucket
+    return n;
+}
+
+void log_sink_echo(const char *data, size_t len) {
+    put(NULL, data, len);
+}
+
+static void report_drops(log_ring_stats_t *seen) {
+    taskENTER_CRITICAL(&s_lock);
+    log_ring_stats_t now = s_ring.stats;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (now.dropped_rate != seen->dropped_rate || now.dropped_full != seen->dropped_full) {
+        ESP_LOGW(TAG, "Dropped %" PRIu32 " lines over their rate, %" PRIu32 " with the ring full",
+                 now.dropped_rate - seen->dropped_rate, now.dropped_full - seen->dropped_full);
+    }
+    *seen = now;
+}
+
+static void log_sink_task(void *pvParameters) {
+    char chunk[LOG_SINK_CHUNK];
+    log_ring_stats_t seen = {0};
+    int64_t reported = esp_timer_get_time();
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_SINK_DROPS_MS));
+        size_t n;
+        do {
+            taskENTER_CRITICAL(&s_lock);
+            n = log_ring_read(&s_ring, chunk, sizeof(chunk));
+            taskEXIT_CRITICAL(&s_lock);
+            fwrite(chunk, 1, n, stdout);
+        } while (n);
+        fflush(stdout);
+
+        if (esp_timer_get_time() - reported >= LOG_SINK_DROPS_MS * 1000LL) {
+            reported = esp_timer_get_time();
+            report_drops(&seen);
+        }
+    }
+}
+
+void log_sink_start(void) {
+    log_ring_init(&s_ring, s_buf, sizeof(s_buf), CONFIG_LOG_SINK_RATE, CONFIG_LOG_SINK_BURST);
+    xTaskCreate(&log_sink_task, "log_sink", LOG_SINK_TASK_STACK, NULL, LOG_SINK_TASK_PRIORITY, &s_task);
+    esp_log_set_vprintf(sink_vprintf);
+}
@@ -0,0 +1,253 @@
+/**
+ * @file test_local_temp.c
+ * @author The Authors
+ * @brief Host test for the local sensor / forecast fusion and debouncing
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Runs on a virtual clock: reading() plays a reading at a given time and
+ * advance() fires the timer the way local_temp_source.c arms it, recording
+ * every render.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "local_temp_fusion.h"
+
+#define MS                  1000LL
+#define DEBOUNCE_US         (500 * MS)
+#define STALE_US            (900 * 1000 * MS)
+#define RENDERS_MAX         64
+
+static const local_temp_view_t s_forecast = { 2, 8, 12 };
+
+typedef struct {
+    int64_t at_us;
+    local_temp_view_t view;
+} render_t;
+
+static render_t s_renders[RENDERS_MAX];
+static int s_count;
+
+static void init(local_temp_t *lt, local_temp_policy_t policy, int blend_pct) {
+    const local_temp_config_t cfg = {
+        .policy = policy,
+        .blend_pct = blend_pct,
+        .debounce_us = DEBOUNCE_US,
+        .stale_us = STALE_US,
+    };
+    local_temp_init(lt, &cfg);
+    s_count = 0;
+}
+
+static void record(int64_t at_us, const local_temp_view_t *v) {
+    TEST_ASSERT_LESS_THAN(RENDERS_MAX, s_count);
+    s_renders[s_count++] = (render_t){ at_us, *v };
+}
+
+/* Fire the timer for everything due up to until_us, as the device would */
+static void advance(local_temp_t *lt, int64_t *now_us, int64_t until_us) {
+    local_temp_view_t v;
+    int64_t next;
+    while ((next = local_temp_next_us(lt, *now_us)) >= 0 && *now_us + next <= until_us) {
+        *now_us += next;
+        if (local_temp_due(lt, *now_us, &v)) {
+            record(*now_us, &v);
+        }
+    }
+    *now_us = until_us;
+}
+
+static void reading(local_temp_t *lt, int64_t *now_us, int64_t at_us, int temp) {
+    local_temp_view_t v;
+    advance(lt, now_us, at_us);
+    if (local_temp_reading(lt, temp, at_us, &v)) {
+        record(at_us, &v);
+    }
+}
+
+static void assert_view(int min, int now, int max, const local_temp_view_t *v) {
+    TEST_ASSERT_EQUAL(min, v->temp_min);
+    TEST_ASSERT_EQUAL(now, v->temp_now);
+    TEST_ASSERT_EQUAL(max, v->temp_max);
+}
+
+static void test_parse(void) {
+    int t;
+
+    TEST_ASSERT_TRUE(local_temp_parse("21.6", 4, NULL, &t));
+    TEST_ASSERT_EQUAL(2160, t);
+    TEST_ASSERT_TRUE(local_temp_parse(" -3.5\n", 6, "", &t));
+    TEST_ASSERT_EQUAL(-350, t);
+    TEST_ASSERT_TRUE(local_temp_parse("-0.4", 4, NULL, &t));
+    TEST_ASSERT_EQUAL(-40, t);
+    TEST_ASSERT_TRUE(local_temp_parse("+7", 2, NULL, &t));
+    TEST_ASSERT_EQUAL(700, t);
+    TEST_ASSERT_TRUE(local_temp_parse("12", 1, NULL, &t));     // only len bytes: "1"
+    TEST_ASSERT_EQUAL(100, t);
+    TEST_ASSERT_TRUE(local_temp_parse("21.645", 6, NULL, &t)); // hundredths, rounded half away from zero
+    TEST_ASSERT_EQUAL(2165, t);
+    TEST_ASSERT_TRUE(local_temp_parse("-0.004", 6, NULL, &t));
+    TEST_ASSERT_EQUAL(0, t);
+    TEST_ASSERT_TRUE(local_temp_parse("100.00", 6, NULL, &t));
+    TEST_ASSERT_EQUAL(10000, t);
+    TEST_ASSERT_FALSE(local_temp_parse("21C", 3, NULL, &t));
+    TEST_ASSERT_FALSE(local_temp_parse("-", 1, NULL, &t));
+    TEST_ASSERT_FALSE(local_temp_parse("", 0, NULL, &t));
+    TEST_ASSERT_FALSE(local_temp_parse("101", 3, NULL, &t));
+    TEST_ASSERT_FALSE(local_temp_parse("100.01", 6, NULL, &t));
+    TEST_ASSERT_FALSE(local_temp_parse("99999999999999", 14, NULL, &t));
+
+    static const char tasmota[] = "{\"Time\":\"2026-10-17T08:00:00\",\"DS18B20\":{\"Id\":\"01\",\"Temperature\":18.7},\"TempUnit\":\"C\"}";
+    TEST_ASSERT_TRUE(local_temp_parse(tasmota, strlen(tasmota), "Temperature", &t));
+    TEST_ASSERT_EQUAL(1870, t);
+    TEST_ASSERT_FALSE(local_temp_parse(tasmota, strlen(tasmota), "Humidity", &t));
+    TEST_ASSERT_FALSE(local_temp_parse(tasmota, strlen(tasmota), "TempUnit", &t));
+    TEST_ASSERT_FALSE(local_temp_parse("{\"Temperature\"", 14, "Temperature", &t));
+}
+
+static void test_policies(void) {
+    local_temp_t lt;
+    local_temp_view_t v;
+
+    /* Override: the reading is now, the range stretched to take it */
+    init(&lt, LOCAL_TEMP_OVERRIDE, 0);
+    TEST_ASSERT_FALSE(local_temp_fuse(&lt, 0, &v));
+    TEST_ASSERT_TRUE(local_temp_reading(&lt, 5, 0, &v));
+    assert_view(5, 5, 5, &v);                           // no forecast yet
+    local_temp_forecast(&lt, &s_forecast, 1 * MS, &v);
+    assert_view(2, 5, 12, &v);
+    TEST_ASSERT_TRUE(local_temp_reading(&lt, 15, DEBOUNCE_US + 1 * MS, &v));
+    assert_view(2, 15, 15, &v);
+
+    /* Blend: 25% of the way from the forecast, rounded */
+    init(&lt, LOCAL_TEMP_BLEND, 25);
+    local_temp_forecast(&lt, &s_forecast, 0, &v);
+    assert_view(2, 8, 12, &v);
+    TEST_ASSERT_TRUE(local_temp_reading(&lt, 14, DEBOUNCE_US, &v));
+    assert_view(2, 10, 12, &v);                         // 8 + 1.5
+    TEST_ASSERT_TRUE(local_temp_reading(&lt, -40, 2 * DEBOUNCE_US, &v));
+    assert_view(-4, -4, 12, &v);                        // 8 - 12
+
+    /* Fallback: the reading only stands in until the first forecast */
+    init(&lt, LOCAL_TEMP_FALLBACK, 0);
+    TEST_ASSERT_TRUE(local_temp_reading(&lt, 30, 0, &v));
+    assert_view(30, 30, 30, &v);
+    local_temp_forecast(&lt, &s_forecast, 1 * MS, &v);
+    assert_view(2, 8, 12, &v);
+    TEST_ASSERT_FALSE(local_temp_reading(&lt, 31, DEBOUNCE_US + 1 * MS, &v));
+    TEST_ASSERT_EQUAL(1, lt.stats.unchanged);
+}
+
+/* A sensor publishing every 20 ms for 2 s, each reading one degree up */
+static void test_burst_coalesced(void) {
+    local_temp_t lt;
+    local_temp_view_t v;
+    int64_t now = 0;
+    const int readings = 100;
+
+    init(&lt, LOCAL_TEMP_OVERRIDE, 0);
+    local_temp_forecast(&lt, &s_forecast, 0, &v);
+    now = 10 * DEBOUNCE_US;
+    for (int i = 0; i < readings; i++) {
+        reading(&lt, &now, 10 * DEBOUNCE_US + i * 20 * MS, -50 + i);
+    }
+    int64_t last_reading_us = now;
+    advance(&lt, &now, now + 10 * DEBOUNCE_US);
+
+    /* The first at once, then one per window, the last reading last */
+    TEST_ASSERT_EQUAL(10 * DEBOUNCE_US, s_renders[0].at_us);
+    TEST_ASSERT_EQUAL(-50, s_renders[0].view.temp_now);
+    for (int i = 1; i < s_count; i++) {
+        TEST_ASSERT_TRUE(s_renders[i].at_us - s_renders[i - 1].at_us >= DEBOUNCE_US);
+    }
+    TEST_ASSERT_EQUAL(-50 + readings - 1, s_renders[s_count - 1].view.temp_now);
+    TEST_ASSERT_TRUE(s_renders[s_count - 1].at_us - last_reading_us <= DEBOUNCE_US);
+    TEST_ASSERT_EQUAL(5, s_count);                      // 2 s of readings, 0.5 s windows
+    TEST_ASSERT_EQUAL(readings, lt.stats.readings);
+    TEST_ASSERT_EQUAL(readings - s_count, lt.stats.coalesced);
+    printf("LOCAL_TEMP readings=%d renders=%d coalesced=%" PRIu32 "\n", readings, s_count, lt.stats.coalesced);
+}
+
+/* A quiet sensor is shown at once, a chatty one within the debounce time */
+static void test_latency(void) {
+    local_temp_t lt;
+    local_temp_view_t v;
+    int64_t now = 0;
+    int64_t worst = 0;
+    /* Irregular gaps, some inside the window, some well outside it */
+    static const int gaps_ms[] = { 5000, 100, 100, 2000, 30, 490, 10, 700, 60000, 1, 1, 1 };
+    int64_t at[sizeof(gaps_ms) / sizeof(gaps_ms[0])];
+    const int n = sizeof(gaps_ms) / sizeof(gaps_ms[0]);
+
+    init(&lt, LOCAL_TEMP_OVERRIDE, 0);
+    local_temp_forecast(&lt, &s_forecast, 0, &v);
+    int64_t t = 0;
+    for (int i = 0; i < n; i++) {
+        t += gaps_ms[i] * MS;
+        at[i] = t;
+        reading(&lt, &now, t, 20 + i);
+    }
+    advance(&lt, &now, t + 10 * DEBOUNCE_US);
+
+    /* Each reading's value, or a later one, is on the strip within DEBOUNCE_US */
+    for (int i = 0; i < n; i++) {
+        int r = 0;
+        while (r < s_count && !(s_renders[r].at_us >= at[i] && s_renders[r].view.temp_now >= 20 + i)) {
+            r++;
+        }
+        TEST_ASSERT_TRUE(r < s_count);
+        int64_t latency = s_renders[r].at_us - at[i];
+        TEST_ASSERT_TRUE(latency <= DEBOUNCE_US);
+        if (gaps_ms[i] * MS >= 2 * DEBOUNCE_US) {      // the one before is drawn by then, and its window over
+            TEST_ASSERT_EQUAL(0, latency);
+        }
+        worst = latency > worst ? latency : worst;
+    }
+    printf("LOCAL_TEMP worst reading->render latency %" PRId64 " ms (was up to a 60 s poll)\n", (int64_t)(worst / MS));
+}
+
+static void test_stale_and_forecast(void) {
+    local_temp_t lt;
+    local_temp_view_t v;
+    int64_t now = 0;
+
+    init(&lt, LOCAL_TEMP_OVERRIDE, 0);
+    local_temp_forecast(&lt, &s_forecast, 0, &v);
+    reading(&lt, &now, DEBOUNCE_US, 20);
+    reading(&lt, &now, DEBOUNCE_US + 10 * MS, 21);       // pending
+
+    /* A forecast with a reading pending takes it in, and the window restarts */
+    local_temp_forecast(&lt, &(local_temp_view_t){ 0, 4, 6 }, DEBOUNCE_US + 20 * MS, &v);
+    assert_view(0, 21, 21, &v);
+    TEST_ASSERT_FALSE(lt.pending);
+    TEST_ASSERT_EQUAL(STALE_US - 10 * MS, local_temp_next_us(&lt, DEBOUNCE_US + 20 * MS));
+
+    /* Without newer readings it goes back to the forecast, once */
+    s_count = 0;
+    advance(&lt, &now, DEBOUNCE_US + 2 * STALE_US);
+    TEST_ASSERT_EQUAL(1, s_count);
+    TEST_ASSERT_EQUAL(DEBOUNCE_US + 10 * MS + STALE_US, s_renders[0].at_us);
+    assert_view(0, 4, 6, &s_renders[0].view);
+    TEST_ASSERT_EQUAL(-1, local_temp_next_us(&lt, now));
+
+    /* Readings that don't change the view don't render */
+    reading(&lt, &now, now + 1 * MS, 4);
+    TEST_ASSERT_EQUAL(1, s_count);
+    TEST_ASSERT_EQUAL(1, lt.stats.unchanged);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_parse);
+    RUN_TEST(test_policies);
+    RUN_TEST(test_burst_coalesced);
+    RUN_TEST(test_latency);
+    RUN_TEST(test_stale_and_forecast);
+    exit(UNITY_END());
+}
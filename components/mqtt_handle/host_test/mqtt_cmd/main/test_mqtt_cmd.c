@@ -0,0 +1,314 @@
+/**
+ * @file test_mqtt_cmd.c
+ * @author The Authors
+ * @brief Host test for the MQTT command dispatch and payload parsing
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * With STANDIN_PORT set, a "controller" connection publishes commands through
+ * the stand-in broker in pytest_mqtt_cmd.py to a "device" connection, which
+ * hands them to the dispatcher in CLIENT_FRAGMENT pieces the way the MQTT
+ * client does. The power handler draws on the recording led_strip mock, so
+ * the latency is publish -> strip refresh.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "unity.h"
+#include "esp_timer.h"
+#include "led_strip.h"
+#include "light_fb.h"
+#include "mqtt_cmd.h"
+
+#define TOPIC_POWER         "cmnd/stairs/power"
+#define TOPIC_COLOR         "cmnd/stairs/color"
+#define TOPIC_REFRESH       "cmnd/stairs/refresh"
+#define CLIENT_FRAGMENT     8       // payload bytes per MQTT_EVENT_DATA, a tiny client buffer
+#define LATENCY_ROUNDS      50
+#define STRIP_LEDS          8
+
+static struct {
+    const char *data;
+    size_t len;
+    int calls;
+    bool on;
+    uint8_t rgb[3];
+} s_last;
+
+static light_fb_t s_fb;
+static int64_t s_photon_us;
+static sem_t s_photon;
+
+static void record(const char *data, size_t len) {
+    s_last.data = data;
+    s_last.len = len;
+    s_last.calls++;
+}
+
+/* As light_driver_set_power(): pixel 0 on or off, flushed to the strip */
+static void cmd_power(const char *data, size_t len) {
+    record(data, len);
+    if (mqtt_cmd_parse_bool(data, len, &s_last.on) && s_fb.strip) {
+        light_fb_set_pixel(&s_fb, 0, 255 * s_last.on, 255 * s_last.on, 255 * s_last.on);
+        light_fb_flush(&s_fb);
+        s_photon_us = esp_timer_get_time();
+        sem_post(&s_photon);
+    }
+}
+
+static void cmd_color(const char *data, size_t len) {
+    record(data, len);
+    mqtt_cmd_parse_rgb(data, len, &s_last.rgb[0], &s_last.rgb[1], &s_last.rgb[2]);
+}
+
+static void cmd_refresh(const char *data, size_t len) {
+    record(data, len);
+}
+
+static const mqtt_cmd_t s_cmds[] = {
+    { TOPIC_POWER,   cmd_power },
+    { TOPIC_COLOR,   cmd_color },
+    { TOPIC_REFRESH, cmd_refresh },
+};
+
+#define CMDS (sizeof(s_cmds) / sizeof(s_cmds[0]))
+
+/* As the MQTT client delivers it: fragments of at most frag bytes, topic on the first */
+static int deliver(mqtt_cmd_dispatcher_t *d, const char *topic, const char *data, size_t len, size_t frag) {
+    int handled = 0;
+    size_t off = 0;
+    do {
+        size_t n = len - off < frag ? len - off : frag;
+        handled += mqtt_cmd_feed(d, off ? NULL : topic, off ? 0 : strlen(topic), data + off, n, off, len);
+        off += n;
+    } while (off < len);
+    return handled;
+}
+
+static void test_parse(void) {
+    bool on;
+    uint32_t v;
+    uint8_t r, g, b;
+
+    TEST_ASSERT_TRUE(mqtt_cmd_parse_bool(" On\n", 4, &on));
+    TEST_ASSERT_TRUE(on);
+    TEST_ASSERT_TRUE(mqtt_cmd_parse_bool("OFF", 3, &on));
+    TEST_ASSERT_FALSE(on);
+    TEST_ASSERT_TRUE(mqtt_cmd_parse_bool("1", 1, &on));
+    TEST_ASSERT_TRUE(on);
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_bool("ONE", 3, &on));
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_bool("ON", 1, &on));      // only len bytes are looked at: "O"
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_bool("", 0, &on));
+
+    TEST_ASSERT_TRUE(mqtt_cmd_parse_uint("3", 1, 3, &v));
+    TEST_ASSERT_EQUAL(3, v);
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_uint("4", 1, 3, &v));
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_uint("99999999999", 11, UINT32_MAX, &v));
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_uint("2x", 2, 3, &v));
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_uint("-1", 2, 3, &v));
+    TEST_ASSERT_TRUE(mqtt_cmd_parse_uint("21", 1, 3, &v));     // "2"
+    TEST_ASSERT_EQUAL(2, v);
+
+    TEST_ASSERT_TRUE(mqtt_cmd_parse_rgb("#Ff8000", 7, &r, &g, &b));
+    TEST_ASSERT_EQUAL(255, r);
+    TEST_ASSERT_EQUAL(128, g);
+    TEST_ASSERT_EQUAL(0, b);
+    TEST_ASSERT_TRUE(mqtt_cmd_parse_rgb("10, 20 ,30", 10, &r, &g, &b));
+    TEST_ASSERT_EQUAL(10, r);
+    TEST_ASSERT_EQUAL(20, g);
+    TEST_ASSERT_EQUAL(30, b);
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_rgb("256,0,0", 7, &r, &g, &b));
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_rgb("1,2", 3, &r, &g, &b));
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_rgb("1,2,3,4", 7, &r, &g, &b));
+    TEST_ASSERT_FALSE(mqtt_cmd_parse_rgb("#12345g", 7, &r, &g, &b));
+}
+
+static void test_dispatch_in_place(void) {
+    mqtt_cmd_dispatcher_t d;
+    static const char payload[] = "ON";
+
+    mqtt_cmd_init(&d, s_cmds, CMDS);
+    memset(&s_last, 0, sizeof(s_last));
+    TEST_ASSERT_TRUE(mqtt_cmd_feed(&d, TOPIC_POWER, strlen(TOPIC_POWER), payload, 2, 0, 2));
+    TEST_ASSERT_TRUE(s_last.data == payload);      // the client's buffer, not a copy
+    TEST_ASSERT_TRUE(s_last.on);
+
+    /* Topic matched on its length, not a prefix */
+    TEST_ASSERT_FALSE(mqtt_cmd_feed(&d, TOPIC_POWER "x", strlen(TOPIC_POWER) + 1, payload, 2, 0, 2));
+    TEST_ASSERT_FALSE(mqtt_cmd_feed(&d, TOPIC_POWER, strlen(TOPIC_POWER) - 1, payload, 2, 0, 2));
+    TEST_ASSERT_EQUAL(2, d.stats.unknown);
+
+    /* Empty payload still dispatches */
+    TEST_ASSERT_TRUE(mqtt_cmd_feed(&d, TOPIC_REFRESH, strlen(TOPIC_REFRESH), "", 0, 0, 0));
+    TEST_ASSERT_EQUAL(2, d.stats.dispatched);
+}
+
+static void test_fragments(void) {
+    mqtt_cmd_dispatcher_t d;
+    char long_color[MQTT_CMD_PAYLOAD_MAX];
+    char too_long[MQTT_CMD_PAYLOAD_MAX + 1];
+
+    mqtt_cmd_init(&d, s_cmds, CMDS);
+    memset(&s_last, 0, sizeof(s_last));
+
+    /* Padded with blanks past one fragment, dispatched once when complete */
+    memset(long_color, ' ', sizeof(long_color));
+    memcpy(long_color + 20, "12,34,56", 8);
+    for (size_t frag = 1; frag <= sizeof(long_color); frag++) {
+        s_last.calls = 0;
+        memset(s_last.rgb, 0, 3);
+        TEST_ASSERT_EQUAL(1, deliver(&d, TOPIC_COLOR, long_color, sizeof(long_color), frag));
+        TEST_ASSERT_EQUAL(1, s_last.calls);
+        TEST_ASSERT_EQUAL(sizeof(long_color), s_last.len);
+        TEST_ASSERT_EQUAL(34, s_last.rgb[1]);
+    }
+    TEST_ASSERT_EQUAL(sizeof(long_color) - 1, d.stats.reassembled);
+
+    /* Too big to reassemble: dropped, and its tail doesn't leak into the next message */
+    memset(too_long, '1', sizeof(too_long));
+    TEST_ASSERT_EQUAL(0, deliver(&d, TOPIC_POWER, too_long, sizeof(too_long), CLIENT_FRAGMENT));
+    TEST_ASSERT_EQUAL(1, d.stats.oversize);
+
+    /* A lost fragment: the rest is ignored, the next message is fine */
+    s_last.calls = 0;
+    TEST_ASSERT_FALSE(mqtt_cmd_feed(&d, TOPIC_COLOR, strlen(TOPIC_COLOR), long_color, 8, 0, sizeof(long_color)));
+    TEST_ASSERT_FALSE(mqtt_cmd_feed(&d, NULL, 0, long_color + 16, 8, 16, sizeof(long_color)));
+    TEST_ASSERT_FALSE(mqtt_cmd_feed(&d, NULL, 0, long_color + 24, 8, 24, sizeof(long_color)));
+    TEST_ASSERT_EQUAL(1, deliver(&d, TOPIC_POWER, "off", 3, CLIENT_FRAGMENT));
+    TEST_ASSERT_EQUAL(1, s_last.calls);
+    TEST_ASSERT_FALSE(s_last.on);
+}
+
+/* Just enough MQTT 3.1.1 for the stand-in broker */
+
+static int connect_standin(const char *client_id) {
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(atoi(getenv("STANDIN_PORT"))),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    uint8_t pkt[64] = { 0x10, 0, 0, 4, 'M', 'Q', 'T', 'T', 4, 0x02, 0, 60, 0, strlen(client_id) };
+    size_t len = 14;
+    memcpy(pkt + len, client_id, strlen(client_id));
+    len += strlen(client_id);
+    pkt[1] = len - 2;
+
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    int nodelay = 1;
+    uint8_t connack[4];
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || send(sock, pkt, len, 0) != (ssize_t)len
+            || recv(sock, connack, 4, MSG_WAITALL) != 4 || connack[0] != 0x20 || connack[3] != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static bool subscribe(int sock, const char *topic) {
+    uint8_t pkt[96] = { 0x82, 0, 0, 1, 0, strlen(topic) };
+    size_t len = 6;
+    memcpy(pkt + len, topic, strlen(topic));
+    len += strlen(topic);
+    pkt[len++] = 0;         // QoS 0
+    pkt[1] = len - 2;
+    uint8_t suback[5];
+    return send(sock, pkt, len, 0) == (ssize_t)len && recv(sock, suback, 5, MSG_WAITALL) == 5 && suback[0] == 0x90;
+}
+
+static bool publish(int sock, const char *topic, const char *payload) {
+    uint8_t pkt[128] = { 0x30, 0, 0, strlen(topic) };
+    size_t len = 4;
+    memcpy(pkt + len, topic, strlen(topic));
+    len += strlen(topic);
+    memcpy(pkt + len, payload, strlen(payload));
+    len += strlen(payload);
+    pkt[1] = len - 2;
+    return send(sock, pkt, len, 0) == (ssize_t)len;
+}
+
+/* The device side: whole PUBLISH packets off the socket, into the dispatcher in fragments */
+static void *device_thread(void *arg) {
+    int sock = *(int *)arg;
+    static mqtt_cmd_dispatcher_t d;
+    uint8_t head[2];
+    char body[128];
+
+    mqtt_cmd_init(&d, s_cmds, CMDS);
+    while (recv(sock, head, 2, MSG_WAITALL) == 2 && head[1] < sizeof(body)
+            && recv(sock, body, head[1], MSG_WAITALL) == head[1]) {
+        if ((head[0] & 0xf0) != 0x30) {
+            continue;
+        }
+        size_t topic_len = (uint8_t)body[0] << 8 | (uint8_t)body[1];
+        char topic[64];
+        snprintf(topic, sizeof(topic), "%.*s", (int)topic_len, body + 2);
+        deliver(&d, topic, body + 2 + topic_len, head[1] - 2 - topic_len, CLIENT_FRAGMENT);
+    }
+    return NULL;
+}
+
+static void test_latency_standin(void) {
+    int device = connect_standin("stairs");
+    int controller = connect_standin("controller");
+    pthread_t thread;
+    int64_t lat_min = INT64_MAX, lat_max = 0, lat_sum = 0;
+
+    TEST_ASSERT_TRUE(device >= 0 && controller >= 0);
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&s_fb, led_strip_mock_new(STRIP_LEDS), STRIP_LEDS));
+    sem_init(&s_photon, 0, 0);
+    for (size_t i = 0; i < CMDS; i++) {
+        TEST_ASSERT_TRUE(subscribe(device, s_cmds[i].topic));
+    }
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, device_thread, &device));
+
+    for (int i = 0; i < LATENCY_ROUNDS; i++) {
+        /* Long enough to arrive in fragments every other round */
+        const char *payload = i % 2 ? "   off     \n" : "  ON   \n";
+        int64_t start = esp_timer_get_time();
+        TEST_ASSERT_TRUE(publish(controller, TOPIC_POWER, payload));
+        sem_wait(&s_photon);
+        int64_t latency = s_photon_us - start;
+
+        TEST_ASSERT_EQUAL(i % 2 ? 0 : 255, led_strip_mock_shown(s_fb.strip)[0]);
+        lat_sum += latency;
+        lat_min = latency < lat_min ? latency : lat_min;
+        lat_max = latency > lat_max ? latency : lat_max;
+    }
+
+    shutdown(device, SHUT_RDWR);
+    pthread_join(thread, NULL);
+    close(device);
+    close(controller);
+    printf("CMD command->photon over %d rounds: min=%" PRId64 " avg=%" PRId64 " max=%" PRId64 " us, refreshes=%" PRIu32 "\n",
+           LATENCY_ROUNDS, lat_min, lat_sum / LATENCY_ROUNDS, lat_max, s_fb.stats.refreshes);
+    TEST_ASSERT_EQUAL(LATENCY_ROUNDS, s_fb.stats.refreshes);
+    TEST_ASSERT_LESS_THAN(100 * 1000, lat_max);    // well under the old 60 s poll, even on a loaded host
+
+    led_strip_del(s_fb.strip);
+    free(s_fb.rgb);
+    free(s_fb.sent);
+    s_fb.strip = NULL;
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_parse);
+    RUN_TEST(test_dispatch_in_place);
+    RUN_TEST(test_fragments);
+    if (getenv("STANDIN_PORT")) {
+        RUN_TEST(test_latency_standin);
+    }
+    exit(UNITY_END());
+}
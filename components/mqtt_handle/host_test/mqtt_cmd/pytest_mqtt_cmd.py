@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+#
+# Runs the MQTT command host test against a local stand-in for the MQTT
+# broker (mosquitto), which routes QoS 0 publishes to the connections that
+# subscribed to their exact topic.
+#
+#   idf.py --preview set-target linux && idf.py build
+#   pytest pytest_mqtt_cmd.py
+
+import os
+import re
+import socket
+import socketserver
+import struct
+import subprocess
+import threading
+
+
+class StandInBroker(socketserver.BaseRequestHandler):
+
+    def read_packet(self) -> tuple:
+        head = self.request.recv(1)
+        if not head:
+            return None, b''
+        length, shift = 0, 0
+        while True:
+            byte = self.request.recv(1)[0]
+            length |= (byte & 0x7f) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        body = b''
+        while len(body) < length:
+            body += self.request.recv(length - len(body))
+        return head[0], body
+
+    def handle(self) -> None:
+        self.request.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        topics = set()
+        try:
+            while True:
+                kind, body = self.read_packet()
+                if kind is None or kind == 0xe0:        # closed, DISCONNECT
+                    return
+                if kind == 0x10:                        # CONNECT
+                    self.request.sendall(b'\x20\x02\x00\x00')
+                elif kind == 0x82:                      # SUBSCRIBE
+                    packet_id, offset, granted = body[:2], 2, b''
+                    while offset < len(body):
+                        topic_len = struct.unpack_from('>H', body, offset)[0]
+                        topics.add(body[offset + 2:offset + 2 + topic_len].decode())
+                        offset += 2 + topic_len + 1
+                        granted += b'\x00'
+                    with self.server.lock:
+                        if all(sock is not self.request for _, sock in self.server.subscribers):
+                            self.server.subscribers.append((topics, self.request))
+                    self.request.sendall(bytes([0x90, 2 + len(granted)]) + packet_id + granted)
+                elif kind & 0xf0 == 0x30:               # PUBLISH, QoS 0
+                    topic_len = struct.unpack_from('>H', body)[0]
+                    topic = body[2:2 + topic_len].decode()
+                    with self.server.lock:
+                        self.server.routed += 1
+                        for subscribed, sock in self.server.subscribers:
+                            if topic in subscribed:
+                                sock.sendall(bytes([0x30, len(body)]) + body)
+                elif kind == 0xc0:                      # PINGREQ
+                    self.request.sendall(b'\xd0\x00')
+        finally:
+            with self.server.lock:
+                self.server.subscribers = [s for s in self.server.subscribers if s[1] is not self.request]
+
+
+def test_mqtt_cmd_latency() -> None:
+    server = socketserver.ThreadingTCPServer(('127.0.0.1', 0), StandInBroker)
+    server.lock = threading.Lock()
+    server.subscribers = []
+    server.routed = 0
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+
+    elf = os.path.join(os.path.dirname(__file__), 'build', 'mqtt_cmd_host_test.elf')
+    env = dict(os.environ, STANDIN_PORT=str(server.server_address[1]))
+    try:
+        result = subprocess.run([elf], env=env, capture_output=True, text=True, timeout=60)
+    finally:
+        server.shutdown()
+    print(result.stdout)
+    assert result.returncode == 0
+    assert server.routed == 50
+
+    latency = re.search(r'CMD command->photon over (\d+) rounds: min=(\d+) avg=(\d+) max=(\d+) us', result.stdout)
+    assert latency
+    assert int(latency.group(3)) < 20000        # avg, loopback
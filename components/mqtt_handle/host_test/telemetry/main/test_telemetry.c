@@ -0,0 +1,235 @@
+/**
+ * @file test_telemetry.c
+ * @author The Authors
+ * @brief Host test for the telemetry batching and payload layout
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * With STANDIN_PORT set the payloads are also published, through just enough
+ * MQTT 3.1.1 to do it, to the stand-in broker in pytest_telemetry.py, which
+ * decodes them with its own copy of the layout.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "unity.h"
+#include "telemetry_batch.h"
+
+#define CYCLES          10
+#define BATCH           4
+#define STANDIN_QOS     1
+
+static telemetry_sample_t cycle_sample(int i) {
+    telemetry_sample_t s = {
+        .dt = 1734609600 + i * 1800,
+        .temp_min = -3 + i,
+        .temp_now = i,
+        .temp_max = 4 + i,
+        .flags = (i % 3 == 1 ? TELEMETRY_FLAG_NOT_MODIFIED : 0) | (i > 0 ? TELEMETRY_FLAG_REUSED : 0),
+        .dns_us = i ? 0 : 41000,
+        .connect_us = i ? 0 : 87000,
+        .first_byte_us = 120000 + i,
+        .parse_us = 900 + i,
+    };
+    if (i == 5) {
+        s.flags |= TELEMETRY_FLAG_FAILED;   // no render follows
+    }
+    return s;
+}
+
+/* CYCLES fetch cycles into payloads[], returns how many */
+static int run_cycles(uint8_t payloads[][TELEMETRY_PAYLOAD_MAX], size_t *lens) {
+    telemetry_batch_t tb;
+    int n = 0;
+
+    telemetry_batch_init(&tb, BATCH);
+    for (int i = 0; i < CYCLES; i++) {
+        telemetry_sample_t s = cycle_sample(i);
+        bool full = telemetry_batch_fetch(&tb, &s);
+        if (!full && !(s.flags & TELEMETRY_FLAG_FAILED)) {
+            full = telemetry_batch_render(&tb, 300000 + i);
+        }
+        if (full) {
+            lens[n] = telemetry_batch_encode(&tb, payloads[n], TELEMETRY_PAYLOAD_MAX);
+            n++;
+        }
+    }
+    return n;
+}
+
+static void test_batches_cover_cycles(void) {
+    static uint8_t payloads[CYCLES][TELEMETRY_PAYLOAD_MAX];
+    size_t lens[CYCLES];
+    telemetry_header_t header;
+    telemetry_sample_t samples[TELEMETRY_BATCH_MAX];
+
+    /* The failed cycle 5 is closed by cycle 6's fetch, which then waits for its render */
+    TEST_ASSERT_EQUAL(2, run_cycles(payloads, lens));
+    int cycle = 0;
+    for (int p = 0; p < 2; p++) {
+        TEST_ASSERT_EQUAL(TELEMETRY_HEADER_LEN + BATCH * TELEMETRY_SAMPLE_LEN, lens[p]);
+        TEST_ASSERT_EQUAL(BATCH, telemetry_decode(payloads[p], lens[p], &header, samples, TELEMETRY_BATCH_MAX));
+        TEST_ASSERT_EQUAL(p, header.seq);
+        TEST_ASSERT_EQUAL(0, header.dropped);
+        for (int i = 0; i < BATCH; i++, cycle++) {
+            telemetry_sample_t want = cycle_sample(cycle);
+            TEST_ASSERT_EQUAL(want.dt, samples[i].dt);
+            TEST_ASSERT_EQUAL(want.temp_now, samples[i].temp_now);
+            TEST_ASSERT_EQUAL(want.first_byte_us, samples[i].first_byte_us);
+            if (cycle == 5) {
+                TEST_ASSERT_EQUAL(0, samples[i].flags & TELEMETRY_FLAG_RENDERED);
+                TEST_ASSERT_EQUAL(0, samples[i].render_us);
+            } else {
+                TEST_ASSERT_EQUAL(want.flags | TELEMETRY_FLAG_RENDERED, samples[i].flags);
+                TEST_ASSERT_EQUAL(300000 + cycle, samples[i].render_us);
+            }
+        }
+    }
+}
+
+static void test_fixed_layout(void) {
+    telemetry_batch_t tb;
+    uint8_t buf[TELEMETRY_PAYLOAD_MAX];
+    telemetry_header_t header;
+    telemetry_sample_t out;
+    const telemetry_sample_t s = {
+        .dt = 0x01020304,
+        .temp_min = -15,
+        .temp_now = telemetry_temp(20000),
+        .temp_max = telemetry_temp(-20000),
+        .flags = TELEMETRY_FLAG_REUSED,
+        .dns_us = 0x11223344,
+        .connect_us = 5,
+        .first_byte_us = 6,
+        .parse_us = 7,
+    };
+
+    telemetry_batch_init(&tb, 1);
+    TEST_ASSERT_FALSE(telemetry_batch_render(&tb, 1));      // nothing open yet
+    TEST_ASSERT_FALSE(telemetry_batch_fetch(&tb, &s));
+    TEST_ASSERT_TRUE(telemetry_batch_render(&tb, 0xa0b0c0d0));
+    TEST_ASSERT_EQUAL(TELEMETRY_HEADER_LEN + TELEMETRY_SAMPLE_LEN, telemetry_batch_encode(&tb, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(0, telemetry_batch_encode(&tb, buf, sizeof(buf)));    // emptied
+
+    const uint8_t want[TELEMETRY_HEADER_LEN + TELEMETRY_SAMPLE_LEN] = {
+        TELEMETRY_VERSION, 1, 0, 0,  0, 0, 0, 0,
+        0x04, 0x03, 0x02, 0x01,  0xf1, 0x7f, 0x80, TELEMETRY_FLAG_REUSED | TELEMETRY_FLAG_RENDERED,
+        0x44, 0x33, 0x22, 0x11,  5, 0, 0, 0,  6, 0, 0, 0,  7, 0, 0, 0,  0xd0, 0xc0, 0xb0, 0xa0,
+    };
+    TEST_ASSERT_EQUAL_MEMORY(want, buf, sizeof(want));
+
+    TEST_ASSERT_EQUAL(1, telemetry_decode(buf, sizeof(want), &header, &out, 1));
+    TEST_ASSERT_EQUAL(-15, out.temp_min);
+    TEST_ASSERT_EQUAL(127, out.temp_now);
+    TEST_ASSERT_EQUAL(-128, out.temp_max);
+    TEST_ASSERT_EQUAL(8, telemetry_temp(783));              // centi-degrees, rounded
+    TEST_ASSERT_EQUAL(-3, telemetry_temp(-250));
+    TEST_ASSERT_EQUAL(2, telemetry_temp(249));
+    TEST_ASSERT_EQUAL(0, telemetry_temp(-49));
+    TEST_ASSERT_EQUAL_UINT32(0xa0b0c0d0, out.render_us);
+    TEST_ASSERT_EQUAL(-1, telemetry_decode(buf, sizeof(want) - 1, &header, &out, 1));
+    buf[0] = TELEMETRY_VERSION + 1;
+    TEST_ASSERT_EQUAL(-1, telemetry_decode(buf, sizeof(want), &header, &out, 1));
+}
+
+static void test_untaken_batch_drops(void) {
+    telemetry_batch_t tb;
+    telemetry_sample_t s = cycle_sample(0);
+
+    /* Full batches that are never encoded: the excess is counted, not overrun */
+    telemetry_batch_init(&tb, TELEMETRY_BATCH_MAX);
+    for (int i = 0; i < TELEMETRY_BATCH_MAX + 3; i++) {
+        telemetry_batch_fetch(&tb, &s);
+        telemetry_batch_render(&tb, 1);
+    }
+    TEST_ASSERT_EQUAL(TELEMETRY_BATCH_MAX, tb.count);
+    TEST_ASSERT_EQUAL(3, tb.dropped);
+}
+
+/* MQTT 3.1.1 remaining length */
+static size_t put_remaining(uint8_t *p, size_t len) {
+    size_t n = 0;
+    do {
+        p[n] = len % 128;
+        len /= 128;
+        if (len) {
+            p[n] |= 0x80;
+        }
+        n++;
+    } while (len);
+    return n;
+}
+
+static bool send_packet(int sock, uint8_t type, const uint8_t *var, size_t len) {
+    uint8_t head[5] = { type };
+    size_t n = 1 + put_remaining(head + 1, len);
+    return send(sock, head, n, 0) == (ssize_t)n && (len == 0 || send(sock, var, len, 0) == (ssize_t)len);
+}
+
+static bool recv_exact(int sock, uint8_t *buf, size_t len) {
+    return recv(sock, buf, len, MSG_WAITALL) == (ssize_t)len;
+}
+
+static void test_standin_broker(void) {
+    static uint8_t payloads[CYCLES][TELEMETRY_PAYLOAD_MAX];
+    static uint8_t packet[TELEMETRY_PAYLOAD_MAX + 64];
+    size_t lens[CYCLES];
+    uint8_t ack[4];
+    int n = run_cycles(payloads, lens);
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(atoi(getenv("STANDIN_PORT"))),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_EQUAL(0, connect(sock, (struct sockaddr *)&addr, sizeof(addr)));
+
+    static const uint8_t connect_var[] = {
+        0, 4, 'M', 'Q', 'T', 'T', 4, 0x02, 0, 60,      // clean session, keep alive 60 s
+        0, 6, 's', 't', 'a', 'i', 'r', 's',
+    };
+    TEST_ASSERT_TRUE(send_packet(sock, 0x10, connect_var, sizeof(connect_var)));
+    TEST_ASSERT_TRUE(recv_exact(sock, ack, 4));
+    TEST_ASSERT_EQUAL(0x20, ack[0]);
+    TEST_ASSERT_EQUAL(0, ack[3]);
+
+    static const char topic[] = "tele/stairs/telemetry";
+    for (int i = 0; i < n; i++) {
+        size_t len = 0;
+        packet[len++] = 0;
+        packet[len++] = sizeof(topic) - 1;
+        memcpy(packet + len, topic, sizeof(topic) - 1);
+        len += sizeof(topic) - 1;
+        packet[len++] = 0;
+        packet[len++] = i + 1;                          // packet id
+        memcpy(packet + len, payloads[i], lens[i]);
+        len += lens[i];
+        TEST_ASSERT_TRUE(send_packet(sock, 0x30 | STANDIN_QOS << 1, packet, len));
+        TEST_ASSERT_TRUE(recv_exact(sock, ack, 4));     // PUBACK
+        TEST_ASSERT_EQUAL(0x40, ack[0]);
+        TEST_ASSERT_EQUAL(i + 1, ack[3]);
+    }
+    send_packet(sock, 0xe0, NULL, 0);
+    close(sock);
+    printf("TELEMETRY published=%d cycles=%d bytes/cycle=%d\n", n, n * BATCH,
+           (TELEMETRY_HEADER_LEN + BATCH * TELEMETRY_SAMPLE_LEN) / BATCH);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_batches_cover_cycles);
+    RUN_TEST(test_fixed_layout);
+    RUN_TEST(test_untaken_batch_drops);
+    if (getenv("STANDIN_PORT")) {
+        RUN_TEST(test_standin_broker);
+    }
+    exit(UNITY_END());
+}
@@ -0,0 +1,94 @@
+#!/usr/bin/env python
+#
+# Runs the telemetry host test against a local stand-in for the MQTT broker
+# (mosquitto), which acknowledges QoS 1 publishes and decodes the payloads
+# with its own copy of the layout in telemetry_batch.h.
+#
+#   idf.py --preview set-target linux && idf.py build
+#   pytest pytest_telemetry.py
+
+import os
+import socketserver
+import struct
+import subprocess
+import threading
+
+TOPIC = 'tele/stairs/telemetry'
+HEADER = struct.Struct('<BBHI')
+SAMPLE = struct.Struct('<IbbbBIIIII')
+FLAG_FAILED = 1 << 1
+FLAG_RENDERED = 1 << 3
+
+
+def decode(payload: bytes) -> list:
+    version, count, seq, dropped = HEADER.unpack_from(payload)
+    assert version == 1
+    assert len(payload) == HEADER.size + count * SAMPLE.size
+    return [SAMPLE.unpack_from(payload, HEADER.size + i * SAMPLE.size) for i in range(count)]
+
+
+class StandInBroker(socketserver.BaseRequestHandler):
+
+    def read_packet(self) -> tuple:
+        head = self.request.recv(1)
+        if not head:
+            return None, b''
+        length, shift = 0, 0
+        while True:
+            byte = self.request.recv(1)[0]
+            length |= (byte & 0x7f) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        body = b''
+        while len(body) < length:
+            body += self.request.recv(length - len(body))
+        return head[0], body
+
+    def handle(self) -> None:
+        while True:
+            kind, body = self.read_packet()
+            if kind is None or kind == 0xe0:        # closed, DISCONNECT
+                return
+            if kind == 0x10:                        # CONNECT
+                self.request.sendall(b'\x20\x02\x00\x00')
+            elif kind & 0xf0 == 0x30:               # PUBLISH
+                qos = kind >> 1 & 3
+                topic_len = struct.unpack_from('>H', body)[0]
+                topic = body[2:2 + topic_len].decode()
+                offset = 2 + topic_len
+                if qos:
+                    packet_id = body[offset:offset + 2]
+                    offset += 2
+                    self.request.sendall(b'\x40\x02' + packet_id)
+                with self.server.lock:
+                    self.server.publishes.append((topic, qos, body[offset:]))
+
+
+def test_telemetry_publish() -> None:
+    server = socketserver.ThreadingTCPServer(('127.0.0.1', 0), StandInBroker)
+    server.lock = threading.Lock()
+    server.publishes = []
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+
+    elf = os.path.join(os.path.dirname(__file__), 'build', 'telemetry_host_test.elf')
+    env = dict(os.environ, STANDIN_PORT=str(server.server_address[1]))
+    try:
+        result = subprocess.run([elf], env=env, capture_output=True, text=True, timeout=60)
+    finally:
+        server.shutdown()
+    print(result.stdout)
+    assert result.returncode == 0
+
+    # 10 cycles in batches of 4: two publishes, the last 2 cycles still batching
+    assert len(server.publishes) == 2
+    samples = []
+    for topic, qos, payload in server.publishes:
+        assert topic == TOPIC
+        assert qos == 1
+        samples += decode(payload)
+    assert [s[2] for s in samples] == list(range(8))        # temp_now
+    for i, (dt, t_min, t_now, t_max, flags, dns, conn, first, parse, render) in enumerate(samples):
+        assert dt == 1734609600 + i * 1800
+        assert bool(flags & FLAG_RENDERED) == (not flags & FLAG_FAILED)
+        assert render == (300000 + i if flags & FLAG_RENDERED else 0)
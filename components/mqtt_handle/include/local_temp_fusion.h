@@ -0,0 +1,131 @@
+/**
+ * @file local_temp_fusion.h
+ * @author The Authors
+ * @brief Combine a pushed local temperature with the forecast, debounced
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The forecast gives min/now/max every fetch; a local sensor pushes "now"
+ * whenever it likes. local_temp_fuse() decides what the strip shows from the
+ * two, by policy. Readings are rate limited rather than delayed: one that
+ * comes debounce_us after the last render is shown at once, a burst inside
+ * that window is coalesced into one render of its last value at the end of
+ * it. A reading older than stale_us no longer counts.
+ *
+ * Poll style like fetch_sched.h: the caller passes the time in, arms a timer
+ * for local_temp_next_us() and calls local_temp_due() when it fires. Nothing
+ * in here touches FreeRTOS or MQTT, for the host test.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    LOCAL_TEMP_OVERRIDE,        // the reading is "now", min/max stretched to include it
+    LOCAL_TEMP_BLEND,           // "now" is blend_pct of the way from the forecast to the reading
+    LOCAL_TEMP_FALLBACK,        // the forecast wins, the reading only shows until there is one
+} local_temp_policy_t;
+
+typedef struct {
+    local_temp_policy_t policy;
+    int blend_pct;              // LOCAL_TEMP_BLEND, 0 to 100
+    int64_t debounce_us;        // least time between renders caused by readings
+    int64_t stale_us;           // readings expire after this
+} local_temp_config_t;
+
+typedef struct {
+    int temp_min;               // centi-degrees C, as the readings
+    int temp_now;
+    int temp_max;
+} local_temp_view_t;
+
+typedef struct {
+    uint32_t readings;
+    uint32_t renders;           // views handed out by local_temp_reading()/_due()
+    uint32_t coalesced;         // readings superseded before they were rendered
+    uint32_t unchanged;         // readings that didn't change the view
+} local_temp_stats_t;
+
+typedef struct {
+    local_temp_config_t cfg;
+    bool have_forecast;
+    local_temp_view_t forecast;
+    bool have_reading;
+    int reading;
+    int64_t reading_us;
+    bool pending;               // a reading waits for the debounce window to end
+    int64_t last_render_us;
+    bool have_shown;
+    local_temp_view_t shown;
+    local_temp_stats_t stats;
+} local_temp_t;
+
+/**
+ * @brief No forecast, no reading
+ *
+ * @param lt
+ * @param cfg
+ */
+void local_temp_init(local_temp_t *lt, const local_temp_config_t *cfg);
+
+/**
+ * @brief The view from whatever is current at now_us
+ *
+ * @return false if there is nothing to show
+ */
+bool local_temp_fuse(const local_temp_t *lt, int64_t now_us, local_temp_view_t *out);
+
+/**
+ * @brief A fresh forecast, always rendered (it comes with its own animation)
+ *
+ * @param lt
+ * @param forecast
+ * @param now_us
+ * @param out       what to show instead, with any live reading fused in
+ */
+void local_temp_forecast(local_temp_t *lt, const local_temp_view_t *forecast, int64_t now_us, local_temp_view_t *out);
+
+/**
+ * @brief A sensor reading
+ *
+ * @return true to render *out now, otherwise see local_temp_next_us()
+ */
+bool local_temp_reading(local_temp_t *lt, int temp, int64_t now_us, local_temp_view_t *out);
+
+/**
+ * @brief When to call local_temp_due(): the end of the debounce window, or the
+ *        reading going stale
+ *
+ * @return microseconds from now_us, -1 for nothing to wait for
+ */
+int64_t local_temp_next_us(const local_temp_t *lt, int64_t now_us);
+
+/**
+ * @brief The timer fired
+ *
+ * @return true to render *out
+ */
+bool local_temp_due(local_temp_t *lt, int64_t now_us, local_temp_view_t *out);
+
+/**
+ * @brief A centi-degree reading from a payload: a bare number ("21.6") or,
+ *        with key set, the number after "key": in JSON
+ *        ({"DS18B20":{"Temperature":21.6}}). Rounded to the nearest hundredth.
+ *
+ * @param key   NULL or "" for a bare number
+ * @return true if a number in -100..100 was found
+ */
+bool local_temp_parse(const char *data, size_t len, const char *key, int *temp);
+
+#ifdef __cplusplus
+}
+#endif
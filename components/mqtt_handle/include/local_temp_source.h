@@ -0,0 +1,36 @@
+/**
+ * @file local_temp_source.h
+ * @author The Authors
+ * @brief Local sensor readings pushed over MQTT, fused into what strip 0 shows
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * mqtt_start() subscribes to CONFIG_LOCAL_TEMP_TOPIC when it is set. Readings
+ * go to the light callback from the MQTT task, without waiting for the next
+ * fetch; forecasts for strip 0 pass through here on their way to it. The
+ * policy and debouncing are in local_temp_fusion.h.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "common.h"
+
+/**
+ * @brief Before mqtt_start() and http_get_init()
+ *
+ * @param light_cb  where the fused readings go
+ */
+void local_temp_source_start(light_strip_set_cb_t light_cb);
+
+/**
+ * @brief light_strip_set_cb_t for http_get_init()
+ */
+void local_temp_source_forecast(int strip, int temp_min, int temp_now, int temp_max);
+
+/**
+ * @brief mqtt_cmd_handler_t for CONFIG_LOCAL_TEMP_TOPIC
+ */
+void local_temp_source_message(const char *data, size_t len);
@@ -0,0 +1,105 @@
+/**
+ * @file mqtt_cmd.h
+ * @author The Authors
+ * @brief Topic -> handler dispatch of MQTT commands, parsed in place
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Fed straight from MQTT_EVENT_DATA. A message that arrives whole (the usual
+ * case, commands are short) is handed to its handler as a pointer into
+ * event->data, nothing is copied. The client splits a message bigger than
+ * its buffer over several events, only the first carrying the topic; those
+ * are reassembled in a MQTT_CMD_PAYLOAD_MAX buffer first.
+ *
+ * The parse helpers take (data, len), payloads aren't NUL terminated.
+ *
+ * Nothing in here touches MQTT or FreeRTOS, for the host test.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MQTT_CMD_PAYLOAD_MAX    64
+
+/* Runs on the MQTT task, keep it short */
+typedef void (*mqtt_cmd_handler_t)(const char *data, size_t len);
+
+typedef struct {
+    const char *topic;
+    mqtt_cmd_handler_t handler;
+} mqtt_cmd_t;
+
+typedef struct {
+    uint32_t dispatched;
+    uint32_t reassembled;       // ... of which arrived in fragments
+    uint32_t unknown;           // no handler for the topic
+    uint32_t oversize;          // fragmented and over MQTT_CMD_PAYLOAD_MAX, dropped
+} mqtt_cmd_stats_t;
+
+typedef struct {
+    const mqtt_cmd_t *cmds;
+    size_t count;
+    const mqtt_cmd_t *pending;  // reassembling a message for this one
+    size_t total;
+    size_t have;
+    char buf[MQTT_CMD_PAYLOAD_MAX];
+    mqtt_cmd_stats_t stats;
+} mqtt_cmd_dispatcher_t;
+
+/**
+ * @brief Dispatch to a table of commands
+ *
+ * @param d
+ * @param cmds      kept, not copied
+ * @param count
+ */
+void mqtt_cmd_init(mqtt_cmd_dispatcher_t *d, const mqtt_cmd_t *cmds, size_t count);
+
+/**
+ * @brief One MQTT_EVENT_DATA
+ *
+ * @param d
+ * @param topic         event->topic, only on the first fragment
+ * @param topic_len
+ * @param data          event->data
+ * @param data_len
+ * @param offset        event->current_data_offset
+ * @param total_len     event->total_data_len
+ * @return true         a handler ran
+ */
+bool mqtt_cmd_feed(mqtt_cmd_dispatcher_t *d, const char *topic, size_t topic_len,
+                   const char *data, size_t data_len, size_t offset, size_t total_len);
+
+/**
+ * @brief "ON"/"OFF", "1"/"0", "true"/"false", any case, surrounding blanks ignored
+ *
+ * @return true if it was one of those
+ */
+bool mqtt_cmd_parse_bool(const char *data, size_t len, bool *out);
+
+/**
+ * @brief Decimal, 0 to max
+ *
+ * @return true if in range & nothing else in the payload
+ */
+bool mqtt_cmd_parse_uint(const char *data, size_t len, uint32_t max, uint32_t *out);
+
+/**
+ * @brief "#rrggbb", "rrggbb" or "r,g,b" (0-255 each)
+ *
+ * @return true if well formed
+ */
+bool mqtt_cmd_parse_rgb(const char *data, size_t len, uint8_t *red, uint8_t *green, uint8_t *blue);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -12,6 +12,45 @@
 #ifndef MQTT_H_
 #define MQTT_H_
 
-void mqtt_start(void);
+#include <stddef.h>
+#include "esp_err.h"
+#include "mqtt_cmd.h"
+
+/* Called from the MQTT task on every (re)connect */
+typedef void (*mqtt_connected_cb_t)(void);
+
+/**
+ * @brief Connect to the broker, doesn't wait for the connection. Every
+ *        command topic is subscribed to on each (re)connect.
+ *
+ * @param on_connected  optional
+ * @param cmds          commands besides the built-in history query & local sensor, copied
+ * @param count
+ * @return esp_err_t    if the client couldn't be created or started
+ */
+esp_err_t mqtt_start(mqtt_connected_cb_t on_connected, const mqtt_cmd_t *cmds, size_t count);
+
+/**
+ * @brief Publish on the running client
+ *
+ * @param topic
+ * @param data
+ * @param len   0: data is a string
+ * @param qos
+ * @return int  message id, -1 if not started or failed
+ */
+int mqtt_publish(const char *topic, const char *data, int len, int qos);
+
+/**
+ * @brief Like mqtt_publish(), but only queued: sent later from the MQTT task,
+ *        so it doesn't wait on the network
+ *
+ * @param topic
+ * @param data
+ * @param len   0: data is a string
+ * @param qos
+ * @return int  message id, -1 if not started or the outbox is full
+ */
+int mqtt_enqueue(const char *topic, const char *data, int len, int qos);
 
 #endif  /* MQTT_H_ */
@@ -0,0 +1,41 @@
+/**
+ * @file telemetry.h
+ * @author The Authors
+ * @brief Batched MQTT telemetry of readings & fetch pipeline timings
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * The fetch and render paths only post to a queue, without waiting: a full
+ * queue drops the sample (and counts it). A low priority task batches the
+ * samples and hands every CONFIG_TELEMETRY_BATCH of them to the MQTT client's
+ * outbox as one payload (layout in telemetry_batch.h) on TELEMETRY_TOPIC.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "common.h"
+
+#define TELEMETRY_TOPIC     "tele/stairs/telemetry"
+
+/**
+ * @brief Start the batching task, before anything reports. Batches filled
+ *        before mqtt_start() are dropped.
+ */
+void telemetry_init(void);
+
+/**
+ * @brief fetch_report_cb_t for http_get_init(), never blocks
+ *
+ * @param report
+ */
+void telemetry_fetch(const fetch_report_t *report);
+
+/**
+ * @brief render_report_cb_t for light_driver_set_render_report_cb(), never blocks
+ *
+ * @param render_us
+ */
+void telemetry_render(uint32_t render_us);
@@ -0,0 +1,149 @@
+/**
+ * @file telemetry_batch.h
+ * @author The Authors
+ * @brief Fetch cycle samples, batched into one fixed-layout MQTT payload
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * One sample per fetch cycle: the reading shown and where the time went. The
+ * render duration arrives after the fetch (the animation runs on), so a
+ * sample stays open until its render is reported or the next fetch starts.
+ *
+ * Payload, little-endian, no padding:
+ *
+ *   header (8 bytes)
+ *     0  u8   version (TELEMETRY_VERSION)
+ *     1  u8   samples
+ *     2  u16  sequence number of the payload
+ *     4  u32  samples dropped since boot (queue full)
+ *   sample (28 bytes each)
+ *     0  u32  dt, unix seconds of the reading, 0 if none yet
+ *     4  i8   temp_min, whole degC (the readings are centi-degrees, rounded)
+ *     5  i8   temp_now
+ *     6  i8   temp_max
+ *     7  u8   TELEMETRY_FLAG_*
+ *     8  u32  dns_us
+ *    12  u32  connect_us
+ *    16  u32  first_byte_us
+ *    20  u32  parse_us
+ *    24  u32  render_us
+ *
+ * Nothing in here touches MQTT or FreeRTOS, for the host test.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRY_VERSION       1
+#define TELEMETRY_HEADER_LEN    8
+#define TELEMETRY_SAMPLE_LEN    28
+#define TELEMETRY_BATCH_MAX     16
+#define TELEMETRY_PAYLOAD_MAX   (TELEMETRY_HEADER_LEN + TELEMETRY_BATCH_MAX * TELEMETRY_SAMPLE_LEN)
+
+#define TELEMETRY_FLAG_NOT_MODIFIED (1 << 0)   // 304, the reading is the previous one
+#define TELEMETRY_FLAG_FAILED       (1 << 1)   // no reading this cycle
+#define TELEMETRY_FLAG_REUSED       (1 << 2)   // kept-alive connection, no DNS or connect
+#define TELEMETRY_FLAG_RENDERED     (1 << 3)   // render_us is valid
+
+typedef struct {
+    uint32_t dt;
+    int8_t temp_min;
+    int8_t temp_now;
+    int8_t temp_max;
+    uint8_t flags;
+    uint32_t dns_us;
+    uint32_t connect_us;
+    uint32_t first_byte_us;
+    uint32_t parse_us;
+    uint32_t render_us;
+} telemetry_sample_t;
+
+typedef struct {
+    uint8_t version;
+    uint8_t count;
+    uint16_t seq;
+    uint32_t dropped;
+} telemetry_header_t;
+
+typedef struct {
+    telemetry_sample_t samples[TELEMETRY_BATCH_MAX];
+    size_t count;
+    size_t batch;               // samples per payload
+    telemetry_sample_t open;    // waiting for its render
+    bool has_open;
+    uint16_t seq;
+    uint32_t dropped;
+} telemetry_batch_t;
+
+/**
+ * @brief Start empty
+ *
+ * @param tb
+ * @param batch     samples per payload, 1 to TELEMETRY_BATCH_MAX
+ */
+void telemetry_batch_init(telemetry_batch_t *tb, size_t batch);
+
+/**
+ * @brief A fetch cycle ended. Closes the previous sample if its render never
+ *        came (e.g. a failed fetch) and opens this one.
+ *
+ * @param tb
+ * @param sample
+ * @return true     a full batch is ready for telemetry_batch_encode()
+ */
+bool telemetry_batch_fetch(telemetry_batch_t *tb, const telemetry_sample_t *sample);
+
+/**
+ * @brief The open sample's animation finished
+ *
+ * @param tb
+ * @param render_us
+ * @return true     a full batch is ready for telemetry_batch_encode()
+ */
+bool telemetry_batch_render(telemetry_batch_t *tb, uint32_t render_us);
+
+/**
+ * @brief Encode the closed samples and empty the batch
+ *
+ * @param tb
+ * @param[out] buf
+ * @param len
+ * @return size_t   payload length, 0 if there was nothing to send or buf is too small
+ */
+size_t telemetry_batch_encode(telemetry_batch_t *tb, uint8_t *buf, size_t len);
+
+/**
+ * @brief Parse a payload
+ *
+ * @param buf
+ * @param len
+ * @param[out] header
+ * @param[out] samples  room for max
+ * @param max
+ * @return int      samples decoded, -1 if the payload is malformed
+ */
+int telemetry_decode(const uint8_t *buf, size_t len, telemetry_header_t *header, telemetry_sample_t *samples, size_t max);
+
+/**
+ * @brief A centi-degree reading as a sample's int8 temperature: rounded to
+ *        the nearest degree, half away from zero, and clamped
+ */
+static inline int8_t telemetry_temp(int centi) {
+    int half = centi < 0 ? -TEMP_CENTI_PER_C / 2 : TEMP_CENTI_PER_C / 2;
+    int temp = (centi + half) / TEMP_CENTI_PER_C;
+    return temp < INT8_MIN ? INT8_MIN : temp > INT8_MAX ? INT8_MAX : (int8_t)temp;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
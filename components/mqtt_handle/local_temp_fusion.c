@@ -0,0 +1,211 @@
+/**
+ * @file local_temp_fusion.c
+ * @author The Authors
+ * @brief Combine a pushed local temperature with the forecast, debounced
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include <ctype.h>
+#include "common.h"
+#include "local_temp_fusion.h"
+
+#define LOCAL_TEMP_LIMIT    100     // degrees either way, anything past that is a broken sensor
+
+static bool fresh(const local_temp_t *lt, int64_t now_us) {
+    return lt->have_reading && now_us - lt->reading_us < lt->cfg.stale_us;
+}
+
+static int round_div(int num, int den) {
+    return num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+
+static void include_now(local_temp_view_t *v) {
+    v->temp_min = v->temp_now < v->temp_min ? v->temp_now : v->temp_min;
+    v->temp_max = v->temp_now > v->temp_max ? v->temp_now : v->temp_max;
+}
+
+/* The fused view at now_us, if it differs from what's shown */
+static bool render(local_temp_t *lt, int64_t now_us, local_temp_view_t *out) {
+    if (!local_temp_fuse(lt, now_us, out)) {
+        return false;
+    }
+    if (lt->have_shown && memcmp(&lt->shown, out, sizeof(*out)) == 0) {
+        return false;
+    }
+    lt->shown = *out;
+    lt->have_shown = true;
+    lt->last_render_us = now_us;
+    lt->stats.renders++;
+    return true;
+}
+
+void local_temp_init(local_temp_t *lt, const local_temp_config_t *cfg) {
+    memset(lt, 0, sizeof(*lt));
+    lt->cfg = *cfg;
+}
+
+bool local_temp_fuse(const local_temp_t *lt, int64_t now_us, local_temp_view_t *out) {
+    if (!fresh(lt, now_us)) {
+        *out = lt->forecast;
+        return lt->have_forecast;
+    }
+    int r = lt->reading;
+    if (!lt->have_forecast) {
+        *out = (local_temp_view_t){ r, r, r };
+        return true;
+    }
+
+    *out = lt->forecast;
+    switch (lt->cfg.policy) {
+    case LOCAL_TEMP_OVERRIDE:
+        out->temp_now = r;
+        break;
+    case LOCAL_TEMP_BLEND:
+        out->temp_now += round_div((r - out->temp_now) * lt->cfg.blend_pct, 100);
+        break;
+    case LOCAL_TEMP_FALLBACK:
+        break;
+    }
+    include_now(out);
+    return true;
+}
+
+void local_temp_forecast(local_temp_t *lt, const local_temp_view_t *forecast, int64_t now_us, local_temp_view_t *out) {
+    lt->forecast = *forecast;
+    lt->have_forecast = true;
+    lt->pending = false;                // the latest reading is in this render
+    local_temp_fuse(lt, now_us, out);
+    lt->shown = *out;
+    lt->have_shown = true;
+    lt->last_render_us = now_us;
+    lt->stats.renders++;
+}
+
+bool local_temp_reading(local_temp_t *lt, int temp, int64_t now_us, local_temp_view_t *out) {
+    lt->stats.readings++;
+    if (lt->pending) {
+        lt->stats.coalesced++;
+    }
+    lt->reading = temp;
+    lt->reading_us = now_us;
+    lt->have_reading = true;
+
+    if (lt->have_shown && now_us - lt->last_render_us < lt->cfg.debounce_us) {
+        lt->pending = true;
+        return false;
+    }
+    lt->pending = false;
+    if (render(lt, now_us, out)) {
+        return true;
+    }
+    lt->stats.unchanged++;
+    return false;
+}
+
+int64_t local_temp_next_us(const local_temp_t *lt, int64_t now_us) {
+    int64_t next = -1;
+    if (lt->pending) {
+        int64_t wait = lt->last_render_us + lt->cfg.debounce_us - now_us;
+        next = wait > 0 ? wait : 0;
+    }
+    if (fresh(lt, now_us)) {
+        int64_t expire = lt->reading_us + lt->cfg.stale_us - now_us;
+        next = next < 0 || expire < next ? expire : next;
+    }
+    return next;
+}
+
+bool local_temp_due(local_temp_t *lt, int64_t now_us, local_temp_view_t *out) {
+    if (lt->pending) {
+        if (now_us - lt->last_render_us < lt->cfg.debounce_us) {
+            return false;               // early, the caller re-arms
+        }
+        lt->pending = false;
+        if (render(lt, now_us, out)) {
+            return true;
+        }
+        lt->stats.unchanged++;
+        return false;
+    }
+    if (lt->have_reading && !fresh(lt, now_us)) {
+        lt->have_reading = false;       // back to the forecast, once
+        return render(lt, now_us, out);
+    }
+    return false;
+}
+
+static const char *find_key(const char *data, size_t len, const char *key) {
+    size_t n = strlen(key);
+    for (size_t i = 0; i + n + 2 <= len; i++) {
+        if (data[i] == '"' && memcmp(data + i + 1, key, n) == 0 && data[i + 1 + n] == '"') {
+            return data + i + n + 2;
+        }
+    }
+    return NULL;
+}
+
+bool local_temp_parse(const char *data, size_t len, const char *key, int *temp) {
+    const char *p = data;
+    const char *end = data + len;
+    bool json = key && *key;
+
+    if (json) {
+        p = find_key(data, len, key);
+        if (!p) {
+            return false;
+        }
+        while (p < end && (isspace((unsigned char)*p) || *p == ':')) {
+            p++;
+        }
+    }
+    while (p < end && isspace((unsigned char)*p)) {
+        p++;
+    }
+
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+    int whole = 0;
+    int digits = 0;
+    while (p < end && isdigit((unsigned char)*p)) {
+        if (whole > LOCAL_TEMP_LIMIT) {
+            return false;
+        }
+        whole = whole * 10 + (*p++ - '0');
+        digits++;
+    }
+    if (!digits) {
+        return false;
+    }
+    int centi = whole * TEMP_CENTI_PER_C;
+    if (p < end && *p == '.') {
+        p++;
+        for (int scale = TEMP_CENTI_PER_C / 10; scale > 0 && p < end && isdigit((unsigned char)*p); scale /= 10) {
+            centi += (*p++ - '0') * scale;
+        }
+        if (p < end && isdigit((unsigned char)*p) && *p >= '5') {
+            centi++;                    // half away from zero
+        }
+        while (p < end && isdigit((unsigned char)*p)) {
+            p++;
+        }
+    }
+    if (!json) {
+        while (p < end && isspace((unsigned char)*p)) {
+            p++;
+        }
+        if (p != end) {
+            return false;
+        }
+    }
+    if (centi > LOCAL_TEMP_LIMIT * TEMP_CENTI_PER_C) {
+        return false;
+    }
+    *temp = negative ? -centi : centi;
+    return true;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file local_temp_source.c
+ * @author The Authors
+ * @brief Local sensor readings pushed over MQTT, fused into what strip 0 shows
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <assert.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "local_temp_source.h"
+#include "local_temp_fusion.h"
+
+static const char *TAG = "local_temp";
+
+#if CONFIG_LOCAL_TEMP_POLICY_BLEND
+#define LOCAL_TEMP_POLICY   LOCAL_TEMP_BLEND
+#define LOCAL_TEMP_BLEND_PCT CONFIG_LOCAL_TEMP_BLEND_PCT
+#elif CONFIG_LOCAL_TEMP_POLICY_FALLBACK
+#define LOCAL_TEMP_POLICY   LOCAL_TEMP_FALLBACK
+#else
+#define LOCAL_TEMP_POLICY   LOCAL_TEMP_OVERRIDE
+#endif
+#ifndef LOCAL_TEMP_BLEND_PCT
+#define LOCAL_TEMP_BLEND_PCT 0
+#endif
+
+static const local_temp_config_t s_cfg = {
+    .policy = LOCAL_TEMP_POLICY,
+    .blend_pct = LOCAL_TEMP_BLEND_PCT,
+    .debounce_us = CONFIG_LOCAL_TEMP_DEBOUNCE_MS * 1000LL,
+    .stale_us = CONFIG_LOCAL_TEMP_STALE_S * 1000000LL,
+};
+
+static local_temp_t s_lt;
+static SemaphoreHandle_t s_lock;        // MQTT task, http_get_task and the timer
+static esp_timer_handle_t s_timer;
+static light_strip_set_cb_t s_light_cb;
+
+/* With s_lock held */
+static void arm(int64_t now_us) {
+    int64_t next = local_temp_next_us(&s_lt, now_us);
+    esp_timer_stop(s_timer);            // ESP_ERR_INVALID_STATE if it wasn't running
+    if (next >= 0) {
+        ESP_ERROR_CHECK(esp_timer_start_once(s_timer, next));
+    }
+}
+
+/* With s_lock held, so views reach the strip in order. The callback only posts. */
+static void show(const local_temp_view_t *v) {
+    s_light_cb(0, v->temp_min, v->temp_now, v->temp_max);
+}
+
+static void timer_cb(void *arg) {
+    local_temp_view_t v;
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool changed = local_temp_due(&s_lt, now, &v);
+    if (changed) {
+        show(&v);
+    }
+    arm(now);
+    xSemaphoreGive(s_lock);
+    if (changed) {
+        ESP_LOGI(TAG, "Showing min=" TEMP_C_FMT " now=" TEMP_C_FMT " max=" TEMP_C_FMT ", coalesced=%" PRIu32,
+                 TEMP_C_ARGS(v.temp_min), TEMP_C_ARGS(v.temp_now), TEMP_C_ARGS(v.temp_max),
+                 s_lt.stats.coalesced);
+    }
+}
+
+void local_temp_source_start(light_strip_set_cb_t light_cb) {
+    const esp_timer_create_args_t timer_args = {
+        .callback = timer_cb,
+        .name = "local_temp",
+    };
+
+    s_light_cb = light_cb;
+    local_temp_init(&s_lt, &s_cfg);
+    s_lock = xSemaphoreCreateMutex();
+    assert(s_lock);
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_timer));
+}
+
+void local_temp_source_forecast(int strip, int temp_min, int temp_now, int temp_max) {
+    if (strip != 0 || sizeof(CONFIG_LOCAL_TEMP_TOPIC) == 1) {
+        s_light_cb(strip, temp_min, temp_now, temp_max);
+        return;
+    }
+    const local_temp_view_t forecast = { temp_min, temp_now, temp_max };
+    local_temp_view_t v;
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    local_temp_forecast(&s_lt, &forecast, now, &v);
+    show(&v);
+    arm(now);
+    xSemaphoreGive(s_lock);
+}
+
+void local_temp_source_message(const char *data, size_t len) {
+    local_temp_view_t v;
+    int temp;
+    int64_t now = esp_timer_get_time();
+
+    if (!local_temp_parse(data, len, CONFIG_LOCAL_TEMP_JSON_KEY, &temp)) {
+        ESP_LOGW(TAG, "No temperature in %.*s", (int)len, data);
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool changed = local_temp_reading(&s_lt, temp, now, &v);
+    if (changed) {
+        show(&v);
+    }
+    arm(now);
+    xSemaphoreGive(s_lock);
+    ESP_LOGD(TAG, "Reading " TEMP_C_FMT ", %s", TEMP_C_ARGS(temp), changed ? "shown" : "held");
+}
@@ -0,0 +1,182 @@
+/**
+ * @file mqtt_cmd.c
+ * @author The Authors
+ * @brief Topic -> handler dispatch of MQTT commands, parsed in place
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include <ctype.h>
+#include "mqtt_cmd.h"
+
+static const mqtt_cmd_t *lookup(const mqtt_cmd_dispatcher_t *d, const char *topic, size_t topic_len) {
+    for (size_t i = 0; i < d->count; i++) {
+        const char *t = d->cmds[i].topic;
+        if (strlen(t) == topic_len && memcmp(t, topic, topic_len) == 0) {
+            return &d->cmds[i];
+        }
+    }
+    return NULL;
+}
+
+static void trim(const char **data, size_t *len) {
+    while (*len && isspace((unsigned char)**data)) {
+        (*data)++;
+        (*len)--;
+    }
+    while (*len && isspace((unsigned char)(*data)[*len - 1])) {
+        (*len)--;
+    }
+}
+
+static bool equals_nocase(const char *data, size_t len, const char *word) {
+    size_t n = strlen(word);
+    if (len != n) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (tolower((unsigned char)data[i]) != word[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = tolower((unsigned char)c);
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+/* Decimal up to max, advancing *data past it */
+static bool take_uint(const char **data, size_t *len, uint32_t max, uint32_t *out) {
+    uint32_t v = 0;
+    size_t digits = 0;
+    while (*len && isdigit((unsigned char)**data)) {
+        uint32_t digit = **data - '0';
+        if (digit > max || v > (max - digit) / 10) {
+            return false;
+        }
+        v = v * 10 + digit;
+        (*data)++;
+        (*len)--;
+        digits++;
+    }
+    *out = v;
+    return digits > 0;
+}
+
+void mqtt_cmd_init(mqtt_cmd_dispatcher_t *d, const mqtt_cmd_t *cmds, size_t count) {
+    memset(d, 0, sizeof(*d));
+    d->cmds = cmds;
+    d->count = count;
+}
+
+bool mqtt_cmd_feed(mqtt_cmd_dispatcher_t *d, const char *topic, size_t topic_len,
+                   const char *data, size_t data_len, size_t offset, size_t total_len) {
+    if (offset == 0) {
+        d->pending = NULL;
+        const mqtt_cmd_t *cmd = lookup(d, topic, topic_len);
+        if (!cmd) {
+            d->stats.unknown++;
+            return false;
+        }
+        if (data_len >= total_len) {
+            d->stats.dispatched++;
+            cmd->handler(data, data_len);       // whole, in place
+            return true;
+        }
+        if (total_len > sizeof(d->buf)) {
+            d->stats.oversize++;
+            return false;
+        }
+        d->pending = cmd;
+        d->total = total_len;
+        d->have = 0;
+    }
+
+    /* A fragment: the client delivers them in order, anything else restarts */
+    if (!d->pending || offset != d->have || offset + data_len > d->total) {
+        d->pending = NULL;
+        return false;
+    }
+    memcpy(d->buf + d->have, data, data_len);
+    d->have += data_len;
+    if (d->have < d->total) {
+        return false;
+    }
+
+    const mqtt_cmd_t *cmd = d->pending;
+    d->pending = NULL;
+    d->stats.dispatched++;
+    d->stats.reassembled++;
+    cmd->handler(d->buf, d->have);
+    return true;
+}
+
+bool mqtt_cmd_parse_bool(const char *data, size_t len, bool *out) {
+    trim(&data, &len);
+    if (equals_nocase(data, len, "on") || equals_nocase(data, len, "1") || equals_nocase(data, len, "true")) {
+        *out = true;
+        return true;
+    }
+    if (equals_nocase(data, len, "off") || equals_nocase(data, len, "0") || equals_nocase(data, len, "false")) {
+        *out = false;
+        return true;
+    }
+    return false;
+}
+
+bool mqtt_cmd_parse_uint(const char *data, size_t len, uint32_t max, uint32_t *out) {
+    trim(&data, &len);
+    return take_uint(&data, &len, max, out) && len == 0;
+}
+
+bool mqtt_cmd_parse_rgb(const char *data, size_t len, uint8_t *red, uint8_t *green, uint8_t *blue) {
+    uint8_t rgb[3];
+
+    trim(&data, &len);
+    if (len && *data == '#') {
+        data++;
+        len--;
+    }
+    if (len == 6 && hex_digit(data[0]) >= 0 && memchr(data, ',', len) == NULL) {
+        for (int i = 0; i < 3; i++) {
+            int hi = hex_digit(data[2 * i]);
+            int lo = hex_digit(data[2 * i + 1]);
+            if (hi < 0 || lo < 0) {
+                return false;
+            }
+            rgb[i] = hi << 4 | lo;
+        }
+    } else {
+        for (int i = 0; i < 3; i++) {
+            uint32_t v;
+            trim(&data, &len);
+            if (!take_uint(&data, &len, 255, &v)) {
+                return false;
+            }
+            rgb[i] = v;
+            trim(&data, &len);
+            if (i < 2) {
+                if (!len || *data != ',') {
+                    return false;
+                }
+                data++;
+                len--;
+            }
+        }
+        if (len) {
+            return false;
+        }
+    }
+    *red = rgb[0];
+    *green = rgb[1];
+    *blue = rgb[2];
+    return true;
+}
@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <string.h>
@@ -20,9 +22,68 @@
 #include "mqtt_handle.h"
 #include "esp_log.h"
 #include "mqtt_client.h"
+#include "forecast_history.h"
+#include "mqtt_cmd.h"
+#include "local_temp_source.h"
 
 static const char *TAG = "mqtt_handle";
 
+#define HISTORY_CMND_TOPIC  "cmnd/stairs/history"
+#define HISTORY_STAT_TOPIC  "stat/stairs/history"
+#define HISTORY_BATCH_MAX   512
+#define CMDS_MAX            12      // the application's commands plus the history query & sensor
+
+static esp_mqtt_client_handle_t s_client;
+static mqtt_connected_cb_t s_on_connected;
+static mqtt_cmd_t s_cmds[CMDS_MAX];
+static mqtt_cmd_dispatcher_t s_dispatcher;
+
+typedef struct {
+    esp_mqtt_client_handle_t client;
+    char batch[HISTORY_BATCH_MAX];
+    int len;
+} history_reply_t;
+
+static void history_flush(history_reply_t *reply) {
+    if (reply->len > 0) {
+        esp_mqtt_client_publish(reply->client, HISTORY_STAT_TOPIC, reply->batch, reply->len, 0, 0);
+        reply->len = 0;
+    }
+}
+
+/* One "dt,min,now,max" line per record, batched into HISTORY_BATCH_MAX messages */
+static bool history_visit(void *ctx, const forecast_record_t *rec) {
+    history_reply_t *reply = ctx;
+    char line[64];
+    int n = snprintf(line, sizeof(line), "%lld," TEMP_C_FMT "," TEMP_C_FMT "," TEMP_C_FMT "\n", (long long)rec->dt,
+                     TEMP_C_ARGS(rec->temp_min), TEMP_C_ARGS(rec->temp_now), TEMP_C_ARGS(rec->temp_max));
+    if (reply->len + n > HISTORY_BATCH_MAX) {
+        history_flush(reply);
+    }
+    memcpy(reply->batch + reply->len, line, n);
+    reply->len += n;
+    return true;
+}
+
+/**
+ * @brief Payload: unix time to start from, empty for everything. The records
+ *        are streamed from flash, then "end,<count>" is published.
+ */
+static void history_query(const char *data, size_t data_len) {
+    static history_reply_t reply;       // MQTT task stack is small
+    char since[24] = { 0 };
+
+    memcpy(since, data, data_len < sizeof(since) - 1 ? data_len : sizeof(since) - 1);
+    reply.client = s_client;
+    reply.len = 0;
+    size_t count = forecast_history_query(strtoll(since, NULL, 10), history_visit, &reply);
+    history_flush(&reply);
+
+    reply.len = snprintf(reply.batch, sizeof(reply.batch), "end,%u", (unsigned)count);
+    history_flush(&reply);
+    ESP_LOGI(TAG, "History since %s: %u records", since[0] ? since : "start", (unsigned)count);
+}
+
 
 static void log_error_if_nonzero(const char *message, int error_code)
 {
@@ -53,8 +114,14 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         msg_id = esp_mqtt_client_publish(client, "/topic/qos1", "online", 0, 1, 0);
         ESP_LOGI(TAG, "sent publish successful, msg_id=%d", msg_id);
 
-        msg_id = esp_mqtt_client_subscribe(client, "cmnd/stairs/power", 0);
-        ESP_LOGI(TAG, "sent subscribe successful, msg_id=%d", msg_id);
+        for (size_t i = 0; i < s_dispatcher.count; i++) {
+            msg_id = esp_mqtt_client_subscribe(client, s_dispatcher.cmds[i].topic, 0);
+            ESP_LOGI(TAG, "sent subscribe %s successful, msg_id=%d", s_dispatcher.cmds[i].topic, msg_id);
+        }
+
+        if (s_on_connected) {
+            s_on_connected();
+        }
 
         break;
     case MQTT_EVENT_DISCONNECTED:
@@ -73,9 +140,13 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         ESP_LOGI(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
         break;
     case MQTT_EVENT_DATA:
-        ESP_LOGI(TAG, "MQTT_EVENT_DATA");
-        printf("TOPIC=%.*s\r\n", event->topic_len, event->topic);
-        printf("DATA=%.*s\r\n", event->data_len, event->data);
+        ESP_LOGD(TAG, "MQTT_EVENT_DATA %.*s: %d of %d bytes at %d", event->topic_len, event->topic ? event->topic : "",
+                 event->data_len, event->total_data_len, event->current_data_offset);
+        if (!mqtt_cmd_feed(&s_dispatcher, event->topic, event->topic_len, event->data, event->data_len,
+                           event->current_data_offset, event->total_data_len) && !s_dispatcher.pending) {
+            ESP_LOGW(TAG, "Ignored a message, unknown=%" PRIu32 " oversize=%" PRIu32,
+                     s_dispatcher.stats.unknown, s_dispatcher.stats.oversize);
+        }
         break;
     case MQTT_EVENT_ERROR:
         ESP_LOGI(TAG, "MQTT_EVENT_ERROR");
@@ -92,7 +163,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     }
 }
 
-void mqtt_start(void) {
+esp_err_t mqtt_start(mqtt_connected_cb_t on_connected, const mqtt_cmd_t *cmds, size_t count) {
     esp_mqtt_client_config_t mqtt_cfg = {
         .broker.address.uri = MQTT_BROKER_URL,
         .credentials.username = MQTT_USERNAME,
@@ -102,8 +173,46 @@ void mqtt_start(void) {
         .network.disable_auto_reconnect = false,
     };
 
+    s_on_connected = on_connected;
+    size_t n = 0;
+    for (size_t i = 0; i < count && n < CMDS_MAX - 2; i++) {
+        s_cmds[n++] = cmds[i];
+    }
+    s_cmds[n++] = (mqtt_cmd_t){ HISTORY_CMND_TOPIC, history_query };
+    if (sizeof(CONFIG_LOCAL_TEMP_TOPIC) > 1) {
+        s_cmds[n++] = (mqtt_cmd_t){ CONFIG_LOCAL_TEMP_TOPIC, local_temp_source_message };
+    }
+    mqtt_cmd_init(&s_dispatcher, s_cmds, n);
+
     esp_mqtt_client_handle_t client = esp_mqtt_client_init(&mqtt_cfg);
+    if (!client) {
+        ESP_LOGE(TAG, "MQTT client not created");
+        return ESP_ERR_NO_MEM;
+    }
     /* The last argument may be used to pass data to the event handler, in this example mqtt_event_handler */
-    esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
-    esp_mqtt_client_start(client);
+    esp_err_t err = esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
+    if (err == ESP_OK) {
+        err = esp_mqtt_client_start(client);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "MQTT client not started: %s", esp_err_to_name(err));
+        esp_mqtt_client_destroy(client);
+        return err;
+    }
+    s_client = client;
+    return ESP_OK;
+}
+
+int mqtt_publish(const char *topic, const char *data, int len, int qos) {
+    if (!s_client) {
+        return -1;
+    }
+    return esp_mqtt_client_publish(s_client, topic, data, len, qos, 0);
+}
+
+int mqtt_enqueue(const char *topic, const char *data, int len, int qos) {
+    if (!s_client) {
+        return -1;
+    }
+    return esp_mqtt_client_enqueue(s_client, topic, data, len, qos, 0, true);
 }
@@ -0,0 +1,107 @@
+/**
+ * @file telemetry.c
+ * @author The Authors
+ * @brief Batched MQTT telemetry of readings & fetch pipeline timings
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <assert.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "mqtt_handle.h"
+#include "telemetry.h"
+#include "telemetry_batch.h"
+#include "trace_sys.h"
+
+#define TELEMETRY_TASK_STACK    2560
+#define TELEMETRY_TASK_PRIORITY 2       // below http_get_task and the render task
+#define TELEMETRY_QUEUE_LEN     8
+
+static const char *TAG = "telemetry";
+
+typedef struct {
+    bool render;
+    union {
+        telemetry_sample_t sample;
+        uint32_t render_us;
+    };
+} telemetry_event_t;
+
+static QueueHandle_t s_queue;
+static atomic_uint s_dropped;       // posts that found the queue full (or not there yet)
+
+static void post(const telemetry_event_t *ev) {
+    if (!s_queue || xQueueSend(s_queue, ev, 0) != pdTRUE) {
+        atomic_fetch_add(&s_dropped, 1);
+    }
+}
+
+void telemetry_fetch(const fetch_report_t *report) {
+    bool ok = report->status == 200 || report->status == 304;
+    telemetry_event_t ev = {
+        .render = false,
+        .sample = {
+            .dt = report->dt > 0 ? (uint32_t)report->dt : 0,
+            .temp_min = telemetry_temp(report->temp_min),
+            .temp_now = telemetry_temp(report->temp_now),
+            .temp_max = telemetry_temp(report->temp_max),
+            .flags = (report->status == 304 ? TELEMETRY_FLAG_NOT_MODIFIED : 0)
+                     | (ok ? 0 : TELEMETRY_FLAG_FAILED)
+                     | (report->reused ? TELEMETRY_FLAG_REUSED : 0),
+            .dns_us = report->dns_us,
+            .connect_us = report->connect_us,
+            .first_byte_us = report->first_byte_us,
+            .parse_us = report->parse_us,
+        },
+    };
+    post(&ev);
+}
+
+void telemetry_render(uint32_t render_us) {
+    telemetry_event_t ev = {
+        .render = true,
+        .render_us = render_us,
+    };
+    post(&ev);
+}
+
+static void telemetry_task(void *pvParameters) {
+    static telemetry_batch_t batch;
+    static uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+    telemetry_event_t ev;
+
+    telemetry_batch_init(&batch, CONFIG_TELEMETRY_BATCH);
+    while (1) {
+        xQueueReceive(s_queue, &ev, portMAX_DELAY);
+        bool full = ev.render ? telemetry_batch_render(&batch, ev.render_us) : telemetry_batch_fetch(&batch, &ev.sample);
+        if (!full) {
+            continue;
+        }
+
+        batch.dropped += atomic_exchange(&s_dropped, 0);
+        uint16_t seq = batch.seq;
+        size_t len = telemetry_batch_encode(&batch, payload, sizeof(payload));
+        int msg_id = mqtt_enqueue(TELEMETRY_TOPIC, (const char *)payload, len, CONFIG_TELEMETRY_QOS);
+        if (msg_id < 0) {
+            ESP_LOGW(TAG, "Payload %u (%u bytes) not queued", seq, (unsigned)len);
+        } else {
+            ESP_LOGI(TAG, "Payload %u (%u bytes) queued, msg_id=%d, dropped=%" PRIu32, seq, (unsigned)len, msg_id, batch.dropped);
+        }
+    }
+}
+
+void telemetry_init(void) {
+    s_queue = xQueueCreate(TELEMETRY_QUEUE_LEN, sizeof(telemetry_event_t));
+    assert(s_queue);
+    TaskHandle_t task;
+    xTaskCreate(&telemetry_task, "telemetry_task", TELEMETRY_TASK_STACK, NULL, TELEMETRY_TASK_PRIORITY, &task);
+    trace_watch_task(task);
+}
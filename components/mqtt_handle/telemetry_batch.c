@@ -0,0 +1,128 @@
+/**
+ * @file telemetry_batch.c
+ * @author The Authors
+ * @brief Fetch cycle samples, batched into one fixed-layout MQTT payload
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include "telemetry_batch.h"
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return p[0] | p[1] << 8;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* Move the open sample into the batch */
+static bool close_open(telemetry_batch_t *tb) {
+    if (!tb->has_open) {
+        return tb->count >= tb->batch;
+    }
+    tb->has_open = false;
+    if (tb->count == TELEMETRY_BATCH_MAX) {
+        tb->dropped++;          // the last batch was never taken
+        return true;
+    }
+    tb->samples[tb->count++] = tb->open;
+    return tb->count >= tb->batch;
+}
+
+void telemetry_batch_init(telemetry_batch_t *tb, size_t batch) {
+    memset(tb, 0, sizeof(*tb));
+    tb->batch = batch < 1 ? 1 : batch > TELEMETRY_BATCH_MAX ? TELEMETRY_BATCH_MAX : batch;
+}
+
+bool telemetry_batch_fetch(telemetry_batch_t *tb, const telemetry_sample_t *sample) {
+    bool full = close_open(tb);
+    tb->open = *sample;
+    tb->open.flags &= ~TELEMETRY_FLAG_RENDERED;
+    tb->open.render_us = 0;
+    tb->has_open = true;
+    return full;
+}
+
+bool telemetry_batch_render(telemetry_batch_t *tb, uint32_t render_us) {
+    if (!tb->has_open) {
+        return false;           // e.g. the last known reading at boot, before any fetch
+    }
+    tb->open.render_us = render_us;
+    tb->open.flags |= TELEMETRY_FLAG_RENDERED;
+    return close_open(tb);
+}
+
+size_t telemetry_batch_encode(telemetry_batch_t *tb, uint8_t *buf, size_t len) {
+    size_t need = TELEMETRY_HEADER_LEN + tb->count * TELEMETRY_SAMPLE_LEN;
+    if (tb->count == 0 || len < need) {
+        return 0;
+    }
+
+    buf[0] = TELEMETRY_VERSION;
+    buf[1] = tb->count;
+    put_u16(buf + 2, tb->seq++);
+    put_u32(buf + 4, tb->dropped);
+
+    uint8_t *p = buf + TELEMETRY_HEADER_LEN;
+    for (size_t i = 0; i < tb->count; i++, p += TELEMETRY_SAMPLE_LEN) {
+        const telemetry_sample_t *s = &tb->samples[i];
+        put_u32(p, s->dt);
+        p[4] = (uint8_t)s->temp_min;
+        p[5] = (uint8_t)s->temp_now;
+        p[6] = (uint8_t)s->temp_max;
+        p[7] = s->flags;
+        put_u32(p + 8, s->dns_us);
+        put_u32(p + 12, s->connect_us);
+        put_u32(p + 16, s->first_byte_us);
+        put_u32(p + 20, s->parse_us);
+        put_u32(p + 24, s->render_us);
+    }
+    tb->count = 0;
+    return need;
+}
+
+int telemetry_decode(const uint8_t *buf, size_t len, telemetry_header_t *header, telemetry_sample_t *samples, size_t max) {
+    if (len < TELEMETRY_HEADER_LEN || buf[0] != TELEMETRY_VERSION) {
+        return -1;
+    }
+    header->version = buf[0];
+    header->count = buf[1];
+    header->seq = get_u16(buf + 2);
+    header->dropped = get_u32(buf + 4);
+    if (len != TELEMETRY_HEADER_LEN + (size_t)header->count * TELEMETRY_SAMPLE_LEN) {
+        return -1;
+    }
+
+    const uint8_t *p = buf + TELEMETRY_HEADER_LEN;
+    size_t n = header->count < max ? header->count : max;
+    for (size_t i = 0; i < n; i++, p += TELEMETRY_SAMPLE_LEN) {
+        telemetry_sample_t *s = &samples[i];
+        s->dt = get_u32(p);
+        s->temp_min = (int8_t)p[4];
+        s->temp_now = (int8_t)p[5];
+        s->temp_max = (int8_t)p[6];
+        s->flags = p[7];
+        s->dns_us = get_u32(p + 8);
+        s->connect_us = get_u32(p + 12);
+        s->first_byte_us = get_u32(p + 16);
+        s->parse_us = get_u32(p + 20);
+        s->render_us = get_u32(p + 24);
+    }
+    return (int)n;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file test_power_acct.c
+ * @author The Authors
+ * @brief Host test for the awake time accounting & current estimate
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "power_acct.h"
+
+#define MS(ms)      ((int64_t)(ms) * 1000)
+
+static const power_model_t s_model = {
+    .sleep_ua = 1000,
+    .awake_ua = 20000,
+    .subsys_ua = {
+        [POWER_FETCH] = 60000,
+        [POWER_RENDER] = 8000,
+    },
+};
+
+static void test_overlap_counts_once(void) {
+    power_acct_t acct;
+    power_summary_t sum;
+
+    power_acct_init(&acct, MS(1000));
+
+    /* Fetch 0..400, a render 300..1300 starts before it ends */
+    power_acct_begin(&acct, POWER_FETCH, MS(1000));
+    power_acct_begin(&acct, POWER_RENDER, MS(1300));
+    power_acct_end(&acct, POWER_FETCH, MS(1400));
+    power_acct_end(&acct, POWER_RENDER, MS(2300));
+
+    power_acct_summary(&acct, &s_model, MS(11000), &sum);
+    TEST_ASSERT_EQUAL_INT64(MS(10000), sum.elapsed_us);
+    TEST_ASSERT_EQUAL_INT64(MS(1300), sum.awake_us);
+    TEST_ASSERT_EQUAL_INT64(MS(400), sum.busy_us[POWER_FETCH]);
+    TEST_ASSERT_EQUAL_INT64(MS(1000), sum.busy_us[POWER_RENDER]);
+    TEST_ASSERT_EQUAL(130, sum.duty_permille);
+
+    /* (1.3 s * 20 mA + 8.7 s * 1 mA + 0.4 s * 60 mA + 1 s * 8 mA) / 10 s */
+    TEST_ASSERT_EQUAL(6670, sum.est_ua);
+    /* (10 s * 20 mA + 0.4 s * 60 mA + 1 s * 8 mA) / 10 s */
+    TEST_ASSERT_EQUAL(23200, sum.est_always_awake_ua);
+}
+
+static void test_nesting_and_open_spans(void) {
+    power_acct_t acct;
+    power_summary_t sum;
+
+    power_acct_init(&acct, 0);
+    power_acct_end(&acct, POWER_RENDER, MS(10));       // unmatched, ignored
+
+    power_acct_begin(&acct, POWER_FETCH, MS(100));
+    power_acct_begin(&acct, POWER_FETCH, MS(150));     // nested: still one span
+    power_acct_end(&acct, POWER_FETCH, MS(200));
+    power_acct_summary(&acct, &s_model, MS(300), &sum);
+    TEST_ASSERT_EQUAL(1, sum.spans[POWER_FETCH]);
+    TEST_ASSERT_EQUAL_INT64(MS(200), sum.busy_us[POWER_FETCH]);   // open span counted to now
+    TEST_ASSERT_EQUAL_INT64(MS(200), sum.awake_us);
+
+    power_acct_end(&acct, POWER_FETCH, MS(400));
+    power_acct_summary(&acct, &s_model, MS(1000), &sum);
+    TEST_ASSERT_EQUAL_INT64(MS(300), sum.busy_us[POWER_FETCH]);
+    TEST_ASSERT_EQUAL_INT64(MS(300), sum.awake_us);
+    TEST_ASSERT_EQUAL_INT64(0, sum.busy_us[POWER_RENDER]);
+}
+
+/* A day of the scheduled fetches: about one an hour plus the animation after it */
+static void test_day_duty_cycle(void) {
+    power_acct_t acct;
+    power_summary_t sum;
+    int64_t t = 0;
+
+    power_acct_init(&acct, t);
+    for (int hour = 0; hour < 24; hour++) {
+        power_acct_begin(&acct, POWER_FETCH, t);
+        power_acct_end(&acct, POWER_FETCH, t + MS(1500));
+        power_acct_begin(&acct, POWER_RENDER, t + MS(1500));
+        power_acct_end(&acct, POWER_RENDER, t + MS(1500 + 10000));
+        t += MS(3600 * 1000);
+    }
+    power_acct_summary(&acct, &s_model, t, &sum);
+    printf("POWER day: awake=%lld ms duty=%u.%u%% est=%u uA always awake=%u uA\n",
+           (long long)(sum.awake_us / 1000), sum.duty_permille / 10, sum.duty_permille % 10,
+           (unsigned)sum.est_ua, (unsigned)sum.est_always_awake_ua);
+    TEST_ASSERT_EQUAL(24, sum.spans[POWER_FETCH]);
+    TEST_ASSERT_LESS_OR_EQUAL(4, sum.duty_permille);
+    TEST_ASSERT_LESS_THAN(sum.est_always_awake_ua / 10, sum.est_ua);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_overlap_counts_once);
+    RUN_TEST(test_nesting_and_open_spans);
+    RUN_TEST(test_day_duty_cycle);
+    exit(UNITY_END());
+}
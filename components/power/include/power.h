@@ -0,0 +1,64 @@
+/**
+ * @file power.h
+ * @author The Authors
+ * @brief Low-power mode: light sleep unless a subsystem holds the chip awake
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "power_acct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Configure DFS & automatic light sleep (with CONFIG_POWER_SAVE) and
+ *        start the awake time accounting. Call before anything uses
+ *        power_begin().
+ *
+ * @return esp_err_t
+ */
+esp_err_t power_init(void);
+
+/**
+ * @brief Put Wi-Fi in modem sleep, so the chip can light sleep between
+ *        DTIM beacons. Call once Wi-Fi is started.
+ */
+void power_wifi_sleep(void);
+
+/**
+ * @brief Hold the chip awake at full speed for a subsystem. Calls nest and
+ *        may come from any task.
+ *
+ * @param subsys
+ */
+void power_begin(power_subsys_t subsys);
+
+/**
+ * @brief Release what power_begin() took
+ *
+ * @param subsys
+ */
+void power_end(power_subsys_t subsys);
+
+/**
+ * @brief Awake time per subsystem, duty cycle & estimated current since boot,
+ *        as JSON
+ *
+ * @param buf
+ * @param len
+ * @return int  as snprintf()
+ */
+int power_report(char *buf, size_t len);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file power_acct.h
+ * @author The Authors
+ * @brief Awake time per subsystem, duty cycle & an estimate of average current
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Subsystems overlap (a render can run during a fetch), so besides each
+ * subsystem's own busy time the union of them is kept: that's the time the
+ * chip had to stay awake. Times are passed in, for the host test.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    POWER_FETCH = 0,            // Wi-Fi up & HTTP fetch
+    POWER_RENDER,               // animation, RMT channel live
+    POWER_SUBSYS_COUNT,
+} power_subsys_t;
+
+/* Current draw to estimate from, in uA */
+typedef struct {
+    uint32_t sleep_ua;                          // light sleep, Wi-Fi in modem sleep
+    uint32_t awake_ua;                          // CPU running, nothing else
+    uint32_t subsys_ua[POWER_SUBSYS_COUNT];     // on top of awake_ua while busy
+} power_model_t;
+
+typedef struct {
+    int64_t start_us;
+    int64_t busy_us[POWER_SUBSYS_COUNT];
+    int64_t busy_since_us[POWER_SUBSYS_COUNT];
+    uint16_t depth[POWER_SUBSYS_COUNT];         // begin/end nest
+    uint32_t spans[POWER_SUBSYS_COUNT];
+    int64_t awake_us;                           // union of all subsystems
+    int64_t awake_since_us;
+    uint8_t busy;                               // subsystems currently busy
+} power_acct_t;
+
+typedef struct {
+    int64_t elapsed_us;
+    int64_t awake_us;
+    int64_t busy_us[POWER_SUBSYS_COUNT];
+    uint32_t spans[POWER_SUBSYS_COUNT];
+    uint16_t duty_permille;                     // awake / elapsed
+    uint32_t est_ua;                            // average, sleeping between spans
+    uint32_t est_always_awake_ua;               // the same work with no sleep at all
+} power_summary_t;
+
+/**
+ * @brief Start counting from now
+ *
+ * @param acct
+ * @param now_us
+ */
+void power_acct_init(power_acct_t *acct, int64_t now_us);
+
+/**
+ * @brief A subsystem needs the chip awake. Calls nest.
+ *
+ * @param acct
+ * @param subsys
+ * @param now_us
+ */
+void power_acct_begin(power_acct_t *acct, power_subsys_t subsys, int64_t now_us);
+
+/**
+ * @brief Matching end for power_acct_begin(), unmatched ones are ignored
+ *
+ * @param acct
+ * @param subsys
+ * @param now_us
+ */
+void power_acct_end(power_acct_t *acct, power_subsys_t subsys, int64_t now_us);
+
+/**
+ * @brief Totals up to now, open spans included
+ *
+ * @param acct
+ * @param model
+ * @param now_us
+ * @param out
+ */
+void power_acct_summary(const power_acct_t *acct, const power_model_t *model, int64_t now_us, power_summary_t *out);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
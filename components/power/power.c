@@ -0,0 +1,115 @@
+/**
+ * @file power.c
+ * @author The Authors
+ * @brief Low-power mode: light sleep unless a subsystem holds the chip awake
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Each subsystem has its own ESP_PM_CPU_FREQ_MAX lock, held only while it
+ * works; with none held the idle task drops into light sleep and Wi-Fi keeps
+ * the association alive in modem sleep. Without CONFIG_POWER_SAVE the locks
+ * can't be created (PM is off) but the accounting still runs, so the same
+ * report gives the "before" numbers.
+ */
+#include <stdio.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "sdkconfig.h"
+#include "power.h"
+
+static const char *TAG = "power";
+
+static const char *const s_subsys_names[POWER_SUBSYS_COUNT] = {
+    [POWER_FETCH] = "fetch",
+    [POWER_RENDER] = "render",
+};
+
+static const power_model_t s_model = {
+    .sleep_ua = CONFIG_POWER_EST_SLEEP_UA,
+    .awake_ua = CONFIG_POWER_EST_AWAKE_UA,
+    .subsys_ua = {
+        [POWER_FETCH] = CONFIG_POWER_EST_FETCH_UA,
+        [POWER_RENDER] = CONFIG_POWER_EST_RENDER_UA,
+    },
+};
+
+static esp_pm_lock_handle_t s_locks[POWER_SUBSYS_COUNT];
+static bool s_sleeping;                 // light sleep configured
+static power_acct_t s_acct;
+static portMUX_TYPE s_acct_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t power_init(void) {
+    power_acct_init(&s_acct, esp_timer_get_time());
+
+#if CONFIG_POWER_SAVE
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_POWER_MAX_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_POWER_MIN_CPU_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK) {
+        return err;
+    }
+    for (int i = 0; i < POWER_SUBSYS_COUNT; i++) {
+        err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, s_subsys_names[i], &s_locks[i]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    s_sleeping = true;
+    ESP_LOGI(TAG, "Light sleep between fetches, %d-%d MHz", CONFIG_POWER_MIN_CPU_FREQ_MHZ, CONFIG_POWER_MAX_CPU_FREQ_MHZ);
+#endif
+    return ESP_OK;
+}
+
+void power_wifi_sleep(void) {
+#if CONFIG_POWER_SAVE
+    ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_MIN_MODEM));
+#endif
+}
+
+void power_begin(power_subsys_t subsys) {
+    if (s_locks[subsys]) {
+        esp_pm_lock_acquire(s_locks[subsys]);
+    }
+    taskENTER_CRITICAL(&s_acct_lock);
+    power_acct_begin(&s_acct, subsys, esp_timer_get_time());
+    taskEXIT_CRITICAL(&s_acct_lock);
+}
+
+void power_end(power_subsys_t subsys) {
+    taskENTER_CRITICAL(&s_acct_lock);
+    power_acct_end(&s_acct, subsys, esp_timer_get_time());
+    taskEXIT_CRITICAL(&s_acct_lock);
+    if (s_locks[subsys]) {
+        esp_pm_lock_release(s_locks[subsys]);
+    }
+}
+
+int power_report(char *buf, size_t len) {
+    power_summary_t sum;
+
+    taskENTER_CRITICAL(&s_acct_lock);
+    power_acct_summary(&s_acct, &s_model, esp_timer_get_time(), &sum);
+    taskEXIT_CRITICAL(&s_acct_lock);
+
+    /* Never asleep without PM, whatever the subsystems were doing */
+    uint32_t duty = s_sleeping ? sum.duty_permille : 1000;
+    uint32_t est_ua = s_sleeping ? sum.est_ua : sum.est_always_awake_ua;
+
+    return snprintf(buf, len,
+                    "{\"sleep\":%s,\"uptime_s\":%lld,\"duty_permille\":%" PRIu32 ","
+                    "\"fetch_ms\":%lld,\"fetches\":%" PRIu32 ",\"render_ms\":%lld,\"renders\":%" PRIu32 ","
+                    "\"est_ua\":%" PRIu32 ",\"always_awake_ua\":%" PRIu32 "}",
+                    s_sleeping ? "true" : "false", (long long)(sum.elapsed_us / 1000000), duty,
+                    (long long)(sum.busy_us[POWER_FETCH] / 1000), sum.spans[POWER_FETCH],
+                    (long long)(sum.busy_us[POWER_RENDER] / 1000), sum.spans[POWER_RENDER],
+                    est_ua, sum.est_always_awake_ua);
+}
@@ -0,0 +1,59 @@
+/**
+ * @file power_acct.c
+ * @author The Authors
+ * @brief Awake time per subsystem, duty cycle & an estimate of average current
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include "power_acct.h"
+
+void power_acct_init(power_acct_t *acct, int64_t now_us) {
+    memset(acct, 0, sizeof(*acct));
+    acct->start_us = now_us;
+}
+
+void power_acct_begin(power_acct_t *acct, power_subsys_t subsys, int64_t now_us) {
+    if (acct->depth[subsys]++ > 0) {
+        return;
+    }
+    acct->busy_since_us[subsys] = now_us;
+    acct->spans[subsys]++;
+    if (acct->busy++ == 0) {
+        acct->awake_since_us = now_us;
+    }
+}
+
+void power_acct_end(power_acct_t *acct, power_subsys_t subsys, int64_t now_us) {
+    if (acct->depth[subsys] == 0 || --acct->depth[subsys] > 0) {
+        return;
+    }
+    acct->busy_us[subsys] += now_us - acct->busy_since_us[subsys];
+    if (--acct->busy == 0) {
+        acct->awake_us += now_us - acct->awake_since_us;
+    }
+}
+
+void power_acct_summary(const power_acct_t *acct, const power_model_t *model, int64_t now_us, power_summary_t *out) {
+    int64_t subsys_charge = 0;      // uA * us
+
+    memset(out, 0, sizeof(*out));
+    out->elapsed_us = now_us - acct->start_us;
+    out->awake_us = acct->awake_us + (acct->busy ? now_us - acct->awake_since_us : 0);
+    for (int i = 0; i < POWER_SUBSYS_COUNT; i++) {
+        out->busy_us[i] = acct->busy_us[i] + (acct->depth[i] ? now_us - acct->busy_since_us[i] : 0);
+        out->spans[i] = acct->spans[i];
+        subsys_charge += out->busy_us[i] * model->subsys_ua[i];
+    }
+    if (out->elapsed_us <= 0) {
+        return;
+    }
+
+    int64_t asleep_us = out->elapsed_us - out->awake_us;
+    out->duty_permille = (uint16_t)(out->awake_us * 1000 / out->elapsed_us);
+    out->est_ua = (uint32_t)((out->awake_us * model->awake_ua + asleep_us * model->sleep_ua + subsys_charge) / out->elapsed_us);
+    out->est_always_awake_ua = (uint32_t)((out->elapsed_us * model->awake_ua + subsys_charge) / out->elapsed_us);
+}
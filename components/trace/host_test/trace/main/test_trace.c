@@ -0,0 +1,188 @@
+/**
+ * @file test_trace.c
+ * @author The Authors
+ * @brief Host test for the trace ring, totals and report
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * On the host trace_now() counts nanoseconds. The racing writers backdate
+ * their start by an amount tied to the span they record, so a record mixed
+ * from two writes shows up as a span/duration mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "unity.h"
+#include "trace.h"
+
+#define WRITERS         4
+#define WRITES          200000
+#define BACKDATE        100000000u      // ns per span id, well over any real span here
+#define MS_CYCLES       (1000 * TRACE_CYCLES_PER_US)
+
+static void test_ring_order(void) {
+    trace_rec_t recs[TRACE_RING_LEN];
+    trace_agg_t agg;
+
+    trace_reset();
+    TEST_ASSERT_EQUAL(0, trace_recent(recs, TRACE_RING_LEN));
+    for (int i = 0; i < 100; i++) {
+        trace_end(i % TRACE_SPAN_COUNT, trace_now() - i * MS_CYCLES);     // i ms
+    }
+    TEST_ASSERT_EQUAL(TRACE_RING_LEN, trace_recent(recs, TRACE_RING_LEN));
+    for (int i = 0; i < TRACE_RING_LEN; i++) {
+        int n = 100 - TRACE_RING_LEN + i;
+        TEST_ASSERT_EQUAL(n % TRACE_SPAN_COUNT, recs[i].span);
+        TEST_ASSERT_EQUAL(n, recs[i].cycles / MS_CYCLES);
+    }
+
+    /* The newest few */
+    TEST_ASSERT_EQUAL(3, trace_recent(recs, 3));
+    TEST_ASSERT_EQUAL(97, recs[0].cycles / MS_CYCLES);
+    TEST_ASSERT_EQUAL(99, recs[2].cycles / MS_CYCLES);
+
+    trace_aggregate(TRACE_DNS, &agg);
+    TEST_ASSERT_EQUAL(17, agg.count);                                // 0, 6, ... 96
+    TEST_ASSERT_EQUAL(96, agg.max_cycles / MS_CYCLES);
+    TEST_ASSERT_EQUAL(16 * 17 / 2 * 6, (uint32_t)(agg.total_cycles / MS_CYCLES));
+}
+
+/* The total carries past 32 bits */
+static void test_total_wraps(void) {
+    trace_agg_t agg;
+
+    trace_reset();
+    for (int i = 0; i < 3; i++) {
+        trace_record(TRACE_RENDER, 0xf0000000u);
+    }
+    trace_aggregate(TRACE_RENDER, &agg);
+    TEST_ASSERT_EQUAL(3, agg.count);
+    TEST_ASSERT_TRUE(agg.total_cycles == 3 * (uint64_t)0xf0000000u);
+}
+
+static void test_counters_and_format(void) {
+    char buf[2048];
+    char want[64];
+    trace_agg_t agg;
+    trace_rec_t recs[2];
+
+    trace_reset();
+    trace_count(TRACE_CTR_FETCHES, 1);
+    trace_count(TRACE_CTR_RX_BYTES, 1500);
+    trace_count(TRACE_CTR_RX_BYTES, 36);
+    trace_end(TRACE_CONNECT, trace_now() - 87 * MS_CYCLES);
+    trace_end(TRACE_PARSE, trace_now() - 900 * TRACE_CYCLES_PER_US);
+    TEST_ASSERT_EQUAL(1536, trace_counter(TRACE_CTR_RX_BYTES));
+
+    size_t n = trace_format(buf, sizeof(buf), 8);
+    printf("%s", buf);
+    TEST_ASSERT_EQUAL(strlen(buf), n);
+    trace_aggregate(TRACE_CONNECT, &agg);
+    TEST_ASSERT_EQUAL(87, agg.max_cycles / MS_CYCLES);
+    snprintf(want, sizeof(want), "connect n=1 avg=%" PRIu32 "us max=%" PRIu32 "us\n",
+             agg.max_cycles / TRACE_CYCLES_PER_US, agg.max_cycles / TRACE_CYCLES_PER_US);
+    TEST_ASSERT_NOT_NULL(strstr(buf, want));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "dns n=0 avg=0us max=0us\n"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "fetches=1 rx_bytes=1536 reconnects=0 dns_heap=0\n"));
+
+    /* Recent, oldest first */
+    TEST_ASSERT_EQUAL(2, trace_recent(recs, 2));
+    snprintf(want, sizeof(want), "@%" PRIu32 "ms connect %" PRIu32 "us\n", recs[0].end_ms, recs[0].cycles / TRACE_CYCLES_PER_US);
+    char *connect = strstr(buf, want);
+    snprintf(want, sizeof(want), "@%" PRIu32 "ms parse %" PRIu32 "us\n", recs[1].end_ms, recs[1].cycles / TRACE_CYCLES_PER_US);
+    char *parse = strstr(buf, want);
+    TEST_ASSERT_TRUE(connect && parse && connect < parse);
+
+    /* Truncated to fit, still terminated */
+    n = trace_format(buf, 40, 8);
+    TEST_ASSERT_EQUAL(39, n);
+    TEST_ASSERT_EQUAL(39, strlen(buf));
+    TEST_ASSERT_EQUAL(0, trace_format(buf, 1, 8));
+    TEST_ASSERT_EQUAL('\0', buf[0]);
+}
+
+static atomic_int s_writing;      // writers still going
+
+static void *writer(void *arg) {
+    int span = (int)(intptr_t)arg;
+    for (int i = 0; i < WRITES; i++) {
+        trace_end(span, trace_now() - (span + 1) * BACKDATE);
+    }
+    atomic_fetch_sub(&s_writing, 1);
+    return NULL;
+}
+
+static void test_racing_writers(void) {
+    pthread_t threads[WRITERS];
+    trace_rec_t recs[TRACE_RING_LEN];
+    trace_agg_t agg;
+    uint64_t last_total = 0;
+    uint32_t reads = 0, copied = 0;
+
+    trace_reset();
+    atomic_store(&s_writing, WRITERS);
+    for (int i = 0; i < WRITERS; i++) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, writer, (void *)(intptr_t)i));
+    }
+    /* Read while they write: whatever comes out must be whole records */
+    while (atomic_load(&s_writing) > 0) {
+        size_t n = trace_recent(recs, TRACE_RING_LEN);
+        for (size_t i = 0; i < n; i++) {
+            TEST_ASSERT_TRUE(recs[i].span < WRITERS);
+            TEST_ASSERT_EQUAL(recs[i].span + 1, recs[i].cycles / BACKDATE);
+        }
+        /* The last writer's total wraps 32 bits every ten or so spans: a read
+         * catching half a carry would go back by 2^32 */
+        trace_aggregate(WRITERS - 1, &agg);
+        TEST_ASSERT_TRUE(agg.total_cycles >= last_total);
+        last_total = agg.total_cycles;
+        reads++;
+        copied += n;
+    }
+    for (int i = 0; i < WRITERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    uint32_t total = 0;
+    for (int i = 0; i < WRITERS; i++) {
+        trace_aggregate(i, &agg);
+        TEST_ASSERT_EQUAL(WRITES, agg.count);
+        TEST_ASSERT_EQUAL(i + 1, agg.max_cycles / BACKDATE);
+        TEST_ASSERT_EQUAL(i + 1, (uint32_t)(agg.total_cycles / WRITES / BACKDATE));
+        total += agg.count;
+    }
+    TEST_ASSERT_EQUAL(WRITERS * WRITES, total);
+    TEST_ASSERT_EQUAL(TRACE_RING_LEN, trace_recent(recs, TRACE_RING_LEN));     // quiet again: all whole
+    printf("TRACE reads=%" PRIu32 " records copied=%" PRIu32 " while %d writers recorded %d spans\n",
+           reads, copied, WRITERS, WRITERS * WRITES);
+}
+
+/* What a span costs, to be sure it can stay on */
+static void test_overhead(void) {
+    const int spans = 1000000;
+
+    trace_reset();
+    uint32_t start = trace_now();
+    for (int i = 0; i < spans; i++) {
+        trace_end(TRACE_PARSE, trace_now());
+    }
+    uint32_t elapsed = trace_now() - start;
+    printf("TRACE %" PRIu32 " ns per span (begin + end)\n", elapsed / spans);
+    TEST_ASSERT_LESS_THAN(1000, elapsed / spans);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_order);
+    RUN_TEST(test_total_wraps);
+    RUN_TEST(test_counters_and_format);
+    RUN_TEST(test_racing_writers);
+    RUN_TEST(test_overhead);
+    exit(UNITY_END());
+}
@@ -0,0 +1,181 @@
+/**
+ * @file trace.h
+ * @author The Authors
+ * @brief Span timers, counters & a ring of recent spans for the hot paths
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ *     uint32_t t = trace_now();
+ *     ...
+ *     trace_end(TRACE_CONNECT, t);
+ *
+ * Spans are timed in CPU cycles. The fetch and render paths hold a power
+ * lock at the top CPU frequency, so cycles convert to microseconds at that
+ * frequency. A span is at most 2^32 cycles, about 26 s at 160 MHz.
+ *
+ * Recording is lock-free: an atomic slot index into the ring, each slot
+ * claimed by compare-and-swap and its sequence number written last, so a
+ * reader (trace_recent()) skips a slot that is being overwritten instead of
+ * waiting on it. Per span totals and the counters are 32-bit atomic adds,
+ * the totals carrying into a second word.
+ *
+ * With CONFIG_TRACE_ENABLE off, trace_end() & trace_count() compile to
+ * nothing.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#include "esp_system.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_RING_LEN  64
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TRACE_CYCLES_PER_US     1000                // nanoseconds stand in for cycles
+#elif CONFIG_POWER_SAVE
+#define TRACE_CYCLES_PER_US     CONFIG_POWER_MAX_CPU_FREQ_MHZ
+#else
+#define TRACE_CYCLES_PER_US     CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#endif
+
+typedef enum {
+    TRACE_DNS = 0,
+    TRACE_CONNECT,
+    TRACE_SEND,
+    TRACE_RECV,                 // request sent to response done, PARSE runs inside it
+    TRACE_PARSE,                // one response, summed over the body chunks
+    TRACE_RENDER,               // one animation of one strip, all its frames composed & sent
+    TRACE_SPAN_COUNT,
+} trace_span_t;
+
+typedef enum {
+    TRACE_CTR_FETCHES = 0,
+    TRACE_CTR_RX_BYTES,
+    TRACE_CTR_RECONNECTS,       // kept-alive connections found dead
+    TRACE_CTR_DNS_HEAP,         // bytes getaddrinfo() held until freeaddrinfo(), summed
+    TRACE_CTR_COUNT,
+} trace_counter_t;
+
+typedef struct {
+    uint32_t end_ms;            // esp_timer time at the end
+    uint32_t cycles;
+    trace_span_t span;
+} trace_rec_t;
+
+typedef struct {
+    uint32_t count;
+    uint64_t total_cycles;
+    uint32_t max_cycles;
+} trace_agg_t;
+
+static inline uint32_t trace_now(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+/* For heap use across a call, 0 on the host */
+static inline uint32_t trace_heap_free(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return 0;
+#else
+    return esp_get_free_heap_size();
+#endif
+}
+
+#if CONFIG_TRACE_ENABLE
+
+/**
+ * @brief Record a span that started at start (a trace_now() value)
+ *
+ * @param span
+ * @param start
+ */
+void trace_end(trace_span_t span, uint32_t start);
+
+/**
+ * @brief Record a span timed some other way, e.g. summed over several calls
+ *
+ * @param span
+ * @param cycles
+ */
+void trace_record(trace_span_t span, uint32_t cycles);
+
+/**
+ * @brief Add to a counter
+ *
+ * @param ctr
+ * @param n
+ */
+void trace_count(trace_counter_t ctr, uint32_t n);
+
+#else
+
+static inline void trace_end(trace_span_t span, uint32_t start) {
+    (void)span;
+    (void)start;
+}
+
+static inline void trace_record(trace_span_t span, uint32_t cycles) {
+    (void)span;
+    (void)cycles;
+}
+
+static inline void trace_count(trace_counter_t ctr, uint32_t n) {
+    (void)ctr;
+    (void)n;
+}
+
+#endif
+
+/**
+ * @brief Copy out the most recent spans, oldest first. Slots being written
+ *        meanwhile are left out.
+ *
+ * @return how many were copied, up to max and TRACE_RING_LEN
+ */
+size_t trace_recent(trace_rec_t *out, size_t max);
+
+/**
+ * @brief Totals of one span since boot
+ */
+void trace_aggregate(trace_span_t span, trace_agg_t *out);
+
+uint32_t trace_counter(trace_counter_t ctr);
+
+const char *trace_span_name(trace_span_t span);
+
+/**
+ * @brief Text report: per span count/avg/max, the counters, then the last
+ *        `recent` spans, one per line
+ *
+ * @return length written, at most len - 1
+ */
+size_t trace_format(char *buf, size_t len, size_t recent);
+
+/**
+ * @brief Forget everything, for the host test
+ */
+void trace_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+/**
+ * @file trace_sys.h
+ * @author The Authors
+ * @brief Task stack & heap low-water gauges alongside the trace report
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "trace.h"
+
+#define TRACE_TASKS_MAX     8
+
+/**
+ * @brief Report the stack high-water mark of a task that lives for good.
+ *        Watching one twice is harmless.
+ *
+ * @param task  NULL for the calling task
+ */
+void trace_watch_task(TaskHandle_t task);
+
+/**
+ * @brief trace_format() preceded by the heap and the watched tasks' stacks
+ *
+ * @return length written, at most len - 1
+ */
+size_t trace_report(char *buf, size_t len, size_t recent);
@@ -0,0 +1,224 @@
+/**
+ * @file trace.c
+ * @author The Authors
+ * @brief Span timers, counters & a ring of recent spans for the hot paths
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include "esp_timer.h"
+#include "trace.h"
+
+#define SLOT_BUSY   UINT32_MAX
+
+typedef struct {
+    atomic_uint seq;            // index + 1 once written, SLOT_BUSY while being written
+    atomic_uint end_ms;
+    atomic_uint cycles;
+    atomic_uint span;
+} trace_slot_t;
+
+/* The total is two 32-bit words: 64-bit atomics aren't lock-free on the
+ * 32-bit RISC-V cores (C3), they'd take libatomic's lock on every span.
+ * Only the add that wraps total_lo bumps total_hi, and it holds carrying up
+ * from before its total_lo write until after its total_hi one, so a reader
+ * can tell it caught one half without the other. */
+typedef struct {
+    atomic_uint count;
+    atomic_uint total_lo;
+    atomic_uint total_hi;       // total_lo wraps
+    atomic_uint carrying;       // adds between wrapping total_lo and bumping total_hi
+    atomic_uint max_cycles;
+} trace_totals_t;
+
+static trace_slot_t s_ring[TRACE_RING_LEN];
+static atomic_uint s_head;      // slots handed out
+static trace_totals_t s_totals[TRACE_SPAN_COUNT];
+static atomic_uint s_counters[TRACE_CTR_COUNT];
+
+static const char *const s_span_names[TRACE_SPAN_COUNT] = {
+    [TRACE_DNS]     = "dns",
+    [TRACE_CONNECT] = "connect",
+    [TRACE_SEND]    = "send",
+    [TRACE_RECV]    = "recv",
+    [TRACE_PARSE]   = "parse",
+    [TRACE_RENDER]  = "render",
+};
+
+static const char *const s_counter_names[TRACE_CTR_COUNT] = {
+    [TRACE_CTR_FETCHES]    = "fetches",
+    [TRACE_CTR_RX_BYTES]   = "rx_bytes",
+    [TRACE_CTR_RECONNECTS] = "reconnects",
+    [TRACE_CTR_DNS_HEAP]   = "dns_heap",
+};
+
+#if CONFIG_TRACE_ENABLE
+
+static void total_add(trace_totals_t *t, uint32_t cycles) {
+    unsigned lo = atomic_load_explicit(&t->total_lo, memory_order_relaxed);
+    bool carry;
+
+    do {
+        carry = lo > UINT32_MAX - cycles;
+        if (carry) {
+            atomic_fetch_add(&t->carrying, 1);
+        }
+        if (atomic_compare_exchange_weak(&t->total_lo, &lo, lo + cycles)) {
+            break;
+        }
+        if (carry) {
+            atomic_fetch_sub(&t->carrying, 1);
+        }
+    } while (1);
+    if (carry) {
+        atomic_fetch_add(&t->total_hi, 1);
+        atomic_fetch_sub(&t->carrying, 1);
+    }
+}
+
+void trace_end(trace_span_t span, uint32_t start) {
+    trace_record(span, trace_now() - start);
+}
+
+void trace_record(trace_span_t span, uint32_t cycles) {
+    unsigned idx = atomic_fetch_add_explicit(&s_head, 1, memory_order_relaxed);
+    trace_slot_t *slot = &s_ring[idx % TRACE_RING_LEN];
+    unsigned seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+
+    /* Claim the slot. A writer held up for a whole lap of the ring can find
+     * it claimed: that record is left out of the ring rather than mixed. */
+    if (seq != SLOT_BUSY && atomic_compare_exchange_strong_explicit(&slot->seq, &seq, SLOT_BUSY,
+                                                                    memory_order_relaxed, memory_order_relaxed)) {
+        atomic_thread_fence(memory_order_release);
+        atomic_store_explicit(&slot->end_ms, (uint32_t)(esp_timer_get_time() / 1000), memory_order_relaxed);
+        atomic_store_explicit(&slot->cycles, cycles, memory_order_relaxed);
+        atomic_store_explicit(&slot->span, span, memory_order_relaxed);
+        atomic_store_explicit(&slot->seq, idx + 1, memory_order_release);
+    }
+
+    trace_totals_t *t = &s_totals[span];
+    atomic_fetch_add_explicit(&t->count, 1, memory_order_relaxed);
+    total_add(t, cycles);
+    unsigned max = atomic_load_explicit(&t->max_cycles, memory_order_relaxed);
+    while (cycles > max && !atomic_compare_exchange_weak_explicit(&t->max_cycles, &max, cycles,
+                                                                 memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void trace_count(trace_counter_t ctr, uint32_t n) {
+    atomic_fetch_add_explicit(&s_counters[ctr], n, memory_order_relaxed);
+}
+
+#endif
+
+size_t trace_recent(trace_rec_t *out, size_t max) {
+    unsigned head = atomic_load_explicit(&s_head, memory_order_acquire);
+    unsigned n = head < TRACE_RING_LEN ? head : TRACE_RING_LEN;
+    n = n < max ? n : max;
+    size_t copied = 0;
+
+    for (unsigned idx = head - n; idx != head; idx++) {
+        trace_slot_t *slot = &s_ring[idx % TRACE_RING_LEN];
+        unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        trace_rec_t rec = {
+            .end_ms = atomic_load_explicit(&slot->end_ms, memory_order_relaxed),
+            .cycles = atomic_load_explicit(&slot->cycles, memory_order_relaxed),
+            .span = atomic_load_explicit(&slot->span, memory_order_relaxed),
+        };
+        atomic_thread_fence(memory_order_acquire);
+        if (seq != idx + 1 || atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq) {
+            continue;           // not written yet, or overwritten while copying
+        }
+        out[copied++] = rec;
+    }
+    return copied;
+}
+
+void trace_aggregate(trace_span_t span, trace_agg_t *out) {
+    trace_totals_t *t = &s_totals[span];
+    unsigned hi, lo;
+
+    /* Again if a wrap was half done, or finished while reading */
+    do {
+        hi = atomic_load(&t->total_hi);
+        lo = atomic_load(&t->total_lo);
+    } while (atomic_load(&t->carrying) || atomic_load(&t->total_hi) != hi);
+    out->count = atomic_load_explicit(&t->count, memory_order_relaxed);
+    out->total_cycles = (uint64_t)hi << 32 | lo;
+    out->max_cycles = atomic_load_explicit(&t->max_cycles, memory_order_relaxed);
+}
+
+uint32_t trace_counter(trace_counter_t ctr) {
+    return atomic_load_explicit(&s_counters[ctr], memory_order_relaxed);
+}
+
+const char *trace_span_name(trace_span_t span) {
+    return span < TRACE_SPAN_COUNT ? s_span_names[span] : "?";
+}
+
+/* snprintf that keeps track of the end, and stops at a full buffer */
+static void append(char *buf, size_t len, size_t *n, const char *fmt, ...) {
+    if (*n + 1 >= len) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int r = vsnprintf(buf + *n, len - *n, fmt, ap);
+    va_end(ap);
+    if (r > 0) {
+        *n += (size_t)r < len - *n ? (size_t)r : len - *n - 1;
+    }
+}
+
+size_t trace_format(char *buf, size_t len, size_t recent) {
+    static trace_rec_t recs[TRACE_RING_LEN];    // callers' stacks are small
+    size_t n = 0;
+
+    if (len == 0) {
+        return 0;
+    }
+    buf[0] = '\0';
+    for (int i = 0; i < TRACE_SPAN_COUNT; i++) {
+        trace_agg_t agg;
+        trace_aggregate(i, &agg);
+        append(buf, len, &n, "%s n=%" PRIu32 " avg=%" PRIu32 "us max=%" PRIu32 "us\n", s_span_names[i], agg.count,
+               agg.count ? (uint32_t)(agg.total_cycles / agg.count / TRACE_CYCLES_PER_US) : 0,
+               agg.max_cycles / TRACE_CYCLES_PER_US);
+    }
+    for (int i = 0; i < TRACE_CTR_COUNT; i++) {
+        append(buf, len, &n, "%s%s=%" PRIu32, i ? " " : "", s_counter_names[i], trace_counter(i));
+    }
+    append(buf, len, &n, "\n");
+
+    size_t count = trace_recent(recs, recent < TRACE_RING_LEN ? recent : TRACE_RING_LEN);
+    for (size_t i = 0; i < count; i++) {
+        append(buf, len, &n, "@%" PRIu32 "ms %s %" PRIu32 "us\n", recs[i].end_ms, trace_span_name(recs[i].span),
+               recs[i].cycles / TRACE_CYCLES_PER_US);
+    }
+    return n;
+}
+
+void trace_reset(void) {
+    for (int i = 0; i < TRACE_RING_LEN; i++) {
+        atomic_store(&s_ring[i].seq, 0);
+    }
+    atomic_store(&s_head, 0);
+    for (int i = 0; i < TRACE_SPAN_COUNT; i++) {
+        atomic_store(&s_totals[i].count, 0);
+        atomic_store(&s_totals[i].total_lo, 0);
+        atomic_store(&s_totals[i].total_hi, 0);
+        atomic_store(&s_totals[i].carrying, 0);
+        atomic_store(&s_totals[i].max_cycles, 0);
+    }
+    for (int i = 0; i < TRACE_CTR_COUNT; i++) {
+        atomic_store(&s_counters[i], 0);
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * @file trace_sys.c
+ * @author The Authors
+ * @brief Task stack & heap low-water gauges alongside the trace report
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "trace_sys.h"
+
+static const char *TAG = "trace";
+
+static TaskHandle_t s_tasks[TRACE_TASKS_MAX];
+static size_t s_task_count;
+static portMUX_TYPE s_tasks_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void trace_watch_task(TaskHandle_t task) {
+    if (!task) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+    taskENTER_CRITICAL(&s_tasks_lock);
+    bool known = false;
+    for (size_t i = 0; i < s_task_count; i++) {
+        known |= s_tasks[i] == task;
+    }
+    bool added = !known && s_task_count < TRACE_TASKS_MAX;
+    if (added) {
+        s_tasks[s_task_count++] = task;
+    }
+    taskEXIT_CRITICAL(&s_tasks_lock);
+    if (!known && !added) {
+        ESP_LOGW(TAG, "Not watching %s, %d tasks already", pcTaskGetName(task), TRACE_TASKS_MAX);
+    }
+}
+
+size_t trace_report(char *buf, size_t len, size_t recent) {
+    int n = snprintf(buf, len, "heap free=%" PRIu32 " min=%" PRIu32 " largest=%u\n", esp_get_free_heap_size(),
+                     esp_get_minimum_free_heap_size(), (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+    for (size_t i = 0; i < s_task_count && n >= 0 && (size_t)n < len; i++) {
+        /* Bytes on ESP-IDF, never less than this since the task started */
+        n += snprintf(buf + n, len - n, "stack %s free_min=%u\n", pcTaskGetName(s_tasks[i]),
+                      (unsigned)uxTaskGetStackHighWaterMark(s_tasks[i]));
+    }
+    if (n < 0) {
+        return 0;
+    }
+    if ((size_t)n >= len) {
+        return len - 1;
+    }
+    return n + trace_format(buf + n, len - n, recent);
+}
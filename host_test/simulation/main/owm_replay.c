@@ -0,0 +1,354 @@
+/**
+ * @file owm_replay.c
+ * @author The Authors
+ * @brief Loopback replay of recorded OpenWeatherMap /forecast and /group responses
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Host only, plain POSIX sockets on purpose: the server side is not the code
+ * under test.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "esp_log.h"
+#include "owm_replay.h"
+
+static const char *TAG = "owm_replay";
+
+#define FIRST_DT            1734609600LL    // 2024-12-19 12:00 UTC
+#define SLOT_SECONDS        (3 * 3600)
+#define SLOTS_PER_DAY       8
+#define CHUNK_SIZE          512
+#define SLOT_MAX            640
+#define REQUEST_MAX         1024
+#define CITY_MAX            640
+
+/* Typical winter day in 3 hour steps from midday, 1/100 degC */
+static const int s_diurnal_centi[SLOTS_PER_DAY] = { 0, -60, -180, -260, -320, -350, -220, -40 };
+
+static int slot_temp_centi(const owm_recording_t *rec, int slot) {
+    return rec->base_centi + rec->drift_centi * (slot / SLOTS_PER_DAY) + s_diurnal_centi[slot % SLOTS_PER_DAY];
+}
+
+static void format_centi(char *buf, size_t len, int centi) {
+    int mag = centi < 0 ? -centi : centi;
+    snprintf(buf, len, "%s%d.%02d", centi < 0 ? "-" : "", mag / 100, mag % 100);
+}
+
+static size_t format_slot(char *buf, size_t len, const owm_recording_t *rec, int slot) {
+    int temp = slot_temp_centi(rec, slot);
+    char t[16], feels[16], t_min[16], t_max[16], dt_txt[24];
+    time_t dt = (time_t)(FIRST_DT + (long long)slot * SLOT_SECONDS);
+    struct tm tm;
+
+    format_centi(t, sizeof(t), temp);
+    format_centi(feels, sizeof(feels), temp - 371);
+    format_centi(t_min, sizeof(t_min), temp - 40);
+    format_centi(t_max, sizeof(t_max), temp + 35);
+    gmtime_r(&dt, &tm);
+    strftime(dt_txt, sizeof(dt_txt), "%Y-%m-%d %H:%M:%S", &tm);
+
+    return snprintf(buf, len,
+                    "%s{\"dt\":%lld,\"main\":{\"temp\":%s,\"feels_like\":%s,\"temp_min\":%s,\"temp_max\":%s,"
+                    "\"pressure\":1012,\"sea_level\":1012,\"grnd_level\":1007,\"humidity\":81,\"temp_kf\":0.71},"
+                    "\"weather\":[{\"id\":500,\"main\":\"Rain\",\"description\":\"light rain\",\"icon\":\"10d\"}],"
+                    "\"clouds\":{\"all\":75},\"wind\":{\"speed\":7.2,\"deg\":250,\"gust\":12.31},\"visibility\":10000,"
+                    "\"pop\":0.41,\"rain\":{\"3h\":0.32},\"sys\":{\"pod\":\"%c\"},\"dt_txt\":\"%s\"}",
+                    slot ? "," : "", (long long)dt, t, feels, t_min, t_max,
+                    (tm.tm_hour >= 8 && tm.tm_hour < 17) ? 'd' : 'n', dt_txt);
+}
+
+static int city_temp_centi(const owm_recording_t *rec, size_t city) {
+    return rec->base_centi + rec->drift_centi * (int)city;
+}
+
+/* Ids at other depths too (sys, weather), which the client must not mistake for the city's */
+static size_t format_city(char *buf, size_t len, const owm_recording_t *rec, size_t city) {
+    int temp = city_temp_centi(rec, city);
+    char t[16], feels[16], t_min[16], t_max[16];
+
+    format_centi(t, sizeof(t), temp);
+    format_centi(feels, sizeof(feels), temp - 371);
+    format_centi(t_min, sizeof(t_min), temp - 40);
+    format_centi(t_max, sizeof(t_max), temp + 35);
+
+    return snprintf(buf, len,
+                    "%s{\"coord\":{\"lon\":-6.2672,\"lat\":53.344},"
+                    "\"sys\":{\"type\":2,\"id\":2037026,\"country\":\"IE\",\"timezone\":0,\"sunrise\":1734597822,\"sunset\":1734623869},"
+                    "\"weather\":[{\"id\":500,\"main\":\"Rain\",\"description\":\"light rain\",\"icon\":\"10d\"}],"
+                    "\"main\":{\"temp\":%s,\"feels_like\":%s,\"temp_min\":%s,\"temp_max\":%s,\"pressure\":1012,\"humidity\":81},"
+                    "\"visibility\":10000,\"wind\":{\"speed\":7.2,\"deg\":250},\"clouds\":{\"all\":75},"
+                    "\"dt\":%lld,\"id\":%lld,\"name\":\"City %zu\"}",
+                    city ? "," : "", t, feels, t_min, t_max, FIRST_DT + (long long)city * 60,
+                    (long long)rec->city_ids[city], city);
+}
+
+static char *format_group_body(const owm_recording_t *rec, size_t *len) {
+    size_t cap = 32 + rec->cities * CITY_MAX;
+    char *body = malloc(cap);
+    if (!body) {
+        return NULL;
+    }
+
+    size_t used = snprintf(body, cap, "{\"cnt\":%zu,\"list\":[", rec->cities);
+    for (size_t city = 0; city < rec->cities; city++) {
+        used += format_city(body + used, cap - used, rec, city);
+    }
+    used += snprintf(body + used, cap - used, "]}");
+    *len = used;
+    return body;
+}
+
+static char *format_body(const owm_recording_t *rec, size_t *len) {
+    if (rec->city_ids) {
+        return format_group_body(rec, len);
+    }
+
+    static const char head[] = "{\"cod\":\"200\",\"message\":0,\"cnt\":40,\"list\":[";
+    static const char tail[] =
+        "],\"city\":{\"id\":2964574,\"name\":\"Dublin\",\"coord\":{\"lat\":53.344,\"lon\":-6.2672},"
+        "\"country\":\"IE\",\"population\":1024027,\"timezone\":0,\"sunrise\":1734597822,\"sunset\":1734623869}}";
+    size_t cap = sizeof(head) + OWM_REPLAY_SLOTS * SLOT_MAX + sizeof(tail);
+    char *body = malloc(cap);
+    if (!body) {
+        return NULL;
+    }
+
+    size_t used = snprintf(body, cap, "%s", head);
+    for (int slot = 0; slot < OWM_REPLAY_SLOTS; slot++) {
+        used += format_slot(body + used, cap - used, rec, slot);
+    }
+    used += snprintf(body + used, cap - used, "%s", tail);
+    *len = used;
+    return body;
+}
+
+char *owm_replay_response(const owm_recording_t *rec, size_t *len) {
+    size_t body_len;
+    char *body = format_body(rec, &body_len);
+    if (!body) {
+        return NULL;
+    }
+
+    /* Chunked framing adds "<hex>\r\n" + "\r\n" per chunk and the last-chunk */
+    size_t cap = body_len + 512 + (body_len / CHUNK_SIZE + 1) * 16;
+    char *resp = malloc(cap);
+    if (!resp) {
+        free(body);
+        return NULL;
+    }
+
+    size_t used = snprintf(resp, cap,
+                           "HTTP/1.1 200 OK\r\n"
+                           "Server: openresty\r\n"
+                           "Date: Thu, 19 Dec 2024 10:31:02 GMT\r\n"
+                           "Content-Type: application/json; charset=utf-8\r\n"
+                           "ETag: %s\r\n"
+                           "X-Cache-Key: /data/2.5/forecast?cnt=40&q=dublin,ie&units=metric\r\n",
+                           rec->etag);
+    if (rec->framing == OWM_FRAMING_CHUNKED) {
+        used += snprintf(resp + used, cap - used, "Transfer-Encoding: chunked\r\n\r\n");
+        for (size_t off = 0; off < body_len; off += CHUNK_SIZE) {
+            size_t n = body_len - off < CHUNK_SIZE ? body_len - off : CHUNK_SIZE;
+            used += snprintf(resp + used, cap - used, "%zx\r\n", n);
+            memcpy(resp + used, body + off, n);
+            used += n;
+            used += snprintf(resp + used, cap - used, "\r\n");
+        }
+        used += snprintf(resp + used, cap - used, "0\r\n\r\n");
+    } else {
+        used += snprintf(resp + used, cap - used, "Content-Length: %zu\r\n%s\r\n", body_len,
+                         rec->framing == OWM_FRAMING_CLOSE ? "Connection: close\r\n" : "");
+        memcpy(resp + used, body, body_len + 1);
+        used += body_len;
+    }
+
+    free(body);
+    *len = used;
+    return resp;
+}
+
+void owm_replay_expected(const owm_recording_t *rec, int *temp_min, int *temp_now, int *temp_max) {
+    int lo = slot_temp_centi(rec, 0) - 40;
+    int hi = slot_temp_centi(rec, 0) + 35;
+    for (int slot = 1; slot < OWM_REPLAY_SLOTS; slot++) {
+        int temp = slot_temp_centi(rec, slot);
+        if (temp - 40 < lo) {
+            lo = temp - 40;
+        }
+        if (temp + 35 > hi) {
+            hi = temp + 35;
+        }
+    }
+    /* C division truncates towards zero, like the parser */
+    *temp_min = lo;
+    *temp_now = slot_temp_centi(rec, 0);
+    *temp_max = hi;
+}
+
+void owm_replay_expected_city(const owm_recording_t *rec, size_t city, int *temp_min, int *temp_now, int *temp_max) {
+    int temp = city_temp_centi(rec, city);
+    *temp_min = temp - 40;
+    *temp_now = temp;
+    *temp_max = temp + 35;
+}
+
+static bool send_all(owm_replay_t *replay, int sock, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(sock, buf, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        replay->stats.bytes_sent += n;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief Answer requests on one connection until either side closes it
+ */
+static void serve_connection(owm_replay_t *replay, int sock) {
+    char req[REQUEST_MAX];
+    size_t used = 0;
+
+    while (!replay->stop) {
+        ssize_t n = recv(sock, req + used, sizeof(req) - 1 - used, 0);
+        if (n <= 0) {
+            return;
+        }
+        used += n;
+        req[used] = '\0';
+
+        char *end = strstr(req, "\r\n\r\n");
+        if (!end) {
+            if (used == sizeof(req) - 1) {
+                ESP_LOGE(TAG, "Request too long");
+                return;
+            }
+            continue;
+        }
+
+        const owm_recording_t *rec = &replay->recordings[replay->selected];
+        char validator[96];
+        snprintf(validator, sizeof(validator), "If-None-Match: %s\r\n", rec->etag);
+        end[2] = '\0';     // keep the last header line's CRLF
+        replay->stats.requests++;
+        if (sscanf(req, "GET %255s", replay->last_path) != 1) {
+            replay->last_path[0] = '\0';
+        }
+
+        if (strstr(req, validator)) {
+            char not_modified[128];
+            int len = snprintf(not_modified, sizeof(not_modified), "HTTP/1.1 304 Not Modified\r\nETag: %s\r\n\r\n", rec->etag);
+            replay->stats.not_modified++;
+            if (!send_all(replay, sock, not_modified, len)) {
+                return;
+            }
+        } else {
+            if (!send_all(replay, sock, replay->responses[replay->selected], replay->response_lens[replay->selected])) {
+                return;
+            }
+            if (rec->framing == OWM_FRAMING_CLOSE) {
+                return;
+            }
+        }
+
+        /* Keep anything pipelined behind this request */
+        size_t consumed = end + 4 - req;
+        memmove(req, req + consumed, used - consumed);
+        used -= consumed;
+    }
+}
+
+static void *replay_thread(void *arg) {
+    owm_replay_t *replay = arg;
+
+    while (!replay->stop) {
+        int sock = accept(replay->listen_sock, NULL, NULL);
+        if (sock < 0) {
+            break;
+        }
+        replay->stats.connections++;
+        serve_connection(replay, sock);
+        close(sock);
+    }
+    return NULL;
+}
+
+esp_err_t owm_replay_start(owm_replay_t *replay, const owm_recording_t *recordings, size_t count) {
+    memset(replay, 0, sizeof(*replay));
+    replay->recordings = recordings;
+    replay->count = count;
+    replay->listen_sock = -1;
+    replay->responses = calloc(count, sizeof(replay->responses[0]));
+    replay->response_lens = calloc(count, sizeof(replay->response_lens[0]));
+    if (!replay->responses || !replay->response_lens) {
+        owm_replay_stop(replay);
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < count; i++) {
+        replay->responses[i] = owm_replay_response(&recordings[i], &replay->response_lens[i]);
+        if (!replay->responses[i]) {
+            owm_replay_stop(replay);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = 0,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addr_len = sizeof(addr);
+    replay->listen_sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (replay->listen_sock < 0
+            || bind(replay->listen_sock, (struct sockaddr *)&addr, sizeof(addr)) != 0
+            || listen(replay->listen_sock, 4) != 0
+            || getsockname(replay->listen_sock, (struct sockaddr *)&addr, &addr_len) != 0) {
+        ESP_LOGE(TAG, "Can't listen on loopback");
+        owm_replay_stop(replay);
+        return ESP_FAIL;
+    }
+    snprintf(replay->port, sizeof(replay->port), "%u", ntohs(addr.sin_port));
+
+    if (pthread_create(&replay->thread, NULL, replay_thread, replay) != 0) {
+        replay->port[0] = '\0';
+        owm_replay_stop(replay);
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Replaying %zu recordings on 127.0.0.1:%s", count, replay->port);
+    return ESP_OK;
+}
+
+void owm_replay_select(owm_replay_t *replay, size_t index) {
+    replay->selected = index < replay->count ? index : replay->count - 1;
+}
+
+void owm_replay_stop(owm_replay_t *replay) {
+    if (replay->listen_sock >= 0) {
+        replay->stop = true;
+        shutdown(replay->listen_sock, SHUT_RDWR);      // wakes accept()
+        if (replay->port[0]) {
+            pthread_join(replay->thread, NULL);
+        }
+        close(replay->listen_sock);
+        replay->listen_sock = -1;
+    }
+    for (size_t i = 0; replay->responses && i < replay->count; i++) {
+        free(replay->responses[i]);
+    }
+    free(replay->responses);
+    free(replay->response_lens);
+    replay->responses = NULL;
+    replay->response_lens = NULL;
+}
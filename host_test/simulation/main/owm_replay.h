@@ -0,0 +1,129 @@
+/**
+ * @file owm_replay.h
+ * @author The Authors
+ * @brief Loopback replay of recorded OpenWeatherMap /forecast and /group responses
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * A recording is a 40 slot (5 day, cnt=40) forecast plus the way the server
+ * framed it. The replay server answers every GET with the selected recording,
+ * or a 304 when the request's If-None-Match carries that recording's ETag, so
+ * the client's conditional GETs and connection reuse are exercised for real.
+ *
+ * A recording with city_ids is a /group response instead: current weather
+ * for each city, one list entry per city.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OWM_REPLAY_SLOTS    40
+
+typedef enum {
+    OWM_FRAMING_LENGTH,         // Content-Length, keep-alive
+    OWM_FRAMING_CHUNKED,        // Transfer-Encoding: chunked, keep-alive
+    OWM_FRAMING_CLOSE,          // Content-Length, then "Connection: close"
+} owm_framing_t;
+
+typedef struct {
+    const char *name;
+    const char *etag;
+    owm_framing_t framing;
+    int base_centi;             // temperature at the first slot, 1/100 degC
+    int drift_centi;            // added per day, or per city for /group
+    const int64_t *city_ids;    // NULL for /forecast
+    size_t cities;
+} owm_recording_t;
+
+typedef struct {
+    uint32_t connections;
+    uint32_t requests;
+    uint32_t not_modified;
+    uint64_t bytes_sent;
+} owm_replay_stats_t;
+
+typedef struct {
+    const owm_recording_t *recordings;
+    size_t count;
+    char **responses;           // full 200 response per recording, headers included
+    size_t *response_lens;
+    size_t selected;
+
+    int listen_sock;
+    char port[8];
+    pthread_t thread;
+    volatile bool stop;
+    owm_replay_stats_t stats;
+    char last_path[256];        // of the last request, truncated
+} owm_replay_t;
+
+/**
+ * @brief Build every response up front (the server doesn't allocate while
+ *        serving) and start listening on 127.0.0.1, any free port
+ *
+ * @param replay
+ * @param recordings
+ * @param count
+ * @return esp_err_t
+ */
+esp_err_t owm_replay_start(owm_replay_t *replay, const owm_recording_t *recordings, size_t count);
+
+/**
+ * @brief Serve recordings[index] from the next request on
+ *
+ * @param replay
+ * @param index
+ */
+void owm_replay_select(owm_replay_t *replay, size_t index);
+
+/**
+ * @brief Stop the server and free the responses
+ *
+ * @param replay
+ */
+void owm_replay_stop(owm_replay_t *replay);
+
+/**
+ * @brief Render the 200 response for a recording into a new buffer
+ *
+ * @param rec
+ * @param[out] len
+ * @return char*    malloc'd, NUL terminated, NULL if out of memory
+ */
+char *owm_replay_response(const owm_recording_t *rec, size_t *len);
+
+/**
+ * @brief What the forecast parser should make of a recording, in
+ *        centi-degrees like the parser
+ *
+ * @param rec
+ * @param[out] temp_min
+ * @param[out] temp_now
+ * @param[out] temp_max
+ */
+void owm_replay_expected(const owm_recording_t *rec, int *temp_min, int *temp_now, int *temp_max);
+
+/**
+ * @brief What sites.c should make of one city in a /group recording
+ *
+ * @param rec
+ * @param city      index into rec->city_ids
+ * @param[out] temp_min
+ * @param[out] temp_now
+ * @param[out] temp_max
+ */
+void owm_replay_expected_city(const owm_recording_t *rec, size_t city, int *temp_min, int *temp_now, int *temp_max);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,468 @@
+/**
+ * @file sim_main.c
+ * @author The Authors
+ * @brief Host simulation of fetch -> parse -> render, and its benchmark baseline
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Drives the real http_client, forecast_parser, boundary_checks, light_anim
+ * and light_fb the way http_get_task and light_render_task do, minus the
+ * delays, against owm_replay and the recording led_strip mock. Reports:
+ *   - parse throughput of a full 40 slot response (framing + tokenizer)
+ *   - fetch -> first frame latency per update
+ *   - refreshes per update (and the WS2812 bus time they'd cost)
+ *   - peak heap (sampled from every body chunk & frame) and peak stack
+ * and runs several locations off one /group request per cycle, each on its
+ * own mock strip.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "led_strip.h"
+#include "forecast_parser.h"
+#include "http_response.h"
+#include "http_client.h"
+#include "sites.h"
+#include "light_driver.h"
+#include "light_fb.h"
+#include "light_anim.h"
+#include "owm_replay.h"
+
+static const char *TAG = "sim";
+
+#define SIM_PATH                "/data/2.5/forecast?q=dublin,ie&cnt=40&units=metric"
+#define SIM_GROUP_IDS           "2964574,2643743,2988507"
+#define SIM_GROUP_PATH          "/data/2.5/group?id=" SIM_GROUP_IDS "&units=metric"
+#define SIM_SITES               3
+#define SIM_RECV_BUF            64              // as http_get_task
+#define SIM_STACK_SIZE          (64 * 1024)
+#define SIM_STACK_PAINT         0xa5
+#define PARSE_BENCH_ITERATIONS  200
+#define ANIMATION_TICKS_MAX     1000
+
+static const owm_recording_t s_recordings[] = {
+    { "mild",      "\"owm-1\"", OWM_FRAMING_LENGTH,   850, -120, NULL, 0 },
+    { "cold snap", "\"owm-2\"", OWM_FRAMING_CHUNKED, -620, -150, NULL, 0 },     // below the strip
+    { "heatwave",  "\"owm-3\"", OWM_FRAMING_CLOSE,   3380,   60, NULL, 0 },     // above the strip
+};
+
+/* One entry per fetch, as the 60 s loop in http_get_task would make them */
+static const struct {
+    size_t recording;
+    int status;
+} s_script[] = {
+    { 0, 200 },
+    { 0, 304 },
+    { 1, 200 },
+    { 1, 304 },
+    { 1, 304 },
+    { 2, 200 },     // server closes the connection after this one
+    { 0, 200 },
+};
+
+#define SIM_UPDATES ((uint32_t)(sizeof(s_script) / sizeof(s_script[0])))
+
+static const int64_t s_group_ids[SIM_SITES] = { 2964574, 2643743, 2988507 };
+
+static const owm_recording_t s_group_recordings[] = {
+    { "group",       "\"owm-g1\"", OWM_FRAMING_CHUNKED,  720, -410, s_group_ids, SIM_SITES },
+    { "group later", "\"owm-g2\"", OWM_FRAMING_LENGTH,  1460, -930, s_group_ids, SIM_SITES },   // last one below the strip
+};
+
+static const struct {
+    size_t recording;
+    int status;
+} s_group_script[] = {
+    { 0, 200 },
+    { 0, 304 },
+    { 1, 200 },
+    { 1, 304 },
+};
+
+#define SIM_GROUP_CYCLES ((uint32_t)(sizeof(s_group_script) / sizeof(s_group_script[0])))
+
+typedef struct {
+    int status;
+    light_display_state_t state;
+    uint32_t body_bytes;
+    int64_t fetch_us;           // request -> response complete, parsing included
+    int64_t parse_us;           // ... of which in the tokenizer
+    int64_t first_frame_us;     // request -> first frame flushed
+    uint32_t frames;
+    uint32_t refreshes;
+    uint32_t pixel_writes;
+} sim_update_t;
+
+typedef struct {
+    owm_replay_t *replay;
+    sim_update_t updates[SIM_UPDATES];
+    http_client_stats_t client;
+    size_t heap_peak;           // above what was in use before the pipeline started
+} sim_run_t;
+
+typedef struct {
+    forecast_parser_t parser;
+    int64_t parse_us;
+    uint32_t body_bytes;
+} sim_sink_t;
+
+static size_t s_heap_peak;
+
+static size_t heap_in_use(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;       // no portable way to ask, reported as 0
+#endif
+}
+
+static inline void heap_sample(void) {
+    size_t used = heap_in_use();
+    if (used > s_heap_peak) {
+        s_heap_peak = used;
+    }
+}
+
+static void sim_body_cb(void *ctx, const char *buf, size_t len) {
+    sim_sink_t *sink = ctx;
+    int64_t start = esp_timer_get_time();
+    forecast_parser_feed(&sink->parser, buf, len);
+    sink->parse_us += esp_timer_get_time() - start;
+    sink->body_bytes += len;
+    heap_sample();
+}
+
+static void parser_cb(void *ctx, const char *buf, size_t len) {
+    forecast_parser_feed((forecast_parser_t *)ctx, buf, len);
+}
+
+/**
+ * @brief The firmware's update loop, one pass per s_script entry
+ */
+static void *pipeline_thread(void *arg) {
+    sim_run_t *run = arg;
+    static http_client_t client;
+    char recv_buf[SIM_RECV_BUF];
+    sim_sink_t sink;
+    light_display_state_t state = { .brightness = LIGHT_DEFAULT_BRIGHTNESS };
+    bool have_forecast = false;
+    light_fb_t fb;
+
+    size_t baseline = heap_in_use();
+    s_heap_peak = baseline;
+
+    led_strip_handle_t strip = led_strip_mock_new(LIGHT_STRIP_LEDS);
+    if (light_fb_init(&fb, strip, LIGHT_STRIP_LEDS) != ESP_OK) {
+        return NULL;
+    }
+    light_fb_invalidate(&fb);
+    http_client_init(&client, "127.0.0.1", run->replay->port, "api.openweathermap.org");
+
+    for (uint32_t i = 0; i < SIM_UPDATES; i++) {
+        sim_update_t *u = &run->updates[i];
+        owm_replay_select(run->replay, s_script[i].recording);
+
+        memset(&sink, 0, sizeof(sink));
+        forecast_parser_init(&sink.parser);
+        int64_t start = esp_timer_get_time();
+        u->status = http_client_get(&client, SIM_PATH, recv_buf, sizeof(recv_buf), sim_body_cb, &sink);
+        u->fetch_us = esp_timer_get_time() - start;
+        u->parse_us = sink.parse_us;
+        u->body_bytes = sink.body_bytes;
+
+        if (u->status == 200) {
+            forecast_parser_finish(&sink.parser);
+            state.temp_min = sink.parser.temp_min;
+            state.temp_now = sink.parser.temp_now;
+            state.temp_max = sink.parser.temp_max;
+            have_forecast = true;
+        } else if (u->status != 304 || !have_forecast) {
+            continue;
+        }
+        boundary_checks(&state.temp_min, &state.temp_now, &state.temp_max);
+        u->state = state;
+
+        uint32_t refreshes = fb.stats.refreshes;
+        uint32_t pixel_writes = fb.stats.pixel_writes;
+        int frame = 0;
+        bool animating;
+        do {
+            animating = light_anim_render(&fb, &state, frame);
+            if (light_fb_flush(&fb) != ESP_OK) {
+                break;
+            }
+            if (frame == 0) {
+                u->first_frame_us = esp_timer_get_time() - start;
+            }
+            frame++;
+            heap_sample();
+        } while (animating && frame < ANIMATION_TICKS_MAX);
+        u->frames = frame;
+        u->refreshes = fb.stats.refreshes - refreshes;
+        u->pixel_writes = fb.stats.pixel_writes - pixel_writes;
+    }
+
+    http_client_close(&client);
+    run->client = client.stats;
+    run->heap_peak = s_heap_peak - baseline;
+    free(fb.rgb);
+    free(fb.sent);
+    led_strip_del(strip);
+    return NULL;
+}
+
+static void *idle_thread(void *arg) {
+    return NULL;
+}
+
+/**
+ * @brief Run fn on a thread whose stack is painted first, like FreeRTOS does
+ *        for uxTaskGetStackHighWaterMark()
+ *
+ * @return size_t   bytes of stack touched, including the thread's own overhead
+ */
+static size_t run_painted(void *(*fn)(void *), void *arg) {
+    void *stack = NULL;
+    pthread_attr_t attr;
+    pthread_t thread;
+
+    TEST_ASSERT_EQUAL(0, posix_memalign(&stack, 64, SIM_STACK_SIZE));
+    memset(stack, SIM_STACK_PAINT, SIM_STACK_SIZE);
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, SIM_STACK_SIZE);
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, &attr, fn, arg));
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+
+    /* Stacks grow down, count the untouched bytes from the bottom */
+    const uint8_t *bytes = stack;
+    size_t untouched = 0;
+    while (untouched < SIM_STACK_SIZE && bytes[untouched] == SIM_STACK_PAINT) {
+        untouched++;
+    }
+    free(stack);
+    return SIM_STACK_SIZE - untouched;
+}
+
+static void test_parse_throughput(void) {
+    size_t len;
+    char *response = owm_replay_response(&s_recordings[0], &len);
+    int temp_min, temp_now, temp_max;
+    http_response_t resp;
+    forecast_parser_t parser;
+
+    TEST_ASSERT_NOT_NULL(response);
+    owm_replay_expected(&s_recordings[0], &temp_min, &temp_now, &temp_max);
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < PARSE_BENCH_ITERATIONS; i++) {
+        http_response_init(&resp);
+        forecast_parser_init(&parser);
+        /* In recv_buf sized pieces, as they come off the socket */
+        for (size_t off = 0; off < len; off += SIM_RECV_BUF) {
+            size_t n = len - off < SIM_RECV_BUF ? len - off : SIM_RECV_BUF;
+            http_response_feed(&resp, response + off, n, parser_cb, &parser);
+        }
+        forecast_parser_finish(&parser);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+
+    TEST_ASSERT_TRUE(http_response_done(&resp));
+    TEST_ASSERT_EQUAL(temp_min, parser.temp_min);
+    TEST_ASSERT_EQUAL(temp_now, parser.temp_now);
+    TEST_ASSERT_EQUAL(temp_max, parser.temp_max);
+
+    if (elapsed_us <= 0) {
+        elapsed_us = 1;
+    }
+    printf("SIM parse: response=%zu bytes, %" PRId64 " us/response, %.1f MB/s\n",
+           len, elapsed_us / PARSE_BENCH_ITERATIONS, (double)len * PARSE_BENCH_ITERATIONS / elapsed_us);
+    free(response);
+}
+
+static void test_replay_pipeline(void) {
+    static sim_run_t run;
+    owm_replay_t replay;
+
+    memset(&run, 0, sizeof(run));
+    TEST_ASSERT_EQUAL(ESP_OK, owm_replay_start(&replay, s_recordings, sizeof(s_recordings) / sizeof(s_recordings[0])));
+    run.replay = &replay;
+    size_t stack_used = run_painted(pipeline_thread, &run);
+    size_t stack_idle = run_painted(idle_thread, NULL);
+    owm_replay_stop(&replay);
+
+    int64_t latency_min = INT64_MAX, latency_max = 0, latency_sum = 0;
+    uint32_t refreshes = 0;
+
+    printf("SIM update status bytes  fetch_us parse_us first_frame_us frames refreshes pixel_writes  min/now/max\n");
+    for (uint32_t i = 0; i < SIM_UPDATES; i++) {
+        const sim_update_t *u = &run.updates[i];
+        const owm_recording_t *rec = &s_recordings[s_script[i].recording];
+        int temp_min, temp_now, temp_max;
+
+        printf("SIM %6" PRIu32 " %6d %5" PRIu32 " %9" PRId64 " %8" PRId64 " %14" PRId64 " %6" PRIu32 " %9" PRIu32 " %12" PRIu32 "  " TEMP_C_FMT "/" TEMP_C_FMT "/" TEMP_C_FMT " (%s)\n",
+               i, u->status, u->body_bytes, u->fetch_us, u->parse_us, u->first_frame_us, u->frames, u->refreshes,
+               u->pixel_writes, TEMP_C_ARGS(u->state.temp_min), TEMP_C_ARGS(u->state.temp_now),
+               TEMP_C_ARGS(u->state.temp_max), rec->name);
+
+        TEST_ASSERT_EQUAL(s_script[i].status, u->status);
+        owm_replay_expected(rec, &temp_min, &temp_now, &temp_max);
+        boundary_checks(&temp_min, &temp_now, &temp_max);
+        TEST_ASSERT_EQUAL(temp_min, u->state.temp_min);
+        TEST_ASSERT_EQUAL(temp_now, u->state.temp_now);
+        TEST_ASSERT_EQUAL(temp_max, u->state.temp_max);
+        if (u->status == 304) {
+            TEST_ASSERT_EQUAL(0, u->body_bytes);
+        }
+
+        TEST_ASSERT_GREATER_THAN(0, u->refreshes);
+        TEST_ASSERT_LESS_OR_EQUAL(u->frames, u->refreshes);
+
+        latency_sum += u->first_frame_us;
+        if (u->first_frame_us < latency_min) {
+            latency_min = u->first_frame_us;
+        }
+        if (u->first_frame_us > latency_max) {
+            latency_max = u->first_frame_us;
+        }
+        refreshes += u->refreshes;
+    }
+
+    /* Keep-alive across the 304s, one reconnect after "Connection: close" */
+    TEST_ASSERT_EQUAL(2, replay.stats.connections);
+    TEST_ASSERT_EQUAL(SIM_UPDATES, replay.stats.requests);
+    TEST_ASSERT_EQUAL(3, replay.stats.not_modified);
+    TEST_ASSERT_EQUAL(2, run.client.connects);
+
+    printf("SIM fetch->first frame: min=%" PRId64 " avg=%" PRId64 " max=%" PRId64 " us (the device adds up to one %d ms render tick)\n",
+           latency_min, latency_sum / (int64_t)SIM_UPDATES, latency_max, LIGHT_ANIM_TICK_MS);
+    printf("SIM refreshes/update=%" PRIu32 ".%02" PRIu32 " (WS2812 bus time %d us/refresh, %" PRIu32 " us/update)\n",
+           refreshes / SIM_UPDATES, refreshes * 100 / SIM_UPDATES % 100, LIGHT_FB_WIRE_TIME_US(LIGHT_STRIP_LEDS),
+           (uint32_t)(refreshes / SIM_UPDATES * LIGHT_FB_WIRE_TIME_US(LIGHT_STRIP_LEDS)));
+    printf("SIM peak heap=%zu bytes, peak stack=%zu bytes (host ABI), bytes from server=%" PRIu64 "\n",
+           run.heap_peak, stack_used - stack_idle, replay.stats.bytes_sent);
+    ESP_LOGI(TAG, "connects=%" PRIu32 " requests=%" PRIu32 " reused=%" PRIu32 " not_modified=%" PRIu32 " dns_lookups=%" PRIu32,
+             run.client.connects, run.client.requests, run.client.reused, run.client.not_modified, run.client.dns_lookups);
+}
+
+/* As light_render_task, to the end. The strip is dark then, so last_lit gets
+ * what it showed on the final frame with the values up. */
+static uint32_t sim_animate(light_fb_t *fb, const light_display_state_t *state, uint8_t *last_lit) {
+    uint32_t refreshes = fb->stats.refreshes;
+    bool animating;
+    int frame = 0;
+    do {
+        animating = light_anim_render(fb, state, frame++);
+        light_fb_flush(fb);
+        if (animating) {
+            memcpy(last_lit, led_strip_mock_shown(fb->strip), LIGHT_STRIP_LEDS * 3);
+        }
+    } while (animating && frame < ANIMATION_TICKS_MAX);
+    return fb->stats.refreshes - refreshes;
+}
+
+/**
+ * @brief http_get_task in group mode: one request per cycle for every site,
+ *        each site fanned out to its own strip
+ */
+static void test_multi_site(void) {
+    static http_client_t client;
+    static sites_t sites;
+    char recv_buf[SIM_RECV_BUF];
+    light_fb_t fbs[SIM_SITES], ref_fb;
+    light_display_state_t states[SIM_SITES];
+    static uint8_t shown[SIM_SITES][LIGHT_STRIP_LEDS * 3], ref_shown[LIGHT_STRIP_LEDS * 3];
+    owm_replay_t replay;
+
+    TEST_ASSERT_EQUAL(SIM_SITES, sites_init(&sites, SIM_GROUP_IDS));
+    for (size_t i = 0; i < SIM_SITES; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&fbs[i], led_strip_mock_new(LIGHT_STRIP_LEDS), LIGHT_STRIP_LEDS));
+        light_fb_invalidate(&fbs[i]);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, light_fb_init(&ref_fb, led_strip_mock_new(LIGHT_STRIP_LEDS), LIGHT_STRIP_LEDS));
+    TEST_ASSERT_EQUAL(ESP_OK, owm_replay_start(&replay, s_group_recordings, sizeof(s_group_recordings) / sizeof(s_group_recordings[0])));
+    http_client_init(&client, "127.0.0.1", replay.port, "api.openweathermap.org");
+
+    for (uint32_t cycle = 0; cycle < SIM_GROUP_CYCLES; cycle++) {
+        const owm_recording_t *rec = &s_group_recordings[s_group_script[cycle].recording];
+        owm_replay_select(&replay, s_group_script[cycle].recording);
+
+        sites_begin(&sites);
+        int64_t start = esp_timer_get_time();
+        int status = http_client_get(&client, SIM_GROUP_PATH, recv_buf, sizeof(recv_buf), sites_body_cb, &sites);
+        size_t updated = status == 200 ? sites_finish(&sites) : 0;
+        int64_t fetch_us = esp_timer_get_time() - start;
+
+        TEST_ASSERT_EQUAL(s_group_script[cycle].status, status);
+        TEST_ASSERT_EQUAL(cycle + 1, replay.stats.requests);
+        TEST_ASSERT_EQUAL_STRING(SIM_GROUP_PATH, replay.last_path);
+        TEST_ASSERT_EQUAL(status == 200 ? SIM_SITES : 0, updated);
+        TEST_ASSERT_EQUAL(0, sites.unknown);
+
+        uint32_t refreshes = 0;
+        for (size_t i = 0; i < SIM_SITES; i++) {
+            const site_t *site = &sites.sites[i];
+            light_display_state_t *state = &states[i];
+            int temp_min, temp_now, temp_max;
+
+            TEST_ASSERT_TRUE(site->valid);
+            TEST_ASSERT_EQUAL_INT64(s_group_ids[i], site->city_id);
+            state->temp_min = site->temp_min;
+            state->temp_now = site->temp_now;
+            state->temp_max = site->temp_max;
+            state->brightness = LIGHT_DEFAULT_BRIGHTNESS;
+            state->skip_sweep = false;
+            boundary_checks(&state->temp_min, &state->temp_now, &state->temp_max);
+            refreshes += sim_animate(&fbs[i], state, shown[i]);
+
+            /* Each strip ends up showing its own city, as rendered on its own */
+            owm_replay_expected_city(rec, i, &temp_min, &temp_now, &temp_max);
+            boundary_checks(&temp_min, &temp_now, &temp_max);
+            TEST_ASSERT_EQUAL(temp_min, state->temp_min);
+            TEST_ASSERT_EQUAL(temp_now, state->temp_now);
+            TEST_ASSERT_EQUAL(temp_max, state->temp_max);
+            light_fb_invalidate(&ref_fb);
+            sim_animate(&ref_fb, state, ref_shown);
+            TEST_ASSERT_EQUAL_MEMORY(ref_shown, shown[i], sizeof(ref_shown));
+        }
+        printf("SIM group cycle %" PRIu32 ": status=%d sites=%zu updated=%zu fetch_us=%" PRId64 " refreshes=%" PRIu32 " (%s)\n",
+               cycle, status, sites.count, updated, fetch_us, refreshes, rec->name);
+    }
+
+    /* The strips differ from each other, so nothing above passed by accident */
+    TEST_ASSERT_NOT_EQUAL(0, memcmp(shown[0], shown[1], sizeof(shown[0])));
+
+    http_client_close(&client);
+    owm_replay_stop(&replay);
+    TEST_ASSERT_EQUAL(SIM_GROUP_CYCLES, replay.stats.requests);
+    TEST_ASSERT_EQUAL(1, replay.stats.connections);
+    TEST_ASSERT_EQUAL(SIM_GROUP_CYCLES / 2, replay.stats.not_modified);
+
+    for (size_t i = 0; i < SIM_SITES; i++) {
+        led_strip_del(fbs[i].strip);
+        free(fbs[i].rgb);
+        free(fbs[i].sent);
+    }
+    led_strip_del(ref_fb.strip);
+    free(ref_fb.rgb);
+    free(ref_fb.sent);
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_throughput);
+    RUN_TEST(test_replay_pipeline);
+    RUN_TEST(test_multi_site);
+    exit(UNITY_END());
+}
@@ -0,0 +1,176 @@
+/**
+ * @file boot.c
+ * @author The Authors
+ * @brief Startup phases run on a few worker tasks, each once its dependencies are done
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdio.h>
+#include <inttypes.h>
+#include <assert.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "boot.h"
+
+static const char *TAG = "boot";
+
+/*
+ * Two chains (LED & cached reading, NVS & netif & Wi-Fi) overlap with two
+ * workers; a task per phase would hold 7 stacks for phases that mostly wait.
+ * Deepest phase is Wi-Fi (example_connect).
+ */
+#define BOOT_WORKERS        2
+#define BOOT_TASK_STACK     4096
+#define BOOT_TASK_PRIORITY  5
+
+/* Done, or failed: what a dependent phase waits for */
+#define SETTLED_BIT(id)     BOOT_BIT((id) + BOOT_PHASES)
+#define SETTLED(bits)       ((bits) << BOOT_PHASES)
+
+_Static_assert(2 * BOOT_PHASES <= 24, "an event group has 24 bits");
+
+static const boot_phase_t *s_phases;
+static EventGroupHandle_t s_done;
+static portMUX_TYPE s_claim_lock = portMUX_INITIALIZER_UNLOCKED;
+static EventBits_t s_claimed;           // phases a worker has taken, under s_claim_lock
+static int64_t s_start_us[BOOT_PHASES];
+static int64_t s_end_us[BOOT_PHASES];
+static esp_err_t s_err[BOOT_PHASES];
+static bool s_skipped[BOOT_PHASES];
+static int64_t s_boot_us;
+
+static const char *boot_phase_error(boot_phase_id_t id) {
+    return s_skipped[id] ? "skipped" : esp_err_to_name(s_err[id]);
+}
+
+/* err is ESP_OK if a dep failed and it never ran */
+static void boot_phase_failed(boot_phase_id_t id, esp_err_t err) {
+    const boot_phase_t *phase = &s_phases[id];
+
+    s_err[id] = err;
+    s_skipped[id] = err == ESP_OK;
+    if (phase->required) {
+        ESP_LOGE(TAG, "Required phase %s failed: %s", phase->name, boot_phase_error(id));
+        ESP_ERROR_CHECK(s_skipped[id] ? ESP_FAIL : err);
+    }
+    ESP_LOGW(TAG, "%s failed: %s", phase->name, boot_phase_error(id));
+    xEventGroupSetBits(s_done, SETTLED_BIT(id));
+}
+
+/*
+ * Take the first phase not yet taken whose deps have all settled. Returns
+ * BOOT_PHASES when every phase is taken, -1 when none is ready yet.
+ */
+static int boot_claim(EventBits_t bits) {
+    int claimed = BOOT_PHASES;
+
+    taskENTER_CRITICAL(&s_claim_lock);
+    for (int id = 0; id < BOOT_PHASES; id++) {
+        if (s_claimed & BOOT_BIT(id)) {
+            continue;
+        }
+        if ((bits & SETTLED(s_phases[id].deps)) == SETTLED(s_phases[id].deps)) {
+            s_claimed |= BOOT_BIT(id);
+            claimed = id;
+            break;
+        }
+        claimed = -1;
+    }
+    taskEXIT_CRITICAL(&s_claim_lock);
+    return claimed;
+}
+
+static void boot_run(boot_phase_id_t id) {
+    const boot_phase_t *phase = &s_phases[id];
+
+    if ((xEventGroupGetBits(s_done) & phase->deps) != phase->deps) {
+        boot_phase_failed(id, ESP_OK);
+        return;
+    }
+    s_start_us[id] = esp_timer_get_time();
+    esp_err_t err = phase->run();
+    if (err != ESP_OK) {
+        boot_phase_failed(id, err);
+    } else if (!phase->completes_later) {
+        boot_phase_done(id);
+    }
+}
+
+static void boot_task(void *pvParameters) {
+    for (;;) {
+        EventBits_t bits = xEventGroupGetBits(s_done);
+        int id = boot_claim(bits);
+
+        if (id == BOOT_PHASES) {
+            break;
+        }
+        if (id < 0) {
+            /* Until another phase settles; one settled since bits was read returns at once */
+            xEventGroupWaitBits(s_done, SETTLED(BOOT_ALL) & ~bits, pdFALSE, pdFALSE, portMAX_DELAY);
+            continue;
+        }
+        boot_run(id);
+    }
+    ESP_LOGI(TAG, "Phases taken, %u B of stack to spare", (unsigned)uxTaskGetStackHighWaterMark(NULL));
+    vTaskDelete(NULL);
+}
+
+void boot_start(const boot_phase_t *phases) {
+    s_boot_us = esp_timer_get_time();
+    s_phases = phases;
+    s_claimed = 0;
+    s_done = xEventGroupCreate();
+    assert(s_done);
+
+    for (int id = 0; id < BOOT_PHASES; id++) {
+        s_start_us[id] = -1;
+        s_end_us[id] = -1;
+        s_err[id] = ESP_OK;
+        s_skipped[id] = false;
+        assert((phases[id].deps & ~(BOOT_BIT(id) - 1)) == 0);     // deps come first
+    }
+    for (int i = 0; i < BOOT_WORKERS; i++) {
+        BaseType_t ok = xTaskCreate(&boot_task, "boot", BOOT_TASK_STACK, NULL, BOOT_TASK_PRIORITY, NULL);
+        assert(ok == pdPASS);
+    }
+}
+
+void boot_phase_done(boot_phase_id_t id) {
+    if (!s_done || s_end_us[id] >= 0) {
+        return;
+    }
+    s_end_us[id] = esp_timer_get_time();
+    ESP_LOGI(TAG, "%s done at %" PRId64 " ms (took %" PRId64 " ms)", s_phases[id].name,
+             s_end_us[id] / 1000, (s_end_us[id] - s_start_us[id]) / 1000);
+    xEventGroupSetBits(s_done, BOOT_BIT(id) | SETTLED_BIT(id));
+}
+
+bool boot_wait(EventBits_t bits, TickType_t timeout) {
+    xEventGroupWaitBits(s_done, SETTLED(bits), pdFALSE, pdTRUE, timeout);
+    return (xEventGroupGetBits(s_done) & bits) == bits;
+}
+
+size_t boot_report(char *buf, size_t len) {
+    size_t used = snprintf(buf, len, "{\"app_main_us\":%" PRId64 ",\"phases\":{", s_boot_us);
+    for (int id = 0; id < BOOT_PHASES && used < len; id++) {
+        used += snprintf(buf + used, len - used, "%s\"%s\":[%" PRId64 ",%" PRId64 "]",
+                         id ? "," : "", s_phases[id].name, s_start_us[id], s_end_us[id]);
+    }
+    const char *sep = "},\"failed\":{";
+    for (int id = 0; id < BOOT_PHASES && used < len; id++) {
+        if (s_err[id] != ESP_OK || s_skipped[id]) {
+            used += snprintf(buf + used, len - used, "%s\"%s\":\"%s\"", sep, s_phases[id].name,
+                             boot_phase_error(id));
+            sep = ",";
+        }
+    }
+    if (used < len) {
+        used += snprintf(buf + used, len - used, "}}");
+    }
+    return used;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file boot.h
+ * @author The Authors
+ * @brief Startup phases run on a few worker tasks, each once its dependencies are done
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+
+typedef enum {
+    BOOT_LED,           // strip & render task
+    BOOT_CACHED,        // last known reading from flash on the strip
+    BOOT_NVS,
+    BOOT_NETIF,         // netif & default event loop
+    BOOT_WIFI,          // associated, with an address
+    BOOT_MQTT,          // broker connected
+    BOOT_FETCH,         // first fresh forecast parsed
+    BOOT_PHASES,
+} boot_phase_id_t;
+
+#define BOOT_BIT(id)    ((EventBits_t)1 << (id))
+#define BOOT_ALL        (BOOT_BIT(BOOT_PHASES) - 1)
+
+typedef struct {
+    const char *name;
+    EventBits_t deps;           // BOOT_BIT()s that must be done first, earlier in the table
+    esp_err_t (*run)(void);
+    bool completes_later;       // done when boot_phase_done() is called, not when run returns
+    bool required;              // an error aborts, like ESP_ERROR_CHECK; otherwise it's reported
+} boot_phase_t;
+
+/**
+ * @brief Run the phases on a couple of worker tasks, each worker taking the
+ *        first phase in the table whose deps have settled. A dep that
+ *        failed (or was skipped) skips the phase.
+ *
+ * Independent chains run side by side. A phase blocking in run() holds
+ * its worker, so one that completes later should return and call
+ * boot_phase_done() instead.
+ *
+ * @param phases    BOOT_PHASES entries, indexed by boot_phase_id_t
+ */
+void boot_start(const boot_phase_t *phases);
+
+/**
+ * @brief Mark a phase done. Later calls are ignored.
+ *
+ * @param id
+ */
+void boot_phase_done(boot_phase_id_t id);
+
+/**
+ * @brief Wait for phases to be done, or to have failed
+ *
+ * @param bits
+ * @param timeout
+ * @return true if they are all done
+ */
+bool boot_wait(EventBits_t bits, TickType_t timeout);
+
+/**
+ * @brief JSON boot report: microseconds since reset at which each phase
+ *        started & finished (-1 if not yet), and the error of any that
+ *        failed ("skipped" if a dep did)
+ *
+ * @param buf
+ * @param len
+ * @return size_t   as snprintf
+ */
+size_t boot_report(char *buf, size_t len);
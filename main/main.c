@@ -20,22 +20,160 @@
 #include "http_get.h"
 #include "light_driver.h"
 #include "mqtt_handle.h"
+#include "telemetry.h"
+#include "local_temp_source.h"
+#include "forecast_history.h"
 #include "common.h"
+#include "boot.h"
+#include "power.h"
+#include "trace_sys.h"
+#include "log_sink.h"
 
-void app_main(void)
-{
-    ESP_ERROR_CHECK(nvs_flash_init());
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
+static const char *TAG = "main";
+
+#define BOOT_REPORT_TOPIC       "stat/stairs/boot"
+#define BOOT_REPORT_FETCH_WAIT  (30 * 1000 / portTICK_PERIOD_MS)
+#define TRACE_REPORT_TOPIC      "stat/stairs/trace"
+#define TRACE_REPORT_RECENT     16
 
+static esp_err_t boot_led(void) {
     light_driver_init(false);
+    telemetry_init();
+    light_driver_set_render_report_cb(telemetry_render);
+    local_temp_source_start(light_strip_animate_and_set);
+    return ESP_OK;
+}
+
+/* Last known reading straight away, the network can take seconds */
+static esp_err_t boot_cached(void) {
+    forecast_record_t last;
+    if (forecast_history_init() == ESP_OK && forecast_history_last(&last)) {
+        light_show_last_known(last.temp_min, last.temp_now, last.temp_max);
+    }
+    return ESP_OK;      // no history isn't fatal
+}
+
+static esp_err_t boot_nvs(void) {
+    return nvs_flash_init();
+}
+
+static esp_err_t boot_netif(void) {
+    esp_err_t err = esp_netif_init();
+    return err == ESP_OK ? esp_event_loop_create_default() : err;
+}
+
+/* This helper function configures Wi-Fi or Ethernet, as selected in menuconfig.
+ * Read "Establishing Wi-Fi or Ethernet Connection" section in
+ * examples/protocols/README.md for more information about this function.
+*/
+static esp_err_t boot_wifi(void) {
+    esp_err_t err = example_connect();
+    if (err == ESP_OK) {
+        power_wifi_sleep();
+    }
+    return err;
+}
+
+static void on_mqtt_connected(void) {
+    boot_phase_done(BOOT_MQTT);
+}
+
+static void cmd_power(const char *data, size_t len) {
+    bool on;
+    if (mqtt_cmd_parse_bool(data, len, &on)) {
+        light_driver_set_power(on);
+    }
+}
+
+/* Redraws what's shown, no fetch */
+static void cmd_brightness(const char *data, size_t len) {
+    uint32_t level;
+    if (mqtt_cmd_parse_uint(data, len, LIGHT_BRIGHTNESS_LEVELS - 1, &level)) {
+        light_driver_set_brightness(level);
+        light_driver_redraw();
+    }
+}
 
-    /* This helper function configures Wi-Fi or Ethernet, as selected in menuconfig.
-     * Read "Establishing Wi-Fi or Ethernet Connection" section in
-     * examples/protocols/README.md for more information about this function.
-    */
-    ESP_ERROR_CHECK(example_connect());
+/* The status pixel's colour, readings keep the colormap */
+static void cmd_color(const char *data, size_t len) {
+    uint8_t red, green, blue;
+    if (mqtt_cmd_parse_rgb(data, len, &red, &green, &blue)) {
+        light_driver_set_color(red, green, blue);
+    }
+}
+
+static void cmd_refresh(const char *data, size_t len) {
+    http_get_refresh_now();
+}
+
+/* Payload: how many recent spans to list, empty for TRACE_REPORT_RECENT */
+static void cmd_trace(const char *data, size_t len) {
+    static char report[2048];          // MQTT task stack is small
+    uint32_t recent = TRACE_REPORT_RECENT;
+
+    if (len && !mqtt_cmd_parse_uint(data, len, TRACE_RING_LEN, &recent)) {
+        return;
+    }
+    trace_watch_task(NULL);             // the MQTT task, from its first report on
+    size_t n = trace_report(report, sizeof(report), recent);
+    mqtt_publish(TRACE_REPORT_TOPIC, report, n, 0);
+    ESP_LOGI(TAG, "Trace:\n%s", report);
+}
+
+static const mqtt_cmd_t s_commands[] = {
+    { "cmnd/stairs/power",      cmd_power },        // ON / OFF
+    { "cmnd/stairs/brightness", cmd_brightness },   // 0 to LIGHT_BRIGHTNESS_LEVELS - 1
+    { "cmnd/stairs/color",      cmd_color },        // #rrggbb or r,g,b, status pixel
+    { "cmnd/stairs/refresh",    cmd_refresh },      // anything
+    { "cmnd/stairs/trace",      cmd_trace },        // recent spans to list, or empty
+};
 
-    mqtt_start();
-    http_get_init((light_animate_and_set_cb_t)light_animate_and_set);
+static esp_err_t boot_mqtt(void) {
+    return mqtt_start(on_mqtt_connected, s_commands, sizeof(s_commands) / sizeof(s_commands[0]));
+}
+
+static void on_forecast(int64_t dt, int temp_min, int temp_now, int temp_max) {
+    forecast_history_record(dt, temp_min, temp_now, temp_max);
+    boot_phase_done(BOOT_FETCH);
+}
+
+static esp_err_t boot_fetch(void) {
+    http_get_init(local_temp_source_forecast, on_forecast, telemetry_fetch);
+    return ESP_OK;
+}
+
+/* Taken in this order once their deps settle; MQTT is optional, the light works without the broker */
+static const boot_phase_t s_boot_phases[BOOT_PHASES] = {
+    [BOOT_LED]    = { "led",    0,                                  boot_led,   false, true },
+    [BOOT_CACHED] = { "cached", BOOT_BIT(BOOT_LED),                 boot_cached },
+    [BOOT_NVS]    = { "nvs",    0,                                  boot_nvs,   false, true },
+    [BOOT_NETIF]  = { "netif",  0,                                  boot_netif, false, true },
+    [BOOT_WIFI]   = { "wifi",   BOOT_BIT(BOOT_NVS) | BOOT_BIT(BOOT_NETIF), boot_wifi, false, true },
+    [BOOT_MQTT]   = { "mqtt",   BOOT_BIT(BOOT_WIFI),                boot_mqtt,  true },
+    [BOOT_FETCH]  = { "fetch",  BOOT_BIT(BOOT_WIFI) | BOOT_BIT(BOOT_CACHED), boot_fetch, true, true },
+};
+
+/**
+ * @brief Publish the phase timings once the broker is up, after the first
+ *        fetch if that comes soon enough. Only logged if MQTT failed.
+ */
+static void boot_report_task(void *pvParameters) {
+    static char report[512];
+
+    bool mqtt = boot_wait(BOOT_BIT(BOOT_MQTT), portMAX_DELAY);
+    boot_wait(BOOT_ALL, BOOT_REPORT_FETCH_WAIT);
+    boot_report(report, sizeof(report));
+    ESP_LOGI(TAG, "Boot: %s", report);
+    if (mqtt) {
+        mqtt_publish(BOOT_REPORT_TOPIC, report, 0, 1);
+    }
+    vTaskDelete(NULL);
+}
+
+void app_main(void)
+{
+    log_sink_start();
+    ESP_ERROR_CHECK(power_init());
+    boot_start(s_boot_phases);
+    xTaskCreate(&boot_report_task, "boot_report", 3072, NULL, 2, NULL);
 }